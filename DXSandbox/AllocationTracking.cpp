@@ -0,0 +1,613 @@
+#include "AllocationTracking.hpp"
+
+#include "Debug.hpp"
+#include "Instrumentation.hpp"
+
+#ifdef _WIN32
+#   include "WindowsPlatform.hpp"
+#   include "StringUtils.hpp"
+#else
+#   include <dlfcn.h>
+#   include <execinfo.h>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <new>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    using DXSandbox::AllocationTracking::Tag;
+    using DXSandbox::Instrumentation::Counter;
+
+    constexpr std::size_t TagCount = static_cast<std::size_t>(Tag::Count);
+
+    constexpr const char* TagNames[TagCount] =
+    {
+        "Untagged",
+        "Window",
+        "Graphics",
+        "Scene",
+        "Capture",
+        "HotReload"
+    };
+
+    Counter g_frameAllocations{"Allocations.FrameCount"};
+    Counter g_frameBytes{"Allocations.FrameBytes"};
+    Counter g_liveBytes{"Allocations.LiveBytes"};
+    Counter g_sampledBlocks{"Allocations.SampledLiveBlocks"};
+
+    // Written by every thread, each tag on its own cache line so threads
+    // working for different subsystems do not contend. Padded explicitly,
+    // which the alignment would otherwise do with a warning.
+    struct alignas(64) TagCounters final
+    {
+        std::atomic<std::uint64_t> allocations = 0;
+        std::atomic<std::uint64_t> allocatedBytes = 0;
+        std::atomic<std::uint64_t> frees = 0;
+        std::atomic<std::uint64_t> freedBytes = 0;
+        std::byte padding[64 - 4 * sizeof(std::atomic<std::uint64_t>)] = {};
+    };
+
+    static_assert(sizeof(TagCounters) == 64);
+
+    constinit std::array<TagCounters, TagCount> g_tagCounters;
+
+    constinit std::atomic<std::size_t> g_sampleInterval = DXSandbox::AllocationTracking::DefaultSampleInterval;
+    constinit std::atomic<std::uint64_t> g_frameIndex = 0;
+
+    constinit thread_local Tag t_tag = Tag::Untagged;
+
+    // Bytes this thread allocates before its next sample
+    constinit thread_local std::int64_t t_bytesUntilSample =
+        static_cast<std::int64_t>(DXSandbox::AllocationTracking::DefaultSampleInterval);
+
+    // Set while the thread is inside the tracker, whose own allocations are
+    // untagged and never sampled
+    constinit thread_local bool t_isTracking = false;
+
+    // In front of every block, whose alignment its size keeps. Blocks with
+    // an alignment above the default have padding in front of the header,
+    // which the offset skips.
+    struct Header final
+    {
+        std::size_t size = 0;
+        std::uint32_t offset = 0;
+        Tag tag = Tag::Untagged;
+        bool isSampled = false;
+        std::uint16_t reserved = 0;
+    };
+
+    static_assert(sizeof(Header) == __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+
+    constexpr std::size_t MaxFrames = 16;
+
+    struct Sample final
+    {
+        std::size_t size = 0;
+        Tag tag = Tag::Untagged;
+        std::uint64_t frameIndex = 0;
+        std::uint32_t frameCount = 0;
+        std::array<void*, MaxFrames> frames = {};
+    };
+
+    // Live sampled blocks by address. Never destroyed, since blocks are
+    // freed until the process ends.
+    struct SampleTable final
+    {
+        std::mutex mutex;
+        std::unordered_map<const void*, Sample> samples;
+    };
+
+    SampleTable& Samples()
+    {
+        static SampleTable& table = *new SampleTable;
+
+        return table;
+    }
+
+    class TrackingGuard final
+    {
+    public:
+        TrackingGuard() noexcept
+            : m_tag{t_tag}
+        {
+            t_isTracking = true;
+            t_tag = Tag::Untagged;
+        }
+
+        ~TrackingGuard()
+        {
+            t_isTracking = false;
+            t_tag = m_tag;
+        }
+
+        TrackingGuard(const TrackingGuard&) = delete;
+        TrackingGuard& operator = (const TrackingGuard&) = delete;
+
+    private:
+        Tag m_tag = Tag::Untagged;
+    };
+
+    std::uint32_t CaptureCallstack(std::array<void*, MaxFrames>& frames) noexcept
+    {
+        // Leaves out the tracker and operator new
+        static constexpr std::uint32_t SkippedFrames = 3;
+
+#ifdef _WIN32
+        return CaptureStackBackTrace(SkippedFrames, static_cast<DWORD>(MaxFrames), frames.data(), nullptr);
+#else
+        std::array<void*, MaxFrames + SkippedFrames> captured;
+
+        const int count = backtrace(captured.data(), static_cast<int>(captured.size()));
+
+        if (count <= static_cast<int>(SkippedFrames))
+            return 0;
+
+        std::copy(captured.begin() + SkippedFrames, captured.begin() + count, frames.begin());
+
+        return static_cast<std::uint32_t>(count) - SkippedFrames;
+#endif
+    }
+
+    // The module and offset of the address, which symbolizers resolve
+    // offline from the build's symbols
+    std::string DescribeFrame(void* address)
+    {
+        const auto value = reinterpret_cast<std::uintptr_t>(address);
+
+#ifdef _WIN32
+        HMODULE module = nullptr;
+
+        static constexpr DWORD flags = GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS |
+                                       GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT;
+
+        if (!GetModuleHandleExW(flags, static_cast<LPCWSTR>(address), &module))
+            return std::format("0x{:x}", value);
+
+        wchar_t path[MAX_PATH];
+
+        const DWORD length = GetModuleFileNameW(module, path, MAX_PATH);
+        const std::filesystem::path modulePath{std::wstring_view{path, length}};
+
+        return std::format("{}+0x{:x}", DXSandbox::StringUtils::UTF16ToUTF8(modulePath.filename().native()),
+                           value - reinterpret_cast<std::uintptr_t>(module));
+#else
+        Dl_info info = {};
+
+        if (!dladdr(address, &info) || !info.dli_fname)
+            return std::format("0x{:x}", value);
+
+        const std::string module = std::filesystem::path{info.dli_fname}.filename().string();
+
+        if (info.dli_sname)
+        {
+            return std::format("{}!{}+0x{:x}", module, info.dli_sname,
+                               value - reinterpret_cast<std::uintptr_t>(info.dli_saddr));
+        }
+
+        return std::format("{}+0x{:x}", module, value - reinterpret_cast<std::uintptr_t>(info.dli_fbase));
+#endif
+    }
+
+    bool ShouldSample(std::size_t size) noexcept
+    {
+        const std::size_t interval = g_sampleInterval.load(std::memory_order_relaxed);
+
+        if (interval == 0 || t_isTracking)
+            return false;
+
+        // Shortened when the interval was lowered since the last sample
+        t_bytesUntilSample = std::min(t_bytesUntilSample, static_cast<std::int64_t>(interval));
+        t_bytesUntilSample -= static_cast<std::int64_t>(size);
+
+        if (t_bytesUntilSample > 0)
+            return false;
+
+        t_bytesUntilSample = static_cast<std::int64_t>(interval);
+
+        return true;
+    }
+
+    // Called with the header filled in; a sample that cannot be recorded
+    // leaves the block unsampled
+    void RecordSample(const void* block, Header& header) noexcept
+    {
+        const TrackingGuard guard;
+
+        Sample sample =
+        {
+            .size = header.size,
+            .tag = header.tag,
+            .frameIndex = g_frameIndex.load(std::memory_order_relaxed),
+            .frameCount = 0,
+            .frames = {}
+        };
+
+        sample.frameCount = CaptureCallstack(sample.frames);
+
+        try
+        {
+            SampleTable& table = Samples();
+
+            const std::lock_guard lock{table.mutex};
+
+            table.samples.emplace(block, sample);
+        }
+        catch (const std::bad_alloc&)
+        {
+            return;
+        }
+
+        header.isSampled = true;
+    }
+
+    void ForgetSample(const void* block) noexcept
+    {
+        const TrackingGuard guard;
+
+        SampleTable& table = Samples();
+
+        const std::lock_guard lock{table.mutex};
+
+        table.samples.erase(block);
+    }
+
+    void* TryAllocate(std::size_t size, std::size_t alignment) noexcept
+    {
+        // The header sits right in front of the returned block, which keeps
+        // the requested alignment
+        const std::size_t offset = std::max(alignment, sizeof(Header));
+
+        if (size > std::numeric_limits<std::size_t>::max() - offset) [[unlikely]]
+            return nullptr;
+
+        std::byte* base = nullptr;
+
+        if (alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+        {
+            base = static_cast<std::byte*>(std::malloc(offset + size));
+        }
+        else
+        {
+#ifdef _WIN32
+            base = static_cast<std::byte*>(_aligned_malloc(offset + size, alignment));
+#else
+            // The size must be a multiple of the alignment
+            const std::size_t alignedSize = (offset + size + alignment - 1) & ~(alignment - 1);
+
+            base = static_cast<std::byte*>(std::aligned_alloc(alignment, alignedSize));
+#endif
+        }
+
+        if (!base) [[unlikely]]
+            return nullptr;
+
+        std::byte* block = base + offset;
+
+        Header& header = *::new (block - sizeof(Header)) Header
+        {
+            .size = size,
+            .offset = static_cast<std::uint32_t>(offset),
+            .tag = t_tag,
+            .isSampled = false,
+            .reserved = 0
+        };
+
+        TagCounters& counters = g_tagCounters[static_cast<std::size_t>(header.tag)];
+
+        counters.allocations.fetch_add(1, std::memory_order_relaxed);
+        counters.allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+
+        if (ShouldSample(size)) [[unlikely]]
+            RecordSample(block, header);
+
+        return block;
+    }
+
+    void* Allocate(std::size_t size, std::size_t alignment)
+    {
+        // What operator new must do when out of memory
+        for (;;)
+        {
+            if (void* block = TryAllocate(size, alignment))
+                return block;
+
+            const std::new_handler handler = std::get_new_handler();
+
+            if (!handler)
+                throw std::bad_alloc{};
+
+            handler();
+        }
+    }
+
+    void Free(void* block) noexcept
+    {
+        if (!block)
+            return;
+
+        const Header& header = *(static_cast<const Header*>(block) - 1);
+
+        TagCounters& counters = g_tagCounters[static_cast<std::size_t>(header.tag)];
+
+        counters.frees.fetch_add(1, std::memory_order_relaxed);
+        counters.freedBytes.fetch_add(header.size, std::memory_order_relaxed);
+
+        if (header.isSampled) [[unlikely]]
+            ForgetSample(block);
+
+        std::byte* base = static_cast<std::byte*>(block) - header.offset;
+
+#ifdef _WIN32
+        if (header.offset > sizeof(Header))
+        {
+            _aligned_free(base);
+            return;
+        }
+#endif
+
+        std::free(base);
+    }
+
+    std::vector<std::string> LeakReportLines()
+    {
+        using namespace DXSandbox::AllocationTracking;
+
+        std::vector<std::string> lines;
+
+        lines.push_back("Tag\tLiveAllocations\tLiveBytes");
+
+        for (std::size_t tag = 0; tag < TagCount; ++tag)
+        {
+            const TagStatistics stats = Stats(static_cast<Tag>(tag));
+
+            lines.push_back(std::format("{}\t{}\t{}", TagNames[tag], stats.liveAllocations, stats.liveBytes));
+        }
+
+        std::vector<std::pair<const void*, Sample>> samples;
+
+        {
+            // The copy is made inside the tracker, so it is not sampled
+            // while the table is locked
+            const TrackingGuard guard;
+
+            SampleTable& table = Samples();
+
+            const std::lock_guard lock{table.mutex};
+
+            samples.assign(table.samples.begin(), table.samples.end());
+        }
+
+        // Largest first; untagged blocks are expected to be live
+        std::erase_if(samples, [](const auto& sample) { return sample.second.tag == Tag::Untagged; });
+        std::ranges::sort(samples, std::greater{}, [](const auto& sample) { return sample.second.size; });
+
+        for (const auto& [block, sample] : samples)
+        {
+            lines.push_back(std::format("Sampled {} block of {} bytes at {}, allocated in frame {}",
+                                        TagNames[static_cast<std::size_t>(sample.tag)], sample.size,
+                                        block, sample.frameIndex));
+
+            for (std::uint32_t frame = 0; frame < sample.frameCount; ++frame)
+                lines.push_back(std::format("    {}", DescribeFrame(sample.frames[frame])));
+        }
+
+        return lines;
+    }
+}
+
+// Every allocation of the program goes through these
+void* operator new(std::size_t size)
+{
+    return Allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new[](std::size_t size)
+{
+    return Allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    return Allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return Allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return TryAllocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return TryAllocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return TryAllocate(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return TryAllocate(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* block) noexcept
+{
+    Free(block);
+}
+
+void operator delete[](void* block) noexcept
+{
+    Free(block);
+}
+
+void operator delete(void* block, std::size_t) noexcept
+{
+    Free(block);
+}
+
+void operator delete[](void* block, std::size_t) noexcept
+{
+    Free(block);
+}
+
+void operator delete(void* block, std::align_val_t) noexcept
+{
+    Free(block);
+}
+
+void operator delete[](void* block, std::align_val_t) noexcept
+{
+    Free(block);
+}
+
+void operator delete(void* block, std::size_t, std::align_val_t) noexcept
+{
+    Free(block);
+}
+
+void operator delete[](void* block, std::size_t, std::align_val_t) noexcept
+{
+    Free(block);
+}
+
+void operator delete(void* block, const std::nothrow_t&) noexcept
+{
+    Free(block);
+}
+
+void operator delete[](void* block, const std::nothrow_t&) noexcept
+{
+    Free(block);
+}
+
+void operator delete(void* block, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    Free(block);
+}
+
+void operator delete[](void* block, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    Free(block);
+}
+
+namespace DXSandbox::AllocationTracking
+{
+    const char* TagName(Tag tag) noexcept
+    {
+        return TagNames[static_cast<std::size_t>(tag)];
+    }
+
+    Tag CurrentTag() noexcept
+    {
+        return t_tag;
+    }
+
+    TagScope::TagScope(Tag tag) noexcept
+        : m_previous{t_tag}
+    {
+        t_tag = tag;
+    }
+
+    TagScope::~TagScope()
+    {
+        t_tag = m_previous;
+    }
+
+    TagStatistics Stats(Tag tag) noexcept
+    {
+        const TagCounters& counters = g_tagCounters[static_cast<std::size_t>(tag)];
+
+        // Frees are read first, so a block allocated and freed meanwhile
+        // cannot make the live values negative
+        const std::uint64_t frees = counters.frees.load(std::memory_order_relaxed);
+        const std::uint64_t freedBytes = counters.freedBytes.load(std::memory_order_relaxed);
+        const std::uint64_t allocations = counters.allocations.load(std::memory_order_relaxed);
+        const std::uint64_t allocatedBytes = counters.allocatedBytes.load(std::memory_order_relaxed);
+
+        return
+        {
+            .allocations = allocations,
+            .allocatedBytes = allocatedBytes,
+            .liveAllocations = allocations - std::min(frees, allocations),
+            .liveBytes = allocatedBytes - std::min(freedBytes, allocatedBytes)
+        };
+    }
+
+    void SetSampleInterval(std::size_t bytes) noexcept
+    {
+        g_sampleInterval.store(bytes, std::memory_order_relaxed);
+    }
+
+    void EndFrame() noexcept
+    {
+        static std::uint64_t previousAllocations = 0;
+        static std::uint64_t previousBytes = 0;
+
+        std::uint64_t allocations = 0;
+        std::uint64_t bytes = 0;
+        std::uint64_t liveBytes = 0;
+
+        for (std::size_t tag = 0; tag < TagCount; ++tag)
+        {
+            const TagStatistics stats = Stats(static_cast<Tag>(tag));
+
+            allocations += stats.allocations;
+            bytes += stats.allocatedBytes;
+            liveBytes += stats.liveBytes;
+        }
+
+        g_frameAllocations.Set(static_cast<std::int64_t>(allocations - previousAllocations));
+        g_frameBytes.Set(static_cast<std::int64_t>(bytes - previousBytes));
+        g_liveBytes.Set(static_cast<std::int64_t>(liveBytes));
+
+        {
+            const TrackingGuard guard;
+
+            SampleTable& table = Samples();
+
+            const std::lock_guard lock{table.mutex};
+
+            g_sampledBlocks.Set(static_cast<std::int64_t>(table.samples.size()));
+        }
+
+        previousAllocations = allocations;
+        previousBytes = bytes;
+
+        g_frameIndex.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void ReportLeaks()
+    {
+        for (const std::string& line : LeakReportLines())
+            Debug::WriteLine(std::string_view{line});
+    }
+
+    bool WriteLeakReport(const std::filesystem::path& path)
+    {
+        std::ofstream file{path, std::ios::trunc};
+
+        for (const std::string& line : LeakReportLines())
+            file << line << '\n';
+
+        return static_cast<bool>(file);
+    }
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+namespace DXSandbox::AllocationTracking
+{
+    // Every allocation made through the global operator new is counted
+    // under the tag of its thread, with a few relaxed atomic additions and a
+    // header in front of the block. Allocations containing every nth
+    // allocated byte are sampled with their callstack, which is what shows
+    // where the live memory of a leaking tag comes from.
+
+    enum class Tag : std::uint8_t
+    {
+        Untagged,   // Statics, the application itself and worker threads
+        Window,
+        Graphics,
+        Scene,
+        Capture,
+        HotReload,
+        Count
+    };
+
+    const char* TagName(Tag tag) noexcept;
+
+    // The tag of the calling thread, for work it hands to other threads
+    Tag CurrentTag() noexcept;
+
+    // Tags the allocations of the current thread until destroyed; scopes
+    // nest. Blocks are freed under the tag they were allocated with.
+    class TagScope final
+    {
+    public:
+        explicit TagScope(Tag tag) noexcept;
+        ~TagScope();
+
+        TagScope(const TagScope&) = delete;
+        TagScope& operator = (const TagScope&) = delete;
+
+    private:
+        Tag m_previous = Tag::Untagged;
+    };
+
+    // Since the start of the process
+    struct TagStatistics final
+    {
+        std::uint64_t allocations = 0;
+        std::uint64_t allocatedBytes = 0;
+        std::uint64_t liveAllocations = 0;
+        std::uint64_t liveBytes = 0;
+    };
+
+    TagStatistics Stats(Tag tag) noexcept;
+
+    inline constexpr std::size_t DefaultSampleInterval = 512 * 1024;
+
+    // Zero stops sampling; allocations sampled earlier stay tracked
+    void SetSampleInterval(std::size_t bytes) noexcept;
+
+    // Publishes the allocations made since the previous call to the
+    // Allocations counters; called once per frame by one thread
+    void EndFrame() noexcept;
+
+    // Tagged allocations still live at shutdown are leaks; untagged ones
+    // include statics, which are freed after any report. Writes the live
+    // allocations of each tag and the callstacks of the sampled ones to
+    // the debug output.
+    void ReportLeaks();
+
+    // The same report to a file; false when it cannot be written
+    bool WriteLeakReport(const std::filesystem::path& path);
+}
@@ -1,23 +1,137 @@
 #include "Application.hpp"
 
+#include "AllocationTracking.hpp"
+#include "Benchmark.hpp"
+#include "CommandCapture.hpp"
 #include "CommandLineArgs.hpp"
+#include "CommandReplay.hpp"
+#include "Debug.hpp"
+#include "ErrorHandling.hpp"
+#include "FramePipeline.hpp"
 #include "GraphicsSystem.hpp"
+#include "HeadlessBenchmark.hpp"
+#include "HotReloader.hpp"
+#include "Instrumentation.hpp"
+#include "Microbenchmarks.hpp"
+#include "OcclusionBenchmark.hpp"
+#include "SceneStore.hpp"
+#include "ScreenshotWriter.hpp"
+#include "StringUtils.hpp"
+#include "TaskGraph.hpp"
+#include "VideoCapture.hpp"
 #include "Window.hpp"
+#include "WindowThread.hpp"
 
+#include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <exception>
+#include <format>
+#include <optional>
+
+namespace
+{
+    using DXSandbox::Instrumentation::Counter;
+
+    Counter g_timeToFirstFrame{"Startup.TimeToFirstFrameMicroseconds"};
+    Counter g_droppedWindowEvents{"Application.DroppedWindowEvents"};
+    Counter g_windowEventQueueDepth{"Application.WindowEventQueueDepth"};
+    Counter g_idleWaits{"Application.IdleWaits"};
+    Counter g_testPresents{"Application.TestPresents"};
+
+    constexpr const wchar_t* StartupTracePath = L"StartupTrace.json";
+    constexpr const char* DefaultCaptureDirectory = "Captures";
+
+    constexpr int BenchmarkFailedExitCode = 1;
+
+    DXSandbox::GraphicsSystem::SwapChainParams SwapChainParamsFor(const DXSandbox::Window& window,
+                                                                  UINT presentInterval = 1)
+    {
+        const POINT size = window.ClientSize();
+
+        return
+        {
+            .hWnd = window.Handle(),
+            .width = static_cast<UINT>(size.x),
+            .height = static_cast<UINT>(size.y),
+            .presentInterval = presentInterval
+        };
+    }
+}
 
 namespace DXSandbox
 {
+    class Application::SecondaryWindowPresenter final : public IWindowPresenter
+    {
+    public:
+        SecondaryWindowPresenter(Application& application, std::uint32_t window) noexcept
+            : m_application{application}
+            , m_window{window}
+        {
+        }
+
+        void OnWindowClose(Window& /*sender*/) override
+        {
+            m_application.PushWindowEvent({.type = WindowEvent::Type::Close, .window = m_window});
+        }
+
+        void OnWindowEvent(Window& /*sender*/, const WindowEvent& event) override
+        {
+            WindowEvent tagged = event;
+            tagged.window = m_window;
+
+            m_application.PushWindowEvent(tagged);
+        }
+
+        POINT WindowMinSize() const override
+        {
+            return {640, 360};
+        }
+
+    private:
+        Application& m_application;
+        std::uint32_t m_window = 0;
+    };
+
     Application::Application(HINSTANCE hInstance, PWSTR commandLine)
         : m_hInstance{hInstance}
         , m_commandLineArgs{commandLine}
     {
+        const auto captureDirectory = m_commandLineArgs.Value("--captureDirectory");
+
+        m_captureDirectory = StringUtils::UTF8ToUTF16(captureDirectory.value_or(DefaultCaptureDirectory));
+        m_isHudVisible = m_commandLineArgs.Contains("--hud");
+
+        // A callstack every --allocationSampleBytes allocated bytes; zero
+        // keeps counting allocations without sampling them
+        AllocationTracking::SetSampleInterval(
+            m_commandLineArgs.NumericValue("--allocationSampleBytes", AllocationTracking::DefaultSampleInterval));
+
+        m_windowEventSignal = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+
+        if (!m_windowEventSignal)
+            ThrowLastError();
     }
 
-    Application::~Application() = default;
+    Application::~Application()
+    {
+        CloseHandle(m_windowEventSignal);
+    }
 
     int Application::Run()
     {
+        // Needs neither the window nor the device
+        if (m_commandLineArgs.Contains("--microbenchmarks"))
+            return RunMicrobenchmarks(m_commandLineArgs);
+        if (m_commandLineArgs.Contains("--headlessBenchmark"))
+            return RunHeadlessBenchmark(m_commandLineArgs);
+        if (m_commandLineArgs.Contains("--compareLoops"))
+            return RunLoopComparison(m_commandLineArgs);
+        if (m_commandLineArgs.Contains("--occlusionBenchmark"))
+            return RunOcclusionBenchmark(m_commandLineArgs);
+        if (m_commandLineArgs.Contains("--replayCommands"))
+            return RunCommandReplay(m_commandLineArgs);
+
         Startup();
         MainLoop();
         Shutdown();
@@ -43,7 +157,12 @@ namespace DXSandbox
 
     void Application::OnWindowClose(Window& /*sender*/)
     {
-        ExitRequest();
+        PushWindowEvent({.type = WindowEvent::Type::Close});
+    }
+
+    void Application::OnWindowEvent(Window& /*sender*/, const WindowEvent& event)
+    {
+        PushWindowEvent(event);
     }
 
     POINT Application::WindowMinSize() const
@@ -53,107 +172,666 @@ namespace DXSandbox
 
     void DXSandbox::Application::Startup()
     {
-        MakeWindow();
-        MakeGraphicsSystem();
+        // The window lives on its own thread, while the device and the
+        // scene do not need it until the swap chain is created
+        MakeBenchmark();
+        MakeCommandCapture();
+
+        TaskGraph graph;
+
+        const auto windowTask = graph.Add("MakeWindow", [this] { MakeWindow(); });
+        const auto graphicsTask = graph.Add("MakeGraphicsSystem", [this] { MakeGraphicsSystem(); });
+
+        graph.Add("MakeScene", [this] { MakeScene(); });
+        graph.Add("MakeHotReloader", [this] { MakeHotReloader(); });
+        graph.Add("AttachGraphicsToWindow", [this] { AttachGraphicsToWindow(); },
+                  {windowTask, graphicsTask});
+
+        graph.Run(&m_startupTrace);
+
+        MakeFramePipeline();
+
+        // Records perf repro sessions from the very first frame
+        if (m_commandLineArgs.Contains("--recordVideo"))
+            StartVideoCapture();
+
+        const TraceScope scope{&m_startupTrace, "ShowWindow"};
+
+        Window& window = m_windowThread->Get();
+
+        for (SecondaryWindow& secondary : m_secondaryWindows)
+        {
+            secondary.thread->Get().Show();
+            secondary.thread->Get().Update();
+        }
+
+        window.Show();
+        window.SetForeground();
+        window.Update();
+    }
 
-        m_window->Show();
-        m_window->SetForeground();
-        m_window->Update();
+    void Application::MakeBenchmark()
+    {
+        assert(!m_benchmark);
 
-        ProcessWindowMessages();
+        if (!m_commandLineArgs.Contains("--benchmark"))
+            return;
+
+        m_benchmark = std::make_unique<Benchmark>(Benchmark::ParseParams(m_commandLineArgs));
+    }
+
+    void Application::MakeCommandCapture()
+    {
+        assert(!m_commandCapture);
+
+        const AllocationTracking::TagScope tag{AllocationTracking::Tag::Capture};
+
+        const auto path = m_commandLineArgs.Value("--captureCommands");
+
+        if (!path)
+            return;
+
+        const auto frameCount = std::max(m_commandLineArgs.NumericValue("--captureCommandFrames", 60u), 1u);
+
+        m_commandCapture = std::make_unique<CommandCapture>(frameCount);
+        m_commandCapturePath = StringUtils::UTF8ToUTF16(*path);
     }
 
     void Application::MakeWindow()
     {
-        assert(!m_window);
+        assert(!m_windowThread);
+
+        const AllocationTracking::TagScope tag{AllocationTracking::Tag::Window};
+
+        const auto secondaryWindowCount = m_commandLineArgs.NumericValue("--secondaryWindows", 0u);
+
+        // Before any window can send events
+        m_overflowedEvents = std::make_unique<OverflowedEvents[]>(secondaryWindowCount + 1);
 
         IWindowPresenter& presenter = *this;
 
-        m_window = std::make_unique<Window>(m_hInstance, presenter);
+        m_windowThread = std::make_unique<WindowThread>(m_hInstance, presenter);
+
+        // Tool panes rarely need the full frame rate
+        m_secondaryWindowPresentInterval =
+            std::max(m_commandLineArgs.NumericValue("--secondaryWindowPresentInterval", 1u), 1u);
+
+        m_secondaryWindows.resize(secondaryWindowCount);
+
+        for (std::uint32_t i = 0; i < secondaryWindowCount; ++i)
+        {
+            SecondaryWindow& secondary = m_secondaryWindows[i];
+
+            secondary.presenter = std::make_unique<SecondaryWindowPresenter>(*this, i + 1);
+            secondary.thread = std::make_unique<WindowThread>(m_hInstance, *secondary.presenter);
+        }
     }
 
     void Application::MakeGraphicsSystem()
     {
-        assert(m_window && !m_graphicsSystem);
+        assert(!m_graphicsSystem);
+
+        const AllocationTracking::TagScope tag{AllocationTracking::Tag::Graphics};
+
+        // --dynamicResolution holds --dynamicResolutionTargetMs (16.7) by
+        // rendering the main window down to --dynamicResolutionMinScale (0.5)
+        std::optional<DynamicResolution::Params> dynamicResolution;
+
+        if (m_commandLineArgs.Contains("--dynamicResolution"))
+        {
+            const double targetMilliseconds = m_commandLineArgs.NumericValue("--dynamicResolutionTargetMs",
+                                                                             1000.0 / 60.0);
+            const double minScale = m_commandLineArgs.NumericValue("--dynamicResolutionMinScale", 0.5);
 
-        const POINT size = m_window->ClientSize();
+            dynamicResolution = DynamicResolution::Params
+            {
+                .targetFrameTime = DynamicResolution::Milliseconds{std::max(targetMilliseconds, 1.0)},
+                .minScale = std::clamp(minScale, 0.25, 1.0)
+            };
+        }
 
         const GraphicsSystem::InitParams params =
         {
-            .hWnd = m_window->Handle(),
-            .width = static_cast<UINT>(size.x),
-            .height = static_cast<UINT>(size.y),
-            .enableDebugLayer = m_commandLineArgs.Contains("--d3dEnableDebugLayer")
+            .enableDebugLayer = m_commandLineArgs.Contains("--d3dEnableDebugLayer"),
+            .isVSyncEnabled = !m_benchmark,
+            .enableGpuProfiler = m_commandLineArgs.Contains("--gpuProfile"),
+            .dynamicResolution = dynamicResolution,
+            .showHud = m_isHudVisible,
+            .trace = &m_startupTrace
         };
 
         m_graphicsSystem = std::make_unique<GraphicsSystem>(params);
+        m_graphicsSystem->SetCommandCapture(m_commandCapture.get());
     }
 
-    void Application::MainLoop()
+    void Application::AttachGraphicsToWindow()
+    {
+        assert(m_windowThread && m_graphicsSystem);
+
+        const AllocationTracking::TagScope tag{AllocationTracking::Tag::Graphics};
+
+        // Attached first, which makes it the main window
+        m_mainSurface = m_graphicsSystem->AttachWindow(SwapChainParamsFor(m_windowThread->Get()));
+
+        for (SecondaryWindow& secondary : m_secondaryWindows)
+        {
+            if (!secondary.isOpen)
+                continue;
+
+            const auto params = SwapChainParamsFor(secondary.thread->Get(), m_secondaryWindowPresentInterval);
+
+            secondary.surface = m_graphicsSystem->AttachWindow(params);
+        }
+    }
+
+    void Application::RecreateGraphicsSystem()
+    {
+        // Everything created from the lost device goes with it; the scene
+        // and the frame pipeline do not depend on the device
+        DestroyGraphicsSystem();
+        MakeGraphicsSystem();
+        AttachGraphicsToWindow();
+    }
+
+    void Application::MakeScene()
+    {
+        assert(!m_scene);
+
+        const AllocationTracking::TagScope tag{AllocationTracking::Tag::Scene};
+
+        m_scene = std::make_unique<SceneStore>();
+
+        if (m_benchmark)
+            m_benchmark->PopulateScene(*m_scene);
+    }
+
+    void Application::MakeFramePipeline()
     {
-        if (IsExitRequested())
+        assert(m_scene && !m_framePipeline);
+
+        // The sequential loop is kept for comparison
+        const bool isPipelined = !m_commandLineArgs.Contains("--singleThreadedLoop");
+
+        auto update = [this](FrameSnapshot& snapshot) { UpdateSimulation(snapshot); };
+
+        m_framePipeline = std::make_unique<FramePipeline>(std::move(update), isPipelined);
+    }
+
+    void Application::MakeHotReloader()
+    {
+        assert(!m_hotReloader);
+
+        const AllocationTracking::TagScope tag{AllocationTracking::Tag::HotReload};
+
+        // Watches the content directory given as --hotReload=<directory>
+        const auto directory = m_commandLineArgs.Value("--hotReload");
+
+        if (!directory)
             return;
 
-        while (ProcessWindowMessages())
+        m_hotReloader = std::make_unique<HotReloader>(StringUtils::UTF8ToUTF16(*directory));
+    }
+
+    void Application::UpdateSimulation(FrameSnapshot& snapshot)
+    {
+        // Runs on the update thread, which owns the scene while the
+        // pipeline exists. Nothing the renderer records comes from the
+        // scene yet, so its transforms are not copied to the snapshot.
+        const AllocationTracking::TagScope tag{AllocationTracking::Tag::Scene};
+
+        if (m_benchmark)
+            m_benchmark->AnimateScene(*m_scene, snapshot.frameIndex);
+
+        m_scene->UpdateTransforms();
+    }
+
+    void Application::MainLoop()
+    {
+        while (!IsExitRequested())
         {
+            TraceRecorder* zones = m_benchmark ? m_benchmark->Zones() : nullptr;
+
+            {
+                const TraceScope scope{zones, "ProcessWindowEvents"};
+
+                ProcessWindowEvents();
+            }
+
             if (IsExitRequested())
-                PostMainLoopQuitMessage();
+                break;
+
+            // Reloaded objects are swapped while no frame is being recorded
+            if (m_hotReloader)
+            {
+                const TraceScope scope{zones, "HotReload"};
+                const AllocationTracking::TagScope tag{AllocationTracking::Tag::HotReload};
 
-            m_graphicsSystem->Render();
+                m_hotReloader->Update();
+            }
+
+            const PresentThrottle::Action action = m_presentThrottle.NextAction(PresentThrottle::Clock::now());
+
+            if (action != PresentThrottle::Action::Render)
+            {
+                WaitWhileHidden(action);
+                continue;
+            }
+
+            RequestCaptures();
+
+            const FrameSnapshot* snapshot = nullptr;
+
+            {
+                const TraceScope scope{zones, "WaitForSnapshot"};
+
+                snapshot = &m_framePipeline->AcquireSnapshot();
+            }
+
+            const GraphicsSystem::FrameResult result = m_graphicsSystem->Render(zones);
+
+            if (result == GraphicsSystem::FrameResult::DeviceLost) [[unlikely]]
+            {
+                RecreateGraphicsSystem();
+                continue;
+            }
+
+            m_presentThrottle.OnPresented(result == GraphicsSystem::FrameResult::Occluded,
+                                          PresentThrottle::Clock::now());
+
+            m_framePipeline->OnFrameRendered(*snapshot);
+
+            if (!m_isFirstFrameRendered)
+                OnFirstFrameRendered();
+
+            if (m_commandCapture && m_commandCapture->IsFull())
+                FinishCommandCapture();
+
+            AllocationTracking::EndFrame();
+
+            if (m_benchmark)
+            {
+                m_benchmark->OnFrameRendered();
+
+                if (m_benchmark->IsFinished())
+                    ExitRequest();
+            }
         }
+    }
+
+    void Application::OnFirstFrameRendered()
+    {
+        assert(!m_isFirstFrameRendered);
 
-        assert(IsExitRequested());
+        m_isFirstFrameRendered = true;
+
+        const auto origin = m_startupTrace.Origin();
+        const auto now = TraceRecorder::Clock::now();
+
+        m_startupTrace.Record("TimeToFirstFrame", origin, now);
+
+        const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(now - origin);
+
+        g_timeToFirstFrame.Set(elapsed.count());
     }
 
-    bool Application::ProcessWindowMessages()
+    void Application::PushWindowEvent(const WindowEvent& event)
     {
-        MSG msg;
+        // The window thread must never wait on the main loop, so events that
+        // do not fit are dropped, except for closes and resizes
+        if (!m_windowEvents.TryPush(event))
+        {
+            OverflowedEvents& overflowed = m_overflowedEvents[event.window];
 
-        while (PeekMessageW(&msg, nullptr, WM_NULL, WM_NULL, PM_REMOVE))
+            if (event.type == WindowEvent::Type::Close)
+                overflowed.isClosed.store(true, std::memory_order_release);
+            else if (event.type == WindowEvent::Type::Resize)
+                overflowed.isResized.store(true, std::memory_order_release);
+            else
+                g_droppedWindowEvents.Add(1);
+        }
+
+        SetEvent(m_windowEventSignal);
+    }
+
+    void Application::ProcessWindowEvents()
+    {
+        const AllocationTracking::TagScope tag{AllocationTracking::Tag::Window};
+
+        std::optional<WindowEvent> resize;
+
+        const auto process = [this, &resize](const WindowEvent& event)
         {
-            if (msg.message != WM_QUIT)
+            if (event.window != 0)
             {
-                TranslateMessage(&msg);
-                DispatchMessageW(&msg);
+                ProcessSecondaryWindowEvent(event);
+                return;
             }
-            else
+
+            switch (event.type)
             {
-                assert(IsExitRequested());
-                assert(ExitCode() == static_cast<int>(msg.wParam));
+                case WindowEvent::Type::Close:
+                    ExitRequest();
+                    break;
+
+                case WindowEvent::Type::Resize:
+                    resize = event;
+
+                    if (event.value == SIZE_MINIMIZED)
+                        m_presentThrottle.OnMinimized();
+                    else
+                        m_presentThrottle.OnRestored();
+                    break;
+
+                case WindowEvent::Type::Activate:
+                    if (event.value != 0)
+                        m_presentThrottle.OnActivated(PresentThrottle::Clock::now());
+                    break;
+
+                case WindowEvent::Type::KeyDown:
+                    OnKeyDown(event.value);
+                    break;
+
+                default:
+                    break;
+            }
+        };
 
-                return false;
+        std::int64_t eventCount = 0;
+
+        for (WindowEvent event; m_windowEvents.TryPop(event);)
+        {
+            ++eventCount;
+            process(event);
+        }
+
+        // What piled up since the previous frame
+        g_windowEventQueueDepth.Set(eventCount);
+
+        // Closes and resizes that did not fit the queue. The size is read
+        // from the window, so it is the latest whatever was queued after.
+        for (std::uint32_t window = 0; window <= m_secondaryWindows.size(); ++window)
+        {
+            OverflowedEvents& overflowed = m_overflowedEvents[window];
+
+            if (overflowed.isResized.exchange(false, std::memory_order_acquire))
+                process(CurrentSizeEvent(window));
+
+            if (overflowed.isClosed.exchange(false, std::memory_order_acquire))
+                process({.type = WindowEvent::Type::Close, .window = window});
+        }
+
+        bool isDeviceLost = false;
+
+        // Only the final size of an interactive resize matters
+        if (resize && resize->value != SIZE_MINIMIZED)
+        {
+            isDeviceLost = !m_graphicsSystem->Resize(m_mainSurface, static_cast<UINT>(resize->x),
+                                                     static_cast<UINT>(resize->y));
+        }
+
+        for (SecondaryWindow& secondary : m_secondaryWindows)
+        {
+            if (!isDeviceLost && secondary.isOpen && secondary.resize)
+            {
+                isDeviceLost = !m_graphicsSystem->Resize(secondary.surface,
+                                                         static_cast<UINT>(secondary.resize->x),
+                                                         static_cast<UINT>(secondary.resize->y));
             }
+
+            secondary.resize.reset();
         }
 
-        return true;
+        // The new swap chains are created at the current window sizes
+        if (isDeviceLost) [[unlikely]]
+            RecreateGraphicsSystem();
     }
 
-    void Application::PostMainLoopQuitMessage()
+    WindowEvent Application::CurrentSizeEvent(std::uint32_t window)
     {
-        assert(IsExitRequested());
+        const Window& source = window == 0 ? m_windowThread->Get() : m_secondaryWindows[window - 1].thread->Get();
+        const POINT size = source.ClientSize();
 
-        PostQuitMessage(ExitCode());
+        return
+        {
+            .type = WindowEvent::Type::Resize,
+            .x = size.x,
+            .y = size.y,
+            .value = IsIconic(source.Handle()) ? SIZE_MINIMIZED : SIZE_RESTORED,
+            .window = window
+        };
+    }
+
+    void Application::ProcessSecondaryWindowEvent(const WindowEvent& event)
+    {
+        assert(event.window - 1 < m_secondaryWindows.size());
+
+        SecondaryWindow& secondary = m_secondaryWindows[event.window - 1];
+
+        if (!secondary.isOpen)
+            return;
+
+        switch (event.type)
+        {
+            case WindowEvent::Type::Close:
+                // Hidden rather than destroyed, so the window threads live
+                // as long as the main window
+                secondary.thread->Get().Hide();
+                m_graphicsSystem->DetachWindow(secondary.surface);
+                secondary.isOpen = false;
+                break;
+
+            // Minimized windows stay attached, their presents find them
+            // occluded
+            case WindowEvent::Type::Resize:
+                secondary.resize = event;
+                break;
+
+            case WindowEvent::Type::KeyDown:
+                OnKeyDown(event.value);
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    void Application::WaitWhileHidden(PresentThrottle::Action action)
+    {
+        if (action == PresentThrottle::Action::TestPresent)
+        {
+            g_testPresents.Add(1);
+
+            const GraphicsSystem::FrameResult result = m_graphicsSystem->TestPresent();
+
+            if (result == GraphicsSystem::FrameResult::DeviceLost) [[unlikely]]
+            {
+                RecreateGraphicsSystem();
+                return;
+            }
+
+            m_presentThrottle.OnPresented(result == GraphicsSystem::FrameResult::Occluded,
+                                          PresentThrottle::Clock::now());
+            return;
+        }
+
+        g_idleWaits.Add(1);
+
+        const auto timeout = m_presentThrottle.WaitTimeout(PresentThrottle::Clock::now());
+
+        // Rounded up, so the wait does not end just before the test present
+        // is due and spin
+        const DWORD milliseconds = timeout
+            ? static_cast<DWORD>(std::chrono::ceil<std::chrono::milliseconds>(*timeout).count())
+            : INFINITE;
+
+        // The window lives on its own thread, so its events are waited on
+        // rather than its messages
+        WaitForSingleObject(m_windowEventSignal, milliseconds);
+    }
+
+    void Application::OnKeyDown(int virtualKey)
+    {
+        switch (virtualKey)
+        {
+            case VK_F11:
+                m_isCapturingFrames = !m_isCapturingFrames;
+                break;
+
+            case VK_F12:
+                m_isScreenshotRequested = true;
+                break;
+
+            case VK_F10:
+                if (m_videoCapture)
+                    StopVideoCapture();
+                else
+                    StartVideoCapture();
+                break;
+
+            case VK_F9:
+                m_isHudVisible = !m_isHudVisible;
+                m_graphicsSystem->SetHudVisible(m_isHudVisible);
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    void Application::RequestCaptures()
+    {
+        const AllocationTracking::TagScope tag{AllocationTracking::Tag::Capture};
+
+        if (m_videoCapture)
+            m_graphicsSystem->RequestReadback(m_videoCapture->FrameHandler());
+
+        if (!m_isScreenshotRequested && !m_isCapturingFrames)
+            return;
+
+        m_isScreenshotRequested = false;
+
+        // Encoding and writing happen on the readback workers
+        m_graphicsSystem->RequestReadback(MakeScreenshotWriter(m_captureDirectory));
+    }
+
+    void Application::StartVideoCapture()
+    {
+        assert(!m_videoCapture);
+
+        const auto fileName = std::format("Recording{:06}.y4m", m_graphicsSystem->FrameFenceValue());
+
+        try
+        {
+            std::filesystem::create_directories(m_captureDirectory);
+
+            m_videoCapture = std::make_shared<VideoCapture>(VideoCapture::Params{.path = m_captureDirectory / fileName});
+        }
+        catch (const std::exception& e)
+        {
+            Debug::WriteLine("Failed to start the video capture: {}", e.what());
+        }
+    }
+
+    void Application::StopVideoCapture()
+    {
+        // The file is completed once the last requested frame was handled
+        m_videoCapture = nullptr;
+    }
+
+    void Application::FinishCommandCapture()
+    {
+        const AllocationTracking::TagScope tag{AllocationTracking::Tag::Capture};
+
+        m_graphicsSystem->SetCommandCapture(nullptr);
+
+        if (!m_commandCapture->Write(m_commandCapturePath))
+            Debug::WriteLine("Failed to write the command capture");
+
+        m_commandCapture = nullptr;
     }
 
     void Application::Shutdown()
     {
-        m_window->Hide();
+        m_windowThread->Get().Hide();
+
+        for (SecondaryWindow& secondary : m_secondaryWindows)
+            secondary.thread->Get().Hide();
+
+        StopVideoCapture();
 
+        // A run ending early keeps the frames captured so far
+        if (m_commandCapture)
+            FinishCommandCapture();
+
+        DestroyHotReloader();
+        DestroyFramePipeline();
+        DestroyScene();
         DestroyGraphicsSystem();
         DestroyWindow();
+
+        Instrumentation::ReportCounters();
+        WriteAllocationReport();
+
+        WriteStartupTrace();
+        WriteBenchmarkReport();
+    }
+
+    void Application::DestroyHotReloader()
+    {
+        m_hotReloader = nullptr;
+    }
+
+    void Application::DestroyFramePipeline()
+    {
+        assert(m_framePipeline);
+
+        m_framePipeline = nullptr;
+    }
+
+    void Application::DestroyScene()
+    {
+        assert(m_scene);
+
+        m_scene = nullptr;
     }
 
     void Application::DestroyGraphicsSystem()
     {
-        assert(m_window && m_graphicsSystem);
+        assert(m_windowThread && m_graphicsSystem);
 
         m_graphicsSystem = nullptr;
     }
 
     void Application::DestroyWindow()
     {
-        assert(m_window);
+        assert(m_windowThread);
+
+        m_secondaryWindows.clear();
+        m_windowThread = nullptr;
+    }
 
-        m_window = nullptr;
+    void Application::WriteStartupTrace() const
+    {
+        if (!m_startupTrace.WriteChromeTrace(StartupTracePath))
+            Debug::WriteLine("Failed to write the startup trace");
+    }
+
+    void Application::WriteAllocationReport() const
+    {
+        // The subsystems are destroyed by now. What remains, such as the
+        // benchmark and the traces, is untagged, so tagged memory is leaked.
+        AllocationTracking::ReportLeaks();
+
+        const auto path = m_commandLineArgs.Value("--allocationReport");
+
+        if (path && !AllocationTracking::WriteLeakReport(StringUtils::UTF8ToUTF16(*path)))
+            Debug::WriteLine("Failed to write the allocation report");
+    }
+
+    void Application::WriteBenchmarkReport()
+    {
+        // Written last, so the counters hold their final values
+        if (m_benchmark && !m_benchmark->WriteReport())
+            ExitRequest(BenchmarkFailedExitCode);
     }
 }
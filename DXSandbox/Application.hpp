@@ -2,15 +2,32 @@
 
 #include "WindowsPlatform.hpp"
 
+#include "BoundedQueue.hpp"
 #include "CommandLineArgs.hpp"
 #include "IWindowPresenter.hpp"
+#include "PresentThrottle.hpp"
+#include "TraceRecorder.hpp"
+#include "WindowEvent.hpp"
 
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
 #include <memory>
+#include <optional>
+#include <vector>
 
 namespace DXSandbox
 {
+    class Benchmark;
+    class CommandCapture;
+    class FramePipeline;
     class GraphicsSystem;
+    class HotReloader;
+    class SceneStore;
+    class VideoCapture;
     class Window;
+    class WindowThread;
+    struct FrameSnapshot;
 
     class Application final : private IWindowPresenter
     {
@@ -26,28 +43,119 @@ namespace DXSandbox
 
     private:
         void OnWindowClose(Window& sender) override;
+        void OnWindowEvent(Window& sender, const WindowEvent& event) override;
 
         POINT WindowMinSize() const override;
 
     private:
         void Startup();
+        void MakeBenchmark();
+        void MakeCommandCapture();
         void MakeWindow();
         void MakeGraphicsSystem();
+        void AttachGraphicsToWindow();
+        void RecreateGraphicsSystem();
+        void MakeScene();
+        void MakeFramePipeline();
+        void MakeHotReloader();
+        void UpdateSimulation(FrameSnapshot& snapshot);
         void MainLoop();
-        bool ProcessWindowMessages();
-        void PostMainLoopQuitMessage();
+        void OnFirstFrameRendered();
+        void PushWindowEvent(const WindowEvent& event);
+        void ProcessWindowEvents();
+        void ProcessSecondaryWindowEvent(const WindowEvent& event);
+        WindowEvent CurrentSizeEvent(std::uint32_t window);
+        void WaitWhileHidden(PresentThrottle::Action action);
+        void OnKeyDown(int virtualKey);
+        void RequestCaptures();
+        void StartVideoCapture();
+        void StopVideoCapture();
+        void FinishCommandCapture();
         void Shutdown();
+        void DestroyHotReloader();
+        void DestroyFramePipeline();
+        void DestroyScene();
         void DestroyGraphicsSystem();
         void DestroyWindow();
+        void WriteStartupTrace() const;
+        void WriteAllocationReport() const;
+        void WriteBenchmarkReport();
 
     private:
         HINSTANCE m_hInstance = nullptr;
 
         CommandLineArgs m_commandLineArgs;
 
-        std::unique_ptr<Window> m_window;
+        TraceRecorder m_startupTrace;
+        bool m_isFirstFrameRendered = false;
+
+        // Produced on the window thread, consumed by the main loop
+        BoundedQueue<WindowEvent, 1024> m_windowEvents;
+
+        // Signaled for every event, wakes the main loop while it waits
+        HANDLE m_windowEventSignal = nullptr;
+
+        // Closes and resizes that did not fit the queue, by window index.
+        // They are kept as flags rather than dropped; a flagged resize is
+        // read back from the window.
+        struct OverflowedEvents final
+        {
+            std::atomic<bool> isClosed = false;
+            std::atomic<bool> isResized = false;
+        };
+
+        std::unique_ptr<OverflowedEvents[]> m_overflowedEvents;
+
+        // Stops rendering while the window is minimized or occluded
+        PresentThrottle m_presentThrottle;
+
+        // Set with --benchmark, ends the run after a fixed number of frames
+        std::unique_ptr<Benchmark> m_benchmark;
+
+        std::unique_ptr<WindowThread> m_windowThread;
         std::unique_ptr<GraphicsSystem> m_graphicsSystem;
 
+        std::uint32_t m_mainSurface = 0;
+
+        // Tags the events of a secondary window with its index
+        class SecondaryWindowPresenter;
+
+        // Extra windows rendered through the same device, created with
+        // --secondaryWindows=<count>; closing one only hides it
+        struct SecondaryWindow final
+        {
+            std::unique_ptr<SecondaryWindowPresenter> presenter;
+            std::unique_ptr<WindowThread> thread;
+            std::uint32_t surface = 0;
+            bool isOpen = true;
+
+            // Applied once per frame, like the main window's size
+            std::optional<WindowEvent> resize;
+        };
+
+        std::vector<SecondaryWindow> m_secondaryWindows;
+        UINT m_secondaryWindowPresentInterval = 1;
+        std::unique_ptr<SceneStore> m_scene;
+        std::unique_ptr<FramePipeline> m_framePipeline;
+        std::unique_ptr<HotReloader> m_hotReloader;
+
+        // F12 captures the next frame, F11 toggles capturing every frame,
+        // F10 toggles recording a video
+        std::filesystem::path m_captureDirectory;
+        bool m_isScreenshotRequested = false;
+        bool m_isCapturingFrames = false;
+
+        // Set with --hud and toggled with F9; kept across device losses
+        bool m_isHudVisible = false;
+
+        // Shared with the readback handlers still in flight
+        std::shared_ptr<VideoCapture> m_videoCapture;
+
+        // Set with --captureCommands=<file>, records the command streams of
+        // the first --captureCommandFrames frames for offline replays
+        std::unique_ptr<CommandCapture> m_commandCapture;
+        std::filesystem::path m_commandCapturePath;
+
         bool m_isExitRequested = false;
         int m_exitCode = 0;
     };
@@ -0,0 +1,148 @@
+#include "AtlasPacker.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+namespace DXSandbox
+{
+    AtlasPacker::AtlasPacker(std::uint32_t width, std::uint32_t height)
+        : m_width{width}
+        , m_height{height}
+    {
+        assert(width > 0 && height > 0);
+
+        Reset();
+    }
+
+    std::optional<AtlasPacker::Rect> AtlasPacker::Pack(std::uint32_t width, std::uint32_t height)
+    {
+        if (width == 0 || height == 0)
+            return std::nullopt;
+
+        std::size_t bestSegment = m_skyline.size();
+        std::uint32_t bestY = 0;
+        std::uint32_t bestBottom = std::numeric_limits<std::uint32_t>::max();
+        std::uint32_t bestWidth = std::numeric_limits<std::uint32_t>::max();
+
+        // Ties go to the narrower segment, which leaves the wide ones for
+        // wide rectangles
+        for (std::size_t segment = 0; segment < m_skyline.size(); ++segment)
+        {
+            const std::optional<std::uint32_t> y = Fit(segment, width, height);
+
+            if (!y)
+                continue;
+
+            const std::uint32_t bottom = *y + height;
+
+            if (bottom < bestBottom || (bottom == bestBottom && m_skyline[segment].width < bestWidth))
+            {
+                bestSegment = segment;
+                bestY = *y;
+                bestBottom = bottom;
+                bestWidth = m_skyline[segment].width;
+            }
+        }
+
+        if (bestSegment == m_skyline.size())
+            return std::nullopt;
+
+        const Rect rect =
+        {
+            .x = m_skyline[bestSegment].x,
+            .y = bestY,
+            .width = width,
+            .height = height
+        };
+
+        // The rectangle becomes a segment, and shortens or removes the
+        // segments it lies on
+        m_skyline.insert(m_skyline.begin() + static_cast<std::ptrdiff_t>(bestSegment),
+                         {.x = rect.x, .y = bestBottom, .width = width});
+
+        const std::uint32_t right = rect.x + width;
+        std::size_t next = bestSegment + 1;
+
+        while (next < m_skyline.size() && m_skyline[next].x < right)
+        {
+            Segment& segment = m_skyline[next];
+            const std::uint32_t segmentRight = segment.x + segment.width;
+
+            if (segmentRight <= right)
+            {
+                m_skyline.erase(m_skyline.begin() + static_cast<std::ptrdiff_t>(next));
+                continue;
+            }
+
+            segment.width = segmentRight - right;
+            segment.x = right;
+            break;
+        }
+
+        // Neighbours at the same height are one segment
+        for (std::size_t i = 1; i < m_skyline.size();)
+        {
+            if (m_skyline[i - 1].y == m_skyline[i].y)
+            {
+                m_skyline[i - 1].width += m_skyline[i].width;
+                m_skyline.erase(m_skyline.begin() + static_cast<std::ptrdiff_t>(i));
+            }
+            else
+            {
+                ++i;
+            }
+        }
+
+        m_usedArea += std::uint64_t{width} * height;
+
+        return rect;
+    }
+
+    void AtlasPacker::Reset()
+    {
+        m_skyline.assign(1, {.x = 0, .y = 0, .width = m_width});
+        m_usedArea = 0;
+    }
+
+    std::uint32_t AtlasPacker::Width() const noexcept
+    {
+        return m_width;
+    }
+
+    std::uint32_t AtlasPacker::Height() const noexcept
+    {
+        return m_height;
+    }
+
+    double AtlasPacker::Occupancy() const noexcept
+    {
+        return static_cast<double>(m_usedArea) / (static_cast<double>(m_width) * m_height);
+    }
+
+    std::optional<std::uint32_t> AtlasPacker::Fit(std::size_t segment, std::uint32_t width,
+                                                  std::uint32_t height) const
+    {
+        const std::uint32_t x = m_skyline[segment].x;
+
+        if (width > m_width - x)
+            return std::nullopt;
+
+        // Placed below every segment it spans
+        std::uint32_t y = 0;
+
+        for (std::uint32_t remaining = width; remaining > 0; ++segment)
+        {
+            assert(segment < m_skyline.size());
+
+            y = std::max(y, m_skyline[segment].y);
+
+            remaining -= std::min(remaining, m_skyline[segment].width);
+        }
+
+        if (height > m_height - std::min(y, m_height))
+            return std::nullopt;
+
+        return y;
+    }
+}
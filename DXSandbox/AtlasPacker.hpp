@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace DXSandbox
+{
+    // Places rectangles into a fixed atlas with the skyline bottom-left
+    // heuristic, filling the atlas from the top row down: the lower edge of
+    // the packed rectangles is kept as a list of horizontal segments, and
+    // each rectangle goes where its own lower edge ends up highest.
+    // Rectangles are never removed; a full atlas is reset.
+    class AtlasPacker final
+    {
+    public:
+        struct Rect final
+        {
+            std::uint32_t x = 0;
+            std::uint32_t y = 0;
+            std::uint32_t width = 0;
+            std::uint32_t height = 0;
+        };
+
+        AtlasPacker(std::uint32_t width, std::uint32_t height);
+
+        // Empty when the rectangle fits nowhere
+        std::optional<Rect> Pack(std::uint32_t width, std::uint32_t height);
+
+        void Reset();
+
+        std::uint32_t Width() const noexcept;
+        std::uint32_t Height() const noexcept;
+
+        // Share of the atlas covered by packed rectangles
+        double Occupancy() const noexcept;
+
+    private:
+        // The skyline over [x, x + width) is at height y
+        struct Segment final
+        {
+            std::uint32_t x = 0;
+            std::uint32_t y = 0;
+            std::uint32_t width = 0;
+        };
+
+        // Row of a rectangle placed at the start of the segment, if it fits
+        std::optional<std::uint32_t> Fit(std::size_t segment, std::uint32_t width, std::uint32_t height) const;
+
+    private:
+        std::uint32_t m_width = 0;
+        std::uint32_t m_height = 0;
+
+        // Ordered by x, covering the whole width
+        std::vector<Segment> m_skyline;
+
+        std::uint64_t m_usedArea = 0;
+    };
+}
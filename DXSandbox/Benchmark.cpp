@@ -0,0 +1,325 @@
+#include "Benchmark.hpp"
+
+#ifdef _WIN32
+#include "WindowsPlatform.hpp"
+
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include "CommandLineArgs.hpp"
+#include "DrawQueue.hpp"
+#include "Instrumentation.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using Duration = DXSandbox::TraceRecorder::Clock::duration;
+
+    constexpr std::uint32_t RootCount = 64;
+    constexpr std::uint32_t ChildCount = 4;
+    constexpr std::uint32_t Depth = 3;
+
+    constexpr const char* DefaultReportPath = "Benchmark.json";
+
+    // Seen along +z from this far in front of the scene, which spans this
+    // depth
+    constexpr float CameraDistance = 20.0f;
+    constexpr float SceneDepth = 40.0f;
+
+    inline double ToMilliseconds(Duration duration) noexcept
+    {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+
+    // Nearest rank on sorted values
+    double Percentile(const std::vector<Duration>& sorted, double percent) noexcept
+    {
+        assert(!sorted.empty());
+
+        const auto rank = static_cast<std::size_t>(std::ceil(percent / 100.0 * static_cast<double>(sorted.size())));
+
+        return ToMilliseconds(sorted[std::clamp<std::size_t>(rank, 1, sorted.size()) - 1]);
+    }
+
+    void CreateSubtree(DXSandbox::SceneStore& scene, DXSandbox::Entity parent, std::uint32_t depth)
+    {
+        if (depth == 0)
+            return;
+
+        for (std::uint32_t i = 0; i < ChildCount; ++i)
+        {
+            const float offset = static_cast<float>(i) - 0.5f * static_cast<float>(ChildCount - 1);
+
+            const auto localTransform = DXSandbox::Math::Translation({offset, 1.0f, 0.0f});
+            const DXSandbox::Entity child = scene.CreateEntity(parent, localTransform);
+
+            CreateSubtree(scene, child, depth - 1);
+        }
+    }
+
+    struct PeakMemory final
+    {
+        std::uint64_t workingSet = 0;
+        std::uint64_t commit = 0;
+    };
+
+    // Outside Windows the peak resident set, and the peak virtual size in
+    // place of the commit charge
+    PeakMemory QueryPeakMemory()
+    {
+#ifdef _WIN32
+        const PeakMemory memory = QueryPeakMemory();
+
+        return {.workingSet = memory.PeakWorkingSetSize, .commit = memory.PeakPagefileUsage};
+#else
+        PeakMemory peak;
+
+        rusage usage = {};
+
+        if (getrusage(RUSAGE_SELF, &usage) == 0)
+            peak.workingSet = static_cast<std::uint64_t>(usage.ru_maxrss) * 1024;
+
+        std::ifstream status{"/proc/self/status"};
+
+        for (std::string line; std::getline(status, line);)
+        {
+            // "VmPeak:    123456 kB"
+            if (line.starts_with("VmPeak:"))
+                peak.commit = std::stoull(line.substr(7)) * 1024;
+        }
+
+        return peak;
+#endif
+    }
+
+    // Reported on the standard error rather than the debug output, so
+    // release runs in CI show which limit failed them
+    void CheckLimit(const char* name, double value, double limit, std::vector<const char*>& exceededLimits)
+    {
+        if (limit <= 0.0 || value <= limit)
+            return;
+
+        std::cerr << std::format("Benchmark {} of {:.3f} ms exceeds the limit of {:.3f} ms\n", name, value, limit);
+
+        exceededLimits.push_back(name);
+    }
+}
+
+namespace DXSandbox
+{
+    Benchmark::Benchmark(const Params& params)
+        : m_params{params}
+    {
+        assert(m_params.measuredFrames > 0);
+
+        // The first measured frame time needs the end of a previous frame
+        m_params.warmupFrames = std::max(m_params.warmupFrames, 1u);
+
+        m_frameTimes.reserve(m_params.measuredFrames);
+    }
+
+    Benchmark::Params Benchmark::ParseParams(const CommandLineArgs& args)
+    {
+        return
+        {
+            .warmupFrames = args.NumericValue("--benchmarkWarmupFrames", 120u),
+            .measuredFrames = std::max(args.NumericValue("--benchmarkFrames", 1000u), 1u),
+            .reportPath = args.PathValue("--benchmarkReport").value_or(DefaultReportPath),
+            .tracePath = args.PathValue("--benchmarkTrace").value_or(""),
+            .maxAverageMilliseconds = args.NumericValue("--benchmarkMaxAverageMs", 0.0),
+            .maxP95Milliseconds = args.NumericValue("--benchmarkMaxP95Ms", 0.0),
+            .maxP99Milliseconds = args.NumericValue("--benchmarkMaxP99Ms", 0.0)
+        };
+    }
+
+    void Benchmark::PopulateScene(SceneStore& scene)
+    {
+        assert(m_roots.empty());
+
+        m_roots.reserve(RootCount);
+
+        for (std::uint32_t i = 0; i < RootCount; ++i)
+        {
+            const Entity root = scene.CreateEntity();
+
+            CreateSubtree(scene, root, Depth - 1);
+
+            m_roots.push_back(root);
+        }
+    }
+
+    void Benchmark::AnimateScene(SceneStore& scene, std::uint64_t frameIndex) const
+    {
+        // Depends on nothing but the frame number, so every run is the same
+        const float time = static_cast<float>(frameIndex % 3600) / 60.0f;
+
+        for (std::size_t i = 0; i < m_roots.size(); ++i)
+        {
+            const float phase = static_cast<float>(i) * Math::TwoPi / static_cast<float>(m_roots.size());
+
+            const Math::Quaternion rotation = Math::RotationAxisAngle({0.0f, 1.0f, 0.0f}, time + phase);
+            const Math::Float3 position = {10.0f * Math::Cos(phase), 0.0f, 10.0f * Math::Sin(phase)};
+
+            scene.SetLocalTransform(m_roots[i], Math::AffineTransformation({1.0f, 1.0f, 1.0f}, rotation, position));
+        }
+    }
+
+    void Benchmark::SubmitDraws(std::span<const Math::Float4x4> worldTransforms, DrawQueue& drawQueue) const
+    {
+        for (std::uint32_t i = 0; i < worldTransforms.size(); ++i)
+        {
+            const float viewDepth = worldTransforms[i].m[3][2] + CameraDistance;
+
+            drawQueue.Submit(
+            {
+                .pipelineState = i % PipelineStateCount,
+                .material = i % MaterialCount,
+                .depth = DrawSortKey::QuantizeDepth(viewDepth / SceneDepth),
+                .vertexCount = 36,
+                .startInstance = i
+            });
+        }
+    }
+
+    TraceRecorder* Benchmark::Zones() noexcept
+    {
+        return IsMeasuring() ? &m_zones : nullptr;
+    }
+
+    void Benchmark::OnFrameRendered()
+    {
+        const auto now = TraceRecorder::Clock::now();
+
+        if (IsMeasuring())
+            m_frameTimes.push_back(now - m_lastFrameEnd);
+
+        m_lastFrameEnd = now;
+
+        ++m_renderedFrames;
+    }
+
+    bool Benchmark::IsFinished() const noexcept
+    {
+        return m_renderedFrames >= m_params.warmupFrames + m_params.measuredFrames;
+    }
+
+    bool Benchmark::WriteReport() const
+    {
+        if (m_frameTimes.empty())
+        {
+            std::cerr << "Benchmark ended before any frame was measured\n";
+            return false;
+        }
+
+        std::vector<Duration> sorted = m_frameTimes;
+        std::sort(sorted.begin(), sorted.end());
+
+        Duration total = {};
+
+        for (const Duration frameTime : sorted)
+            total += frameTime;
+
+        const double frameCount = static_cast<double>(sorted.size());
+
+        const double average = ToMilliseconds(total) / frameCount;
+        const double p50 = Percentile(sorted, 50.0);
+        const double p95 = Percentile(sorted, 95.0);
+        const double p99 = Percentile(sorted, 99.0);
+        const double max = ToMilliseconds(sorted.back());
+
+        // Sorted by name, so reports diff cleanly
+        std::map<std::string, Duration> zones;
+
+        for (const TraceRecorder::Event& event : m_zones.Events())
+            zones[event.name] += event.duration;
+
+        const PeakMemory memory = QueryPeakMemory();
+
+        // Every limit is checked, so all violations are logged
+        std::vector<const char*> exceededLimits;
+
+        CheckLimit("average frame time", average, m_params.maxAverageMilliseconds, exceededLimits);
+        CheckLimit("p95 frame time", p95, m_params.maxP95Milliseconds, exceededLimits);
+        CheckLimit("p99 frame time", p99, m_params.maxP99Milliseconds, exceededLimits);
+
+        const bool isPassed = exceededLimits.empty();
+
+        std::ofstream file{m_params.reportPath, std::ios::trunc};
+
+        file << "{\n"
+             << "  \"warmupFrames\": " << m_params.warmupFrames << ",\n"
+             << "  \"measuredFrames\": " << sorted.size() << ",\n"
+             << "  \"frameTimeMilliseconds\": {"
+             << "\"average\": " << average << ", \"p50\": " << p50 << ", \"p95\": " << p95
+             << ", \"p99\": " << p99 << ", \"max\": " << max << "},\n"
+             << "  \"zoneMillisecondsPerFrame\": {";
+
+        const char* separator = "";
+
+        for (const auto& [name, time] : zones)
+        {
+            file << separator << "\"" << name << "\": " << ToMilliseconds(time) / frameCount;
+            separator = ", ";
+        }
+
+        file << "},\n"
+             << "  \"peakMemoryBytes\": {\"workingSet\": " << memory.workingSet
+             << ", \"commit\": " << memory.commit << "},\n"
+             << "  \"counters\": {";
+
+        separator = "";
+
+        using Instrumentation::Counter;
+
+        for (const Counter* counter = Instrumentation::FirstCounter(); counter; counter = counter->Next())
+        {
+            file << separator << "\"" << counter->Name() << "\": " << counter->Value();
+            separator = ", ";
+        }
+
+        file << "},\n"
+             << "  \"exceededLimits\": [";
+
+        separator = "";
+
+        for (const char* name : exceededLimits)
+        {
+            file << separator << "\"" << name << "\"";
+            separator = ", ";
+        }
+
+        file << "],\n"
+             << "  \"passed\": " << (isPassed ? "true" : "false") << "\n"
+             << "}\n";
+
+        if (!file)
+        {
+            std::cerr << "Failed to write the benchmark report " << m_params.reportPath << '\n';
+            return false;
+        }
+
+        if (!m_params.tracePath.empty() && !m_zones.WriteChromeTrace(m_params.tracePath))
+        {
+            std::cerr << "Failed to write the benchmark trace " << m_params.tracePath << '\n';
+            return false;
+        }
+
+        return isPassed;
+    }
+
+    bool Benchmark::IsMeasuring() const noexcept
+    {
+        return m_renderedFrames >= m_params.warmupFrames && !IsFinished();
+    }
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "SceneStore.hpp"
+#include "TraceRecorder.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+namespace DXSandbox
+{
+    class CommandLineArgs;
+    class DrawQueue;
+
+    // Reproducible performance run: a scene animated from the frame number
+    // alone is rendered for a number of warm-up frames, which are ignored,
+    // and then for a number of measured frames. The report has frame time
+    // percentiles, the time spent in each zone per frame, the peak memory
+    // of the process, every instrumentation counter and the limits the run
+    // exceeded, which are also written to the standard error.
+    class Benchmark final
+    {
+    public:
+        struct Params final
+        {
+            std::uint32_t warmupFrames = 120;
+            std::uint32_t measuredFrames = 1000;
+
+            std::filesystem::path reportPath;
+
+            // Chrome trace of the measured frames, with the GPU scopes when
+            // the GPU profiler is enabled; empty to skip it
+            std::filesystem::path tracePath;
+
+            // Limits in milliseconds that fail the run; zero disables them
+            double maxAverageMilliseconds = 0.0;
+            double maxP95Milliseconds = 0.0;
+            double maxP99Milliseconds = 0.0;
+        };
+
+        // The states the draws of the scene cycle through
+        static constexpr std::uint32_t RootSignatureCount = 1;
+        static constexpr std::uint32_t PipelineStateCount = 8;
+        static constexpr std::uint32_t MaterialCount = 64;
+
+        explicit Benchmark(const Params& params);
+
+        // From --benchmarkReport (Benchmark.json), --benchmarkTrace,
+        // --benchmarkWarmupFrames, --benchmarkFrames and the
+        // --benchmarkMax{Average,P95,P99}Ms limits
+        static Params ParseParams(const CommandLineArgs& args);
+
+        Benchmark(const Benchmark&) = delete;
+        Benchmark& operator = (const Benchmark&) = delete;
+
+        void PopulateScene(SceneStore& scene);
+
+        // Safe on the update thread, the roots do not change anymore
+        void AnimateScene(SceneStore& scene, std::uint64_t frameIndex) const;
+
+        // A draw for every entity, by the world transforms of the scene
+        void SubmitDraws(std::span<const Math::Float4x4> worldTransforms, DrawQueue& drawQueue) const;
+
+        // Collects zones during the measured frames, null otherwise
+        TraceRecorder* Zones() noexcept;
+
+        // Render thread, once per presented frame
+        void OnFrameRendered();
+
+        bool IsFinished() const noexcept;
+
+        // Returns false when a limit is exceeded or the report cannot be
+        // written, which is the exit code CI checks
+        bool WriteReport() const;
+
+    private:
+        bool IsMeasuring() const noexcept;
+
+    private:
+        Params m_params;
+
+        std::vector<Entity> m_roots;
+
+        TraceRecorder m_zones;
+
+        std::uint32_t m_renderedFrames = 0;
+        TraceRecorder::Clock::time_point m_lastFrameEnd;
+        std::vector<TraceRecorder::Clock::duration> m_frameTimes;
+    };
+}
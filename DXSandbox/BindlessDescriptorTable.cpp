@@ -0,0 +1,149 @@
+#include "BindlessDescriptorTable.hpp"
+
+#include "ErrorHandling.hpp"
+#include "Instrumentation.hpp"
+
+#include <cassert>
+#include <new>
+#include <utility>
+
+namespace
+{
+    using DXSandbox::Instrumentation::Counter;
+
+    Counter g_liveDescriptors{"Bindless.LiveDescriptors"};
+    Counter g_pendingDescriptors{"Bindless.PendingDescriptors"};
+}
+
+namespace DXSandbox
+{
+    BindlessDescriptorTable::BindlessDescriptorTable(ComPtr<ID3D12Device> device, std::uint32_t capacity)
+        : m_device{std::move(device)}
+        , m_handles{capacity}
+    {
+        assert(m_device);
+
+        const D3D12_DESCRIPTOR_HEAP_DESC heapDesc =
+        {
+            .Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV,
+            .NumDescriptors = capacity,
+            .Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE
+        };
+
+        ThrowIfFailed(m_device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&m_heap)));
+
+        m_heapStart = m_heap->GetCPUDescriptorHandleForHeapStart();
+        m_gpuHeapStart = m_heap->GetGPUDescriptorHandleForHeapStart();
+        m_descriptorSize = m_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+    }
+
+    BindlessDescriptorTable::Handle BindlessDescriptorTable::RegisterTexture(ID3D12Resource* texture,
+                                                                             const D3D12_SHADER_RESOURCE_VIEW_DESC* desc)
+    {
+        assert(texture);
+
+        D3D12_CPU_DESCRIPTOR_HANDLE descriptor;
+
+        const Handle handle = AllocateSlot(descriptor);
+
+        m_device->CreateShaderResourceView(texture, desc, descriptor);
+
+        return handle;
+    }
+
+    BindlessDescriptorTable::Handle BindlessDescriptorTable::RegisterBuffer(ID3D12Resource* buffer,
+                                                                            UINT firstElement, UINT elementCount,
+                                                                            UINT stride)
+    {
+        assert(buffer && elementCount > 0);
+
+        const bool isRaw = stride == 0;
+
+        // Raw views address 32-bit elements
+        const D3D12_SHADER_RESOURCE_VIEW_DESC desc =
+        {
+            .Format = isRaw ? DXGI_FORMAT_R32_TYPELESS : DXGI_FORMAT_UNKNOWN,
+            .ViewDimension = D3D12_SRV_DIMENSION_BUFFER,
+            .Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING,
+            .Buffer =
+            {
+                .FirstElement = firstElement,
+                .NumElements = elementCount,
+                .StructureByteStride = stride,
+                .Flags = isRaw ? D3D12_BUFFER_SRV_FLAG_RAW : D3D12_BUFFER_SRV_FLAG_NONE
+            }
+        };
+
+        D3D12_CPU_DESCRIPTOR_HANDLE descriptor;
+
+        const Handle handle = AllocateSlot(descriptor);
+
+        m_device->CreateShaderResourceView(buffer, &desc, descriptor);
+
+        return handle;
+    }
+
+    void BindlessDescriptorTable::Release(Handle handle, UINT64 fenceValue)
+    {
+        m_handles.Free(handle, fenceValue);
+
+        const auto stats = m_handles.Stats();
+
+        g_liveDescriptors.Set(stats.liveCount);
+        g_pendingDescriptors.Set(stats.pendingCount);
+    }
+
+    void BindlessDescriptorTable::Reclaim(UINT64 completedFenceValue)
+    {
+        m_handles.Reclaim(completedFenceValue);
+
+        g_pendingDescriptors.Set(m_handles.Stats().pendingCount);
+    }
+
+    std::uint32_t BindlessDescriptorTable::Index(Handle handle) const noexcept
+    {
+        return m_handles.Index(handle);
+    }
+
+    bool BindlessDescriptorTable::IsValid(Handle handle) const noexcept
+    {
+        return m_handles.IsValid(handle);
+    }
+
+    D3D12_GPU_DESCRIPTOR_HANDLE BindlessDescriptorTable::GpuDescriptor(Handle handle) const noexcept
+    {
+        return
+        {
+            .ptr = m_gpuHeapStart.ptr + UINT64{m_handles.Index(handle)} * m_descriptorSize
+        };
+    }
+
+    ID3D12DescriptorHeap* BindlessDescriptorTable::Heap() const noexcept
+    {
+        return m_heap.Get();
+    }
+
+    BindlessHandleTable::Statistics BindlessDescriptorTable::Stats() const noexcept
+    {
+        return m_handles.Stats();
+    }
+
+    BindlessDescriptorTable::Handle BindlessDescriptorTable::AllocateSlot(D3D12_CPU_DESCRIPTOR_HANDLE& descriptor)
+    {
+        const Handle handle = m_handles.Allocate();
+
+        if (handle == BindlessHandleTable::InvalidHandle)
+            throw std::bad_alloc{};
+
+        // Views are written straight into the shader visible heap, which
+        // frames in flight never read at this slot
+        descriptor =
+        {
+            .ptr = m_heapStart.ptr + SIZE_T{m_handles.Index(handle)} * m_descriptorSize
+        };
+
+        g_liveDescriptors.Set(m_handles.Stats().liveCount);
+
+        return handle;
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "WindowsPlatform.hpp"
+
+#include "BindlessHandleTable.hpp"
+#include "ComPtr.hpp"
+
+#include <d3d12.h>
+
+#include <cstdint>
+
+namespace DXSandbox
+{
+    // One shader visible CBV/SRV/UAV heap holding the views of every
+    // texture and buffer, registered once. Shaders index it directly with
+    // the index of a handle, passed as the material root constant or
+    // stored in a buffer, so draws neither copy descriptors nor set tables.
+    // Root signatures indexing it are created with
+    // D3D12_ROOT_SIGNATURE_FLAG_CBV_SRV_UAV_HEAP_DIRECTLY_INDEXED.
+    class BindlessDescriptorTable final
+    {
+    public:
+        using Handle = BindlessHandleTable::Handle;
+
+        static constexpr std::uint32_t DefaultCapacity = 64 * 1024;
+
+        explicit BindlessDescriptorTable(ComPtr<ID3D12Device> device, std::uint32_t capacity = DefaultCapacity);
+
+        BindlessDescriptorTable(const BindlessDescriptorTable&) = delete;
+        BindlessDescriptorTable& operator = (const BindlessDescriptorTable&) = delete;
+
+        // The default view of the resource without a description. Throws
+        // std::bad_alloc when the table is full.
+        Handle RegisterTexture(ID3D12Resource* texture, const D3D12_SHADER_RESOURCE_VIEW_DESC* desc = nullptr);
+
+        // A structured buffer view, or a raw one without a stride
+        Handle RegisterBuffer(ID3D12Resource* buffer, UINT firstElement, UINT elementCount, UINT stride = 0);
+
+        // The view stays until the fence reaches the value; the handle is
+        // invalid at once
+        void Release(Handle handle, UINT64 fenceValue);
+
+        void Reclaim(UINT64 completedFenceValue);
+
+        // What shaders index the heap with
+        std::uint32_t Index(Handle handle) const noexcept;
+
+        bool IsValid(Handle handle) const noexcept;
+
+        // For shaders compiled without direct heap indexing, which reach
+        // the view through a descriptor table starting at it
+        D3D12_GPU_DESCRIPTOR_HANDLE GpuDescriptor(Handle handle) const noexcept;
+
+        // Bound once per command list
+        ID3D12DescriptorHeap* Heap() const noexcept;
+
+        BindlessHandleTable::Statistics Stats() const noexcept;
+
+    private:
+        Handle AllocateSlot(D3D12_CPU_DESCRIPTOR_HANDLE& descriptor);
+
+    private:
+        ComPtr<ID3D12Device> m_device;
+        ComPtr<ID3D12DescriptorHeap> m_heap;
+
+        D3D12_CPU_DESCRIPTOR_HANDLE m_heapStart = {};
+        D3D12_GPU_DESCRIPTOR_HANDLE m_gpuHeapStart = {};
+        UINT m_descriptorSize = 0;
+
+        BindlessHandleTable m_handles;
+    };
+}
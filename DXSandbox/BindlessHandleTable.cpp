@@ -0,0 +1,78 @@
+#include "BindlessHandleTable.hpp"
+
+namespace DXSandbox
+{
+    BindlessHandleTable::BindlessHandleTable(std::uint32_t capacity)
+        : m_generations(capacity, 1)
+        , m_isLive(capacity, false)
+    {
+        assert(capacity > 0 && capacity <= MaxCapacity);
+
+        m_freeIndices.reserve(capacity);
+
+        // Slot 0 is handed out first
+        for (std::uint32_t index = capacity; index > 0; --index)
+            m_freeIndices.push_back(index - 1);
+    }
+
+    BindlessHandleTable::Handle BindlessHandleTable::Allocate()
+    {
+        if (m_freeIndices.empty()) [[unlikely]]
+            return InvalidHandle;
+
+        const std::uint32_t index = m_freeIndices.back();
+
+        m_freeIndices.pop_back();
+
+        m_isLive[index] = true;
+        ++m_liveCount;
+
+        return static_cast<Handle>(m_generations[index]) << IndexBits | index;
+    }
+
+    void BindlessHandleTable::Free(Handle handle, std::uint64_t fenceValue)
+    {
+        // Also catches double frees, the generation having moved on
+        assert(IsValid(handle));
+        assert(m_pendingFrees.empty() || m_pendingFrees.back().fenceValue <= fenceValue);
+
+        const std::uint32_t index = handle & IndexMask;
+
+        // Wraps around skipping zero, which keeps InvalidHandle unused
+        std::uint16_t& generation = m_generations[index];
+
+        generation = generation == MaxGeneration ? 1 : static_cast<std::uint16_t>(generation + 1);
+
+        m_isLive[index] = false;
+        --m_liveCount;
+
+        m_pendingFrees.push_back({.fenceValue = fenceValue, .index = index});
+    }
+
+    void BindlessHandleTable::Reclaim(std::uint64_t completedFenceValue)
+    {
+        while (!m_pendingFrees.empty() && m_pendingFrees.front().fenceValue <= completedFenceValue)
+        {
+            m_freeIndices.push_back(m_pendingFrees.front().index);
+            m_pendingFrees.pop_front();
+        }
+    }
+
+    bool BindlessHandleTable::IsValid(Handle handle) const noexcept
+    {
+        const std::uint32_t index = handle & IndexMask;
+
+        return index < m_generations.size() && m_isLive[index] &&
+               m_generations[index] == handle >> IndexBits;
+    }
+
+    BindlessHandleTable::Statistics BindlessHandleTable::Stats() const noexcept
+    {
+        return
+        {
+            .capacity = static_cast<std::uint32_t>(m_generations.size()),
+            .liveCount = m_liveCount,
+            .pendingCount = static_cast<std::uint32_t>(m_pendingFrees.size())
+        };
+    }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace DXSandbox
+{
+    // Slots of a bindless descriptor table, referred to by 32-bit handles
+    // of a slot index and a generation. Freeing a slot bumps its generation,
+    // so stale handles are told apart from the handle of the next object in
+    // the slot; debug builds check every handle looked up. Freed slots are
+    // reused only once the GPU has completed the frame given on release,
+    // since frames in flight may still index them.
+    class BindlessHandleTable final
+    {
+    public:
+        using Handle = std::uint32_t;
+
+        static constexpr unsigned IndexBits = 20;
+        static constexpr unsigned GenerationBits = 32 - IndexBits;
+
+        // The resource binding tier 2 limit of a shader visible heap
+        static constexpr std::uint32_t MaxCapacity = 1u << IndexBits;
+
+        // Generations start at one, so no slot ever has this handle
+        static constexpr Handle InvalidHandle = 0;
+
+        struct Statistics final
+        {
+            std::uint32_t capacity = 0;
+            std::uint32_t liveCount = 0;
+            std::uint32_t pendingCount = 0;
+        };
+
+        explicit BindlessHandleTable(std::uint32_t capacity);
+
+        // InvalidHandle when every slot is live or waiting for the GPU
+        Handle Allocate();
+
+        // The slot is reused once the fence reaches the value
+        void Free(Handle handle, std::uint64_t fenceValue);
+
+        // Returns the slots of the completed frames to the free list
+        void Reclaim(std::uint64_t completedFenceValue);
+
+        bool IsValid(Handle handle) const noexcept;
+
+        // Descriptor index of a live handle
+        std::uint32_t Index(Handle handle) const noexcept
+        {
+            assert(IsValid(handle));
+
+            return handle & IndexMask;
+        }
+
+        Statistics Stats() const noexcept;
+
+    private:
+        static constexpr std::uint32_t IndexMask = MaxCapacity - 1;
+        static constexpr std::uint32_t MaxGeneration = (1u << GenerationBits) - 1;
+
+        struct PendingFree final
+        {
+            std::uint64_t fenceValue = 0;
+            std::uint32_t index = 0;
+        };
+
+    private:
+        // Current generation of each slot, that of its live handle if any
+        std::vector<std::uint16_t> m_generations;
+        std::vector<bool> m_isLive;
+
+        // Reused last in, first out, which keeps the table dense
+        std::vector<std::uint32_t> m_freeIndices;
+
+        // In release order, which is fence order
+        std::deque<PendingFree> m_pendingFrees;
+
+        std::uint32_t m_liveCount = 0;
+    };
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+
+namespace DXSandbox
+{
+    // Fixed capacity lock-free queue for any number of producers and
+    // consumers (Vyukov's bounded queue). Every cell carries a sequence
+    // number telling whose turn it is, so a push or pop claims a position
+    // with one CAS and publishes with one release store. Pushing to a full
+    // queue fails instead of waiting.
+    template <typename T, std::size_t Capacity>
+    class BoundedQueue final
+    {
+        static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                      "Capacity must be a power of two");
+        static_assert(std::is_trivially_copyable_v<T>);
+
+    public:
+        BoundedQueue() noexcept
+        {
+            for (std::size_t i = 0; i < Capacity; ++i)
+                m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        BoundedQueue(const BoundedQueue&) = delete;
+        BoundedQueue& operator = (const BoundedQueue&) = delete;
+
+        bool TryPush(const T& value) noexcept
+        {
+            std::size_t position = m_pushPosition.load(std::memory_order_relaxed);
+
+            for (;;)
+            {
+                Cell& cell = m_cells[position & Mask];
+
+                const std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+                const auto lag = static_cast<std::ptrdiff_t>(sequence - position);
+
+                if (lag == 0)
+                {
+                    if (m_pushPosition.compare_exchange_weak(position, position + 1,
+                                                             std::memory_order_relaxed))
+                    {
+                        cell.value = value;
+                        cell.sequence.store(position + 1, std::memory_order_release);
+
+                        return true;
+                    }
+                }
+                else if (lag < 0)
+                {
+                    // The cell still holds the value pushed one lap ago
+                    return false;
+                }
+                else
+                {
+                    position = m_pushPosition.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        bool TryPop(T& value) noexcept
+        {
+            std::size_t position = m_popPosition.load(std::memory_order_relaxed);
+
+            for (;;)
+            {
+                Cell& cell = m_cells[position & Mask];
+
+                const std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+                const auto lag = static_cast<std::ptrdiff_t>(sequence - (position + 1));
+
+                if (lag == 0)
+                {
+                    if (m_popPosition.compare_exchange_weak(position, position + 1,
+                                                            std::memory_order_relaxed))
+                    {
+                        value = cell.value;
+                        cell.sequence.store(position + Capacity, std::memory_order_release);
+
+                        return true;
+                    }
+                }
+                else if (lag < 0)
+                {
+                    // Nothing has been pushed to the cell yet
+                    return false;
+                }
+                else
+                {
+                    position = m_popPosition.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        static constexpr std::size_t MaxSize() noexcept
+        {
+            return Capacity;
+        }
+
+    private:
+        static constexpr std::size_t Mask = Capacity - 1;
+        static constexpr std::size_t CacheLineSize = 64;
+
+        struct Cell final
+        {
+            std::atomic<std::size_t> sequence;
+            T value;
+        };
+
+        using Position = std::atomic<std::size_t>;
+
+        // Producers and consumers each get their own cache line. Padding is
+        // explicit since over-aligned members trip the padding warning.
+        std::array<Cell, Capacity> m_cells;
+        std::byte m_cellsPadding[CacheLineSize];
+        Position m_pushPosition = 0;
+        std::byte m_pushPadding[CacheLineSize - sizeof(Position)];
+        Position m_popPosition = 0;
+        std::byte m_popPadding[CacheLineSize - sizeof(Position)];
+    };
+}
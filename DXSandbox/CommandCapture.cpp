@@ -0,0 +1,231 @@
+#include "CommandCapture.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+
+namespace
+{
+    // "DXCS", then the version; every integer is 32-bit little endian
+    constexpr std::uint32_t Magic = 0x53435844;
+    constexpr std::uint32_t Version = 1;
+
+    // Sanity limit on the counts of a file, to reject garbage before
+    // allocating for it
+    constexpr std::uint32_t MaxCount = 1u << 24;
+
+    void WriteUInt(std::ofstream& file, std::uint32_t value)
+    {
+        const char bytes[] =
+        {
+            static_cast<char>(value & 0xFF),
+            static_cast<char>((value >> 8) & 0xFF),
+            static_cast<char>((value >> 16) & 0xFF),
+            static_cast<char>((value >> 24) & 0xFF)
+        };
+
+        file.write(bytes, sizeof(bytes));
+    }
+
+    std::optional<std::uint32_t> ReadUInt(std::ifstream& file)
+    {
+        unsigned char bytes[4] = {};
+
+        if (!file.read(reinterpret_cast<char*>(bytes), sizeof(bytes)))
+            return std::nullopt;
+
+        return static_cast<std::uint32_t>(bytes[0]) | static_cast<std::uint32_t>(bytes[1]) << 8 |
+               static_cast<std::uint32_t>(bytes[2]) << 16 | static_cast<std::uint32_t>(bytes[3]) << 24;
+    }
+}
+
+namespace DXSandbox
+{
+    CommandCapture::CommandCapture(std::uint32_t maxFrames)
+        : m_maxFrames{maxFrames}
+    {
+    }
+
+    CommandStream& CommandCapture::Stream() noexcept
+    {
+        return m_stream;
+    }
+
+    std::uint32_t CommandCapture::TargetIndex(const void* resource, std::uint32_t width, std::uint32_t height)
+    {
+        // A resized target is a new one, even at the same address
+        const auto [it, isInserted] = m_targetIndices.try_emplace({resource, width, height},
+                                                                  static_cast<std::uint32_t>(m_targets.size()));
+
+        if (isInserted)
+            m_targets.push_back({.width = width, .height = height});
+
+        return it->second;
+    }
+
+    void CommandCapture::SetStateCounts(std::uint32_t rootSignatures, std::uint32_t pipelineStates) noexcept
+    {
+        m_rootSignatureCount = rootSignatures;
+        m_pipelineStateCount = pipelineStates;
+    }
+
+    void CommandCapture::EndFrame()
+    {
+        assert(!IsFull());
+
+        const auto bytes = m_stream.Bytes();
+
+        m_frameBytes.insert(m_frameBytes.end(), bytes.begin(), bytes.end());
+        m_frameOffsets.push_back(m_frameBytes.size());
+        m_commandCount += m_stream.CommandCount();
+
+        m_stream.Reset();
+    }
+
+    bool CommandCapture::IsFull() const noexcept
+    {
+        return m_maxFrames != 0 && FrameCount() >= m_maxFrames;
+    }
+
+    std::uint32_t CommandCapture::FrameCount() const noexcept
+    {
+        return static_cast<std::uint32_t>(m_frameOffsets.size() - 1);
+    }
+
+    std::span<const std::byte> CommandCapture::Frame(std::uint32_t frame) const noexcept
+    {
+        assert(frame < FrameCount());
+
+        const std::size_t begin = m_frameOffsets[frame];
+
+        return std::span{m_frameBytes}.subspan(begin, m_frameOffsets[frame + 1] - begin);
+    }
+
+    std::size_t CommandCapture::CommandCount() const noexcept
+    {
+        return m_commandCount;
+    }
+
+    std::size_t CommandCapture::ByteCount() const noexcept
+    {
+        return m_frameBytes.size();
+    }
+
+    std::span<const CommandCapture::Target> CommandCapture::Targets() const noexcept
+    {
+        return m_targets;
+    }
+
+    std::uint32_t CommandCapture::RootSignatureCount() const noexcept
+    {
+        return m_rootSignatureCount;
+    }
+
+    std::uint32_t CommandCapture::PipelineStateCount() const noexcept
+    {
+        return m_pipelineStateCount;
+    }
+
+    bool CommandCapture::Write(const std::filesystem::path& path) const
+    {
+        std::ofstream file{path, std::ios::binary | std::ios::trunc};
+
+        if (!file)
+            return false;
+
+        WriteUInt(file, Magic);
+        WriteUInt(file, Version);
+        WriteUInt(file, static_cast<std::uint32_t>(m_commandCount));
+        WriteUInt(file, m_rootSignatureCount);
+        WriteUInt(file, m_pipelineStateCount);
+        WriteUInt(file, static_cast<std::uint32_t>(m_targets.size()));
+
+        for (const Target& target : m_targets)
+        {
+            WriteUInt(file, target.width);
+            WriteUInt(file, target.height);
+        }
+
+        WriteUInt(file, FrameCount());
+
+        for (std::uint32_t frame = 0; frame < FrameCount(); ++frame)
+            WriteUInt(file, static_cast<std::uint32_t>(Frame(frame).size()));
+
+        file.write(reinterpret_cast<const char*>(m_frameBytes.data()),
+                   static_cast<std::streamsize>(m_frameBytes.size()));
+
+        return static_cast<bool>(file);
+    }
+
+    std::optional<CommandCapture> CommandCapture::Read(const std::filesystem::path& path)
+    {
+        std::ifstream file{path, std::ios::binary};
+
+        if (!file || ReadUInt(file) != Magic || ReadUInt(file) != Version)
+            return std::nullopt;
+
+        const auto commandCount = ReadUInt(file);
+        const auto rootSignatureCount = ReadUInt(file);
+        const auto pipelineStateCount = ReadUInt(file);
+        const auto targetCount = ReadUInt(file);
+
+        if (!commandCount || !rootSignatureCount || !pipelineStateCount || !targetCount ||
+            *targetCount > MaxCount)
+        {
+            return std::nullopt;
+        }
+
+        CommandCapture capture;
+
+        capture.m_commandCount = *commandCount;
+        capture.SetStateCounts(*rootSignatureCount, *pipelineStateCount);
+
+        for (std::uint32_t i = 0; i < *targetCount; ++i)
+        {
+            const auto width = ReadUInt(file);
+            const auto height = ReadUInt(file);
+
+            if (!width || !height)
+                return std::nullopt;
+
+            capture.m_targets.push_back({.width = *width, .height = *height});
+        }
+
+        const auto frameCount = ReadUInt(file);
+
+        if (!frameCount || *frameCount > MaxCount)
+            return std::nullopt;
+
+        for (std::uint32_t i = 0; i < *frameCount; ++i)
+        {
+            const auto size = ReadUInt(file);
+
+            if (!size)
+                return std::nullopt;
+
+            capture.m_frameOffsets.push_back(capture.m_frameOffsets.back() + *size);
+        }
+
+        // Read in chunks, so a truncated file fails before a huge claimed
+        // size is allocated
+        static constexpr std::size_t ChunkSize = 64 * 1024;
+
+        const std::size_t byteCount = capture.m_frameOffsets.back();
+
+        while (capture.m_frameBytes.size() < byteCount)
+        {
+            const std::size_t offset = capture.m_frameBytes.size();
+            const std::size_t chunk = std::min(byteCount - offset, ChunkSize);
+
+            capture.m_frameBytes.resize(offset + chunk);
+
+            if (!file.read(reinterpret_cast<char*>(capture.m_frameBytes.data() + offset),
+                           static_cast<std::streamsize>(chunk)))
+            {
+                return std::nullopt;
+            }
+        }
+
+        return capture;
+    }
+}
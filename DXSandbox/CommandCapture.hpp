@@ -0,0 +1,70 @@
+#pragma once
+
+#include "CommandStream.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <span>
+#include <tuple>
+#include <vector>
+
+namespace DXSandbox
+{
+    // The command streams of consecutive frames and the resources they
+    // reference, which replay without the scene or the device that
+    // recorded them. Targets are interned by the identity of the resource
+    // while recording and only their sizes are kept.
+    class CommandCapture final
+    {
+    public:
+        struct Target final
+        {
+            std::uint32_t width = 0;
+            std::uint32_t height = 0;
+        };
+
+        explicit CommandCapture(std::uint32_t maxFrames = 0);
+
+        // Recording; the stream receives the commands of the current frame
+        CommandStream& Stream() noexcept;
+        std::uint32_t TargetIndex(const void* resource, std::uint32_t width, std::uint32_t height);
+        void SetStateCounts(std::uint32_t rootSignatures, std::uint32_t pipelineStates) noexcept;
+        void EndFrame();
+
+        // Once the number of frames given on construction is recorded
+        bool IsFull() const noexcept;
+
+        std::uint32_t FrameCount() const noexcept;
+        std::span<const std::byte> Frame(std::uint32_t frame) const noexcept;
+        std::size_t CommandCount() const noexcept;
+        std::size_t ByteCount() const noexcept;
+
+        std::span<const Target> Targets() const noexcept;
+        std::uint32_t RootSignatureCount() const noexcept;
+        std::uint32_t PipelineStateCount() const noexcept;
+
+        bool Write(const std::filesystem::path& path) const;
+
+        // Nothing when the file cannot be read or is not a capture
+        static std::optional<CommandCapture> Read(const std::filesystem::path& path);
+
+    private:
+        std::uint32_t m_maxFrames = 0;
+
+        CommandStream m_stream;
+
+        // Frame i spans m_frameOffsets[i] to m_frameOffsets[i + 1]
+        std::vector<std::byte> m_frameBytes;
+        std::vector<std::size_t> m_frameOffsets = {0};
+        std::size_t m_commandCount = 0;
+
+        std::vector<Target> m_targets;
+        std::map<std::tuple<const void*, std::uint32_t, std::uint32_t>, std::uint32_t> m_targetIndices;
+
+        std::uint32_t m_rootSignatureCount = 0;
+        std::uint32_t m_pipelineStateCount = 0;
+    };
+}
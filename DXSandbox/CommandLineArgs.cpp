@@ -1,14 +1,15 @@
 #include "CommandLineArgs.hpp"
 
-#include "WindowsPlatform.hpp"
-
-#include "ErrorHandling.hpp"
-#include "StringUtils.hpp"
-
-#include <shellapi.h>
+#ifdef _WIN32
+#   include "WindowsPlatform.hpp"
+#   include "ErrorHandling.hpp"
+#   include "StringUtils.hpp"
+#   include <shellapi.h>
+#endif
 
 #include <algorithm>
 
+#ifdef _WIN32
 namespace
 {
     std::vector<std::string> MakeCommandLineArgs(wchar_t* cmdLine)
@@ -34,16 +35,45 @@ namespace
         return args;
     }
 }
+#endif
 
 namespace DXSandbox
 {
+#ifdef _WIN32
     CommandLineArgs::CommandLineArgs(wchar_t* cmdLine)
         : m_args(MakeCommandLineArgs(cmdLine))
     {
     }
+#endif
+
+    CommandLineArgs::CommandLineArgs(int argc, const char* const* argv)
+        : m_args(argv + std::min(argc, 1), argv + argc)
+    {
+    }
 
     bool CommandLineArgs::Contains(std::string_view arg) const
     {
         return std::find(m_args.begin(), m_args.end(), arg) != m_args.end();
     }
+
+    std::optional<std::string_view> CommandLineArgs::Value(std::string_view name) const
+    {
+        for (std::string_view arg : m_args)
+        {
+            if (arg.size() > name.size() && arg.starts_with(name) && arg[name.size()] == '=')
+                return arg.substr(name.size() + 1);
+        }
+
+        return std::nullopt;
+    }
+
+    std::optional<std::filesystem::path> CommandLineArgs::PathValue(std::string_view name) const
+    {
+        const auto utf8 = Value(name);
+
+        if (!utf8)
+            return std::nullopt;
+
+        return std::u8string_view{reinterpret_cast<const char8_t*>(utf8->data()), utf8->size()};
+    }
 }
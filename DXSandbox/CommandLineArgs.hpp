@@ -1,5 +1,8 @@
 #pragma once
 
+#include <charconv>
+#include <filesystem>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -9,10 +12,40 @@ namespace DXSandbox
     class CommandLineArgs final
     {
     public:
+#ifdef _WIN32
         explicit CommandLineArgs(wchar_t* cmdLine);
+#endif
+
+        // The arguments of main, without the program name
+        CommandLineArgs(int argc, const char* const* argv);
 
         bool Contains(std::string_view arg) const;
 
+        // Value of an argument given as "name=value"
+        std::optional<std::string_view> Value(std::string_view name) const;
+
+        // Value of a "name=value" argument as a path. Arguments are UTF-8 on
+        // every platform, which the narrow path constructor only assumes
+        // outside Windows.
+        std::optional<std::filesystem::path> PathValue(std::string_view name) const;
+
+        // Numeric value of a "name=value" argument; the default is returned
+        // when the argument is missing or not a number
+        template <typename T>
+        T NumericValue(std::string_view name, T defaultValue) const
+        {
+            const auto text = Value(name);
+
+            if (!text)
+                return defaultValue;
+
+            T value = defaultValue;
+
+            const auto result = std::from_chars(text->data(), text->data() + text->size(), value);
+
+            return result.ec == std::errc{} ? value : defaultValue;
+        }
+
         const auto begin() const noexcept
         {
             return m_args.begin();
@@ -0,0 +1,102 @@
+#include "CommandReplay.hpp"
+
+#include "CommandCapture.hpp"
+#include "CommandLineArgs.hpp"
+#include "HeadlessCommandBackend.hpp"
+
+#include <algorithm>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <string_view>
+
+namespace
+{
+    constexpr const char* DefaultOutputPath = "CommandReplay.tsv";
+    constexpr const char* Header = "capture\tframes\tcommands\tbytes\titerations\tseconds\tcommands_per_second\t"
+                                   "megabytes_per_second\tdraws\tvalidation_errors";
+}
+
+namespace DXSandbox
+{
+    ReplayResult ReplayCapture(const CommandCapture& capture, ICommandBackend& backend, std::uint32_t iterations)
+    {
+        ReplayResult result;
+
+        const auto start = std::chrono::steady_clock::now();
+
+        for (std::uint32_t iteration = 0; iteration < iterations && result.isValid; ++iteration)
+        {
+            for (std::uint32_t frame = 0; frame < capture.FrameCount(); ++frame)
+            {
+                const auto commandCount = CommandStream::Replay(capture.Frame(frame), backend);
+
+                if (!commandCount) [[unlikely]]
+                {
+                    result.isValid = false;
+                    break;
+                }
+
+                result.commands += *commandCount;
+            }
+        }
+
+        result.elapsed = std::chrono::steady_clock::now() - start;
+
+        return result;
+    }
+
+    int RunCommandReplay(const CommandLineArgs& args)
+    {
+        const auto capturePath = args.Value("--replayCommands").value_or("");
+        const auto capture = CommandCapture::Read(args.PathValue("--replayCommands").value_or(""));
+
+        // Reported on the standard streams rather than the debug output, so
+        // release runs of the replay show why they failed
+        if (!capture)
+        {
+            std::cerr << "Failed to read the command capture " << capturePath << '\n';
+            return 1;
+        }
+
+        const auto iterations = std::max(args.NumericValue("--replayIterations", 100u), 1u);
+
+        HeadlessCommandBackend backend{*capture};
+
+        const ReplayResult result = ReplayCapture(*capture, backend, iterations);
+
+        if (!result.isValid)
+        {
+            std::cerr << "The command capture " << capturePath << " is malformed\n";
+            return 1;
+        }
+
+        const HeadlessCommandBackend::Statistics& stats = backend.Stats();
+
+        const double seconds = std::chrono::duration<double>(result.elapsed).count();
+        const double commandsPerSecond = seconds > 0.0 ? static_cast<double>(result.commands) / seconds : 0.0;
+        const double bytes = static_cast<double>(capture->ByteCount()) * iterations;
+        const double megabytesPerSecond = seconds > 0.0 ? bytes / (1024.0 * 1024.0) / seconds : 0.0;
+
+        std::cout << std::format("Replayed {} commands of {} frames {} times: {:.0f} commands/s, {:.1f} MiB/s, "
+                                 "{} validation errors\n", capture->CommandCount(), capture->FrameCount(), iterations,
+                                 commandsPerSecond, megabytesPerSecond, stats.validationErrors);
+
+        const auto outputPath = args.Value("--replayOutput").value_or(DefaultOutputPath);
+
+        std::ofstream file{args.PathValue("--replayOutput").value_or(DefaultOutputPath), std::ios::trunc};
+
+        file << Header << '\n'
+             << capturePath << '\t' << capture->FrameCount() << '\t' << capture->CommandCount() << '\t'
+             << capture->ByteCount() << '\t' << iterations << '\t' << seconds << '\t' << commandsPerSecond << '\t'
+             << megabytesPerSecond << '\t' << stats.draws << '\t' << stats.validationErrors << '\n';
+
+        if (!file)
+        {
+            std::cerr << "Failed to write the replay results to " << outputPath << '\n';
+            return 1;
+        }
+
+        return stats.validationErrors == 0 ? 0 : 1;
+    }
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace DXSandbox
+{
+    class CommandCapture;
+    class CommandLineArgs;
+    class ICommandBackend;
+
+    struct ReplayResult final
+    {
+        std::uint64_t commands = 0;
+        std::chrono::steady_clock::duration elapsed = {};
+
+        // False when a frame of the capture is malformed
+        bool isValid = true;
+    };
+
+    // Replays every frame of the capture through the backend, the given
+    // number of times in a row
+    ReplayResult ReplayCapture(const CommandCapture& capture, ICommandBackend& backend, std::uint32_t iterations);
+
+    // Replays the capture given as --replayCommands=<file> through the
+    // headless backend --replayIterations (100) times and writes the
+    // throughput in commands per second to --replayOutput
+    // (CommandReplay.tsv). Malformed captures and commands the backend
+    // rejects make the returned exit code nonzero.
+    int RunCommandReplay(const CommandLineArgs& args);
+}
@@ -0,0 +1,356 @@
+#include "CommandStream.hpp"
+
+#include <bit>
+
+namespace
+{
+    using DXSandbox::ResourceState;
+
+    enum Opcode : std::uint8_t
+    {
+        BeginListOpcode,
+        BarrierOpcode,
+        SetRenderTargetOpcode,
+        ClearOpcode,
+        SetRootSignatureOpcode,
+        SetPipelineStateOpcode,
+        SetMaterialOpcode,
+        DrawOpcode,
+        UpscaleOpcode,
+        CopyToReadbackOpcode
+    };
+
+    constexpr std::uint8_t MaxResourceState = static_cast<std::uint8_t>(ResourceState::CopySource);
+
+    // Bounds checked decoding; the first failure sticks
+    class Reader final
+    {
+    public:
+        explicit Reader(std::span<const std::byte> bytes) noexcept
+            : m_position{bytes.data()}
+            , m_end{bytes.data() + bytes.size()}
+        {
+        }
+
+        bool IsAtEnd() const noexcept
+        {
+            return m_position == m_end;
+        }
+
+        bool IsValid() const noexcept
+        {
+            return m_isValid;
+        }
+
+        std::uint8_t ReadByte() noexcept
+        {
+            if (m_position == m_end) [[unlikely]]
+            {
+                m_isValid = false;
+                return 0;
+            }
+
+            return static_cast<std::uint8_t>(*m_position++);
+        }
+
+        std::uint32_t ReadUInt() noexcept
+        {
+            std::uint32_t value = 0;
+
+            for (unsigned shift = 0; shift < 35; shift += 7)
+            {
+                const std::uint8_t byte = ReadByte();
+
+                value |= static_cast<std::uint32_t>(byte & 0x7F) << shift;
+
+                if (!(byte & 0x80))
+                    return value;
+            }
+
+            m_isValid = false;
+
+            return 0;
+        }
+
+        float ReadFloat() noexcept
+        {
+            std::uint32_t bits = 0;
+
+            for (unsigned shift = 0; shift < 32; shift += 8)
+                bits |= static_cast<std::uint32_t>(ReadByte()) << shift;
+
+            return std::bit_cast<float>(bits);
+        }
+
+        ResourceState ReadState() noexcept
+        {
+            const std::uint8_t state = ReadByte();
+
+            if (state > MaxResourceState) [[unlikely]]
+                m_isValid = false;
+
+            return static_cast<ResourceState>(state);
+        }
+
+    private:
+        const std::byte* m_position = nullptr;
+        const std::byte* m_end = nullptr;
+
+        bool m_isValid = true;
+    };
+}
+
+namespace DXSandbox
+{
+    void CommandStream::BeginList()
+    {
+        WriteOpcode(BeginListOpcode);
+    }
+
+    void CommandStream::Barrier(std::uint32_t target, ResourceState before, ResourceState after)
+    {
+        WriteOpcode(BarrierOpcode);
+        WriteUInt(target);
+        m_bytes.push_back(static_cast<std::byte>(before));
+        m_bytes.push_back(static_cast<std::byte>(after));
+    }
+
+    void CommandStream::SetRenderTarget(std::uint32_t target, std::uint32_t width, std::uint32_t height)
+    {
+        WriteOpcode(SetRenderTargetOpcode);
+        WriteUInt(target);
+        WriteUInt(width);
+        WriteUInt(height);
+    }
+
+    void CommandStream::Clear(std::uint32_t target, std::uint32_t width, std::uint32_t height,
+                              const std::array<float, 4>& color)
+    {
+        WriteOpcode(ClearOpcode);
+        WriteUInt(target);
+        WriteUInt(width);
+        WriteUInt(height);
+
+        for (const float component : color)
+            WriteFloat(component);
+    }
+
+    void CommandStream::SetRootSignature(std::uint32_t rootSignature)
+    {
+        WriteOpcode(SetRootSignatureOpcode);
+        WriteUInt(rootSignature);
+    }
+
+    void CommandStream::SetPipelineState(std::uint32_t pipelineState)
+    {
+        WriteOpcode(SetPipelineStateOpcode);
+        WriteUInt(pipelineState);
+    }
+
+    void CommandStream::SetMaterial(std::uint32_t material)
+    {
+        WriteOpcode(SetMaterialOpcode);
+        WriteUInt(material);
+    }
+
+    void CommandStream::Draw(const DrawArgs& args)
+    {
+        WriteOpcode(DrawOpcode);
+        WriteUInt(args.vertexCount);
+        WriteUInt(args.instanceCount);
+        WriteUInt(args.startVertex);
+        WriteUInt(args.startInstance);
+    }
+
+    void CommandStream::Upscale(std::uint32_t source, std::uint32_t width, std::uint32_t height)
+    {
+        WriteOpcode(UpscaleOpcode);
+        WriteUInt(source);
+        WriteUInt(width);
+        WriteUInt(height);
+    }
+
+    void CommandStream::CopyToReadback(std::uint32_t source)
+    {
+        WriteOpcode(CopyToReadbackOpcode);
+        WriteUInt(source);
+    }
+
+    void CommandStream::Reset() noexcept
+    {
+        m_bytes.clear();
+        m_commandCount = 0;
+    }
+
+    std::span<const std::byte> CommandStream::Bytes() const noexcept
+    {
+        return m_bytes;
+    }
+
+    std::size_t CommandStream::CommandCount() const noexcept
+    {
+        return m_commandCount;
+    }
+
+    std::optional<std::size_t> CommandStream::Replay(std::span<const std::byte> bytes, ICommandBackend& backend)
+    {
+        Reader reader{bytes};
+
+        std::size_t commandCount = 0;
+
+        // Commands are only issued once fully decoded
+        while (!reader.IsAtEnd())
+        {
+            switch (reader.ReadByte())
+            {
+                case BeginListOpcode:
+                    backend.BeginList();
+                    break;
+
+                case BarrierOpcode:
+                {
+                    const std::uint32_t target = reader.ReadUInt();
+                    const ResourceState before = reader.ReadState();
+                    const ResourceState after = reader.ReadState();
+
+                    if (reader.IsValid())
+                        backend.Barrier(target, before, after);
+
+                    break;
+                }
+
+                case SetRenderTargetOpcode:
+                {
+                    const std::uint32_t target = reader.ReadUInt();
+                    const std::uint32_t width = reader.ReadUInt();
+                    const std::uint32_t height = reader.ReadUInt();
+
+                    if (reader.IsValid())
+                        backend.SetRenderTarget(target, width, height);
+
+                    break;
+                }
+
+                case ClearOpcode:
+                {
+                    const std::uint32_t target = reader.ReadUInt();
+                    const std::uint32_t width = reader.ReadUInt();
+                    const std::uint32_t height = reader.ReadUInt();
+
+                    std::array<float, 4> color;
+
+                    for (float& component : color)
+                        component = reader.ReadFloat();
+
+                    if (reader.IsValid())
+                        backend.Clear(target, width, height, color);
+
+                    break;
+                }
+
+                case SetRootSignatureOpcode:
+                {
+                    const std::uint32_t rootSignature = reader.ReadUInt();
+
+                    if (reader.IsValid())
+                        backend.SetRootSignature(rootSignature);
+
+                    break;
+                }
+
+                case SetPipelineStateOpcode:
+                {
+                    const std::uint32_t pipelineState = reader.ReadUInt();
+
+                    if (reader.IsValid())
+                        backend.SetPipelineState(pipelineState);
+
+                    break;
+                }
+
+                case SetMaterialOpcode:
+                {
+                    const std::uint32_t material = reader.ReadUInt();
+
+                    if (reader.IsValid())
+                        backend.SetMaterial(material);
+
+                    break;
+                }
+
+                case DrawOpcode:
+                {
+                    DrawArgs args;
+
+                    args.vertexCount = reader.ReadUInt();
+                    args.instanceCount = reader.ReadUInt();
+                    args.startVertex = reader.ReadUInt();
+                    args.startInstance = reader.ReadUInt();
+
+                    if (reader.IsValid())
+                        backend.Draw(args);
+
+                    break;
+                }
+
+                case UpscaleOpcode:
+                {
+                    const std::uint32_t source = reader.ReadUInt();
+                    const std::uint32_t width = reader.ReadUInt();
+                    const std::uint32_t height = reader.ReadUInt();
+
+                    if (reader.IsValid())
+                        backend.Upscale(source, width, height);
+
+                    break;
+                }
+
+                case CopyToReadbackOpcode:
+                {
+                    const std::uint32_t source = reader.ReadUInt();
+
+                    if (reader.IsValid())
+                        backend.CopyToReadback(source);
+
+                    break;
+                }
+
+                default:
+                    return std::nullopt;
+            }
+
+            if (!reader.IsValid())
+                return std::nullopt;
+
+            ++commandCount;
+        }
+
+        return commandCount;
+    }
+
+    void CommandStream::WriteOpcode(std::uint8_t opcode)
+    {
+        m_bytes.push_back(static_cast<std::byte>(opcode));
+
+        ++m_commandCount;
+    }
+
+    void CommandStream::WriteUInt(std::uint32_t value)
+    {
+        while (value >= 0x80)
+        {
+            m_bytes.push_back(static_cast<std::byte>((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+
+        m_bytes.push_back(static_cast<std::byte>(value));
+    }
+
+    void CommandStream::WriteFloat(float value)
+    {
+        const auto bits = std::bit_cast<std::uint32_t>(value);
+
+        for (unsigned shift = 0; shift < 32; shift += 8)
+            m_bytes.push_back(static_cast<std::byte>((bits >> shift) & 0xFF));
+    }
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "ICommandBackend.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace DXSandbox
+{
+    // Encodes the commands given to it as a compact byte stream: a one byte
+    // opcode followed by the integers of the command as LEB128 varints and
+    // the floats as their four little endian bytes. Draws of a sorted queue
+    // mostly take a handful of bytes.
+    class CommandStream final : public ICommandBackend
+    {
+    public:
+        void BeginList() override;
+        void Barrier(std::uint32_t target, ResourceState before, ResourceState after) override;
+        void SetRenderTarget(std::uint32_t target, std::uint32_t width, std::uint32_t height) override;
+        void Clear(std::uint32_t target, std::uint32_t width, std::uint32_t height,
+                   const std::array<float, 4>& color) override;
+        void SetRootSignature(std::uint32_t rootSignature) override;
+        void SetPipelineState(std::uint32_t pipelineState) override;
+        void SetMaterial(std::uint32_t material) override;
+        void Draw(const DrawArgs& args) override;
+        void Upscale(std::uint32_t source, std::uint32_t width, std::uint32_t height) override;
+        void CopyToReadback(std::uint32_t source) override;
+
+        void Reset() noexcept;
+
+        std::span<const std::byte> Bytes() const noexcept;
+        std::size_t CommandCount() const noexcept;
+
+        // Calls the backend for each command of the stream and returns the
+        // number of commands, or nothing when the stream is malformed, in
+        // which case the commands before the error have been replayed
+        static std::optional<std::size_t> Replay(std::span<const std::byte> bytes, ICommandBackend& backend);
+
+    private:
+        void WriteOpcode(std::uint8_t opcode);
+        void WriteUInt(std::uint32_t value);
+        void WriteFloat(float value);
+
+    private:
+        std::vector<std::byte> m_bytes;
+        std::size_t m_commandCount = 0;
+    };
+}
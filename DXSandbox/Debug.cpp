@@ -2,7 +2,11 @@
 
 #ifndef NDEBUG
 
-#include "WindowsPlatform.hpp"
+#ifdef _WIN32
+#   include "WindowsPlatform.hpp"
+#else
+#   include <cstdio>
+#endif
 
 #include <cassert>
 
@@ -12,7 +16,11 @@ namespace DXSandbox::Debug
     {
         assert(text);
 
+#ifdef _WIN32
         OutputDebugStringA(text);
+#else
+        std::fputs(text, stderr);
+#endif
     }
 }
 
@@ -0,0 +1,144 @@
+#include "DependencyGraph.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <unordered_set>
+
+namespace DXSandbox
+{
+    void DependencyGraph::AddDependency(const std::string& dependent, const std::string& dependency)
+    {
+        assert(dependent != dependency);
+
+        std::vector<std::string>& dependencies = m_dependencies[dependent];
+
+        if (std::find(dependencies.begin(), dependencies.end(), dependency) != dependencies.end())
+            return;
+
+        dependencies.push_back(dependency);
+        m_dependents[dependency].push_back(dependent);
+    }
+
+    void DependencyGraph::ClearDependencies(const std::string& dependent)
+    {
+        const auto found = m_dependencies.find(dependent);
+
+        if (found == m_dependencies.end())
+            return;
+
+        for (const std::string& dependency : found->second)
+            RemoveEdge(m_dependents, dependency, dependent);
+
+        m_dependencies.erase(found);
+    }
+
+    void DependencyGraph::Remove(const std::string& node)
+    {
+        ClearDependencies(node);
+
+        const auto found = m_dependents.find(node);
+
+        if (found == m_dependents.end())
+            return;
+
+        for (const std::string& dependent : found->second)
+            RemoveEdge(m_dependencies, dependent, node);
+
+        m_dependents.erase(found);
+    }
+
+    bool DependencyGraph::Contains(const std::string& node) const
+    {
+        return m_dependencies.contains(node) || m_dependents.contains(node);
+    }
+
+    std::vector<std::string> DependencyGraph::Dependents(std::span<const std::string> changed) const
+    {
+        // Everything reachable from the changed nodes, in discovery order so
+        // the result does not depend on hashing
+        std::unordered_set<std::string> affected;
+        std::vector<const std::string*> discovered;
+
+        std::vector<const std::string*> pending;
+
+        for (const std::string& node : changed)
+            pending.push_back(&node);
+
+        while (!pending.empty())
+        {
+            const std::string& node = *pending.back();
+            pending.pop_back();
+
+            const auto found = m_dependents.find(node);
+
+            if (found == m_dependents.end())
+                continue;
+
+            for (const std::string& dependent : found->second)
+            {
+                if (affected.insert(dependent).second)
+                {
+                    discovered.push_back(&dependent);
+                    pending.push_back(&dependent);
+                }
+            }
+        }
+
+        // Depth-first post-order over the dependencies within the affected
+        // set puts every node after what it is built from
+        std::vector<std::string> ordered;
+        ordered.reserve(discovered.size());
+
+        std::unordered_set<std::string> visited;
+
+        struct Frame final
+        {
+            const std::string* node = nullptr;
+            std::size_t nextDependency = 0;
+        };
+
+        std::vector<Frame> stack;
+
+        for (const std::string* root : discovered)
+        {
+            if (!visited.insert(*root).second)
+                continue;
+
+            stack.push_back({.node = root});
+
+            while (!stack.empty())
+            {
+                Frame& frame = stack.back();
+
+                const auto found = m_dependencies.find(*frame.node);
+
+                if (found != m_dependencies.end() && frame.nextDependency < found->second.size())
+                {
+                    const std::string& dependency = found->second[frame.nextDependency++];
+
+                    if (affected.contains(dependency) && visited.insert(dependency).second)
+                        stack.push_back({.node = &dependency});
+                }
+                else
+                {
+                    ordered.push_back(*frame.node);
+                    stack.pop_back();
+                }
+            }
+        }
+
+        return ordered;
+    }
+
+    void DependencyGraph::RemoveEdge(EdgeMap& edges, const std::string& from, const std::string& to)
+    {
+        const auto found = edges.find(from);
+
+        assert(found != edges.end());
+
+        std::erase(found->second, to);
+
+        if (found->second.empty())
+            edges.erase(found);
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace DXSandbox
+{
+    // Records which nodes are built from which, to find everything that has
+    // to be rebuilt when some of them change. Nodes are identified by name,
+    // typically source file paths and artifact names.
+    class DependencyGraph final
+    {
+    public:
+        void AddDependency(const std::string& dependent, const std::string& dependency);
+
+        // Forgets what the node depends on, but not what depends on it
+        void ClearDependencies(const std::string& dependent);
+
+        // Forgets the node and all of its edges
+        void Remove(const std::string& node);
+
+        bool Contains(const std::string& node) const;
+
+        // Every node depending directly or transitively on one of the changed
+        // nodes, each one listed after the nodes it depends on. Dependency
+        // cycles are broken at an arbitrary edge.
+        std::vector<std::string> Dependents(std::span<const std::string> changed) const;
+
+    private:
+        using EdgeMap = std::unordered_map<std::string, std::vector<std::string>>;
+
+        static void RemoveEdge(EdgeMap& edges, const std::string& from, const std::string& to);
+
+    private:
+        EdgeMap m_dependencies;
+        EdgeMap m_dependents;
+    };
+}
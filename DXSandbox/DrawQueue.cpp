@@ -0,0 +1,129 @@
+#include "DrawQueue.hpp"
+
+#include "Instrumentation.hpp"
+
+#include <chrono>
+
+namespace
+{
+    using DXSandbox::Instrumentation::Counter;
+
+    Counter g_drawCount{"DrawQueue.Draws"};
+    Counter g_culledDrawCount{"DrawQueue.CulledDraws"};
+    Counter g_unsortedStateChanges{"DrawQueue.StateChangesUnsorted"};
+    Counter g_sortedStateChanges{"DrawQueue.StateChangesSorted"};
+    Counter g_sortedPipelineChanges{"DrawQueue.PipelineStateChangesSorted"};
+    Counter g_sortedRootSignatureChanges{"DrawQueue.RootSignatureChangesSorted"};
+    Counter g_sortMicroseconds{"DrawQueue.SortMicroseconds"};
+}
+
+namespace DXSandbox
+{
+    void DrawQueue::Submit(const DrawPacket& packet)
+    {
+        m_sortEntries.push_back({DrawSortKey::Encode(packet), static_cast<std::uint32_t>(m_packets.size())});
+        m_packets.push_back(packet);
+    }
+
+    void DrawQueue::Clear() noexcept
+    {
+        m_packets.clear();
+        m_sortedPackets.clear();
+        m_sortEntries.clear();
+    }
+
+    bool DrawQueue::IsEmpty() const noexcept
+    {
+        return m_packets.empty();
+    }
+
+    std::size_t DrawQueue::Size() const noexcept
+    {
+        return m_packets.size();
+    }
+
+    void DrawQueue::RemoveHidden(std::span<const std::uint8_t> isVisible)
+    {
+        assert(isVisible.size() == m_packets.size());
+        assert(m_sortedPackets.empty());
+
+        std::size_t kept = 0;
+
+        for (std::size_t i = 0; i < m_packets.size(); ++i)
+        {
+            if (!isVisible[i])
+                continue;
+
+            m_packets[kept] = m_packets[i];
+            m_sortEntries[kept] = {m_sortEntries[i].key, static_cast<std::uint32_t>(kept)};
+
+            ++kept;
+        }
+
+        g_culledDrawCount.Set(static_cast<std::int64_t>(m_packets.size() - kept));
+
+        m_packets.resize(kept);
+        m_sortEntries.resize(kept);
+    }
+
+    void DrawQueue::Sort(std::pmr::memory_resource* scratch)
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        if (scratch)
+            m_sorter.Sort(m_sortEntries, *scratch);
+        else
+            m_sorter.Sort(m_sortEntries);
+
+        m_sortedPackets.resize(m_packets.size());
+
+        for (std::size_t i = 0; i < m_sortEntries.size(); ++i)
+            m_sortedPackets[i] = m_packets[m_sortEntries[i].value];
+
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+
+        const DrawStateChanges unsorted = CountStateChanges(SubmittedPackets());
+        const DrawStateChanges sorted = CountStateChanges(SortedPackets());
+
+        g_drawCount.Set(static_cast<std::int64_t>(m_packets.size()));
+        g_unsortedStateChanges.Set(unsorted.Total());
+        g_sortedStateChanges.Set(sorted.Total());
+        g_sortedPipelineChanges.Set(sorted.pipelineStates);
+        g_sortedRootSignatureChanges.Set(sorted.rootSignatures);
+        g_sortMicroseconds.Set(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+    }
+
+    std::span<const DrawPacket> DrawQueue::SubmittedPackets() const noexcept
+    {
+        return m_packets;
+    }
+
+    std::span<const DrawPacket> DrawQueue::SortedPackets() const noexcept
+    {
+        return m_sortedPackets;
+    }
+
+    DrawStateChanges DrawQueue::CountStateChanges(std::span<const DrawPacket> packets) noexcept
+    {
+        DrawStateChanges changes;
+
+        const DrawPacket* previous = nullptr;
+
+        for (const DrawPacket& packet : packets)
+        {
+            // A root signature change also invalidates the bound material
+            const bool rootSignatureChanged = !previous || previous->rootSignature != packet.rootSignature;
+
+            if (rootSignatureChanged)
+                ++changes.rootSignatures;
+            if (!previous || previous->pipelineState != packet.pipelineState)
+                ++changes.pipelineStates;
+            if (rootSignatureChanged || previous->material != packet.material)
+                ++changes.materials;
+
+            previous = &packet;
+        }
+
+        return changes;
+    }
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "RadixSort.hpp"
+
+#include <cassert>
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <vector>
+
+namespace DXSandbox
+{
+    struct DrawPacket final
+    {
+        std::uint32_t pass = 0;
+        std::uint32_t rootSignature = 0;
+        std::uint32_t pipelineState = 0;
+        std::uint32_t material = 0;
+
+        // Quantized view depth, see DrawSortKey::QuantizeDepth
+        std::uint32_t depth = 0;
+
+        std::uint32_t vertexCount = 0;
+        std::uint32_t instanceCount = 1;
+        std::uint32_t startVertex = 0;
+        std::uint32_t startInstance = 0;
+    };
+
+    // 64-bit sort key, most significant field first:
+    // pass (4) | root signature (6) | pipeline state (12) | material (18) | depth (24)
+    namespace DrawSortKey
+    {
+        inline constexpr unsigned DepthBits = 24;
+        inline constexpr unsigned MaterialBits = 18;
+        inline constexpr unsigned PipelineStateBits = 12;
+        inline constexpr unsigned RootSignatureBits = 6;
+        inline constexpr unsigned PassBits = 4;
+
+        static_assert(DepthBits + MaterialBits + PipelineStateBits +
+                      RootSignatureBits + PassBits == 64);
+
+        inline constexpr std::uint32_t MaxPasses = 1U << PassBits;
+        inline constexpr std::uint32_t MaxRootSignatures = 1U << RootSignatureBits;
+        inline constexpr std::uint32_t MaxPipelineStates = 1U << PipelineStateBits;
+        inline constexpr std::uint32_t MaxMaterials = 1U << MaterialBits;
+        inline constexpr std::uint32_t MaxDepth = (1U << DepthBits) - 1;
+
+        constexpr std::uint64_t Encode(const DrawPacket& packet) noexcept
+        {
+            assert(packet.pass < MaxPasses);
+            assert(packet.rootSignature < MaxRootSignatures);
+            assert(packet.pipelineState < MaxPipelineStates);
+            assert(packet.material < MaxMaterials);
+            assert(packet.depth <= MaxDepth);
+
+            std::uint64_t key = packet.pass;
+
+            key = (key << RootSignatureBits) | packet.rootSignature;
+            key = (key << PipelineStateBits) | packet.pipelineState;
+            key = (key << MaterialBits) | packet.material;
+            key = (key << DepthBits) | packet.depth;
+
+            return key;
+        }
+
+        // Maps depth in [0, 1] to the key range, front to back
+        constexpr std::uint32_t QuantizeDepth(float normalizedDepth) noexcept
+        {
+            if (normalizedDepth <= 0.0f)
+                return 0;
+            if (normalizedDepth >= 1.0f)
+                return MaxDepth;
+
+            return static_cast<std::uint32_t>(normalizedDepth * static_cast<float>(MaxDepth));
+        }
+    }
+
+    struct DrawStateChanges final
+    {
+        std::uint32_t rootSignatures = 0;
+        std::uint32_t pipelineStates = 0;
+        std::uint32_t materials = 0;
+
+        std::uint32_t Total() const noexcept
+        {
+            return rootSignatures + pipelineStates + materials;
+        }
+    };
+
+    // Collects the draws of one frame and orders them by sort key, so the
+    // recording loop changes root signatures and pipeline states as rarely
+    // as possible.
+    class DrawQueue final
+    {
+    public:
+        void Submit(const DrawPacket& packet);
+        void Clear() noexcept;
+
+        bool IsEmpty() const noexcept;
+        std::size_t Size() const noexcept;
+
+        // Drops the submitted packets whose entry in isVisible, indexed like
+        // SubmittedPackets, is zero; before Sort
+        void RemoveHidden(std::span<const std::uint8_t> isVisible);
+
+        // Sort scratch comes from the resource when given, typically the
+        // frame arena; otherwise it is kept by the queue between calls
+        void Sort(std::pmr::memory_resource* scratch = nullptr);
+
+        std::span<const DrawPacket> SubmittedPackets() const noexcept;
+        std::span<const DrawPacket> SortedPackets() const noexcept;
+
+        static DrawStateChanges CountStateChanges(std::span<const DrawPacket> packets) noexcept;
+
+    private:
+        std::vector<DrawPacket> m_packets;
+        std::vector<DrawPacket> m_sortedPackets;
+        std::vector<RadixSortEntry> m_sortEntries;
+
+        RadixSorter m_sorter;
+    };
+}
@@ -0,0 +1,120 @@
+#include "DynamicResolution.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace DXSandbox
+{
+    DynamicResolution::DynamicResolution(const Params& params)
+        : m_params{params}
+        , m_scale{params.maxScale}
+        , m_framesSinceChange{params.settleFrames}
+    {
+        assert(m_params.targetFrameTime.count() > 0.0);
+        assert(m_params.minScale > 0.0 && m_params.minScale <= m_params.maxScale);
+        assert(m_params.smoothing > 0.0 && m_params.smoothing <= 1.0);
+        assert(m_params.headroom >= 0.0 && m_params.headroom < 1.0);
+        assert(m_params.panicFactor > 1.0 && m_params.scaleStep > 0.0);
+    }
+
+    double DynamicResolution::Update(Milliseconds cpuFrameTime, Milliseconds gpuFrameTime)
+    {
+        const Milliseconds target = m_params.targetFrameTime;
+
+        if (gpuFrameTime.count() <= 0.0)
+            return m_scale;
+
+        if (gpuFrameTime > target * m_params.panicFactor && m_scale > m_params.minScale)
+        {
+            // Straight to the scale that would have met the target, which a
+            // spike in the middle of a settling period cannot wait for
+            const double scale = Quantize(m_scale * std::sqrt(target / gpuFrameTime));
+
+            // The load has changed, which the average would take many frames
+            // to show
+            m_smoothedGpuFrameTime = gpuFrameTime;
+            m_hasSample = true;
+
+            ChangeScale(std::min(scale, m_scale - m_params.scaleStep));
+
+            ++m_stats.panicDrops;
+
+            return m_scale;
+        }
+
+        if (m_hasSample)
+            m_smoothedGpuFrameTime += (gpuFrameTime - m_smoothedGpuFrameTime) * m_params.smoothing;
+        else
+            m_smoothedGpuFrameTime = gpuFrameTime;
+
+        m_hasSample = true;
+
+        if (m_framesSinceChange < m_params.settleFrames)
+        {
+            ++m_framesSinceChange;
+            return m_scale;
+        }
+
+        const Milliseconds lowerBound = target * (1.0 - m_params.headroom);
+        const Milliseconds aim = target * (1.0 - 0.5 * m_params.headroom);
+
+        const bool isOverTarget = m_smoothedGpuFrameTime > target;
+        const bool isUnderBand = m_smoothedGpuFrameTime < lowerBound && cpuFrameTime <= target;
+
+        if (isOverTarget || isUnderBand)
+        {
+            const double scale = Quantize(m_scale * std::sqrt(aim / m_smoothedGpuFrameTime));
+
+            if (scale != m_scale)
+                ChangeScale(scale);
+        }
+
+        return m_scale;
+    }
+
+    double DynamicResolution::Scale() const noexcept
+    {
+        return m_scale;
+    }
+
+    DynamicResolution::Milliseconds DynamicResolution::SmoothedGpuFrameTime() const noexcept
+    {
+        return m_smoothedGpuFrameTime;
+    }
+
+    DynamicResolution::Statistics DynamicResolution::Stats() const noexcept
+    {
+        return m_stats;
+    }
+
+    std::uint32_t DynamicResolution::ScaledSize(std::uint32_t size, double scale) noexcept
+    {
+        const double scaled = std::round(static_cast<double>(size) * scale);
+
+        return std::max(static_cast<std::uint32_t>(scaled), 1u);
+    }
+
+    double DynamicResolution::Quantize(double scale) const noexcept
+    {
+        // Rounded down, so a rise never overshoots the band
+        const double quantized = std::floor(scale / m_params.scaleStep) * m_params.scaleStep;
+
+        return std::clamp(quantized, m_params.minScale, m_params.maxScale);
+    }
+
+    void DynamicResolution::ChangeScale(double scale) noexcept
+    {
+        scale = std::clamp(scale, m_params.minScale, m_params.maxScale);
+
+        // The frames at the new scale are expected to take the time of the
+        // pixels they render, so the average does not have to catch up
+        if (m_hasSample)
+            m_smoothedGpuFrameTime *= (scale * scale) / (m_scale * m_scale);
+
+        m_scale = scale;
+        m_framesSinceChange = 0;
+
+        ++m_stats.changes;
+    }
+}
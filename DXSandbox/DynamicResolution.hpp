@@ -0,0 +1,86 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace DXSandbox
+{
+    // Chooses the scale of the render resolution that holds a target frame
+    // time. GPU time follows the rendered pixels, the square of the scale,
+    // so the scale is moved by the square root of the ratio between the
+    // target and the smoothed GPU time. It only moves when that time leaves
+    // a band below the target, and after a change waits for the frames
+    // rendered at the old scale to drain. A single frame far over the target
+    // drops the scale at once. The controller only does arithmetic on the
+    // times it is given, so a recorded trace of frame times always produces
+    // the same scales.
+    class DynamicResolution final
+    {
+    public:
+        using Milliseconds = std::chrono::duration<double, std::milli>;
+
+        struct Params final
+        {
+            Milliseconds targetFrameTime{1000.0 / 60.0};
+
+            double minScale = 0.5;
+            double maxScale = 1.0;
+
+            // Weight of the newest frame in the smoothed GPU time
+            double smoothing = 0.1;
+
+            // The scale rises once the smoothed time is below the target by
+            // this fraction, and drops once it is above the target. Changes
+            // aim for the middle of the band.
+            double headroom = 0.1;
+
+            // A frame over the target by this factor drops the scale at once
+            double panicFactor = 1.5;
+
+            // Frames after a change before the next one, as the times of
+            // frames in flight still reflect the old scale
+            std::uint32_t settleFrames = 4;
+
+            // Scales are multiples of the step, so the render size does not
+            // churn over small variations
+            double scaleStep = 1.0 / 64.0;
+        };
+
+        struct Statistics final
+        {
+            std::uint32_t changes = 0;
+            std::uint32_t panicDrops = 0;
+        };
+
+        explicit DynamicResolution(const Params& params);
+
+        // Takes the times of the last completed frame and returns the scale
+        // of the next one. A CPU missing the target sets the frame rate by
+        // itself, so the scale does not rise then; drops follow the GPU.
+        double Update(Milliseconds cpuFrameTime, Milliseconds gpuFrameTime);
+
+        double Scale() const noexcept;
+        Milliseconds SmoothedGpuFrameTime() const noexcept;
+
+        Statistics Stats() const noexcept;
+
+        // A size of the output scaled for rendering, at least one pixel
+        static std::uint32_t ScaledSize(std::uint32_t size, double scale) noexcept;
+
+    private:
+        double Quantize(double scale) const noexcept;
+        void ChangeScale(double scale) noexcept;
+
+    private:
+        Params m_params;
+
+        double m_scale = 1.0;
+
+        Milliseconds m_smoothedGpuFrameTime{};
+        bool m_hasSample = false;
+
+        std::uint32_t m_framesSinceChange = 0;
+
+        Statistics m_stats;
+    };
+}
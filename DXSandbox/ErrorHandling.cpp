@@ -0,0 +1,14 @@
+#include "ErrorHandling.hpp"
+
+namespace DXSandbox
+{
+    void ThrowLastError()
+    {
+        throw HResultException::FromLastError();
+    }
+
+    void ThrowHResultError(HRESULT hResult)
+    {
+        throw HResultException::FromHResult(hResult);
+    }
+}
@@ -4,19 +4,14 @@
 
 namespace DXSandbox
 {
-    [[noreturn]] inline void ThrowLastError()
-    {
-        throw HResultException::FromLastError();
-    }
-
-    [[noreturn]] inline void ThrowHResultError(HRESULT hResult)
-    {
-        throw HResultException::FromHResult(hResult);
-    }
+    // Outlined, so the exception is constructed and thrown in one place
+    // rather than in every caller of the checks below
+    [[noreturn]] __declspec(noinline) void ThrowLastError();
+    [[noreturn]] __declspec(noinline) void ThrowHResultError(HRESULT hResult);
 
     inline void ThrowIfFailed(HRESULT hResult)
     {
-        if (FAILED(hResult))
+        if (FAILED(hResult)) [[unlikely]]
             ThrowHResultError(hResult);
     }
 }
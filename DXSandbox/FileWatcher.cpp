@@ -0,0 +1,275 @@
+#include "FileWatcher.hpp"
+
+#ifdef _WIN32
+#   include "WindowsPlatform.hpp"
+#   include "ErrorHandling.hpp"
+#else
+#   include <sys/inotify.h>
+#   include <unistd.h>
+#   include <array>
+#   include <cerrno>
+#   include <cstdint>
+#   include <system_error>
+#   include <unordered_map>
+#endif
+
+#include <algorithm>
+
+namespace DXSandbox
+{
+#ifdef _WIN32
+    struct FileWatcher::PlatformState final
+    {
+        static constexpr DWORD NotifyFilter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE;
+        static constexpr std::size_t BufferSize = 64 * 1024;
+
+        HANDLE directory = INVALID_HANDLE_VALUE;
+        HANDLE event = nullptr;
+        OVERLAPPED overlapped = {};
+
+        // FILE_NOTIFY_INFORMATION records are DWORD aligned
+        std::vector<DWORD> buffer = std::vector<DWORD>(BufferSize / sizeof(DWORD));
+
+        bool isReading = false;
+
+        ~PlatformState()
+        {
+            if (isReading)
+            {
+                DWORD bytes = 0;
+
+                CancelIoEx(directory, &overlapped);
+                GetOverlappedResult(directory, &overlapped, &bytes, TRUE);
+            }
+
+            if (event)
+                CloseHandle(event);
+
+            if (directory != INVALID_HANDLE_VALUE)
+                CloseHandle(directory);
+        }
+
+        void Open(const std::filesystem::path& path)
+        {
+            directory = CreateFileW(path.c_str(), FILE_LIST_DIRECTORY,
+                                    FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                                    OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED,
+                                    nullptr);
+
+            if (directory == INVALID_HANDLE_VALUE)
+                ThrowLastError();
+
+            event = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+
+            if (!event)
+                ThrowLastError();
+
+            Read();
+        }
+
+        void Read()
+        {
+            overlapped = {};
+            overlapped.hEvent = event;
+
+            if (!ReadDirectoryChangesW(directory, buffer.data(), static_cast<DWORD>(BufferSize), TRUE,
+                                       NotifyFilter, nullptr, &overlapped, nullptr))
+                ThrowLastError();
+
+            isReading = true;
+        }
+
+        void Collect(const std::filesystem::path& root, std::vector<std::filesystem::path>& changed)
+        {
+            for (;;)
+            {
+                DWORD bytes = 0;
+
+                if (!GetOverlappedResult(directory, &overlapped, &bytes, FALSE))
+                {
+                    if (GetLastError() == ERROR_IO_INCOMPLETE)
+                        return;
+
+                    ThrowLastError();
+                }
+
+                isReading = false;
+
+                // Zero bytes means the buffer overflowed and the changes are lost
+                for (auto record = reinterpret_cast<const std::byte*>(buffer.data()); bytes > 0;)
+                {
+                    const auto& info = *reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(record);
+
+                    if (info.Action != FILE_ACTION_REMOVED && info.Action != FILE_ACTION_RENAMED_OLD_NAME)
+                    {
+                        const std::wstring_view name{info.FileName, info.FileNameLength / sizeof(wchar_t)};
+
+                        changed.push_back(root / name);
+                    }
+
+                    if (info.NextEntryOffset == 0)
+                        break;
+
+                    record += info.NextEntryOffset;
+                }
+
+                Read();
+            }
+        }
+    };
+#else
+    struct FileWatcher::PlatformState final
+    {
+        static constexpr std::uint32_t WatchMask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_ONLYDIR;
+
+        int descriptor = -1;
+        std::unordered_map<int, std::filesystem::path> watches;
+
+        ~PlatformState()
+        {
+            if (descriptor >= 0)
+                close(descriptor);
+        }
+
+        [[noreturn]] static void ThrowErrno()
+        {
+            throw std::system_error{errno, std::generic_category(), "inotify"};
+        }
+
+        void Open(const std::filesystem::path& path)
+        {
+            descriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+            if (descriptor < 0)
+                ThrowErrno();
+
+            WatchTree(path);
+        }
+
+        // inotify is not recursive, so every directory gets its own watch.
+        // Directories may vanish while being scanned, which is not an error.
+        void WatchTree(const std::filesystem::path& path, std::vector<std::filesystem::path>* files = nullptr)
+        {
+            Watch(path);
+
+            const auto options = std::filesystem::directory_options::skip_permission_denied;
+
+            std::error_code error;
+
+            for (std::filesystem::recursive_directory_iterator it{path, options, error}, end;
+                 !error && it != end; it.increment(error))
+            {
+                if (it->is_directory(error))
+                    Watch(it->path());
+                else if (files)
+                    files->push_back(it->path());
+            }
+        }
+
+        void Watch(const std::filesystem::path& path)
+        {
+            const int watch = inotify_add_watch(descriptor, path.c_str(), WatchMask);
+
+            if (watch < 0)
+            {
+                if (errno == ENOENT || errno == ENOTDIR)
+                    return;
+
+                ThrowErrno();
+            }
+
+            watches[watch] = path;
+        }
+
+        void Collect(const std::filesystem::path& /*root*/, std::vector<std::filesystem::path>& changed)
+        {
+            alignas(inotify_event) std::array<char, 16 * 1024> buffer;
+
+            for (;;)
+            {
+                const ssize_t length = read(descriptor, buffer.data(), buffer.size());
+
+                if (length < 0)
+                {
+                    if (errno == EAGAIN)
+                        return;
+                    if (errno == EINTR)
+                        continue;
+
+                    ThrowErrno();
+                }
+
+                for (const char* record = buffer.data(); record < buffer.data() + length;)
+                {
+                    const auto& event = *reinterpret_cast<const inotify_event*>(record);
+
+                    record += sizeof(inotify_event) + event.len;
+
+                    if (event.mask & IN_IGNORED)
+                    {
+                        watches.erase(event.wd);
+                        continue;
+                    }
+
+                    const auto watch = watches.find(event.wd);
+
+                    if (watch == watches.end() || event.len == 0)
+                        continue;
+
+                    std::filesystem::path path = watch->second / event.name;
+
+                    if (event.mask & IN_ISDIR)
+                    {
+                        // Files written into the new directory before its
+                        // watch existed are reported by the tree scan
+                        if (event.mask & (IN_CREATE | IN_MOVED_TO))
+                            WatchTree(path, &changed);
+                    }
+                    else if (event.mask & (IN_CLOSE_WRITE | IN_MOVED_TO))
+                    {
+                        changed.push_back(std::move(path));
+                    }
+                }
+            }
+        }
+    };
+#endif
+
+    FileWatcher::FileWatcher(const std::filesystem::path& directory)
+        : m_directory{std::filesystem::absolute(directory).lexically_normal()}
+        , m_state{std::make_unique<PlatformState>()}
+    {
+        m_state->Open(m_directory);
+    }
+
+    FileWatcher::~FileWatcher() = default;
+
+    const std::filesystem::path& FileWatcher::Directory() const noexcept
+    {
+        return m_directory;
+    }
+
+    std::vector<std::filesystem::path> FileWatcher::Poll()
+    {
+        std::vector<std::filesystem::path> changed;
+
+        m_state->Collect(m_directory, changed);
+
+        for (auto& path : changed)
+            path = path.lexically_normal();
+
+        std::ranges::sort(changed);
+        changed.erase(std::ranges::unique(changed).begin(), changed.end());
+
+        // Directories are reported when their contents change, and files may
+        // be gone again by the time they are polled
+        std::erase_if(changed, [](const std::filesystem::path& path)
+        {
+            std::error_code error;
+
+            return !std::filesystem::is_regular_file(path, error);
+        });
+
+        return changed;
+    }
+}
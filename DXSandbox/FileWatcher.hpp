@@ -0,0 +1,34 @@
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+namespace DXSandbox
+{
+    // Watches a directory tree for written, created and renamed files. The
+    // OS queues the notifications in the background (ReadDirectoryChangesW
+    // on Windows, inotify elsewhere) and Poll collects them without waiting.
+    class FileWatcher final
+    {
+    public:
+        explicit FileWatcher(const std::filesystem::path& directory);
+        ~FileWatcher();
+
+        FileWatcher(const FileWatcher&) = delete;
+        FileWatcher& operator = (const FileWatcher&) = delete;
+
+        // Absolute and normalized
+        const std::filesystem::path& Directory() const noexcept;
+
+        // Files changed since the previous call, each one listed once, as
+        // absolute normalized paths
+        std::vector<std::filesystem::path> Poll();
+
+    private:
+        struct PlatformState;
+
+        std::filesystem::path m_directory;
+        std::unique_ptr<PlatformState> m_state;
+    };
+}
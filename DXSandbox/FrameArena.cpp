@@ -0,0 +1,132 @@
+#include "FrameArena.hpp"
+
+#include "Instrumentation.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <new>
+
+namespace
+{
+    using DXSandbox::Instrumentation::Counter;
+
+    Counter g_arenaBytes{"FrameMemory.ArenaBytes"};
+    Counter g_arenaPeakBytes{"FrameMemory.ArenaPeakBytes"};
+    Counter g_arenaAllocations{"FrameMemory.ArenaAllocations"};
+    Counter g_arenaOverflowBytes{"FrameMemory.ArenaOverflowBytes"};
+    Counter g_arenaOverflows{"FrameMemory.ArenaOverflows"};
+
+    inline std::size_t AlignUp(std::size_t value, std::size_t alignment) noexcept
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+}
+
+namespace DXSandbox
+{
+    FrameArena::FrameArena(std::size_t capacity, std::pmr::memory_resource* upstream)
+        : m_upstream{upstream}
+        , m_capacity{AlignUp(capacity, BufferAlignment)}
+    {
+        assert(m_upstream);
+
+        if (m_capacity > 0)
+            m_buffer = static_cast<std::byte*>(m_upstream->allocate(m_capacity, BufferAlignment));
+
+        m_stats.capacity = m_capacity;
+    }
+
+    FrameArena::~FrameArena()
+    {
+        ReleaseOverflow();
+
+        if (m_buffer)
+            m_upstream->deallocate(m_buffer, m_capacity, BufferAlignment);
+    }
+
+    void FrameArena::Reset() noexcept
+    {
+        g_arenaBytes.Set(static_cast<std::int64_t>(m_stats.usedBytes));
+        g_arenaAllocations.Set(static_cast<std::int64_t>(m_stats.allocationCount));
+        g_arenaOverflowBytes.Set(static_cast<std::int64_t>(m_stats.overflowBytes));
+        g_arenaOverflows.Set(static_cast<std::int64_t>(m_stats.overflowCount));
+        g_arenaPeakBytes.Set(std::max(g_arenaPeakBytes.Value(), static_cast<std::int64_t>(m_stats.peakBytes)));
+
+        ReleaseOverflow();
+
+        m_offset = 0;
+
+        m_stats.usedBytes = 0;
+        m_stats.allocationCount = 0;
+        m_stats.overflowBytes = 0;
+        m_stats.overflowCount = 0;
+    }
+
+    FrameArena::Statistics FrameArena::Stats() const noexcept
+    {
+        return m_stats;
+    }
+
+    void* FrameArena::do_allocate(std::size_t bytes, std::size_t alignment)
+    {
+        const std::size_t offset = AlignUp(m_offset, alignment);
+
+        void* pointer = nullptr;
+
+        // The buffer is aligned to BufferAlignment, so offsets only cover
+        // alignments up to that; stricter requests go upstream
+        if (alignment <= BufferAlignment && offset <= m_capacity && bytes <= m_capacity - offset)
+        {
+            pointer = m_buffer + offset;
+            m_offset = offset + bytes;
+        }
+        else
+        {
+            pointer = AllocateOverflow(bytes, alignment);
+        }
+
+        m_stats.usedBytes += bytes;
+        m_stats.peakBytes = std::max(m_stats.peakBytes, m_stats.usedBytes);
+        ++m_stats.allocationCount;
+
+        return pointer;
+    }
+
+    void FrameArena::do_deallocate(void*, std::size_t, std::size_t) noexcept
+    {
+        // Memory is reclaimed in bulk by Reset
+    }
+
+    bool FrameArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+    {
+        return this == &other;
+    }
+
+    void* FrameArena::AllocateOverflow(std::size_t bytes, std::size_t alignment)
+    {
+        const std::size_t chunkAlignment = std::max(alignment, alignof(OverflowChunk));
+        const std::size_t headerSize = AlignUp(sizeof(OverflowChunk), chunkAlignment);
+        const std::size_t chunkSize = headerSize + bytes;
+
+        auto memory = static_cast<std::byte*>(m_upstream->allocate(chunkSize, chunkAlignment));
+
+        m_overflowChunks = new (memory) OverflowChunk{m_overflowChunks, chunkSize, chunkAlignment};
+
+        m_stats.overflowBytes += bytes;
+        ++m_stats.overflowCount;
+
+        return memory + headerSize;
+    }
+
+    void FrameArena::ReleaseOverflow() noexcept
+    {
+        while (m_overflowChunks)
+        {
+            OverflowChunk* chunk = m_overflowChunks;
+            m_overflowChunks = chunk->next;
+
+            m_upstream->deallocate(chunk, chunk->size, chunk->alignment);
+        }
+    }
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+namespace DXSandbox
+{
+    // Linear allocator for data that lives for one frame. Allocation bumps an
+    // offset into a buffer reserved up front and deallocation is a no-op; the
+    // whole arena is reclaimed by Reset once the GPU has retired the frame.
+    // Requests that do not fit are served by the upstream resource and
+    // reported as overflow, which means the capacity should be raised.
+    class FrameArena final : public std::pmr::memory_resource
+    {
+    public:
+        struct Statistics final
+        {
+            std::size_t capacity = 0;
+            std::size_t usedBytes = 0;
+            std::size_t peakBytes = 0;
+            std::size_t allocationCount = 0;
+            std::size_t overflowBytes = 0;
+            std::size_t overflowCount = 0;
+        };
+
+        explicit FrameArena(std::size_t capacity,
+                            std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+        ~FrameArena() override;
+
+        FrameArena(const FrameArena&) = delete;
+        FrameArena& operator = (const FrameArena&) = delete;
+
+        // Invalidates everything allocated since the previous reset
+        void Reset() noexcept;
+
+        Statistics Stats() const noexcept;
+
+    private:
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+        void do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment) noexcept override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+        void* AllocateOverflow(std::size_t bytes, std::size_t alignment);
+        void ReleaseOverflow() noexcept;
+
+    private:
+        struct OverflowChunk final
+        {
+            OverflowChunk* next = nullptr;
+            std::size_t size = 0;
+            std::size_t alignment = 0;
+        };
+
+        static constexpr std::size_t BufferAlignment = 64;
+
+        std::pmr::memory_resource* m_upstream = nullptr;
+
+        std::byte* m_buffer = nullptr;
+        std::size_t m_capacity = 0;
+        std::size_t m_offset = 0;
+
+        OverflowChunk* m_overflowChunks = nullptr;
+
+        Statistics m_stats;
+    };
+
+    // Frame scoped containers
+    template <typename T>
+    using FrameVector = std::pmr::vector<T>;
+}
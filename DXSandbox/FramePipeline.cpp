@@ -0,0 +1,162 @@
+#include "FramePipeline.hpp"
+
+#include "Instrumentation.hpp"
+
+#include <cassert>
+
+namespace
+{
+    using DXSandbox::Instrumentation::Counter;
+
+    Counter g_frames{"FramePipeline.Frames"};
+    Counter g_averageLatency{"FramePipeline.AverageLatencyMicroseconds"};
+    Counter g_averageFrameTime{"FramePipeline.AverageFrameMicroseconds"};
+
+    inline std::int64_t ToMicroseconds(DXSandbox::FrameSnapshot::Clock::duration duration) noexcept
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+    }
+}
+
+namespace DXSandbox
+{
+    FramePipeline::FramePipeline(UpdateFunction update, bool isPipelined)
+        : m_update{std::move(update)}
+    {
+        assert(m_update);
+
+        if (isPipelined)
+            m_updateThread = std::jthread{[this] { UpdateLoop(); }};
+    }
+
+    FramePipeline::~FramePipeline()
+    {
+        // Releases the update thread if it waits for a snapshot to be taken;
+        // the thread is joined before any other member is destroyed
+        m_acquiredFrame.store(Stopped, std::memory_order_release);
+        m_acquiredFrame.notify_all();
+    }
+
+    const FrameSnapshot& FramePipeline::AcquireSnapshot()
+    {
+        const std::uint64_t nextFrame = m_acquiredFrame.load(std::memory_order_relaxed) + 1;
+
+        if (!IsPipelined())
+            Produce(nextFrame);
+
+        std::uint64_t publishedFrame = m_publishedFrame.load(std::memory_order_acquire);
+
+        while (publishedFrame < nextFrame)
+        {
+            m_publishedFrame.wait(publishedFrame, std::memory_order_acquire);
+            publishedFrame = m_publishedFrame.load(std::memory_order_acquire);
+        }
+
+        if (publishedFrame == Stopped)
+            std::rethrow_exception(m_updateError);
+
+        [[maybe_unused]]
+        const bool isAcquired = m_snapshots.Acquire();
+
+        assert(isAcquired);
+
+        const FrameSnapshot& snapshot = m_snapshots.ReadBuffer();
+
+        assert(snapshot.frameIndex == nextFrame);
+
+        m_acquiredFrame.store(snapshot.frameIndex, std::memory_order_release);
+        m_acquiredFrame.notify_one();
+
+        return snapshot;
+    }
+
+    void FramePipeline::OnFrameRendered(const FrameSnapshot& snapshot) noexcept
+    {
+        const auto now = FrameSnapshot::Clock::now();
+
+        if (m_renderedFrames == 0)
+            m_firstFrameEnd = now;
+
+        m_lastFrameEnd = now;
+
+        ++m_renderedFrames;
+        m_totalLatency += now - snapshot.updateStart;
+
+        const Statistics stats = Stats();
+
+        g_frames.Set(static_cast<std::int64_t>(stats.frames));
+        g_averageLatency.Set(ToMicroseconds(stats.averageLatency));
+
+        if (stats.frames > 1)
+            g_averageFrameTime.Set(ToMicroseconds(stats.averageFrameTime));
+    }
+
+    bool FramePipeline::IsPipelined() const noexcept
+    {
+        return m_updateThread.joinable();
+    }
+
+    FramePipeline::Statistics FramePipeline::Stats() const noexcept
+    {
+        Statistics stats = {.frames = m_renderedFrames};
+
+        const auto frames = static_cast<FrameSnapshot::Clock::rep>(m_renderedFrames);
+
+        if (frames > 0)
+            stats.averageLatency = m_totalLatency / frames;
+
+        if (frames > 1)
+            stats.averageFrameTime = (m_lastFrameEnd - m_firstFrameEnd) / (frames - 1);
+
+        return stats;
+    }
+
+    void FramePipeline::Produce(std::uint64_t frameIndex)
+    {
+        FrameSnapshot& snapshot = m_snapshots.WriteBuffer();
+
+        snapshot.frameIndex = frameIndex;
+        snapshot.updateStart = FrameSnapshot::Clock::now();
+
+        m_update(snapshot);
+
+        // Pacing guarantees the previous snapshot has been taken
+        [[maybe_unused]]
+        const bool isConsumed = m_snapshots.Publish();
+
+        assert(isConsumed);
+
+        m_publishedFrame.store(frameIndex, std::memory_order_release);
+        m_publishedFrame.notify_one();
+    }
+
+    void FramePipeline::UpdateLoop()
+    {
+        try
+        {
+            for (std::uint64_t frameIndex = 1;; ++frameIndex)
+            {
+                Produce(frameIndex);
+
+                // Stay at most one frame ahead of the render thread
+                std::uint64_t acquiredFrame = m_acquiredFrame.load(std::memory_order_acquire);
+
+                while (acquiredFrame < frameIndex)
+                {
+                    m_acquiredFrame.wait(acquiredFrame, std::memory_order_acquire);
+                    acquiredFrame = m_acquiredFrame.load(std::memory_order_acquire);
+                }
+
+                if (acquiredFrame == Stopped)
+                    return;
+            }
+        }
+        catch (...)
+        {
+            m_updateError = std::current_exception();
+
+            m_publishedFrame.store(Stopped, std::memory_order_release);
+            m_publishedFrame.notify_all();
+        }
+    }
+}
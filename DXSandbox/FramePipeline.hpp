@@ -0,0 +1,93 @@
+#pragma once
+
+#include "Math.hpp"
+#include "TripleBuffer.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace DXSandbox
+{
+    // Immutable result of one simulation update, read by the render thread
+    struct FrameSnapshot final
+    {
+        using Clock = std::chrono::steady_clock;
+
+        std::uint64_t frameIndex = 0;
+        Clock::time_point updateStart;
+
+        // Filled by updates whose render side draws the scene
+        std::vector<Math::Float4x4> worldTransforms;
+    };
+
+    // Two-stage frame pipeline. An update thread produces snapshots into a
+    // triple buffer while the render thread consumes the newest one, so the
+    // update of frame N + 1 overlaps with rendering frame N. The update
+    // thread runs at most one frame ahead, which bounds the added latency.
+    // Without pipelining the update runs inline when a snapshot is taken,
+    // which is the sequential loop the pipeline is measured against.
+    class FramePipeline final
+    {
+    public:
+        // Since the first rendered frame
+        struct Statistics final
+        {
+            std::uint64_t frames = 0;
+
+            // From the start of the update to the end of the rendering
+            FrameSnapshot::Clock::duration averageLatency = {};
+            FrameSnapshot::Clock::duration averageFrameTime = {};
+        };
+
+        // Fills the snapshot; snapshot buffers are reused, so vectors keep
+        // their capacity
+        using UpdateFunction = std::function<void(FrameSnapshot& snapshot)>;
+
+        explicit FramePipeline(UpdateFunction update, bool isPipelined = true);
+        ~FramePipeline();
+
+        FramePipeline(const FramePipeline&) = delete;
+        FramePipeline& operator = (const FramePipeline&) = delete;
+
+        // Render thread; waits for the next snapshot and rethrows errors of
+        // the update thread. Valid until the next call.
+        const FrameSnapshot& AcquireSnapshot();
+
+        // Render thread; records latency and frame time counters
+        void OnFrameRendered(const FrameSnapshot& snapshot) noexcept;
+
+        bool IsPipelined() const noexcept;
+
+        Statistics Stats() const noexcept;
+
+    private:
+        void Produce(std::uint64_t frameIndex);
+        void UpdateLoop();
+
+    private:
+        static constexpr std::uint64_t Stopped = ~std::uint64_t{0};
+
+        UpdateFunction m_update;
+
+        TripleBuffer<FrameSnapshot> m_snapshots;
+
+        // The update thread waits for the render thread to take each
+        // snapshot and the render thread waits for each one to be published
+        std::atomic<std::uint64_t> m_publishedFrame = 0;
+        std::atomic<std::uint64_t> m_acquiredFrame = 0;
+
+        std::exception_ptr m_updateError;
+
+        FrameSnapshot::Clock::time_point m_firstFrameEnd;
+        FrameSnapshot::Clock::time_point m_lastFrameEnd;
+        std::uint64_t m_renderedFrames = 0;
+        FrameSnapshot::Clock::duration m_totalLatency = {};
+
+        std::jthread m_updateThread;
+    };
+}
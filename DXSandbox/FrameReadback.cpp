@@ -0,0 +1,162 @@
+#include "FrameReadback.hpp"
+
+#include "ErrorHandling.hpp"
+#include "Instrumentation.hpp"
+
+#include <cassert>
+
+namespace
+{
+    using DXSandbox::Instrumentation::Counter;
+
+    Counter g_copies{"Readback.Copies"};
+    Counter g_bufferBytes{"Readback.BufferBytes"};
+}
+
+namespace DXSandbox
+{
+    FrameReadback::FrameReadback(ComPtr<ID3D12Device> device, std::size_t slotCount, std::size_t workerCount)
+        : m_device{std::move(device)}
+        , m_workers{workerCount}
+    {
+        assert(m_device && slotCount > 0);
+
+        m_slots.reserve(slotCount);
+
+        for (std::size_t i = 0; i < slotCount; ++i)
+            m_slots.push_back(std::make_unique<Slot>());
+    }
+
+    FrameReadback::~FrameReadback() = default;
+
+    bool FrameReadback::HasFreeSlot() const noexcept
+    {
+        return FindFreeSlot() != nullptr;
+    }
+
+    void FrameReadback::RecordCopy(ID3D12GraphicsCommandList* commandList, ID3D12Resource* source,
+                                   UINT64 fenceValue, ReadbackHandler handler)
+    {
+        assert(commandList && source && handler);
+
+        Slot* slot = FindFreeSlot();
+
+        assert(slot);
+
+        const D3D12_RESOURCE_DESC sourceDesc = source->GetDesc();
+
+        assert(sourceDesc.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE2D);
+        assert(sourceDesc.Format == DXGI_FORMAT_R8G8B8A8_UNORM ||
+               sourceDesc.Format == DXGI_FORMAT_R8G8B8A8_UNORM_SRGB);
+
+        D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprint = {};
+        UINT64 totalSize = 0;
+
+        m_device->GetCopyableFootprints(&sourceDesc, 0, 1, 0, &footprint, nullptr, nullptr, &totalSize);
+
+        PrepareBuffer(*slot, totalSize);
+
+        D3D12_TEXTURE_COPY_LOCATION destination = {};
+
+        destination.pResource = slot->buffer.Get();
+        destination.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+        destination.PlacedFootprint = footprint;
+
+        D3D12_TEXTURE_COPY_LOCATION sourceLocation = {};
+
+        sourceLocation.pResource = source;
+        sourceLocation.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+        sourceLocation.SubresourceIndex = 0;
+
+        commandList->CopyTextureRegion(&destination, 0, 0, 0, &sourceLocation, nullptr);
+
+        slot->fenceValue = fenceValue;
+        slot->image =
+        {
+            .frameIndex = fenceValue,
+            .width = footprint.Footprint.Width,
+            .height = footprint.Footprint.Height,
+            .rowPitch = footprint.Footprint.RowPitch,
+            .pixels = slot->mappedData + footprint.Offset
+        };
+        slot->handler = std::move(handler);
+
+        // Only the render thread looks at slots in this state
+        slot->state.store(SlotState::Copying, std::memory_order_relaxed);
+
+        g_copies.Add(1);
+    }
+
+    void FrameReadback::Collect(UINT64 completedFenceValue)
+    {
+        for (const auto& slot : m_slots)
+        {
+            if (slot->state.load(std::memory_order_relaxed) != SlotState::Copying)
+                continue;
+            if (slot->fenceValue > completedFenceValue)
+                continue;
+
+            slot->state.store(SlotState::Handling, std::memory_order_relaxed);
+
+            m_workers.Submit([slot = slot.get()]
+            {
+                slot->handler(slot->image);
+                slot->handler = nullptr;
+
+                // Publishes the cleared handler before the slot is reused
+                slot->state.store(SlotState::Free, std::memory_order_release);
+            });
+        }
+    }
+
+    FrameReadback::Slot* FrameReadback::FindFreeSlot() const noexcept
+    {
+        for (const auto& slot : m_slots)
+        {
+            if (slot->state.load(std::memory_order_acquire) == SlotState::Free)
+                return slot.get();
+        }
+
+        return nullptr;
+    }
+
+    void FrameReadback::PrepareBuffer(Slot& slot, UINT64 size)
+    {
+        if (slot.bufferSize >= size)
+            return;
+
+        static constexpr D3D12_HEAP_PROPERTIES heapProperties =
+        {
+            .Type = D3D12_HEAP_TYPE_READBACK
+        };
+
+        const D3D12_RESOURCE_DESC bufferDesc =
+        {
+            .Dimension = D3D12_RESOURCE_DIMENSION_BUFFER,
+            .Width = size,
+            .Height = 1,
+            .DepthOrArraySize = 1,
+            .MipLevels = 1,
+            .Format = DXGI_FORMAT_UNKNOWN,
+            .SampleDesc = {.Count = 1},
+            .Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR
+        };
+
+        ComPtr<ID3D12Resource> buffer;
+
+        ThrowIfFailed(m_device->CreateCommittedResource(&heapProperties, D3D12_HEAP_FLAG_NONE, &bufferDesc,
+                                                        D3D12_RESOURCE_STATE_COPY_DEST, nullptr,
+                                                        IID_PPV_ARGS(&buffer)));
+
+        // Readback heaps may stay mapped; reads happen after the fence only
+        void* mappedData = nullptr;
+
+        ThrowIfFailed(buffer->Map(0, nullptr, &mappedData));
+
+        g_bufferBytes.Add(static_cast<std::int64_t>(size) - static_cast<std::int64_t>(slot.bufferSize));
+
+        slot.buffer = std::move(buffer);
+        slot.bufferSize = size;
+        slot.mappedData = static_cast<std::byte*>(mappedData);
+    }
+}
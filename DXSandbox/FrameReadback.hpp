@@ -0,0 +1,79 @@
+#pragma once
+
+#include "WindowsPlatform.hpp"
+
+#include "ComPtr.hpp"
+#include "ReadbackImage.hpp"
+#include "ThreadPool.hpp"
+
+#include <d3d12.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace DXSandbox
+{
+    // Ring of persistently mapped READBACK buffers. A copy is recorded into
+    // a free slot, and once its fence value has completed the slot is handed
+    // to a worker thread that runs the handler straight from the mapped
+    // memory. The slot becomes free again when the handler returns, so the
+    // render thread never waits, neither for the GPU nor for the handlers;
+    // with no free slot the frame is simply not captured.
+    class FrameReadback final
+    {
+    public:
+        explicit FrameReadback(ComPtr<ID3D12Device> device,
+                               std::size_t slotCount = 3,
+                               std::size_t workerCount = 2);
+
+        // Waits for running handlers; copies not yet collected are dropped
+        ~FrameReadback();
+
+        FrameReadback(const FrameReadback&) = delete;
+        FrameReadback& operator = (const FrameReadback&) = delete;
+
+        bool HasFreeSlot() const noexcept;
+
+        // The source must be in the COPY_SOURCE state and a slot must be free
+        void RecordCopy(ID3D12GraphicsCommandList* commandList, ID3D12Resource* source,
+                        UINT64 fenceValue, ReadbackHandler handler);
+
+        // Starts the handlers of copies whose fence value has completed
+        void Collect(UINT64 completedFenceValue);
+
+    private:
+        enum class SlotState : std::uint8_t
+        {
+            Free,
+            Copying,
+            Handling
+        };
+
+        struct Slot final
+        {
+            std::atomic<SlotState> state = SlotState::Free;
+
+            ComPtr<ID3D12Resource> buffer;
+            UINT64 bufferSize = 0;
+            std::byte* mappedData = nullptr;
+
+            UINT64 fenceValue = 0;
+            ReadbackImage image;
+            ReadbackHandler handler;
+        };
+
+        Slot* FindFreeSlot() const noexcept;
+        void PrepareBuffer(Slot& slot, UINT64 size);
+
+    private:
+        ComPtr<ID3D12Device> m_device;
+
+        std::vector<std::unique_ptr<Slot>> m_slots;
+
+        // Destroyed first, so running handlers finish before the slots go
+        ThreadPool m_workers;
+    };
+}
@@ -0,0 +1,124 @@
+#include "GlyphAtlas.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <new>
+
+namespace DXSandbox
+{
+    GlyphAtlas::GlyphAtlas(std::uint32_t width, std::uint32_t height, float lineHeight, float ascent)
+        : m_packer{width, height}
+        , m_pixels(std::size_t{width} * height, 0)
+        , m_lineHeight{lineHeight}
+        , m_ascent{ascent}
+    {
+        // Sampled at its center, so filtering never reaches its border
+        static constexpr std::uint32_t SolidSize = 4;
+
+        const std::optional<AtlasPacker::Rect> solid = m_packer.Pack(SolidSize, SolidSize);
+
+        if (!solid)
+            throw std::bad_alloc{};
+
+        for (std::uint32_t y = 0; y < SolidSize; ++y)
+        {
+            std::fill_n(m_pixels.begin() + static_cast<std::ptrdiff_t>((solid->y + y) * width + solid->x),
+                        SolidSize, std::uint8_t{0xff});
+        }
+
+        m_solidU = (static_cast<float>(solid->x) + SolidSize * 0.5f) / static_cast<float>(width);
+        m_solidV = (static_cast<float>(solid->y) + SolidSize * 0.5f) / static_cast<float>(height);
+    }
+
+    bool GlyphAtlas::AddGlyph(char character, const GlyphBitmap& bitmap)
+    {
+        if (character < FirstCharacter || character > LastCharacter)
+            return false;
+
+        assert(bitmap.coverage.size() == std::size_t{bitmap.width} * bitmap.height);
+
+        Glyph glyph =
+        {
+            .u0 = 0.0f,
+            .v0 = 0.0f,
+            .u1 = 0.0f,
+            .v1 = 0.0f,
+            .left = static_cast<float>(bitmap.bearingX),
+            .top = m_ascent - static_cast<float>(bitmap.bearingY),
+            .width = static_cast<float>(bitmap.width),
+            .height = static_cast<float>(bitmap.height),
+            .advance = bitmap.advance
+        };
+
+        if (bitmap.width != 0 && bitmap.height != 0)
+        {
+            const std::optional<AtlasPacker::Rect> rect = m_packer.Pack(bitmap.width + 2 * Padding,
+                                                                        bitmap.height + 2 * Padding);
+
+            if (!rect)
+                return false;
+
+            const std::uint32_t x = rect->x + Padding;
+            const std::uint32_t y = rect->y + Padding;
+            const std::uint32_t atlasWidth = m_packer.Width();
+
+            for (std::uint32_t row = 0; row < bitmap.height; ++row)
+            {
+                const auto source = bitmap.coverage.subspan(std::size_t{row} * bitmap.width, bitmap.width);
+
+                std::ranges::copy(source, m_pixels.begin() +
+                                          static_cast<std::ptrdiff_t>((y + row) * atlasWidth + x));
+            }
+
+            const float width = static_cast<float>(atlasWidth);
+            const float height = static_cast<float>(m_packer.Height());
+
+            glyph.u0 = static_cast<float>(x) / width;
+            glyph.v0 = static_cast<float>(y) / height;
+            glyph.u1 = static_cast<float>(x + bitmap.width) / width;
+            glyph.v1 = static_cast<float>(y + bitmap.height) / height;
+        }
+
+        const auto index = static_cast<std::size_t>(character);
+
+        m_glyphs[index] = glyph;
+        m_hasGlyph.set(index);
+
+        return true;
+    }
+
+    float GlyphAtlas::SolidU() const noexcept
+    {
+        return m_solidU;
+    }
+
+    float GlyphAtlas::SolidV() const noexcept
+    {
+        return m_solidV;
+    }
+
+    float GlyphAtlas::LineHeight() const noexcept
+    {
+        return m_lineHeight;
+    }
+
+    std::uint32_t GlyphAtlas::Width() const noexcept
+    {
+        return m_packer.Width();
+    }
+
+    std::uint32_t GlyphAtlas::Height() const noexcept
+    {
+        return m_packer.Height();
+    }
+
+    std::span<const std::uint8_t> GlyphAtlas::Pixels() const noexcept
+    {
+        return m_pixels;
+    }
+
+    double GlyphAtlas::Occupancy() const noexcept
+    {
+        return m_packer.Occupancy();
+    }
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "AtlasPacker.hpp"
+
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace DXSandbox
+{
+    // Coverage of the printable ASCII glyphs of one font size, rasterized
+    // once by the platform and packed into a single-channel texture, plus
+    // a fully covered block for solid rectangles. Text is laid out from the
+    // cached metrics without touching the font again.
+    class GlyphAtlas final
+    {
+    public:
+        static constexpr char FirstCharacter = ' ';
+        static constexpr char LastCharacter = '~';
+
+        // A rasterized glyph: rows of 8-bit coverage, tightly packed, and
+        // the offset of its top left corner from the pen on the baseline
+        struct GlyphBitmap final
+        {
+            std::uint32_t width = 0;
+            std::uint32_t height = 0;
+            std::int32_t bearingX = 0;
+            std::int32_t bearingY = 0;     // Up from the baseline
+            float advance = 0.0f;
+
+            std::span<const std::uint8_t> coverage;
+        };
+
+        // Where a glyph is in the atlas, in texture coordinates, and where
+        // it goes relative to the top left corner of its line
+        struct Glyph final
+        {
+            float u0 = 0.0f;
+            float v0 = 0.0f;
+            float u1 = 0.0f;
+            float v1 = 0.0f;
+
+            float left = 0.0f;
+            float top = 0.0f;
+            float width = 0.0f;
+            float height = 0.0f;
+            float advance = 0.0f;
+        };
+
+        // The ascent places the baseline below the top of a line
+        GlyphAtlas(std::uint32_t width, std::uint32_t height, float lineHeight, float ascent);
+
+        // False when the character is not printable ASCII or the atlas is
+        // full. Glyphs without coverage, such as spaces, only advance.
+        bool AddGlyph(char character, const GlyphBitmap& bitmap);
+
+        // Null for characters without a glyph
+        const Glyph* Find(char character) const noexcept
+        {
+            const auto index = static_cast<std::size_t>(static_cast<unsigned char>(character));
+
+            return index < m_glyphs.size() && m_hasGlyph[index] ? &m_glyphs[index] : nullptr;
+        }
+
+        // Texture coordinates inside the fully covered block
+        float SolidU() const noexcept;
+        float SolidV() const noexcept;
+
+        float LineHeight() const noexcept;
+
+        std::uint32_t Width() const noexcept;
+        std::uint32_t Height() const noexcept;
+
+        // Rows of Width() bytes
+        std::span<const std::uint8_t> Pixels() const noexcept;
+
+        double Occupancy() const noexcept;
+
+    private:
+        static constexpr std::size_t GlyphCount = 128;
+
+        // Empty texels around each glyph keep filtering from reading its
+        // neighbours
+        static constexpr std::uint32_t Padding = 1;
+
+    private:
+        AtlasPacker m_packer;
+        std::vector<std::uint8_t> m_pixels;
+
+        float m_lineHeight = 0.0f;
+        float m_ascent = 0.0f;
+
+        float m_solidU = 0.0f;
+        float m_solidV = 0.0f;
+
+        std::array<Glyph, GlyphCount> m_glyphs = {};
+        std::bitset<GlyphCount> m_hasGlyph;
+    };
+}
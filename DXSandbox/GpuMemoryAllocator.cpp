@@ -0,0 +1,468 @@
+#include "GpuMemoryAllocator.hpp"
+
+#include "ErrorHandling.hpp"
+#include "Instrumentation.hpp"
+#include "ResidencyManager.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <new>
+
+namespace
+{
+    using DXSandbox::Instrumentation::Counter;
+
+    Counter g_heapBytes{"GpuMemory.HeapBytes"};
+    Counter g_usedBytes{"GpuMemory.UsedBytes"};
+    Counter g_allocationCount{"GpuMemory.Allocations"};
+    Counter g_defragmentationMoves{"GpuMemory.DefragmentationMoves"};
+
+    inline UINT64 AlignUp(UINT64 value, UINT64 alignment) noexcept
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    inline DXSandbox::GpuMemoryAllocator::AlignmentClass ClassifyAlignment(UINT64 alignment) noexcept
+    {
+        using enum DXSandbox::GpuMemoryAllocator::AlignmentClass;
+
+        if (alignment <= D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT)
+            return Small;
+        if (alignment <= D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT)
+            return Default;
+
+        return Msaa;
+    }
+
+    bool CanHoldMsaa(D3D12_HEAP_FLAGS heapFlags) noexcept
+    {
+        const auto deniedFlags = D3D12_HEAP_FLAG_DENY_RT_DS_TEXTURES;
+
+        return (heapFlags & deniedFlags) == 0;
+    }
+}
+
+namespace DXSandbox
+{
+    float GpuMemoryAllocator::Statistics::Fragmentation() const noexcept
+    {
+        return freeBytes ? 1.0f - static_cast<float>(largestFreeBlock) / static_cast<float>(freeBytes) : 0.0f;
+    }
+
+    GpuMemoryAllocator::GpuMemoryAllocator(ComPtr<ID3D12Device> device, D3D12_HEAP_TYPE heapType,
+                                           D3D12_HEAP_FLAGS heapFlags, ResidencyManager* residency,
+                                           UINT64 blockSize)
+        : m_device{std::move(device)}
+        , m_residency{residency}
+        , m_heapType{heapType}
+        , m_heapFlags{heapFlags}
+        , m_blockSize{AlignUp(blockSize, D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT)}
+    {
+        assert(m_device);
+
+        if (CanHoldMsaa(m_heapFlags))
+            m_heapAlignment = D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT;
+    }
+
+    GpuMemoryAllocator::~GpuMemoryAllocator()
+    {
+        // The owner must have waited for the GPU, so nothing is in flight
+        m_pendingFrees.clear();
+
+        for (const Allocation& allocation : m_allocations)
+        {
+            if (allocation.resource)
+            {
+                g_usedBytes.Add(-static_cast<std::int64_t>(allocation.size));
+                g_allocationCount.Add(-1);
+            }
+        }
+
+        for (Block& block : m_blocks)
+        {
+            if (block.allocator)
+                RemoveBlock(block);
+        }
+    }
+
+    GpuMemoryAllocator::AllocationId GpuMemoryAllocator::CreateResource(const D3D12_RESOURCE_DESC& desc,
+                                                                        D3D12_RESOURCE_STATES initialState,
+                                                                        const D3D12_CLEAR_VALUE* clearValue)
+    {
+        D3D12_RESOURCE_DESC resourceDesc = desc;
+
+        // Small textures may use 4KB placement when the layout allows it
+        const bool trySmallAlignment = resourceDesc.Dimension != D3D12_RESOURCE_DIMENSION_BUFFER &&
+                                       resourceDesc.Alignment == 0 &&
+                                       resourceDesc.SampleDesc.Count <= 1 &&
+                                       (resourceDesc.Flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET |
+                                                              D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL)) == 0;
+
+        if (trySmallAlignment)
+            resourceDesc.Alignment = D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT;
+
+        D3D12_RESOURCE_ALLOCATION_INFO info = m_device->GetResourceAllocationInfo(0, 1, &resourceDesc);
+
+        if (trySmallAlignment && info.Alignment != D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT)
+        {
+            resourceDesc.Alignment = 0;
+            info = m_device->GetResourceAllocationInfo(0, 1, &resourceDesc);
+        }
+
+        if (info.SizeInBytes == UINT64_MAX)
+            ThrowHResultError(E_INVALIDARG);
+
+        TlsfAllocator::Allocation placement;
+
+        const std::uint32_t block = AllocateInBlocks(info.SizeInBytes, info.Alignment, NoBlock, true, placement);
+
+        ComPtr<ID3D12Resource> resource;
+
+        try
+        {
+            resource = CreatePlaced(block, placement.offset, resourceDesc, initialState, clearValue);
+        }
+        catch (...)
+        {
+            m_blocks[block].allocator->Free(placement.handle);
+            throw;
+        }
+
+        const AllocationId id = NewAllocationId();
+
+        m_allocations[id] =
+        {
+            .resource = std::move(resource),
+            .desc = resourceDesc,
+            .block = block,
+            .handle = placement.handle,
+            .alignmentClass = ClassifyAlignment(info.Alignment),
+            .alignment = info.Alignment,
+            .size = placement.size,
+            // Buffers decay to COMMON between command lists, so they can be
+            // copied with implicit promotion; mapped heaps must stay put
+            .isMovable = resourceDesc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER &&
+                         initialState == D3D12_RESOURCE_STATE_COMMON &&
+                         m_heapType == D3D12_HEAP_TYPE_DEFAULT
+        };
+
+        g_usedBytes.Add(static_cast<std::int64_t>(placement.size));
+        g_allocationCount.Add(1);
+
+        return id;
+    }
+
+    ID3D12Resource* GpuMemoryAllocator::Resource(AllocationId id) const noexcept
+    {
+        assert(id < m_allocations.size() && m_allocations[id].resource);
+
+        return m_allocations[id].resource.Get();
+    }
+
+    void GpuMemoryAllocator::MarkUsed(AllocationId id, UINT64 fenceValue)
+    {
+        assert(id < m_allocations.size() && m_allocations[id].resource);
+
+        Allocation& allocation = m_allocations[id];
+
+        allocation.lastUsedFenceValue = std::max(allocation.lastUsedFenceValue, fenceValue);
+
+        MarkBlockUsed(allocation.block, fenceValue);
+    }
+
+    UINT64 GpuMemoryAllocator::LastUsed(AllocationId id) const noexcept
+    {
+        assert(id < m_allocations.size() && m_allocations[id].resource);
+
+        return m_allocations[id].lastUsedFenceValue;
+    }
+
+    void GpuMemoryAllocator::Release(AllocationId id, UINT64 fenceValue)
+    {
+        assert(id < m_allocations.size() && m_allocations[id].resource);
+
+        Allocation& allocation = m_allocations[id];
+
+        m_pendingFrees.push_back(
+        {
+            .resource = std::move(allocation.resource),
+            .block = allocation.block,
+            .handle = allocation.handle,
+            .fenceValue = fenceValue
+        });
+
+        g_usedBytes.Add(-static_cast<std::int64_t>(allocation.size));
+        g_allocationCount.Add(-1);
+
+        allocation = {};
+
+        m_freeAllocationIds.push_back(id);
+    }
+
+    void GpuMemoryAllocator::ReleaseCompleted(UINT64 completedFenceValue)
+    {
+        auto isCompleted = [completedFenceValue](const PendingFree& pending)
+        {
+            return pending.fenceValue <= completedFenceValue;
+        };
+
+        for (PendingFree& pending : m_pendingFrees)
+        {
+            if (isCompleted(pending))
+            {
+                pending.resource = nullptr;
+                m_blocks[pending.block].allocator->Free(pending.handle);
+            }
+        }
+
+        std::erase_if(m_pendingFrees, isCompleted);
+
+        // Keep one empty block around to avoid recreating heaps every frame
+        bool keptEmptyBlock = false;
+
+        for (std::uint32_t i = 0; i < m_blocks.size(); ++i)
+        {
+            Block& block = m_blocks[i];
+
+            if (!block.allocator || !block.allocator->IsEmpty())
+                continue;
+
+            const bool isPending = std::any_of(m_pendingFrees.begin(), m_pendingFrees.end(),
+                                               [i](const PendingFree& pending) { return pending.block == i; });
+
+            if (isPending)
+                continue;
+
+            if (!keptEmptyBlock && block.allocator->Capacity() == m_blockSize)
+            {
+                keptEmptyBlock = true;
+                continue;
+            }
+
+            RemoveBlock(block);
+        }
+    }
+
+    std::size_t GpuMemoryAllocator::Defragment(ID3D12GraphicsCommandList* commandList, UINT64 fenceValue,
+                                               std::size_t maxMoves)
+    {
+        assert(commandList);
+
+        std::uint32_t source = NoBlock;
+        float sourceUsage = 1.0f;
+        std::uint32_t usedBlockCount = 0;
+
+        for (std::uint32_t i = 0; i < m_blocks.size(); ++i)
+        {
+            const auto& allocator = m_blocks[i].allocator;
+
+            if (!allocator || allocator->IsEmpty())
+                continue;
+
+            ++usedBlockCount;
+
+            const TlsfAllocator::Statistics stats = allocator->Stats();
+            const float usage = static_cast<float>(stats.usedBytes) / static_cast<float>(stats.capacity);
+
+            if (usage <= sourceUsage)
+            {
+                source = i;
+                sourceUsage = usage;
+            }
+        }
+
+        if (usedBlockCount < 2)
+            return 0;
+
+        std::size_t moveCount = 0;
+
+        for (Allocation& allocation : m_allocations)
+        {
+            if (moveCount == maxMoves)
+                break;
+
+            if (!allocation.resource || !allocation.isMovable || allocation.block != source)
+                continue;
+
+            TlsfAllocator::Allocation placement;
+
+            const std::uint32_t target = AllocateInBlocks(allocation.size, allocation.alignment,
+                                                          source, false, placement);
+
+            if (target == NoBlock)
+                break;
+
+            ComPtr<ID3D12Resource> resource;
+
+            try
+            {
+                resource = CreatePlaced(target, placement.offset, allocation.desc,
+                                        D3D12_RESOURCE_STATE_COMMON, nullptr);
+            }
+            catch (...)
+            {
+                m_blocks[target].allocator->Free(placement.handle);
+                throw;
+            }
+
+            commandList->CopyResource(resource.Get(), allocation.resource.Get());
+
+            // The copy reads the source block, which must stay resident too
+            MarkBlockUsed(allocation.block, fenceValue);
+            MarkBlockUsed(target, fenceValue);
+
+            allocation.lastUsedFenceValue = std::max(allocation.lastUsedFenceValue, fenceValue);
+
+            m_pendingFrees.push_back(
+            {
+                .resource = std::move(allocation.resource),
+                .block = allocation.block,
+                .handle = allocation.handle,
+                .fenceValue = fenceValue
+            });
+
+            allocation.resource = std::move(resource);
+            allocation.block = target;
+            allocation.handle = placement.handle;
+
+            ++moveCount;
+        }
+
+        g_defragmentationMoves.Add(static_cast<std::int64_t>(moveCount));
+
+        return moveCount;
+    }
+
+    GpuMemoryAllocator::Statistics GpuMemoryAllocator::Stats() const
+    {
+        Statistics stats;
+
+        for (const Block& block : m_blocks)
+        {
+            if (!block.allocator)
+                continue;
+
+            const TlsfAllocator::Statistics blockStats = block.allocator->Stats();
+
+            ++stats.blockCount;
+            stats.allocationCount += blockStats.allocationCount;
+            stats.capacity += blockStats.capacity;
+            stats.usedBytes += blockStats.usedBytes;
+            stats.freeBytes += blockStats.FreeBytes();
+            stats.largestFreeBlock = std::max(stats.largestFreeBlock, blockStats.largestFreeBlock);
+        }
+
+        for (const Allocation& allocation : m_allocations)
+        {
+            if (allocation.resource)
+                ++stats.alignmentClassCounts[static_cast<std::size_t>(allocation.alignmentClass)];
+        }
+
+        return stats;
+    }
+
+    std::uint32_t GpuMemoryAllocator::AllocateInBlocks(UINT64 size, UINT64 alignment, std::uint32_t excludedBlock,
+                                                       bool allowNewBlock, TlsfAllocator::Allocation& allocation)
+    {
+        for (std::uint32_t i = 0; i < m_blocks.size(); ++i)
+        {
+            if (i == excludedBlock || !m_blocks[i].allocator)
+                continue;
+
+            allocation = m_blocks[i].allocator->Allocate(size, alignment);
+
+            if (allocation.IsValid())
+                return i;
+        }
+
+        if (!allowNewBlock)
+            return NoBlock;
+
+        const std::uint32_t block = AddBlock(size);
+
+        allocation = m_blocks[block].allocator->Allocate(size, alignment);
+
+        if (!allocation.IsValid())
+            throw std::bad_alloc{};
+
+        return block;
+    }
+
+    std::uint32_t GpuMemoryAllocator::AddBlock(UINT64 minSize)
+    {
+        // Oversized resources get a dedicated block
+        const UINT64 size = std::max(m_blockSize, AlignUp(minSize, m_heapAlignment));
+
+        const D3D12_HEAP_DESC heapDesc =
+        {
+            .SizeInBytes = size,
+            .Properties = {.Type = m_heapType},
+            .Alignment = m_heapAlignment,
+            .Flags = m_heapFlags
+        };
+
+        ComPtr<ID3D12Heap> heap;
+
+        ThrowIfFailed(m_device->CreateHeap(&heapDesc, IID_PPV_ARGS(&heap)));
+
+        auto emptySlot = std::find_if(m_blocks.begin(), m_blocks.end(),
+                                      [](const Block& block) { return !block.allocator; });
+
+        if (emptySlot == m_blocks.end())
+            emptySlot = m_blocks.insert(m_blocks.end(), Block{});
+
+        if (m_residency)
+            emptySlot->residencyId = m_residency->Track(heap, size);
+
+        emptySlot->heap = std::move(heap);
+        emptySlot->allocator.emplace(size);
+
+        g_heapBytes.Add(static_cast<std::int64_t>(size));
+
+        return static_cast<std::uint32_t>(emptySlot - m_blocks.begin());
+    }
+
+    void GpuMemoryAllocator::RemoveBlock(Block& block)
+    {
+        g_heapBytes.Add(-static_cast<std::int64_t>(block.allocator->Capacity()));
+
+        if (m_residency)
+            m_residency->Untrack(block.residencyId);
+
+        block = {};
+    }
+
+    void GpuMemoryAllocator::MarkBlockUsed(std::uint32_t block, UINT64 fenceValue)
+    {
+        if (m_residency)
+            m_residency->MarkUsed(m_blocks[block].residencyId, fenceValue);
+    }
+
+    ComPtr<ID3D12Resource> GpuMemoryAllocator::CreatePlaced(std::uint32_t block, UINT64 offset,
+                                                            const D3D12_RESOURCE_DESC& desc,
+                                                            D3D12_RESOURCE_STATES state,
+                                                            const D3D12_CLEAR_VALUE* clearValue)
+    {
+        ComPtr<ID3D12Resource> resource;
+
+        ThrowIfFailed(m_device->CreatePlacedResource(m_blocks[block].heap.Get(), offset, &desc,
+                                                     state, clearValue, IID_PPV_ARGS(&resource)));
+
+        return resource;
+    }
+
+    GpuMemoryAllocator::AllocationId GpuMemoryAllocator::NewAllocationId()
+    {
+        if (!m_freeAllocationIds.empty())
+        {
+            const AllocationId id = m_freeAllocationIds.back();
+            m_freeAllocationIds.pop_back();
+
+            return id;
+        }
+
+        m_allocations.emplace_back();
+
+        return static_cast<AllocationId>(m_allocations.size() - 1);
+    }
+}
@@ -0,0 +1,157 @@
+#pragma once
+
+#include "WindowsPlatform.hpp"
+
+#include "ComPtr.hpp"
+#include "ResidencyPolicy.hpp"
+#include "TlsfAllocator.hpp"
+
+#include <d3d12.h>
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace DXSandbox
+{
+    class ResidencyManager;
+
+    // Places resources into large ID3D12Heap blocks carved up by a
+    // TlsfAllocator instead of creating a committed resource for each.
+    // Resources are referred to by id, so defragmentation can move them
+    // without invalidating what callers hold. Given a ResidencyManager, the
+    // blocks are tracked by it and kept resident while their resources are
+    // used.
+    class GpuMemoryAllocator final
+    {
+    public:
+        using AllocationId = std::uint32_t;
+
+        static constexpr AllocationId InvalidAllocation = ~AllocationId{0};
+
+        static constexpr UINT64 DefaultBlockSize = 64 * 1024 * 1024;
+
+        enum class AlignmentClass
+        {
+            Small,      // D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT
+            Default,    // D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT
+            Msaa,       // D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT
+            Count
+        };
+
+        struct Statistics final
+        {
+            std::uint32_t blockCount = 0;
+            std::uint32_t allocationCount = 0;
+            std::uint64_t capacity = 0;
+            std::uint64_t usedBytes = 0;
+            std::uint64_t freeBytes = 0;
+            std::uint64_t largestFreeBlock = 0;
+
+            std::array<std::uint32_t, static_cast<std::size_t>(AlignmentClass::Count)> alignmentClassCounts = {};
+
+            // 0 when the free space of every block is one contiguous range
+            float Fragmentation() const noexcept;
+        };
+
+        explicit GpuMemoryAllocator(ComPtr<ID3D12Device> device, D3D12_HEAP_TYPE heapType,
+                                    D3D12_HEAP_FLAGS heapFlags, ResidencyManager* residency = nullptr,
+                                    UINT64 blockSize = DefaultBlockSize);
+        ~GpuMemoryAllocator();
+
+        GpuMemoryAllocator(const GpuMemoryAllocator&) = delete;
+        GpuMemoryAllocator& operator = (const GpuMemoryAllocator&) = delete;
+
+        AllocationId CreateResource(const D3D12_RESOURCE_DESC& desc, D3D12_RESOURCE_STATES initialState,
+                                    const D3D12_CLEAR_VALUE* clearValue = nullptr);
+
+        ID3D12Resource* Resource(AllocationId id) const noexcept;
+
+        // The frame signaling fenceValue uses the resource, which keeps its
+        // block resident until that frame completes
+        void MarkUsed(AllocationId id, UINT64 fenceValue);
+
+        // Fence value of the last frame using the resource, 0 for none yet
+        UINT64 LastUsed(AllocationId id) const noexcept;
+
+        // The memory is reused once the queue fence reaches fenceValue
+        void Release(AllocationId id, UINT64 fenceValue);
+
+        void ReleaseCompleted(UINT64 completedFenceValue);
+
+        // Moves up to maxMoves buffers out of the least used block into the
+        // free space of the others, recording the copies into commandList.
+        // The vacated memory is reused once the fence reaches fenceValue.
+        // Moved buffers have a new resource and GPU address, so callers
+        // holding either look them up again; no frame calls this yet, as
+        // nothing in the sandbox allocates from these heaps.
+        std::size_t Defragment(ID3D12GraphicsCommandList* commandList, UINT64 fenceValue,
+                               std::size_t maxMoves);
+
+        Statistics Stats() const;
+
+    private:
+        struct Block final
+        {
+            ComPtr<ID3D12Heap> heap;
+            std::optional<TlsfAllocator> allocator;
+            ResidencyPolicy::ObjectId residencyId = ResidencyPolicy::InvalidObject;
+        };
+
+        struct Allocation final
+        {
+            ComPtr<ID3D12Resource> resource;
+            D3D12_RESOURCE_DESC desc = {};
+
+            std::uint32_t block = 0;
+            TlsfAllocator::Handle handle = TlsfAllocator::InvalidHandle;
+
+            AlignmentClass alignmentClass = AlignmentClass::Default;
+            UINT64 alignment = 0;
+            UINT64 size = 0;
+            UINT64 lastUsedFenceValue = 0;
+
+            bool isMovable = false;
+        };
+
+        struct PendingFree final
+        {
+            ComPtr<ID3D12Resource> resource;
+            std::uint32_t block = 0;
+            TlsfAllocator::Handle handle = TlsfAllocator::InvalidHandle;
+            UINT64 fenceValue = 0;
+        };
+
+        static constexpr std::uint32_t NoBlock = ~std::uint32_t{0};
+
+        std::uint32_t AllocateInBlocks(UINT64 size, UINT64 alignment, std::uint32_t excludedBlock,
+                                       bool allowNewBlock, TlsfAllocator::Allocation& allocation);
+        std::uint32_t AddBlock(UINT64 minSize);
+        void RemoveBlock(Block& block);
+        void MarkBlockUsed(std::uint32_t block, UINT64 fenceValue);
+
+        ComPtr<ID3D12Resource> CreatePlaced(std::uint32_t block, UINT64 offset,
+                                            const D3D12_RESOURCE_DESC& desc,
+                                            D3D12_RESOURCE_STATES state,
+                                            const D3D12_CLEAR_VALUE* clearValue);
+
+        AllocationId NewAllocationId();
+
+    private:
+        ComPtr<ID3D12Device> m_device;
+        ResidencyManager* m_residency = nullptr;
+
+        D3D12_HEAP_TYPE m_heapType = D3D12_HEAP_TYPE_DEFAULT;
+        D3D12_HEAP_FLAGS m_heapFlags = D3D12_HEAP_FLAG_NONE;
+        UINT64 m_blockSize = DefaultBlockSize;
+        UINT64 m_heapAlignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+
+        std::vector<Block> m_blocks;
+
+        std::vector<Allocation> m_allocations;
+        std::vector<AllocationId> m_freeAllocationIds;
+
+        std::vector<PendingFree> m_pendingFrees;
+    };
+}
@@ -0,0 +1,265 @@
+#include "GpuProfiler.hpp"
+
+#include "ErrorHandling.hpp"
+#include "Instrumentation.hpp"
+#include "TraceRecorder.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+
+namespace
+{
+    using DXSandbox::Instrumentation::Counter;
+
+    Counter g_droppedScopes{"GpuProfiler.DroppedScopes"};
+    Counter g_frameMicroseconds{"GpuProfiler.FrameMicroseconds"};
+
+    // Samples the GPU clock and the CPU clock at the same instant. The queue
+    // reports the CPU side as a performance counter value, which is moved to
+    // the trace clock through a second sample of both CPU clocks.
+    bool CalibrateGpuClock(ID3D12CommandQueue* commandQueue, DXSandbox::GpuClockCalibration& calibration)
+    {
+        UINT64 gpuFrequency = 0;
+        UINT64 gpuTimestamp = 0;
+        UINT64 cpuCounter = 0;
+
+        if (FAILED(commandQueue->GetTimestampFrequency(&gpuFrequency)) || gpuFrequency == 0)
+            return false;
+        if (FAILED(commandQueue->GetClockCalibration(&gpuTimestamp, &cpuCounter)))
+            return false;
+
+        LARGE_INTEGER counterFrequency;
+        LARGE_INTEGER counterNow;
+
+        QueryPerformanceFrequency(&counterFrequency);
+        QueryPerformanceCounter(&counterNow);
+
+        const auto cpuNow = DXSandbox::TraceRecorder::Clock::now();
+
+        const DXSandbox::GpuClockCalibration counterClock =
+        {
+            .gpuTimestamp = static_cast<std::uint64_t>(counterNow.QuadPart),
+            .gpuFrequency = static_cast<std::uint64_t>(counterFrequency.QuadPart),
+            .cpuTime = cpuNow
+        };
+
+        calibration =
+        {
+            .gpuTimestamp = gpuTimestamp,
+            .gpuFrequency = gpuFrequency,
+            .cpuTime = counterClock.ToCpuTime(cpuCounter)
+        };
+
+        return true;
+    }
+}
+
+namespace DXSandbox
+{
+    GpuProfiler::Frame::Frame(std::uint32_t maxScopes)
+        : scopes{maxScopes}
+    {
+    }
+
+    GpuProfiler::GpuProfiler(ComPtr<ID3D12Device> device, std::size_t frameCount, std::uint32_t maxScopes)
+        : m_device{std::move(device)}
+    {
+        assert(m_device && frameCount > 0 && maxScopes > 0);
+
+        m_frames.reserve(frameCount);
+
+        for (std::size_t i = 0; i < frameCount; ++i)
+        {
+            m_frames.push_back(std::make_unique<Frame>(maxScopes));
+
+            CreateFrame(*m_frames.back());
+        }
+    }
+
+    GpuProfiler::~GpuProfiler() = default;
+
+    void GpuProfiler::BeginFrame(std::size_t frame)
+    {
+        assert(frame < m_frames.size());
+
+        m_currentFrame = m_frames[frame].get();
+        m_currentFrame->scopes.Clear();
+        m_currentFrame->isResolved = false;
+    }
+
+    void GpuProfiler::BeginScope(ID3D12GraphicsCommandList* commandList, std::string_view name)
+    {
+        assert(m_currentFrame && commandList);
+
+        if (const auto query = m_currentFrame->scopes.Begin(name))
+            commandList->EndQuery(m_currentFrame->queryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, *query);
+    }
+
+    void GpuProfiler::EndScope(ID3D12GraphicsCommandList* commandList)
+    {
+        assert(m_currentFrame && commandList);
+
+        if (const auto query = m_currentFrame->scopes.End())
+            commandList->EndQuery(m_currentFrame->queryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, *query);
+    }
+
+    HRESULT GpuProfiler::EndFrame(ID3D12GraphicsCommandList*& resolveList)
+    {
+        assert(m_currentFrame && m_currentFrame->scopes.IsBalanced());
+
+        Frame& frame = *m_currentFrame;
+
+        m_currentFrame = nullptr;
+
+        resolveList = frame.resolveList.Get();
+
+        HRESULT hr = frame.allocator->Reset();
+
+        if (FAILED(hr)) [[unlikely]]
+            return hr;
+
+        hr = resolveList->Reset(frame.allocator.Get(), nullptr);
+
+        if (FAILED(hr)) [[unlikely]]
+            return hr;
+
+        if (const std::uint32_t queryCount = frame.scopes.QueryCount(); queryCount > 0)
+        {
+            resolveList->ResolveQueryData(frame.queryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, 0, queryCount,
+                                          frame.readbackBuffer.Get(), 0);
+        }
+
+        hr = resolveList->Close();
+
+        if (FAILED(hr)) [[unlikely]]
+            return hr;
+
+        frame.isResolved = true;
+
+        g_droppedScopes.Add(frame.scopes.DroppedScopes());
+
+        return S_OK;
+    }
+
+    void GpuProfiler::Collect(std::size_t frame, ID3D12CommandQueue* commandQueue, TraceRecorder* trace)
+    {
+        assert(frame < m_frames.size() && commandQueue);
+
+        Frame& completed = *m_frames[frame];
+
+        if (!completed.isResolved)
+            return;
+
+        completed.isResolved = false;
+
+        const std::span<const std::uint64_t> timestamps{completed.timestamps,
+                                                        completed.scopes.QueryCount()};
+
+        if (timestamps.empty())
+            return;
+
+        // Calibrated for every traced frame, the clocks drift apart; durations
+        // alone only need the frequency
+        GpuClockCalibration calibration = {.gpuTimestamp = timestamps.front()};
+
+        if (trace && !CalibrateGpuClock(commandQueue, calibration))
+            return;
+        if (!trace && FAILED(commandQueue->GetTimestampFrequency(&calibration.gpuFrequency)))
+            return;
+        if (calibration.gpuFrequency == 0)
+            return;
+
+        completed.scopes.Resolve(timestamps, calibration, m_resolvedScopes);
+
+        if (m_resolvedScopes.empty())
+            return;
+
+        if (trace)
+        {
+            trace->NameTrack(TrackId, "GPU");
+
+            GpuScopeTree::Export(m_resolvedScopes, *trace, TrackId);
+        }
+
+        auto frameStart = m_resolvedScopes.front().start;
+        auto frameEnd = m_resolvedScopes.front().end;
+
+        for (const GpuScopeTree::ResolvedScope& scope : m_resolvedScopes)
+        {
+            frameStart = std::min(frameStart, scope.start);
+            frameEnd = std::max(frameEnd, scope.end);
+        }
+
+        m_frameTime = std::chrono::duration_cast<std::chrono::nanoseconds>(frameEnd - frameStart);
+
+        const auto frameTime = std::chrono::duration_cast<std::chrono::microseconds>(m_frameTime);
+
+        g_frameMicroseconds.Set(frameTime.count());
+    }
+
+    std::chrono::nanoseconds GpuProfiler::FrameTime() const noexcept
+    {
+        return m_frameTime;
+    }
+
+    void GpuProfiler::CreateFrame(Frame& frame)
+    {
+        const D3D12_QUERY_HEAP_DESC queryHeapDesc =
+        {
+            .Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP,
+            .Count = frame.scopes.MaxQueryCount()
+        };
+
+        ThrowIfFailed(m_device->CreateQueryHeap(&queryHeapDesc, IID_PPV_ARGS(&frame.queryHeap)));
+
+        static constexpr D3D12_HEAP_PROPERTIES heapProperties =
+        {
+            .Type = D3D12_HEAP_TYPE_READBACK
+        };
+
+        const D3D12_RESOURCE_DESC bufferDesc =
+        {
+            .Dimension = D3D12_RESOURCE_DIMENSION_BUFFER,
+            .Width = sizeof(std::uint64_t) * frame.scopes.MaxQueryCount(),
+            .Height = 1,
+            .DepthOrArraySize = 1,
+            .MipLevels = 1,
+            .Format = DXGI_FORMAT_UNKNOWN,
+            .SampleDesc = {.Count = 1},
+            .Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR
+        };
+
+        ThrowIfFailed(m_device->CreateCommittedResource(&heapProperties, D3D12_HEAP_FLAG_NONE, &bufferDesc,
+                                                        D3D12_RESOURCE_STATE_COPY_DEST, nullptr,
+                                                        IID_PPV_ARGS(&frame.readbackBuffer)));
+
+        // Readback heaps may stay mapped; reads happen after the fence only
+        void* mappedData = nullptr;
+
+        ThrowIfFailed(frame.readbackBuffer->Map(0, nullptr, &mappedData));
+
+        frame.timestamps = static_cast<const std::uint64_t*>(mappedData);
+
+        ThrowIfFailed(m_device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT,
+                                                       IID_PPV_ARGS(&frame.allocator)));
+        ThrowIfFailed(m_device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT,
+                                                  frame.allocator.Get(), nullptr,
+                                                  IID_PPV_ARGS(&frame.resolveList)));
+        ThrowIfFailed(frame.resolveList->Close());
+    }
+
+    GpuScope::GpuScope(GpuProfiler* profiler, ID3D12GraphicsCommandList* commandList, std::string_view name)
+        : m_profiler{profiler}
+        , m_commandList{commandList}
+    {
+        if (m_profiler)
+            m_profiler->BeginScope(m_commandList, name);
+    }
+
+    GpuScope::~GpuScope()
+    {
+        if (m_profiler)
+            m_profiler->EndScope(m_commandList);
+    }
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "WindowsPlatform.hpp"
+
+#include "ComPtr.hpp"
+#include "GpuScopeTree.hpp"
+
+#include <d3d12.h>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace DXSandbox
+{
+    class TraceRecorder;
+
+    // Hierarchical GPU timing. Scopes write timestamp queries into the heap
+    // of the frame being recorded, one heap per frame in flight, and a list
+    // of the profiler resolves them into persistently mapped readback memory.
+    // Once the frame has completed, its scopes are placed on the CPU timeline
+    // with a fresh clock calibration and recorded on the GPU track of the
+    // trace, next to the CPU zones. Frames without a trace only measure the
+    // GPU time of the frame.
+    class GpuProfiler final
+    {
+    public:
+        // Not a valid thread id, which are multiples of four
+        static constexpr std::uint32_t TrackId = 0xFFFF'FFFFu;
+
+        GpuProfiler(ComPtr<ID3D12Device> device, std::size_t frameCount, std::uint32_t maxScopes = 256);
+        ~GpuProfiler();
+
+        GpuProfiler(const GpuProfiler&) = delete;
+        GpuProfiler& operator = (const GpuProfiler&) = delete;
+
+        void BeginFrame(std::size_t frame);
+
+        void BeginScope(ID3D12GraphicsCommandList* commandList, std::string_view name);
+        void EndScope(ID3D12GraphicsCommandList* commandList);
+
+        // The returned list resolves the timestamps of the frame and must be
+        // executed after every list with scopes
+        [[nodiscard]] HRESULT EndFrame(ID3D12GraphicsCommandList*& resolveList);
+
+        // Once the GPU has completed the frame; the trace may be null
+        void Collect(std::size_t frame, ID3D12CommandQueue* commandQueue, TraceRecorder* trace);
+
+        // From the first scope beginning to the last one ending, in the last
+        // collected frame
+        std::chrono::nanoseconds FrameTime() const noexcept;
+
+    private:
+        struct Frame final
+        {
+            explicit Frame(std::uint32_t maxScopes);
+
+            ComPtr<ID3D12QueryHeap> queryHeap;
+            ComPtr<ID3D12Resource> readbackBuffer;
+            const std::uint64_t* timestamps = nullptr;
+
+            ComPtr<ID3D12CommandAllocator> allocator;
+            ComPtr<ID3D12GraphicsCommandList> resolveList;
+
+            GpuScopeTree scopes;
+            bool isResolved = false;
+        };
+
+        void CreateFrame(Frame& frame);
+
+    private:
+        ComPtr<ID3D12Device> m_device;
+
+        std::vector<std::unique_ptr<Frame>> m_frames;
+        Frame* m_currentFrame = nullptr;
+
+        std::vector<GpuScopeTree::ResolvedScope> m_resolvedScopes;
+
+        std::chrono::nanoseconds m_frameTime{};
+    };
+
+    // Times the GPU work recorded during the scope; does nothing without a
+    // profiler
+    class GpuScope final
+    {
+    public:
+        GpuScope(GpuProfiler* profiler, ID3D12GraphicsCommandList* commandList, std::string_view name);
+        ~GpuScope();
+
+        GpuScope(const GpuScope&) = delete;
+        GpuScope& operator = (const GpuScope&) = delete;
+
+    private:
+        GpuProfiler* m_profiler = nullptr;
+        ID3D12GraphicsCommandList* m_commandList = nullptr;
+    };
+}
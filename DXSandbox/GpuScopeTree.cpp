@@ -0,0 +1,148 @@
+#include "GpuScopeTree.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace
+{
+    // Split in whole seconds and the remainder, so the multiplication cannot
+    // overflow for any realistic frequency
+    std::int64_t TicksToNanoseconds(std::int64_t ticks, std::uint64_t frequency) noexcept
+    {
+        const auto signedFrequency = static_cast<std::int64_t>(frequency);
+
+        const std::int64_t seconds = ticks / signedFrequency;
+        const std::int64_t remainder = ticks % signedFrequency;
+
+        return seconds * 1'000'000'000 + remainder * 1'000'000'000 / signedFrequency;
+    }
+}
+
+namespace DXSandbox
+{
+    TraceRecorder::Clock::time_point GpuClockCalibration::ToCpuTime(std::uint64_t timestamp) const noexcept
+    {
+        assert(gpuFrequency > 0);
+
+        // Timestamps before the calibration give negative offsets
+        const auto ticks = static_cast<std::int64_t>(timestamp - gpuTimestamp);
+
+        const std::chrono::nanoseconds offset{TicksToNanoseconds(ticks, gpuFrequency)};
+
+        return cpuTime + std::chrono::duration_cast<TraceRecorder::Clock::duration>(offset);
+    }
+
+    GpuScopeTree::GpuScopeTree(std::uint32_t maxScopes)
+        : m_maxScopes{maxScopes}
+    {
+        m_scopes.reserve(maxScopes);
+    }
+
+    void GpuScopeTree::Clear() noexcept
+    {
+        m_scopes.clear();
+        m_openScopes.clear();
+        m_droppedScopes = 0;
+    }
+
+    std::optional<std::uint32_t> GpuScopeTree::Begin(std::string_view name)
+    {
+        const bool isParentDropped = !m_openScopes.empty() && m_openScopes.back() == NoParent;
+
+        if (isParentDropped || m_scopes.size() >= m_maxScopes)
+        {
+            ++m_droppedScopes;
+            m_openScopes.push_back(NoParent);
+            return std::nullopt;
+        }
+
+        const auto index = static_cast<std::uint32_t>(m_scopes.size());
+
+        const std::uint32_t parent = m_openScopes.empty() ? NoParent : m_openScopes.back();
+
+        m_scopes.push_back(
+        {
+            .name = name,
+            .parent = parent,
+            .depth = static_cast<std::uint32_t>(m_openScopes.size())
+        });
+
+        m_openScopes.push_back(index);
+
+        return 2 * index;
+    }
+
+    std::optional<std::uint32_t> GpuScopeTree::End()
+    {
+        assert(!m_openScopes.empty());
+
+        const std::uint32_t index = m_openScopes.back();
+
+        m_openScopes.pop_back();
+
+        if (index == NoParent)
+            return std::nullopt;
+
+        m_scopes[index].isClosed = true;
+
+        return 2 * index + 1;
+    }
+
+    std::span<const GpuScopeTree::Scope> GpuScopeTree::Scopes() const noexcept
+    {
+        return m_scopes;
+    }
+
+    std::uint32_t GpuScopeTree::QueryCount() const noexcept
+    {
+        return 2 * static_cast<std::uint32_t>(m_scopes.size());
+    }
+
+    std::uint32_t GpuScopeTree::MaxQueryCount() const noexcept
+    {
+        return 2 * m_maxScopes;
+    }
+
+    std::uint32_t GpuScopeTree::DroppedScopes() const noexcept
+    {
+        return m_droppedScopes;
+    }
+
+    bool GpuScopeTree::IsBalanced() const noexcept
+    {
+        return m_openScopes.empty();
+    }
+
+    void GpuScopeTree::Resolve(std::span<const std::uint64_t> timestamps, const GpuClockCalibration& calibration,
+                               std::vector<ResolvedScope>& resolved) const
+    {
+        assert(timestamps.size() >= QueryCount());
+
+        resolved.clear();
+
+        for (std::size_t i = 0; i < m_scopes.size(); ++i)
+        {
+            const Scope& scope = m_scopes[i];
+
+            if (!scope.isClosed)
+                continue;
+
+            const std::uint64_t begin = timestamps[2 * i];
+            const std::uint64_t end = std::max(timestamps[2 * i + 1], begin);
+
+            resolved.push_back(
+            {
+                .name = scope.name,
+                .depth = scope.depth,
+                .start = calibration.ToCpuTime(begin),
+                .end = calibration.ToCpuTime(end)
+            });
+        }
+    }
+
+    void GpuScopeTree::Export(std::span<const ResolvedScope> scopes, TraceRecorder& trace, std::uint32_t trackId)
+    {
+        for (const ResolvedScope& scope : scopes)
+            trace.Record(scope.name, trackId, scope.start, scope.end);
+    }
+}
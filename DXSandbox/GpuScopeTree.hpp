@@ -0,0 +1,93 @@
+#pragma once
+
+#include "TraceRecorder.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace DXSandbox
+{
+    // A GPU timestamp and the CPU time it was sampled at, which places the
+    // timestamps of the queue on the CPU timeline
+    struct GpuClockCalibration final
+    {
+        std::uint64_t gpuTimestamp = 0;
+
+        // Timestamp ticks per second
+        std::uint64_t gpuFrequency = 1;
+
+        TraceRecorder::Clock::time_point cpuTime;
+
+        TraceRecorder::Clock::time_point ToCpuTime(std::uint64_t timestamp) const noexcept;
+    };
+
+    // Scopes of GPU work recorded in one frame. Each scope nests inside the
+    // scope open when it begins and owns two timestamp queries, its begin at
+    // 2 * index and its end at 2 * index + 1. The tree knows nothing of the
+    // GPU, so it can be filled and resolved with synthetic timestamps.
+    class GpuScopeTree final
+    {
+    public:
+        static constexpr std::uint32_t NoParent = ~std::uint32_t{0};
+
+        struct Scope final
+        {
+            // Not copied, must outlive the tree, like a string literal
+            std::string_view name;
+
+            std::uint32_t parent = NoParent;
+            std::uint32_t depth = 0;
+            bool isClosed = false;
+        };
+
+        struct ResolvedScope final
+        {
+            std::string_view name;
+            std::uint32_t depth = 0;
+            TraceRecorder::Clock::time_point start;
+            TraceRecorder::Clock::time_point end;
+        };
+
+        explicit GpuScopeTree(std::uint32_t maxScopes);
+
+        void Clear() noexcept;
+
+        // Return the query receiving the timestamp. Scopes beyond the
+        // capacity are dropped, with their children; they return nothing.
+        std::optional<std::uint32_t> Begin(std::string_view name);
+        std::optional<std::uint32_t> End();
+
+        std::span<const Scope> Scopes() const noexcept;
+
+        // Queries written by the scopes so far, resolved from the first one
+        std::uint32_t QueryCount() const noexcept;
+        std::uint32_t MaxQueryCount() const noexcept;
+
+        std::uint32_t DroppedScopes() const noexcept;
+
+        // Every scope that began has ended
+        bool IsBalanced() const noexcept;
+
+        // Converts the closed scopes to CPU time, in the order they began.
+        // The timestamps are indexed by query. An end before its begin, which
+        // the queue can report across a clock change, is clamped to the begin.
+        void Resolve(std::span<const std::uint64_t> timestamps, const GpuClockCalibration& calibration,
+                     std::vector<ResolvedScope>& resolved) const;
+
+        // Records resolved scopes on a trace track; nesting follows from time
+        static void Export(std::span<const ResolvedScope> scopes, TraceRecorder& trace, std::uint32_t trackId);
+
+    private:
+        std::uint32_t m_maxScopes = 0;
+
+        std::vector<Scope> m_scopes;
+
+        // Open scopes, innermost last; dropped scopes are NoParent
+        std::vector<std::uint32_t> m_openScopes;
+
+        std::uint32_t m_droppedScopes = 0;
+    };
+}
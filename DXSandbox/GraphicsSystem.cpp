@@ -1,16 +1,103 @@
 #include "GraphicsSystem.hpp"
 
+#include "AllocationTracking.hpp"
+#include "BindlessDescriptorTable.hpp"
+#include "CommandCapture.hpp"
 #include "Debug.hpp"
 #include "ErrorHandling.hpp"
+#include "FrameArena.hpp"
+#include "FrameReadback.hpp"
+#include "GpuMemoryAllocator.hpp"
+#include "GpuProfiler.hpp"
+#include "HudRenderer.hpp"
+#include "Instrumentation.hpp"
+#include "PerfHud.hpp"
+#include "ResidencyManager.hpp"
+#include "TaskGraph.hpp"
+#include "TextLayout.hpp"
+#include "TraceRecorder.hpp"
+#include "UploadRing.hpp"
+#include "Upscaler.hpp"
 #include "Window.hpp"
+#include "WindowSurface.hpp"
 
 #include <d3d12.h>
 #include <dxgi1_6.h>
+#include <psapi.h>
 
 #include <cassert>
+#include <chrono>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
 
 namespace
 {
+    using DXSandbox::Instrumentation::Counter;
+
+    Counter g_droppedReadbacks{"Readback.DroppedRequests"};
+    Counter g_deviceLosses{"GraphicsSystem.DeviceLosses"};
+    Counter g_commandListHits{"GraphicsSystem.CommandListHits"};
+    Counter g_commandListMisses{"GraphicsSystem.CommandListMisses"};
+    Counter g_windowCount{"GraphicsSystem.Windows"};
+    Counter g_windowMicroseconds{"GraphicsSystem.WindowCpuMicroseconds"};
+    Counter g_windowBackBufferBytes{"GraphicsSystem.WindowBackBufferBytes"};
+    Counter g_renderScalePercent{"GraphicsSystem.RenderScalePercent"};
+    Counter g_renderScaleChanges{"GraphicsSystem.RenderScaleChanges"};
+    Counter g_renderScalePanicDrops{"GraphicsSystem.RenderScalePanicDrops"};
+    Counter g_retiredObjects{"GraphicsSystem.RetiredObjects"};
+    Counter g_workingSetBytes{"GraphicsSystem.WorkingSetBytes"};
+
+    using DXSandbox::PerfHud;
+
+    // Memory first, then the depths of the queues feeding and draining
+    // the frames
+    constexpr PerfHud::Row HudRows[] =
+    {
+        {"Working set", "GraphicsSystem.WorkingSetBytes", PerfHud::Unit::Bytes},
+        {"Heap live", "Allocations.LiveBytes", PerfHud::Unit::Bytes},
+        {"Allocations", "Allocations.FrameCount", PerfHud::Unit::Count},
+        {"Allocated", "Allocations.FrameBytes", PerfHud::Unit::Bytes},
+        {"GPU resident", "Residency.ResidentBytes", PerfHud::Unit::Bytes},
+        {"GPU budget", "Residency.BudgetBytes", PerfHud::Unit::Bytes},
+        {"GPU heaps used", "GpuMemory.UsedBytes", PerfHud::Unit::Bytes},
+        {"Frame arena peak", "FrameMemory.ArenaPeakBytes", PerfHud::Unit::Bytes},
+        {"Uploads", "UploadRing.FrameBytes", PerfHud::Unit::Bytes},
+        {"GPU frame", "GpuProfiler.FrameMicroseconds", PerfHud::Unit::Microseconds},
+        {"Draws", "DrawQueue.Draws", PerfHud::Unit::Count},
+        {"Culled draws", "DrawQueue.CulledDraws", PerfHud::Unit::Count},
+        {"Window events", "Application.WindowEventQueueDepth", PerfHud::Unit::Count},
+        {"Retired objects", "GraphicsSystem.RetiredObjects", PerfHud::Unit::Count},
+        {"Pending views", "Bindless.PendingDescriptors", PerfHud::Unit::Count}
+    };
+
+    constexpr float HudMargin = 8.0f;
+
+    // FNV-1a, fed with the draw packets to detect unchanged frames
+    constexpr std::uint64_t FnvOffsetBasis = 0xcbf29ce484222325ull;
+    constexpr std::uint64_t FnvPrime = 0x100000001b3ull;
+
+    std::uint64_t HashBytes(std::uint64_t hash, std::span<const std::byte> bytes) noexcept
+    {
+        for (const std::byte byte : bytes)
+        {
+            hash ^= static_cast<std::uint64_t>(byte);
+            hash *= FnvPrime;
+        }
+
+        return hash;
+    }
+
+    bool IsDeviceLost(HRESULT hResult) noexcept
+    {
+        return hResult == DXGI_ERROR_DEVICE_REMOVED ||
+               hResult == DXGI_ERROR_DEVICE_RESET ||
+               hResult == DXGI_ERROR_DEVICE_HUNG ||
+               hResult == DXGI_ERROR_DRIVER_INTERNAL_ERROR;
+    }
+
     bool EnableDebugLayer(const DXSandbox::GraphicsSystem::InitParams& params) noexcept
     {
         if (!params.enableDebugLayer)
@@ -29,35 +116,409 @@ namespace
 
 namespace DXSandbox
 {
+    struct GraphicsSystem::RenderTarget final
+    {
+        D3D12_CPU_DESCRIPTOR_HANDLE view = {};
+        UINT width = 0;
+        UINT height = 0;
+
+        std::uint32_t captureTarget = 0;
+    };
+
     GraphicsSystem::GraphicsSystem(const InitParams& params)
+        : m_syncInterval{params.isVSyncEnabled ? 1u : 0u}
+        , m_isHudVisible{params.showHud}
     {
-        const bool isDebugEnabled = EnableDebugLayer(params);
+        // The device is free threaded, so everything created from it is
+        // created concurrently once it exists
+        TaskGraph graph;
+
+        const auto factory = graph.Add("CreateFactory", [this, &params]
+        {
+            CreateFactory(EnableDebugLayer(params));
+        });
+
+        const auto device = graph.Add("CreateDevice", [this] { CreateDevice(); }, {factory});
+
+        graph.Add("CreateCommandQueue", [this] { CreateCommandQueue(); }, {device});
+        graph.Add("CreateFence", [this] { CreateFence(); }, {device});
+        graph.Add("CreateMemoryAllocators", [this] { CreateMemoryAllocators(); }, {device});
+        graph.Add("CreateFrameArenas", [this] { CreateFrameArenas(); });
+        graph.Add("CreateFrameReadback", [this] { CreateFrameReadback(); }, {device});
+        const auto bindlessDescriptors = graph.Add("CreateBindlessDescriptors", [this]
+        {
+            CreateBindlessDescriptors();
+        }, {device});
+
+        graph.Add("CreateUploadRing", [this] { CreateUploadRing(); }, {device});
+        graph.Add("CreateHud", [this] { CreateHud(); }, {device, bindlessDescriptors});
+
+        // Dynamic resolution is driven by the GPU time of every frame
+        if (params.enableGpuProfiler || params.dynamicResolution)
+            graph.Add("CreateGpuProfiler", [this] { CreateGpuProfiler(); }, {device});
 
-        CreateFactory(isDebugEnabled);
-        CreateDevice();
-        CreateCommandQueue();
-        CreateSwapChain(params);
-        CreateCommandList();
-        CreateFence();
+        if (params.dynamicResolution)
+        {
+            graph.Add("CreateUpscaler", [this, &params]
+            {
+                CreateUpscaler(*params.dynamicResolution);
+            }, {device});
+        }
+
+        graph.Run(params.trace);
     }
 
     GraphicsSystem::~GraphicsSystem()
     {
-        WaitForPreviousFrame();
+        // A lost device has no work left to wait for, nor frames to hand out
+        if (SUCCEEDED(WaitForPreviousFrame()))
+            m_frameReadback->Collect(m_fence->GetCompletedValue());
 
         CloseHandle(m_fenceEvent);
     }
 
-    void GraphicsSystem::Render()
+    std::uint32_t GraphicsSystem::AttachWindow(const SwapChainParams& params)
+    {
+        assert(m_device && m_commandQueue);
+
+        // Presents of one frame are made back to back, so a second window
+        // waiting for vertical sync would halve the frame rate
+        const WindowSurface::Params surfaceParams =
+        {
+            .hWnd = params.hWnd,
+            .width = params.width,
+            .height = params.height,
+            .syncInterval = MainSurface() ? 0 : m_syncInterval,
+            .presentInterval = params.presentInterval
+        };
+
+        m_surfaces.push_back(std::make_unique<WindowSurface>(m_factory.Get(), m_device,
+                                                             m_commandQueue.Get(), surfaceParams));
+
+        if (m_upscaler && m_surfaces.size() == 1)
+            ThrowIfFailed(m_upscaler->Resize(params.width, params.height));
+
+        return static_cast<std::uint32_t>(m_surfaces.size() - 1);
+    }
+
+    void GraphicsSystem::DetachWindow(std::uint32_t surface)
     {
-        PopulateCommandList();
+        assert(surface < m_surfaces.size() && m_surfaces[surface]);
 
-        ID3D12CommandList* commandLists = m_commandList.Get();
-        m_commandQueue->ExecuteCommandLists(1, &commandLists);
+        // Render waits for the GPU at the end of every frame, so nothing
+        // references the swap chain anymore
+        m_surfaces[surface] = nullptr;
+    }
+
+    bool GraphicsSystem::Resize(std::uint32_t surface, UINT width, UINT height)
+    {
+        assert(surface < m_surfaces.size() && m_surfaces[surface]);
+
+        // Render waits for the GPU at the end of every frame, so nothing
+        // references the back buffers anymore
+        HRESULT hr = m_surfaces[surface]->Resize(width, height);
 
-        ThrowIfFailed(m_swapChain->Present(1, 0));
+        if (SUCCEEDED(hr) && m_upscaler && surface == 0)
+            hr = m_upscaler->Resize(width, height);
 
-        WaitForPreviousFrame();
+        if (FAILED(hr)) [[unlikely]]
+            return OnFrameFailure(hr) != FrameResult::DeviceLost;
+
+        return true;
+    }
+
+    GraphicsSystem::FrameResult GraphicsSystem::Render(TraceRecorder* trace)
+    {
+        assert(MainSurface());
+
+        const AllocationTracking::TagScope tag{AllocationTracking::Tag::Graphics};
+
+        HRESULT hr = S_OK;
+
+        // The lists and presents of the due windows
+        FrameVector<ID3D12CommandList*> submittedLists{&FrameScratch()};
+        FrameVector<WindowSurface*> presentedSurfaces{&FrameScratch()};
+
+        // CPU time spent on the windows, without waiting for vertical sync
+        std::chrono::steady_clock::duration windowTime = {};
+
+        GpuProfiler* profiler = trace || m_dynamicResolution ? m_gpuProfiler.get() : nullptr;
+
+        if (profiler)
+            profiler->BeginFrame(m_frameArenaIndex);
+
+        {
+            const TraceScope scope{trace, "RecordCommands"};
+
+            if (m_isHudVisible)
+                UpdateHud();
+
+            const std::uint64_t contentKey = FrameContentKey();
+
+            for (const auto& surface : m_surfaces)
+            {
+                if (!surface || !surface->IsPresentDue(m_frameIndex))
+                    continue;
+
+                // Occluded secondary windows wait for a test present to
+                // find them visible; the main window is throttled by the
+                // caller
+                const bool isMainSurface = surface.get() == MainSurface();
+
+                if (surface->IsOccluded() && !isMainSurface)
+                {
+                    hr = surface->TestPresent();
+
+                    if (FAILED(hr)) [[unlikely]]
+                        break;
+
+                    continue;
+                }
+
+                ID3D12GraphicsCommandList* commandList = nullptr;
+
+                const auto recordStart = std::chrono::steady_clock::now();
+
+                hr = PopulateCommandList(*surface, isMainSurface, contentKey, profiler, commandList);
+
+                windowTime += std::chrono::steady_clock::now() - recordStart;
+
+                if (FAILED(hr)) [[unlikely]]
+                    break;
+
+                submittedLists.push_back(commandList);
+                presentedSurfaces.push_back(surface.get());
+            }
+
+            if (m_commandCapture && SUCCEEDED(hr))
+            {
+                m_commandCapture->SetStateCounts(static_cast<std::uint32_t>(m_rootSignatures.size()),
+                                                 static_cast<std::uint32_t>(m_pipelineStates.size()));
+                m_commandCapture->EndFrame();
+            }
+
+            if (profiler && SUCCEEDED(hr))
+            {
+                ID3D12GraphicsCommandList* resolveList = nullptr;
+
+                hr = profiler->EndFrame(resolveList);
+
+                submittedLists.push_back(resolveList);
+            }
+        }
+
+        if (FAILED(hr)) [[unlikely]]
+            return OnFrameFailure(hr);
+
+        {
+            const TraceScope scope{trace, "UpdateResidency"};
+
+            // Heaps used by the frame are resident before it executes, and
+            // the ones evicted to fit the budget were used by completed frames
+            hr = m_residency->Update(m_fence->GetCompletedValue());
+        }
+
+        if (FAILED(hr)) [[unlikely]]
+            return OnFrameFailure(hr);
+
+        const auto cpuFrameEnd = std::chrono::steady_clock::now();
+
+        bool isOccluded = false;
+
+        {
+            const TraceScope scope{trace, "Present"};
+
+            // One submission for every window
+            if (!submittedLists.empty())
+            {
+                m_commandQueue->ExecuteCommandLists(static_cast<UINT>(submittedLists.size()),
+                                                    submittedLists.data());
+            }
+
+            for (WindowSurface* surface : presentedSurfaces)
+            {
+                const auto presentStart = std::chrono::steady_clock::now();
+
+                hr = surface->Present();
+
+                if (FAILED(hr)) [[unlikely]]
+                    break;
+
+                if (surface != MainSurface())
+                    windowTime += std::chrono::steady_clock::now() - presentStart;
+                else
+                    isOccluded = surface->IsOccluded();
+            }
+        }
+
+        if (FAILED(hr)) [[unlikely]]
+            return OnFrameFailure(hr);
+
+        UpdateWindowCounters(windowTime, presentedSurfaces.size());
+
+        m_frameArenaFenceValues[m_frameArenaIndex] = FrameFenceValue();
+        m_uploadRing->EndFrame(FrameFenceValue());
+
+        {
+            const TraceScope scope{trace, "WaitForGpu"};
+
+            hr = WaitForPreviousFrame();
+        }
+
+        if (FAILED(hr)) [[unlikely]]
+            return OnFrameFailure(hr);
+
+        const UINT64 completedFenceValue = m_fence->GetCompletedValue();
+
+        m_bufferAllocator->ReleaseCompleted(completedFenceValue);
+        m_textureAllocator->ReleaseCompleted(completedFenceValue);
+        m_bindlessDescriptors->Reclaim(completedFenceValue);
+        m_uploadRing->Reclaim(completedFenceValue);
+
+        ReleaseRetiredObjects(completedFenceValue);
+
+        m_frameReadback->Collect(completedFenceValue);
+
+        if (profiler)
+            profiler->Collect(m_frameArenaIndex, m_commandQueue.Get(), trace);
+
+        // Frames without the main window have no time at its scale
+        const bool isMainSurfaceRendered = !presentedSurfaces.empty() &&
+                                           presentedSurfaces.front() == MainSurface();
+
+        if (m_dynamicResolution && m_cpuFrameStart && isMainSurfaceRendered)
+            UpdateRenderScale(cpuFrameEnd - *m_cpuFrameStart);
+
+        const auto frameStart = std::chrono::steady_clock::now();
+
+        // The overlay shows the whole frame period, vertical sync included
+        if (m_cpuFrameStart)
+            m_perfHud->AddFrame(frameStart - *m_cpuFrameStart);
+
+        m_cpuFrameStart = frameStart;
+
+        m_drawQueue.Clear();
+
+        AdvanceFrameArena();
+
+        ++m_frameIndex;
+
+        return isOccluded ? FrameResult::Occluded : FrameResult::Presented;
+    }
+
+    GraphicsSystem::FrameResult GraphicsSystem::TestPresent()
+    {
+        WindowSurface* surface = MainSurface();
+
+        assert(surface);
+
+        const HRESULT hr = surface->TestPresent();
+
+        if (FAILED(hr)) [[unlikely]]
+            return OnFrameFailure(hr);
+
+        return surface->IsOccluded() ? FrameResult::Occluded : FrameResult::Presented;
+    }
+
+    DrawQueue& GraphicsSystem::Draws() noexcept
+    {
+        return m_drawQueue;
+    }
+
+    void GraphicsSystem::SetCommandCapture(CommandCapture* capture) noexcept
+    {
+        m_commandCapture = capture;
+    }
+
+    std::uint32_t GraphicsSystem::RegisterRootSignature(ComPtr<ID3D12RootSignature> rootSignature)
+    {
+        assert(rootSignature);
+
+        if (m_rootSignatures.size() >= DrawSortKey::MaxRootSignatures)
+            throw std::length_error{"Too many root signatures"};
+
+        m_rootSignatures.push_back(std::move(rootSignature));
+
+        return static_cast<std::uint32_t>(m_rootSignatures.size() - 1);
+    }
+
+    std::uint32_t GraphicsSystem::RegisterPipelineState(ComPtr<ID3D12PipelineState> pipelineState)
+    {
+        assert(pipelineState);
+
+        if (m_pipelineStates.size() >= DrawSortKey::MaxPipelineStates)
+            throw std::length_error{"Too many pipeline states"};
+
+        m_pipelineStates.push_back(std::move(pipelineState));
+
+        return static_cast<std::uint32_t>(m_pipelineStates.size() - 1);
+    }
+
+    void GraphicsSystem::ReplacePipelineState(std::uint32_t index, ComPtr<ID3D12PipelineState> pipelineState)
+    {
+        assert(index < m_pipelineStates.size() && pipelineState);
+
+        Retire(std::move(m_pipelineStates[index]));
+
+        m_pipelineStates[index] = std::move(pipelineState);
+
+        ++m_pipelineStateGeneration;
+    }
+
+    void GraphicsSystem::Retire(ComPtr<IUnknown> object)
+    {
+        if (!object)
+            return;
+
+        // The frame being recorded signals the current value, earlier ones less
+        m_retiredObjects.push_back({.fenceValue = m_fenceValue, .object = std::move(object)});
+    }
+
+    GpuMemoryAllocator& GraphicsSystem::BufferAllocator() noexcept
+    {
+        return *m_bufferAllocator;
+    }
+
+    GpuMemoryAllocator& GraphicsSystem::TextureAllocator() noexcept
+    {
+        return *m_textureAllocator;
+    }
+
+    BindlessDescriptorTable& GraphicsSystem::BindlessDescriptors() noexcept
+    {
+        return *m_bindlessDescriptors;
+    }
+
+    UINT64 GraphicsSystem::FrameFenceValue() const noexcept
+    {
+        return m_fenceValue;
+    }
+
+    FrameArena& GraphicsSystem::FrameScratch() noexcept
+    {
+        return *m_frameArenas[m_frameArenaIndex];
+    }
+
+    UploadRing& GraphicsSystem::FrameUploads() noexcept
+    {
+        return *m_uploadRing;
+    }
+
+    void GraphicsSystem::SetHudVisible(bool isVisible) noexcept
+    {
+        m_isHudVisible = isVisible;
+    }
+
+    bool GraphicsSystem::IsHudVisible() const noexcept
+    {
+        return m_isHudVisible;
+    }
+
+    void GraphicsSystem::RequestReadback(ReadbackHandler handler)
+    {
+        assert(handler);
+
+        m_readbackRequests.push_back(std::move(handler));
     }
 
     void GraphicsSystem::CreateFactory(bool enableDebug)
@@ -97,7 +558,11 @@ namespace DXSandbox
                 continue;
             if (SUCCEEDED(D3D12CreateDevice(adapter.Get(), D3D_FEATURE_LEVEL_12_1,
                                             IID_PPV_ARGS(&m_device))))
+            {
+                // Reports the video memory budget of the device
+                ThrowIfFailed(adapter.As(&m_adapter));
                 break;
+            }
         }
 
         if (!m_device)
@@ -116,135 +581,555 @@ namespace DXSandbox
         ThrowIfFailed(m_device->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&m_commandQueue)));
     }
 
-    void GraphicsSystem::CreateSwapChain(const InitParams& params)
+    void GraphicsSystem::CreateFence()
     {
-        assert(m_factory && m_commandQueue);
+        assert(m_device);
 
-        const DXGI_SWAP_CHAIN_DESC1 swapChainDesc =
-        {
-            .Width = params.width,
-            .Height = params.height,
-            .Format = DXGI_FORMAT_R8G8B8A8_UNORM,
-            .SampleDesc = {.Count = 1},
-            .BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT,
-            .BufferCount = BackBufferCount,
-            .SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD
-        };
+        ThrowIfFailed(m_device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_fence)));
 
-        ComPtr<IDXGISwapChain1> baseSwapChain;
+        m_fenceEvent = CreateEventW(nullptr, FALSE, FALSE, nullptr);
 
-        ThrowIfFailed(m_factory->CreateSwapChainForHwnd(m_commandQueue.Get(), params.hWnd,
-                                                        &swapChainDesc, nullptr, nullptr,
-                                                        &baseSwapChain));
-        ThrowIfFailed(baseSwapChain.As(&m_swapChain));
-        ThrowIfFailed(m_factory->MakeWindowAssociation(params.hWnd, DXGI_MWA_NO_ALT_ENTER));
+        if (!m_fenceEvent)
+            ThrowLastError();
 
-        m_currentBackBufferIndex = m_swapChain->GetCurrentBackBufferIndex();
+        m_fenceValue = 1;
+    }
 
-        static constexpr D3D12_DESCRIPTOR_HEAP_DESC rtvHeapDesc =
-        {
-            .Type = D3D12_DESCRIPTOR_HEAP_TYPE_RTV,
-            .NumDescriptors = BackBufferCount
-        };
+    void GraphicsSystem::CreateMemoryAllocators()
+    {
+        assert(m_device && m_adapter);
 
-        ThrowIfFailed(m_device->CreateDescriptorHeap(&rtvHeapDesc, IID_PPV_ARGS(&m_rtvHeap)));
+        m_residency = std::make_unique<ResidencyManager>(m_device, m_adapter);
 
-        m_rtvDescriptorSize = m_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
+        m_bufferAllocator = std::make_unique<GpuMemoryAllocator>(m_device, D3D12_HEAP_TYPE_DEFAULT,
+                                                                 D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS,
+                                                                 m_residency.get());
+        m_textureAllocator = std::make_unique<GpuMemoryAllocator>(m_device, D3D12_HEAP_TYPE_DEFAULT,
+                                                                  D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES,
+                                                                  m_residency.get());
+    }
 
-        D3D12_CPU_DESCRIPTOR_HANDLE rtvHandle = m_rtvHeap->GetCPUDescriptorHandleForHeapStart();
+    void GraphicsSystem::CreateFrameArenas()
+    {
+        for (auto& arena : m_frameArenas)
+            arena = std::make_unique<FrameArena>(FrameArenaCapacity);
+    }
 
-        for (UINT i = 0; i < BackBufferCount; ++i)
-        {
-            ThrowIfFailed(m_swapChain->GetBuffer(i, IID_PPV_ARGS(&m_backBuffers[i])));
-            m_device->CreateRenderTargetView(m_backBuffers[i].Get(), nullptr, rtvHandle);
-            rtvHandle.ptr += m_rtvDescriptorSize;
-        }
+    void GraphicsSystem::CreateFrameReadback()
+    {
+        assert(m_device);
+
+        m_frameReadback = std::make_unique<FrameReadback>(m_device);
     }
 
-    void GraphicsSystem::CreateCommandList()
+    void GraphicsSystem::CreateBindlessDescriptors()
     {
         assert(m_device);
 
-        ThrowIfFailed(m_device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT,
-                                                       IID_PPV_ARGS(&m_commandAllocator)));
-        ThrowIfFailed(m_device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT,
-                                                  m_commandAllocator.Get(), nullptr,
-                                                  IID_PPV_ARGS(&m_commandList)));
-        ThrowIfFailed(m_commandList->Close());
+        m_bindlessDescriptors = std::make_unique<BindlessDescriptorTable>(m_device);
     }
 
-    void GraphicsSystem::CreateFence()
+    void GraphicsSystem::CreateUploadRing()
     {
         assert(m_device);
 
-        ThrowIfFailed(m_device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_fence)));
+        m_uploadRing = std::make_unique<UploadRing>(m_device, UploadRingCapacity);
+    }
 
-        m_fenceEvent = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+    void GraphicsSystem::CreateHud()
+    {
+        assert(m_device && m_bindlessDescriptors);
 
-        if (!m_fenceEvent)
-            ThrowLastError();
+        // Drawn over the back buffers
+        m_hudRenderer = std::make_unique<HudRenderer>(m_device, DXGI_FORMAT_R8G8B8A8_UNORM, *m_bindlessDescriptors);
+        m_hudLayout = std::make_unique<TextLayout>(m_hudRenderer->Atlas());
+        m_perfHud = std::make_unique<PerfHud>(HudRows);
+    }
 
-        m_fenceValue = 1;
+    void GraphicsSystem::CreateGpuProfiler()
+    {
+        assert(m_device);
+
+        m_gpuProfiler = std::make_unique<GpuProfiler>(m_device, m_frameArenas.size());
+    }
+
+    void GraphicsSystem::CreateUpscaler(const DynamicResolution::Params& params)
+    {
+        assert(m_device);
+
+        // Same format as the back buffers it is upscaled to
+        m_upscaler = std::make_unique<Upscaler>(m_device, DXGI_FORMAT_R8G8B8A8_UNORM);
+        m_dynamicResolution = std::make_unique<DynamicResolution>(params);
     }
 
-    void GraphicsSystem::PopulateCommandList()
+    void GraphicsSystem::AdvanceFrameArena()
     {
-        ThrowIfFailed(m_commandAllocator->Reset());
-        ThrowIfFailed(m_commandList->Reset(m_commandAllocator.Get(), m_pipelineState.Get()));
+        m_frameArenaIndex = (m_frameArenaIndex + 1) % m_frameArenas.size();
+
+        // The arena is reused only after the frame that filled it has retired
+        assert(m_fence->GetCompletedValue() >= m_frameArenaFenceValues[m_frameArenaIndex]);
+
+        m_frameArenas[m_frameArenaIndex]->Reset();
+    }
+
+    void GraphicsSystem::ReleaseRetiredObjects(UINT64 completedFenceValue) noexcept
+    {
+        while (!m_retiredObjects.empty() && m_retiredObjects.front().fenceValue <= completedFenceValue)
+            m_retiredObjects.pop_front();
+
+        g_retiredObjects.Set(static_cast<std::int64_t>(m_retiredObjects.size()));
+    }
+
+    WindowSurface* GraphicsSystem::MainSurface() const noexcept
+    {
+        return m_surfaces.empty() ? nullptr : m_surfaces.front().get();
+    }
+
+    HRESULT GraphicsSystem::PopulateCommandList(WindowSurface& surface, bool isMainSurface,
+                                                std::uint64_t contentKey, GpuProfiler* profiler,
+                                                ID3D12GraphicsCommandList*& commandList)
+    {
+        WindowSurface::CachedCommandList& cached = surface.CurrentCommandList();
+
+        commandList = cached.commandList.Get();
+
+        // Readbacks copy to a different slot every time, profiled frames
+        // write the queries of their frame, and the overlay uploads its
+        // quads to the ring, so all are recorded, as are the frames being
+        // captured
+        const bool isReadbackRequested = isMainSurface && !m_readbackRequests.empty();
+        const bool isHudDrawn = isMainSurface && m_isHudVisible;
+        const bool isReplayable = !isReadbackRequested && !profiler && !m_commandCapture && !isHudDrawn;
+
+        if (isReplayable && cached.isValid && cached.contentKey == contentKey)
+        {
+            g_commandListHits.Add(1);
+            return S_OK;
+        }
+
+        g_commandListMisses.Add(1);
+
+        cached.isValid = false;
+
+        HRESULT hr = cached.allocator->Reset();
+
+        if (FAILED(hr)) [[unlikely]]
+            return hr;
+
+        hr = commandList->Reset(cached.allocator.Get(), m_pipelineState.Get());
+
+        if (FAILED(hr)) [[unlikely]]
+            return hr;
 
         const D3D12_RESOURCE_BARRIER renderTargetBarrier =
         {
             .Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION,
             .Transition =
             {
-                .pResource = m_backBuffers[m_currentBackBufferIndex].Get(),
+                .pResource = surface.BackBuffer(),
                 .Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES,
                 .StateBefore = D3D12_RESOURCE_STATE_PRESENT,
                 .StateAfter = D3D12_RESOURCE_STATE_RENDER_TARGET
             }
         };
 
-        m_commandList->ResourceBarrier(1, &renderTargetBarrier);
+        CommandStream* capture = m_commandCapture ? &m_commandCapture->Stream() : nullptr;
+
+        const std::uint32_t backBufferTarget = CaptureTarget(surface.BackBuffer(), surface.Width(), surface.Height());
+
+        if (capture)
+        {
+            capture->BeginList();
+            capture->Barrier(backBufferTarget, ResourceState::Present, ResourceState::RenderTarget);
+        }
+
+        bool isReadback = false;
+
+        {
+            const std::string_view windowName = isMainSurface ? "GpuMainWindow" : "GpuSecondaryWindow";
+            const GpuScope windowScope{profiler, commandList, windowName};
+
+            commandList->ResourceBarrier(1, &renderTargetBarrier);
 
-        D3D12_CPU_DESCRIPTOR_HANDLE rtvHandle = m_rtvHeap->GetCPUDescriptorHandleForHeapStart();
+            const RenderTarget output =
+            {
+                .view = surface.RenderTargetView(),
+                .width = surface.Width(),
+                .height = surface.Height(),
+                .captureTarget = backBufferTarget
+            };
+
+            // The main window renders to the corner of the internal target
+            // its scale allows, which is upscaled over the back buffer
+            const bool isScaled = isMainSurface && m_upscaler;
+
+            const RenderTarget target = isScaled ? RenderTarget
+            {
+                .view = m_upscaler->TargetView(),
+                .width = DynamicResolution::ScaledSize(m_upscaler->Width(), m_dynamicResolution->Scale()),
+                .height = DynamicResolution::ScaledSize(m_upscaler->Height(), m_dynamicResolution->Scale()),
+                .captureTarget = CaptureTarget(m_upscaler->Target(), m_upscaler->Width(), m_upscaler->Height())
+            } : output;
+
+            static constexpr float clearColor[] = {0.0f, 0.2f, 0.4f, 1.0f};
+
+            {
+                const GpuScope scope{profiler, commandList, "GpuClear"};
+
+                const D3D12_RECT clearRect =
+                {
+                    .right = static_cast<LONG>(target.width),
+                    .bottom = static_cast<LONG>(target.height)
+                };
+
+                commandList->ClearRenderTargetView(target.view, clearColor, 1, &clearRect);
+
+                if (capture)
+                {
+                    capture->Clear(target.captureTarget, target.width, target.height,
+                                   std::to_array(clearColor));
+                }
+            }
+
+            {
+                const GpuScope scope{profiler, commandList, "GpuDraws"};
 
-        rtvHandle.ptr += static_cast<SIZE_T>(m_currentBackBufferIndex) * m_rtvDescriptorSize;
+                RecordDraws(target, commandList);
+            }
+
+            if (isScaled)
+            {
+                const GpuScope scope{profiler, commandList, "GpuUpscale"};
+
+                BindRenderTarget(output, commandList);
 
-        static constexpr float clearColor[] = {0.0f, 0.2f, 0.4f, 1.0f};
+                m_upscaler->Record(commandList, target.width, target.height);
 
-        m_commandList->ClearRenderTargetView(rtvHandle, clearColor, 0, nullptr);
+                if (capture)
+                {
+                    capture->SetRenderTarget(output.captureTarget, output.width, output.height);
+                    capture->Upscale(target.captureTarget, target.width, target.height);
+                }
+            }
+
+            // Over the output rather than the scaled target, so the text
+            // stays sharp; readbacks include it
+            if (isHudDrawn)
+            {
+                const GpuScope scope{profiler, commandList, "GpuHud"};
+
+                BindRenderTarget(output, commandList);
+
+                m_hudRenderer->Record(commandList, *m_uploadRing, m_hudLayout->Quads(),
+                                      output.width, output.height);
+            }
+
+            if (isReadbackRequested)
+            {
+                const GpuScope scope{profiler, commandList, "GpuReadback"};
+
+                isReadback = RecordReadback(surface, commandList);
+            }
+        }
 
         const D3D12_RESOURCE_BARRIER presentBarrier =
         {
             .Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION,
             .Transition =
             {
-                .pResource = m_backBuffers[m_currentBackBufferIndex].Get(),
+                .pResource = surface.BackBuffer(),
                 .Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES,
-                .StateBefore = D3D12_RESOURCE_STATE_RENDER_TARGET,
+                .StateBefore = isReadback ? D3D12_RESOURCE_STATE_COPY_SOURCE
+                                          : D3D12_RESOURCE_STATE_RENDER_TARGET,
                 .StateAfter = D3D12_RESOURCE_STATE_PRESENT
             }
         };
 
-        m_commandList->ResourceBarrier(1, &presentBarrier);
+        commandList->ResourceBarrier(1, &presentBarrier);
+
+        if (capture)
+        {
+            capture->Barrier(backBufferTarget,
+                             isReadback ? ResourceState::CopySource : ResourceState::RenderTarget,
+                             ResourceState::Present);
+        }
+
+        hr = commandList->Close();
+
+        if (FAILED(hr)) [[unlikely]]
+            return hr;
+
+        cached.contentKey = contentKey;
+        cached.isValid = isReplayable;
+
+        return S_OK;
+    }
+
+    std::uint64_t GraphicsSystem::FrameContentKey() const noexcept
+    {
+        static_assert(std::has_unique_object_representations_v<DrawPacket>);
+
+        const std::uint64_t hash = HashBytes(FnvOffsetBasis, std::as_bytes(m_drawQueue.SubmittedPackets()));
+
+        return HashBytes(hash, std::as_bytes(std::span{&m_pipelineStateGeneration, 1}));
+    }
+
+    void GraphicsSystem::BindRenderTarget(const RenderTarget& target, ID3D12GraphicsCommandList* commandList)
+    {
+        const D3D12_VIEWPORT viewport =
+        {
+            .Width = static_cast<float>(target.width),
+            .Height = static_cast<float>(target.height),
+            .MaxDepth = 1.0f
+        };
+
+        const D3D12_RECT scissorRect =
+        {
+            .right = static_cast<LONG>(target.width),
+            .bottom = static_cast<LONG>(target.height)
+        };
+
+        commandList->OMSetRenderTargets(1, &target.view, FALSE, nullptr);
+        commandList->RSSetViewports(1, &viewport);
+        commandList->RSSetScissorRects(1, &scissorRect);
+    }
+
+    void GraphicsSystem::RecordDraws(const RenderTarget& target, ID3D12GraphicsCommandList* commandList)
+    {
+        if (m_drawQueue.IsEmpty())
+            return;
+
+        // Sorted once for every window of the frame
+        if (m_drawQueue.SortedPackets().size() != m_drawQueue.Size())
+            m_drawQueue.Sort(&FrameScratch());
+
+        BindRenderTarget(target, commandList);
+
+        commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+        // Materials index the bindless heap, bound once for every draw
+        ID3D12DescriptorHeap* const heaps[] = {m_bindlessDescriptors->Heap()};
+
+        commandList->SetDescriptorHeaps(1, heaps);
+
+        CommandStream* capture = m_commandCapture ? &m_commandCapture->Stream() : nullptr;
+
+        if (capture)
+            capture->SetRenderTarget(target.captureTarget, target.width, target.height);
+
+        static constexpr std::uint32_t None = std::numeric_limits<std::uint32_t>::max();
+
+        std::uint32_t rootSignature = None;
+        std::uint32_t pipelineState = None;
+        std::uint32_t material = None;
+
+        for (const DrawPacket& packet : m_drawQueue.SortedPackets())
+        {
+            assert(packet.rootSignature < m_rootSignatures.size());
+            assert(packet.pipelineState < m_pipelineStates.size());
+
+            if (packet.rootSignature != rootSignature)
+            {
+                rootSignature = packet.rootSignature;
+                material = None;
+
+                commandList->SetGraphicsRootSignature(m_rootSignatures[rootSignature].Get());
+
+                if (capture)
+                    capture->SetRootSignature(rootSignature);
+            }
+
+            if (packet.pipelineState != pipelineState)
+            {
+                pipelineState = packet.pipelineState;
+
+                commandList->SetPipelineState(m_pipelineStates[pipelineState].Get());
+
+                if (capture)
+                    capture->SetPipelineState(pipelineState);
+            }
+
+            // By convention root parameter 0 holds the material index
+            if (packet.material != material)
+            {
+                material = packet.material;
+
+                commandList->SetGraphicsRoot32BitConstant(0, material, 0);
+
+                if (capture)
+                    capture->SetMaterial(material);
+            }
+
+            commandList->DrawInstanced(packet.vertexCount, packet.instanceCount,
+                                       packet.startVertex, packet.startInstance);
+
+            if (capture)
+            {
+                capture->Draw(
+                {
+                    .vertexCount = packet.vertexCount,
+                    .instanceCount = packet.instanceCount,
+                    .startVertex = packet.startVertex,
+                    .startInstance = packet.startInstance
+                });
+            }
+        }
+    }
+
+    bool GraphicsSystem::RecordReadback(const WindowSurface& surface, ID3D12GraphicsCommandList* commandList)
+    {
+        if (m_readbackRequests.empty())
+            return false;
+
+        // Every request of the frame shares one copy
+        std::vector<ReadbackHandler> handlers = std::move(m_readbackRequests);
+        m_readbackRequests.clear();
+
+        if (!m_frameReadback->HasFreeSlot())
+        {
+            g_droppedReadbacks.Add(static_cast<std::int64_t>(handlers.size()));
+            return false;
+        }
+
+        ID3D12Resource* backBuffer = surface.BackBuffer();
+
+        const D3D12_RESOURCE_BARRIER copySourceBarrier =
+        {
+            .Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION,
+            .Transition =
+            {
+                .pResource = backBuffer,
+                .Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES,
+                .StateBefore = D3D12_RESOURCE_STATE_RENDER_TARGET,
+                .StateAfter = D3D12_RESOURCE_STATE_COPY_SOURCE
+            }
+        };
+
+        commandList->ResourceBarrier(1, &copySourceBarrier);
+
+        if (m_commandCapture)
+        {
+            const std::uint32_t target = CaptureTarget(backBuffer, surface.Width(), surface.Height());
+
+            m_commandCapture->Stream().Barrier(target, ResourceState::RenderTarget, ResourceState::CopySource);
+            m_commandCapture->Stream().CopyToReadback(target);
+        }
+
+        m_frameReadback->RecordCopy(commandList, backBuffer, FrameFenceValue(),
+                                    [handlers = std::move(handlers)](const ReadbackImage& image)
+        {
+            for (const ReadbackHandler& handler : handlers)
+                handler(image);
+        });
+
+        return true;
+    }
+
+    std::uint32_t GraphicsSystem::CaptureTarget(ID3D12Resource* resource, UINT width, UINT height)
+    {
+        return m_commandCapture ? m_commandCapture->TargetIndex(resource, width, height) : 0;
+    }
+
+    void GraphicsSystem::UpdateRenderScale(std::chrono::steady_clock::duration cpuFrameTime)
+    {
+        assert(m_dynamicResolution && m_gpuProfiler);
+
+        using Milliseconds = DynamicResolution::Milliseconds;
 
-        ThrowIfFailed(m_commandList->Close());
+        const double scale = m_dynamicResolution->Update(std::chrono::duration_cast<Milliseconds>(cpuFrameTime),
+                                                         std::chrono::duration_cast<Milliseconds>(
+                                                             m_gpuProfiler->FrameTime()));
+
+        const DynamicResolution::Statistics stats = m_dynamicResolution->Stats();
+
+        g_renderScalePercent.Set(static_cast<std::int64_t>(scale * 100.0));
+        g_renderScaleChanges.Set(stats.changes);
+        g_renderScalePanicDrops.Set(stats.panicDrops);
     }
 
-    void GraphicsSystem::WaitForPreviousFrame()
+    void GraphicsSystem::UpdateHud()
+    {
+        PROCESS_MEMORY_COUNTERS memory = {};
+
+        if (GetProcessMemoryInfo(GetCurrentProcess(), &memory, sizeof(memory)))
+            g_workingSetBytes.Set(static_cast<std::int64_t>(memory.WorkingSetSize));
+
+        // Counters updated while recording show the previous frame
+        m_hudLayout->Clear();
+        m_perfHud->Build(*m_hudLayout, HudMargin, HudMargin);
+    }
+
+    void GraphicsSystem::UpdateWindowCounters(std::chrono::steady_clock::duration windowTime,
+                                              std::size_t presentedCount) const noexcept
+    {
+        std::int64_t windowCount = 0;
+        std::uint64_t backBufferBytes = 0;
+
+        for (const auto& surface : m_surfaces)
+        {
+            if (!surface)
+                continue;
+
+            ++windowCount;
+            backBufferBytes += surface->BackBufferBytes();
+        }
+
+        g_windowCount.Set(windowCount);
+
+        if (windowCount != 0)
+            g_windowBackBufferBytes.Set(static_cast<std::int64_t>(backBufferBytes) / windowCount);
+
+        // Averaged over the windows rendered in the frame
+        if (presentedCount != 0)
+        {
+            const auto microseconds = std::chrono::duration_cast<std::chrono::microseconds>(windowTime);
+
+            g_windowMicroseconds.Set(microseconds.count() / static_cast<std::int64_t>(presentedCount));
+        }
+    }
+
+    HRESULT GraphicsSystem::WaitForPreviousFrame()
     {
         const UINT64 currentFenceValue = m_fenceValue;
 
-        ThrowIfFailed(m_commandQueue->Signal(m_fence.Get(), currentFenceValue));
+        HRESULT hr = m_commandQueue->Signal(m_fence.Get(), currentFenceValue);
+
+        if (FAILED(hr)) [[unlikely]]
+            return hr;
 
         ++m_fenceValue;
 
         if (m_fence->GetCompletedValue() < currentFenceValue)
         {
-            ThrowIfFailed(m_fence->SetEventOnCompletion(currentFenceValue, m_fenceEvent));
+            hr = m_fence->SetEventOnCompletion(currentFenceValue, m_fenceEvent);
+
+            if (FAILED(hr)) [[unlikely]]
+                return hr;
+
             WaitForSingleObject(m_fenceEvent, INFINITE);
         }
 
-        m_currentBackBufferIndex = m_swapChain->GetCurrentBackBufferIndex();
+        for (const auto& surface : m_surfaces)
+        {
+            if (surface)
+                surface->UpdateBackBufferIndex();
+        }
+
+        return S_OK;
+    }
+
+    GraphicsSystem::FrameResult GraphicsSystem::OnFrameFailure(HRESULT hResult)
+    {
+        if (!IsDeviceLost(hResult))
+            ThrowHResultError(hResult);
+
+        const HRESULT reason = m_device->GetDeviceRemovedReason();
+
+        g_deviceLosses.Add(1);
+
+        Debug::WriteLine("Device lost with HRESULT {:#010x}, reason {:#010x}",
+                         static_cast<std::uint32_t>(hResult), static_cast<std::uint32_t>(reason));
+
+        return FrameResult::DeviceLost;
     }
 }
@@ -3,72 +3,286 @@
 #include "WindowsPlatform.hpp"
 
 #include "ComPtr.hpp"
+#include "DrawQueue.hpp"
+#include "DynamicResolution.hpp"
+#include "ReadbackImage.hpp"
 
 #include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <vector>
 
 interface IDXGIFactory6;
+interface IDXGIAdapter3;
 interface ID3D12Device;
 interface ID3D12CommandQueue;
-interface IDXGISwapChain3;
 interface ID3D12Fence;
-interface ID3D12DescriptorHeap;
-interface ID3D12CommandAllocator;
+interface ID3D12CommandList;
 interface ID3D12GraphicsCommandList;
 interface ID3D12PipelineState;
+interface ID3D12RootSignature;
 interface ID3D12Resource;
 
 namespace DXSandbox
 {
+    class BindlessDescriptorTable;
+    class CommandCapture;
+    class FrameArena;
+    class FrameReadback;
+    class GpuProfiler;
+    class GpuMemoryAllocator;
+    class HudRenderer;
+    class PerfHud;
+    class ResidencyManager;
+    class TextLayout;
+    class TraceRecorder;
+    class UploadRing;
+    class Upscaler;
     class Window;
+    class WindowSurface;
 
     class GraphicsSystem final
     {
     public:
         struct InitParams final
+        {
+            bool enableDebugLayer = false;
+
+            // Disabled to measure frame times not bound by the display
+            bool isVSyncEnabled = true;
+
+            // Times the GPU work of the frames rendered with a trace, on a
+            // GPU track of that trace
+            bool enableGpuProfiler = false;
+
+            // Renders the main window to an internal target at the scale
+            // holding the target frame time, and upscales it to the window.
+            // The frames are timed on the GPU for the controller.
+            std::optional<DynamicResolution::Params> dynamicResolution;
+
+            // Shows the performance overlay over the main window from the
+            // start; it can be toggled later either way
+            bool showHud = false;
+
+            // Receives the timing of each initialization step
+            TraceRecorder* trace = nullptr;
+        };
+
+        // Per-frame failures are returned rather than thrown. A lost device
+        // cannot render anymore, and the system has to be recreated.
+        enum class [[nodiscard]] FrameResult : std::uint8_t
+        {
+            Presented,
+            Occluded,   // Nothing of the window is visible
+            DeviceLost
+        };
+
+        struct SwapChainParams final
         {
             HWND hWnd = nullptr;
             UINT width = 0;
             UINT height = 0;
 
-            bool enableDebugLayer = false;
+            // Renders the window every nth frame
+            UINT presentInterval = 1;
         };
 
+        // Creates the device level objects, which do not need a window, so
+        // the window can be created concurrently
         explicit GraphicsSystem(const InitParams& params);
         ~GraphicsSystem();
 
-        void Render();
+        // Must be called before Render. Any thread may attach a window
+        // whose own thread keeps pumping messages, which creating the swap
+        // chain sends to it. Every window renders through the same device,
+        // queue and frame. The first one attached is the main window: its
+        // frames are read back, and only its presents wait for vertical sync.
+        std::uint32_t AttachWindow(const SwapChainParams& params);
+        void DetachWindow(std::uint32_t surface);
+
+        // Zero sizes, as reported for minimized windows, are ignored. False
+        // when the device was lost, like Render; other failures throw.
+        [[nodiscard]] bool Resize(std::uint32_t surface, UINT width, UINT height);
+
+        // Records the due windows into one submission and presents them one
+        // after the other. Occluded reports the main window; other occluded
+        // windows only make test presents until they are visible again.
+        // The trace receives the time spent in each step of the frame.
+        FrameResult Render(TraceRecorder* trace = nullptr);
+
+        // Checks whether the main window is still occluded, without presenting
+        FrameResult TestPresent();
+
+        // Draws submitted here are sorted and recorded by the next Render
+        DrawQueue& Draws() noexcept;
+
+        // Mirrors the commands recorded for the windows into the capture,
+        // one frame per Render, until reset to null. Cached lists are
+        // recorded again meanwhile.
+        void SetCommandCapture(CommandCapture* capture) noexcept;
+
+        std::uint32_t RegisterRootSignature(ComPtr<ID3D12RootSignature> rootSignature);
+        std::uint32_t RegisterPipelineState(ComPtr<ID3D12PipelineState> pipelineState);
+
+        // Swaps the pipeline state used by draws with the index, for hot
+        // reloads between frames; the old one is retired
+        void ReplacePipelineState(std::uint32_t index, ComPtr<ID3D12PipelineState> pipelineState);
+
+        // Keeps the object alive until the GPU has finished every frame that
+        // may still reference it
+        void Retire(ComPtr<IUnknown> object);
+
+        // Placed-resource allocators for buffers and non render target
+        // textures. Their heaps are kept within the video memory budget;
+        // resources must be marked used by the frames using them.
+        GpuMemoryAllocator& BufferAllocator() noexcept;
+        GpuMemoryAllocator& TextureAllocator() noexcept;
+
+        // Views of textures and buffers registered once; draws pass the
+        // index of a handle as their material. Handles are released with
+        // the fence value of the last frame using them.
+        BindlessDescriptorTable& BindlessDescriptors() noexcept;
+
+        // Fence value signaled once the frame being recorded completes
+        UINT64 FrameFenceValue() const noexcept;
+
+        // Scratch memory valid until the GPU retires the current frame
+        FrameArena& FrameScratch() noexcept;
+
+        // Upload memory valid until the GPU retires the current frame
+        UploadRing& FrameUploads() noexcept;
+
+        // The overlay of the frame rate, frame times, memory use and queue
+        // depths, drawn over the main window. Its lists are recorded again
+        // every frame while it is shown.
+        void SetHudVisible(bool isVisible) noexcept;
+        bool IsHudVisible() const noexcept;
+
+        // Copies the next rendered frame to the CPU and hands it to the
+        // handler on a worker thread, without stalling the render thread.
+        // Requests are dropped when every readback slot is in use.
+        void RequestReadback(ReadbackHandler handler);
 
     private:
         void CreateFactory(bool enableDebug);
         void CreateDevice();
         void CreateCommandQueue();
-        void CreateSwapChain(const InitParams& params);
-        void CreateCommandList();
         void CreateFence();
+        void CreateMemoryAllocators();
+        void CreateFrameArenas();
+        void CreateFrameReadback();
+        void CreateBindlessDescriptors();
+        void CreateUploadRing();
+        void CreateHud();
+        void CreateGpuProfiler();
+        void CreateUpscaler(const DynamicResolution::Params& params);
+
+        void AdvanceFrameArena();
+        void ReleaseRetiredObjects(UINT64 completedFenceValue) noexcept;
+
+        WindowSurface* MainSurface() const noexcept;
+
+        // Replays the list cached for the back buffer when the frame content
+        // is unchanged, records it again otherwise
+        [[nodiscard]] HRESULT PopulateCommandList(WindowSurface& surface, bool isMainSurface,
+                                                  std::uint64_t contentKey, GpuProfiler* profiler,
+                                                  ID3D12GraphicsCommandList*& commandList);
+        std::uint64_t FrameContentKey() const noexcept;
+
+        // The view and size draws are recorded to
+        struct RenderTarget;
+
+        static void BindRenderTarget(const RenderTarget& target, ID3D12GraphicsCommandList* commandList);
+        void RecordDraws(const RenderTarget& target, ID3D12GraphicsCommandList* commandList);
+        void UpdateRenderScale(std::chrono::steady_clock::duration cpuFrameTime);
+        void UpdateHud();
+        bool RecordReadback(const WindowSurface& surface, ID3D12GraphicsCommandList* commandList);
+
+        // Index of the target in the capture, zero when not capturing
+        std::uint32_t CaptureTarget(ID3D12Resource* resource, UINT width, UINT height);
+        void UpdateWindowCounters(std::chrono::steady_clock::duration windowTime,
+                                  std::size_t presentedCount) const noexcept;
+        [[nodiscard]] HRESULT WaitForPreviousFrame();
 
-        void PopulateCommandList();
-        void WaitForPreviousFrame();
+        // Cold path of Render; throws unless the device was lost
+        __declspec(noinline) FrameResult OnFrameFailure(HRESULT hResult);
 
     private:
         ComPtr<IDXGIFactory6> m_factory;
+        ComPtr<IDXGIAdapter3> m_adapter;
         ComPtr<ID3D12Device> m_device;
         ComPtr<ID3D12CommandQueue> m_commandQueue;
-        ComPtr<IDXGISwapChain3> m_swapChain;
         ComPtr<ID3D12Fence> m_fence;
-        ComPtr<ID3D12DescriptorHeap> m_rtvHeap;
-        ComPtr<ID3D12CommandAllocator> m_commandAllocator;
-        ComPtr<ID3D12GraphicsCommandList> m_commandList;
         ComPtr<ID3D12PipelineState> m_pipelineState;
 
         HANDLE m_fenceEvent = nullptr;
         UINT64 m_fenceValue = 0;
 
-        UINT m_rtvDescriptorSize = 0;
+        UINT m_syncInterval = 1;
 
         static constexpr UINT BackBufferCount = 2;
 
-        std::array<ComPtr<ID3D12Resource>, BackBufferCount> m_backBuffers;
+        // Indexed by surface id; detached windows leave an empty slot
+        std::vector<std::unique_ptr<WindowSurface>> m_surfaces;
+
+        std::uint64_t m_frameIndex = 0;
+
+        // Bumped when a pipeline state is replaced, which the draw packets
+        // referencing it by index do not show
+        std::uint64_t m_pipelineStateGeneration = 0;
+
+        DrawQueue m_drawQueue;
+
+        std::vector<ComPtr<ID3D12RootSignature>> m_rootSignatures;
+        std::vector<ComPtr<ID3D12PipelineState>> m_pipelineStates;
+
+        struct RetiredObject final
+        {
+            UINT64 fenceValue = 0;
+            ComPtr<IUnknown> object;
+        };
+
+        std::deque<RetiredObject> m_retiredObjects;
+
+        // Outlives the allocators, whose heaps it tracks
+        std::unique_ptr<ResidencyManager> m_residency;
+
+        std::unique_ptr<GpuMemoryAllocator> m_bufferAllocator;
+        std::unique_ptr<GpuMemoryAllocator> m_textureAllocator;
+
+        static constexpr std::size_t FrameArenaCapacity = 4 * 1024 * 1024;
+
+        std::array<std::unique_ptr<FrameArena>, BackBufferCount> m_frameArenas;
+        std::array<UINT64, BackBufferCount> m_frameArenaFenceValues = {};
+        std::size_t m_frameArenaIndex = 0;
+
+        std::unique_ptr<FrameReadback> m_frameReadback;
+        std::unique_ptr<BindlessDescriptorTable> m_bindlessDescriptors;
+
+        static constexpr UINT64 UploadRingCapacity = 1024 * 1024;
+
+        std::unique_ptr<UploadRing> m_uploadRing;
+
+        // The renderer holds views in the bindless table, and the layout
+        // refers to the atlas of the renderer
+        std::unique_ptr<HudRenderer> m_hudRenderer;
+        std::unique_ptr<TextLayout> m_hudLayout;
+        std::unique_ptr<PerfHud> m_perfHud;
+        bool m_isHudVisible = false;
+
+        std::unique_ptr<GpuProfiler> m_gpuProfiler;
+
+        std::unique_ptr<DynamicResolution> m_dynamicResolution;
+        std::unique_ptr<Upscaler> m_upscaler;
+
+        // Set when the previous frame has completed; the CPU time of a frame
+        // runs from there until its presents
+        std::optional<std::chrono::steady_clock::time_point> m_cpuFrameStart;
+        std::vector<ReadbackHandler> m_readbackRequests;
 
-        UINT m_currentBackBufferIndex = 0;
+        CommandCapture* m_commandCapture = nullptr;
     };
 }
@@ -5,23 +5,27 @@
 #include <format>
 #include <type_traits>
 
-namespace
+namespace DXSandbox
 {
-    inline std::string HResultToString(HRESULT hResult)
+    HResultException::HResultException(HRESULT error) noexcept
+        : m_hResult{error}
     {
-        using UHR = std::make_unsigned_t<HRESULT>;
-        const auto value = std::bit_cast<UHR>(hResult);
-
-        return std::format("HRESULT: {:#010x}", value);
+        assert(FAILED(m_hResult));
     }
-}
 
-namespace DXSandbox
-{
-    HResultException::HResultException(HRESULT error)
-        : std::runtime_error{HResultToString(error)}
-        , m_hResult{error}
+    const char* HResultException::what() const noexcept
     {
-        assert(FAILED(m_hResult));
+        static constexpr std::size_t MaxMessageLength = 32;
+
+        thread_local char message[MaxMessageLength + 1];
+
+        using UHR = std::make_unsigned_t<HRESULT>;
+        const auto value = std::bit_cast<UHR>(m_hResult);
+
+        const auto result = std::format_to_n(message, MaxMessageLength, "HRESULT: {:#010x}", value);
+
+        *result.out = '\0';
+
+        return message;
     }
 }
@@ -2,11 +2,13 @@
 
 #include "WindowsPlatform.hpp"
 
-#include <stdexcept>
+#include <exception>
 
 namespace DXSandbox
 {
-    class [[nodiscard]] HResultException final : public std::runtime_error
+    // Holds only the error code; the message is formatted when asked for,
+    // so throwing does not allocate
+    class [[nodiscard]] HResultException final : public std::exception
     {
     public:
         static HResultException FromLastError()
@@ -21,8 +23,11 @@ namespace DXSandbox
 
         HRESULT Result() const noexcept { return m_hResult; }
 
+        // Valid until the next call on the same thread
+        const char* what() const noexcept override;
+
     private:
-        HResultException(HRESULT error);
+        HResultException(HRESULT error) noexcept;
 
     private:
         const HRESULT m_hResult = E_FAIL;
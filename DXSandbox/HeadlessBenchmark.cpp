@@ -0,0 +1,237 @@
+#include "HeadlessBenchmark.hpp"
+
+#include "AllocationTracking.hpp"
+#include "Benchmark.hpp"
+#include "CommandCapture.hpp"
+#include "CommandLineArgs.hpp"
+#include "DrawQueue.hpp"
+#include "FramePipeline.hpp"
+#include "HeadlessCommandBackend.hpp"
+#include "SceneStore.hpp"
+#include "TraceRecorder.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <span>
+#include <utility>
+
+namespace
+{
+    constexpr std::uint32_t Width = 1920;
+    constexpr std::uint32_t Height = 1080;
+
+    constexpr int BenchmarkFailedExitCode = 1;
+
+    constexpr const char* DefaultComparisonOutputPath = "LoopComparison.tsv";
+    constexpr const char* ComparisonHeader = "loop\tframes\taverage_latency_us\taverage_frame_us\tframes_per_second";
+
+    // The commands GraphicsSystem records for the main window, without the
+    // scaled target and the overlay
+    void RecordFrame(std::span<const DXSandbox::DrawPacket> sortedPackets, std::uint32_t backBuffer,
+                     DXSandbox::ICommandBackend& backend)
+    {
+        using DXSandbox::ResourceState;
+
+        static constexpr std::array<float, 4> ClearColor = {0.0f, 0.2f, 0.4f, 1.0f};
+
+        backend.BeginList();
+        backend.Barrier(backBuffer, ResourceState::Present, ResourceState::RenderTarget);
+        backend.Clear(backBuffer, Width, Height, ClearColor);
+        backend.SetRenderTarget(backBuffer, Width, Height);
+
+        static constexpr std::uint32_t None = std::numeric_limits<std::uint32_t>::max();
+
+        std::uint32_t rootSignature = None;
+        std::uint32_t pipelineState = None;
+        std::uint32_t material = None;
+
+        for (const DXSandbox::DrawPacket& packet : sortedPackets)
+        {
+            if (packet.rootSignature != rootSignature)
+            {
+                rootSignature = packet.rootSignature;
+                material = None;
+
+                backend.SetRootSignature(rootSignature);
+            }
+
+            if (packet.pipelineState != pipelineState)
+            {
+                pipelineState = packet.pipelineState;
+
+                backend.SetPipelineState(pipelineState);
+            }
+
+            if (packet.material != material)
+            {
+                material = packet.material;
+
+                backend.SetMaterial(material);
+            }
+
+            backend.Draw(
+            {
+                .vertexCount = packet.vertexCount,
+                .instanceCount = packet.instanceCount,
+                .startVertex = packet.startVertex,
+                .startInstance = packet.startInstance
+            });
+        }
+
+        backend.Barrier(backBuffer, ResourceState::RenderTarget, ResourceState::Present);
+    }
+
+    struct RunResult final
+    {
+        DXSandbox::FramePipeline::Statistics frames;
+        DXSandbox::HeadlessCommandBackend::Statistics commands;
+    };
+
+    RunResult RunFrames(DXSandbox::Benchmark& benchmark, bool isPipelined)
+    {
+        using namespace DXSandbox;
+
+        SceneStore scene;
+
+        benchmark.PopulateScene(scene);
+
+        // Only gives the backend the tables a capture would have
+        CommandCapture tables;
+
+        const std::uint32_t backBuffer = tables.TargetIndex(&tables, Width, Height);
+
+        tables.SetStateCounts(Benchmark::RootSignatureCount, Benchmark::PipelineStateCount);
+
+        HeadlessCommandBackend backend{tables};
+        DrawQueue drawQueue;
+
+        // Owns the scene on the update thread until destroyed, before it
+        auto update = [&](FrameSnapshot& snapshot)
+        {
+            benchmark.AnimateScene(scene, snapshot.frameIndex);
+
+            scene.UpdateTransforms();
+
+            const auto worldTransforms = scene.WorldTransforms();
+
+            snapshot.worldTransforms.assign(worldTransforms.begin(), worldTransforms.end());
+        };
+
+        FramePipeline framePipeline{std::move(update), isPipelined};
+
+        while (!benchmark.IsFinished())
+        {
+            TraceRecorder* zones = benchmark.Zones();
+
+            const FrameSnapshot* snapshot = nullptr;
+
+            {
+                const TraceScope scope{zones, "WaitForSnapshot"};
+
+                snapshot = &framePipeline.AcquireSnapshot();
+            }
+
+            {
+                const TraceScope scope{zones, "SubmitDraws"};
+
+                drawQueue.Clear();
+                benchmark.SubmitDraws(snapshot->worldTransforms, drawQueue);
+                drawQueue.Sort();
+            }
+
+            {
+                const TraceScope scope{zones, "RecordCommands"};
+
+                RecordFrame(drawQueue.SortedPackets(), backBuffer, backend);
+            }
+
+            framePipeline.OnFrameRendered(*snapshot);
+
+            AllocationTracking::EndFrame();
+
+            benchmark.OnFrameRendered();
+        }
+
+        return {.frames = framePipeline.Stats(), .commands = backend.Stats()};
+    }
+
+    inline double ToMicroseconds(DXSandbox::FrameSnapshot::Clock::duration duration) noexcept
+    {
+        return std::chrono::duration<double, std::micro>(duration).count();
+    }
+}
+
+namespace DXSandbox
+{
+    int RunHeadlessBenchmark(const CommandLineArgs& args)
+    {
+        Benchmark benchmark{Benchmark::ParseParams(args)};
+
+        const RunResult result = RunFrames(benchmark, !args.Contains("--singleThreadedLoop"));
+
+        std::cout << std::format("Recorded {} draws in {} command lists, {} state changes\n",
+                                 result.commands.draws, result.commands.lists, result.commands.stateChanges);
+
+        // The report is written either way, with the limits it exceeds
+        const bool isPassed = benchmark.WriteReport();
+
+        if (result.commands.validationErrors > 0)
+        {
+            std::cerr << std::format("The headless backend rejected {} commands\n",
+                                     result.commands.validationErrors);
+            return BenchmarkFailedExitCode;
+        }
+
+        return isPassed ? 0 : BenchmarkFailedExitCode;
+    }
+
+    int RunLoopComparison(const CommandLineArgs& args)
+    {
+        const auto outputPath = args.Value("--loopComparisonOutput").value_or(DefaultComparisonOutputPath);
+
+        std::ofstream file{args.PathValue("--loopComparisonOutput").value_or(DefaultComparisonOutputPath),
+                           std::ios::trunc};
+
+        file << ComparisonHeader << '\n';
+
+        for (const bool isPipelined : {true, false})
+        {
+            // Without a report, so the limits do not apply
+            Benchmark benchmark{Benchmark::ParseParams(args)};
+
+            const RunResult result = RunFrames(benchmark, isPipelined);
+
+            if (result.commands.validationErrors > 0)
+            {
+                std::cerr << std::format("The headless backend rejected {} commands\n",
+                                         result.commands.validationErrors);
+                return BenchmarkFailedExitCode;
+            }
+
+            const char* loop = isPipelined ? "pipelined" : "single_threaded";
+
+            const double latency = ToMicroseconds(result.frames.averageLatency);
+            const double frameTime = ToMicroseconds(result.frames.averageFrameTime);
+            const double framesPerSecond = frameTime > 0.0 ? 1'000'000.0 / frameTime : 0.0;
+
+            std::cout << std::format("{} loop: {:.1f} us latency, {:.1f} us per frame, {:.0f} frames/s\n",
+                                     loop, latency, frameTime, framesPerSecond);
+
+            file << loop << '\t' << result.frames.frames << '\t' << latency << '\t' << frameTime << '\t'
+                 << framesPerSecond << '\n';
+        }
+
+        if (!file)
+        {
+            std::cerr << "Failed to write the loop comparison to " << outputPath << '\n';
+            return BenchmarkFailedExitCode;
+        }
+
+        return 0;
+    }
+}
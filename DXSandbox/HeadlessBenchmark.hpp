@@ -0,0 +1,20 @@
+#pragma once
+
+namespace DXSandbox
+{
+    class CommandLineArgs;
+
+    // The --benchmark run without a window or a device: the benchmark scene
+    // is animated on the frame pipeline, its draws are sorted and recorded
+    // through the headless backend, and the same report is written. Limits
+    // exceeded and commands the backend rejects make the returned exit code
+    // nonzero. --singleThreadedLoop runs the update inline, as in the
+    // application.
+    int RunHeadlessBenchmark(const CommandLineArgs& args);
+
+    // Runs the frames of the headless benchmark on the pipelined loop and
+    // then on the single-threaded one, and writes the average latency from
+    // update to recorded frame and the average frame time of each, warm-up
+    // frames included, to --loopComparisonOutput (LoopComparison.tsv)
+    int RunLoopComparison(const CommandLineArgs& args);
+}
@@ -0,0 +1,14 @@
+#include "CommandLineArgs.hpp"
+#include "HeadlessBenchmark.hpp"
+
+// The benchmark alone, without a window or a device, so it runs on any
+// platform
+int main(int argc, char* argv[])
+{
+    const DXSandbox::CommandLineArgs args{argc, argv};
+
+    if (args.Contains("--compareLoops"))
+        return DXSandbox::RunLoopComparison(args);
+
+    return DXSandbox::RunHeadlessBenchmark(args);
+}
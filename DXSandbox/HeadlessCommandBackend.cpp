@@ -0,0 +1,164 @@
+#include "HeadlessCommandBackend.hpp"
+
+namespace DXSandbox
+{
+    HeadlessCommandBackend::HeadlessCommandBackend(const CommandCapture& capture)
+        : m_targets{capture.Targets().begin(), capture.Targets().end()}
+        , m_targetStates(m_targets.size())
+        , m_rootSignatureCount{capture.RootSignatureCount()}
+        , m_pipelineStateCount{capture.PipelineStateCount()}
+    {
+    }
+
+    void HeadlessCommandBackend::BeginList()
+    {
+        m_boundTarget = None;
+        m_rootSignature = None;
+        m_pipelineState = None;
+
+        ++m_stats.lists;
+    }
+
+    void HeadlessCommandBackend::Barrier(std::uint32_t target, ResourceState before, ResourceState after)
+    {
+        if (!ExpectState(target, before))
+            return;
+
+        m_targetStates[target] = after;
+
+        if (m_boundTarget == target && after != ResourceState::RenderTarget)
+            m_boundTarget = None;
+    }
+
+    void HeadlessCommandBackend::SetRenderTarget(std::uint32_t target, std::uint32_t width, std::uint32_t height)
+    {
+        if (!FitsTarget(target, width, height) || !ExpectState(target, ResourceState::RenderTarget))
+        {
+            m_boundTarget = None;
+            return;
+        }
+
+        m_boundTarget = target;
+    }
+
+    void HeadlessCommandBackend::Clear(std::uint32_t target, std::uint32_t width, std::uint32_t height,
+                                       const std::array<float, 4>& /*color*/)
+    {
+        if (!FitsTarget(target, width, height) || !ExpectState(target, ResourceState::RenderTarget))
+            return;
+
+        m_stats.clearedPixels += std::uint64_t{width} * height;
+    }
+
+    void HeadlessCommandBackend::SetRootSignature(std::uint32_t rootSignature)
+    {
+        if (rootSignature >= m_rootSignatureCount) [[unlikely]]
+        {
+            ++m_stats.validationErrors;
+            return;
+        }
+
+        m_rootSignature = rootSignature;
+
+        ++m_stats.stateChanges;
+    }
+
+    void HeadlessCommandBackend::SetPipelineState(std::uint32_t pipelineState)
+    {
+        if (pipelineState >= m_pipelineStateCount) [[unlikely]]
+        {
+            ++m_stats.validationErrors;
+            return;
+        }
+
+        m_pipelineState = pipelineState;
+
+        ++m_stats.stateChanges;
+    }
+
+    void HeadlessCommandBackend::SetMaterial(std::uint32_t /*material*/)
+    {
+        // Root constants need the root signature they belong to
+        if (m_rootSignature == None) [[unlikely]]
+        {
+            ++m_stats.validationErrors;
+            return;
+        }
+
+        ++m_stats.stateChanges;
+    }
+
+    void HeadlessCommandBackend::Draw(const DrawArgs& args)
+    {
+        if (m_boundTarget == None || m_rootSignature == None || m_pipelineState == None) [[unlikely]]
+        {
+            ++m_stats.validationErrors;
+            return;
+        }
+
+        ++m_stats.draws;
+        m_stats.vertices += std::uint64_t{args.vertexCount} * args.instanceCount;
+    }
+
+    void HeadlessCommandBackend::Upscale(std::uint32_t source, std::uint32_t width, std::uint32_t height)
+    {
+        if (m_boundTarget == None || !FitsTarget(source, width, height)) [[unlikely]]
+        {
+            ++m_stats.validationErrors;
+            return;
+        }
+
+        // The pass binds its own pipeline
+        m_rootSignature = None;
+        m_pipelineState = None;
+
+        const CommandCapture::Target& output = m_targets[m_boundTarget];
+
+        m_stats.upscaledPixels += std::uint64_t{output.width} * output.height;
+    }
+
+    void HeadlessCommandBackend::CopyToReadback(std::uint32_t source)
+    {
+        ExpectState(source, ResourceState::CopySource);
+    }
+
+    const HeadlessCommandBackend::Statistics& HeadlessCommandBackend::Stats() const noexcept
+    {
+        return m_stats;
+    }
+
+    bool HeadlessCommandBackend::ExpectState(std::uint32_t target, ResourceState state) noexcept
+    {
+        if (target >= m_targetStates.size()) [[unlikely]]
+        {
+            ++m_stats.validationErrors;
+            return false;
+        }
+
+        std::optional<ResourceState>& current = m_targetStates[target];
+
+        if (!current)
+            current = state;
+
+        if (*current != state) [[unlikely]]
+        {
+            ++m_stats.validationErrors;
+            return false;
+        }
+
+        return true;
+    }
+
+    bool HeadlessCommandBackend::FitsTarget(std::uint32_t target, std::uint32_t width,
+                                            std::uint32_t height) noexcept
+    {
+        if (target >= m_targets.size() || width > m_targets[target].width || height > m_targets[target].height)
+            [[unlikely]]
+        {
+            ++m_stats.validationErrors;
+            return false;
+        }
+
+        return true;
+    }
+}
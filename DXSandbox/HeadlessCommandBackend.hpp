@@ -0,0 +1,74 @@
+#pragma once
+
+#include "CommandCapture.hpp"
+#include "ICommandBackend.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace DXSandbox
+{
+    // Executes command streams on the CPU alone: it tracks what is bound
+    // and the state of every target, and counts the commands that the GPU
+    // would have rejected or that would have drawn nothing. Replaying a
+    // capture through it measures the cost of the submission side with no
+    // device, on any platform.
+    class HeadlessCommandBackend final : public ICommandBackend
+    {
+    public:
+        struct Statistics final
+        {
+            std::uint64_t lists = 0;
+            std::uint64_t draws = 0;
+            std::uint64_t vertices = 0;
+            std::uint64_t stateChanges = 0;
+            std::uint64_t clearedPixels = 0;
+            std::uint64_t upscaledPixels = 0;
+
+            // Commands referencing missing objects, draws without a
+            // pipeline or target, and barriers from a state the target is
+            // not in
+            std::uint64_t validationErrors = 0;
+        };
+
+        explicit HeadlessCommandBackend(const CommandCapture& capture);
+
+        void BeginList() override;
+        void Barrier(std::uint32_t target, ResourceState before, ResourceState after) override;
+        void SetRenderTarget(std::uint32_t target, std::uint32_t width, std::uint32_t height) override;
+        void Clear(std::uint32_t target, std::uint32_t width, std::uint32_t height,
+                   const std::array<float, 4>& color) override;
+        void SetRootSignature(std::uint32_t rootSignature) override;
+        void SetPipelineState(std::uint32_t pipelineState) override;
+        void SetMaterial(std::uint32_t material) override;
+        void Draw(const DrawArgs& args) override;
+        void Upscale(std::uint32_t source, std::uint32_t width, std::uint32_t height) override;
+        void CopyToReadback(std::uint32_t source) override;
+
+        const Statistics& Stats() const noexcept;
+
+    private:
+        // A target is first assumed to be in the state it is used in
+        bool ExpectState(std::uint32_t target, ResourceState state) noexcept;
+        bool FitsTarget(std::uint32_t target, std::uint32_t width, std::uint32_t height) noexcept;
+
+    private:
+        static constexpr std::uint32_t None = ~std::uint32_t{0};
+
+        std::vector<CommandCapture::Target> m_targets;
+
+        // Unknown until first used, as captures start in the middle of the
+        // life of their targets
+        std::vector<std::optional<ResourceState>> m_targetStates;
+
+        std::uint32_t m_rootSignatureCount = 0;
+        std::uint32_t m_pipelineStateCount = 0;
+
+        std::uint32_t m_boundTarget = None;
+        std::uint32_t m_rootSignature = None;
+        std::uint32_t m_pipelineState = None;
+
+        Statistics m_stats;
+    };
+}
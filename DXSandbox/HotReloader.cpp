@@ -0,0 +1,104 @@
+#include "HotReloader.hpp"
+
+#include "Debug.hpp"
+#include "Instrumentation.hpp"
+#include "StringUtils.hpp"
+
+#include <cassert>
+#include <exception>
+#include <vector>
+
+namespace
+{
+    using DXSandbox::Instrumentation::Counter;
+
+    Counter g_changedFiles{"HotReload.ChangedFiles"};
+    Counter g_rebuilds{"HotReload.Rebuilds"};
+    Counter g_failedRebuilds{"HotReload.FailedRebuilds"};
+
+    inline std::string SourceName(const std::filesystem::path& path)
+    {
+        return DXSandbox::StringUtils::UTF16ToUTF8(path.lexically_normal().wstring());
+    }
+}
+
+namespace DXSandbox
+{
+    HotReloader::HotReloader(const std::filesystem::path& directory)
+        : m_watcher{directory}
+    {
+    }
+
+    void HotReloader::Register(const std::string& artifact,
+                               std::span<const std::filesystem::path> sources,
+                               RebuildFunction rebuild)
+    {
+        assert(rebuild);
+
+        m_dependencies.ClearDependencies(artifact);
+
+        for (const std::filesystem::path& source : sources)
+            m_dependencies.AddDependency(artifact, SourceName(m_watcher.Directory() / source));
+
+        m_rebuilds[artifact] = std::move(rebuild);
+    }
+
+    void HotReloader::AddDependency(const std::string& artifact, const std::string& dependency)
+    {
+        assert(m_rebuilds.contains(artifact) && m_rebuilds.contains(dependency));
+
+        m_dependencies.AddDependency(artifact, dependency);
+    }
+
+    void HotReloader::Unregister(const std::string& artifact)
+    {
+        m_dependencies.Remove(artifact);
+        m_rebuilds.erase(artifact);
+    }
+
+    std::size_t HotReloader::Update()
+    {
+        const std::vector<std::filesystem::path> changedFiles = m_watcher.Poll();
+
+        if (changedFiles.empty())
+            return 0;
+
+        g_changedFiles.Add(static_cast<std::int64_t>(changedFiles.size()));
+
+        std::vector<std::string> changed;
+        changed.reserve(changedFiles.size());
+
+        for (const std::filesystem::path& file : changedFiles)
+            changed.push_back(SourceName(file));
+
+        std::size_t rebuiltCount = 0;
+
+        // Source files are nodes too, but only artifacts have rebuilds
+        for (const std::string& node : m_dependencies.Dependents(changed))
+        {
+            const auto found = m_rebuilds.find(node);
+
+            if (found == m_rebuilds.end())
+                continue;
+
+            // Rebuilds may register again, for example with new includes
+            const RebuildFunction rebuild = found->second;
+
+            try
+            {
+                rebuild();
+                ++rebuiltCount;
+            }
+            catch (const std::exception& e)
+            {
+                g_failedRebuilds.Add(1);
+
+                Debug::WriteLine("Hot reload of {} failed: {}", node, e.what());
+            }
+        }
+
+        g_rebuilds.Add(static_cast<std::int64_t>(rebuiltCount));
+
+        return rebuiltCount;
+    }
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "DependencyGraph.hpp"
+#include "FileWatcher.hpp"
+
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <span>
+#include <string>
+#include <unordered_map>
+
+namespace DXSandbox
+{
+    // Rebuilds artifacts (pipeline states, textures, ...) whose source files
+    // changed on disk. Update runs the rebuild functions on the calling
+    // thread, so when it is called between frames they can swap GPU objects
+    // in place and hand the old ones to GraphicsSystem::Retire.
+    class HotReloader final
+    {
+    public:
+        // Creates the new version of the artifact and swaps it in; throwing
+        // keeps the previous version
+        using RebuildFunction = std::function<void()>;
+
+        explicit HotReloader(const std::filesystem::path& directory);
+
+        HotReloader(const HotReloader&) = delete;
+        HotReloader& operator = (const HotReloader&) = delete;
+
+        // Sources are relative to the watched directory. Registering an
+        // artifact again replaces its sources and rebuild function.
+        void Register(const std::string& artifact,
+                      std::span<const std::filesystem::path> sources,
+                      RebuildFunction rebuild);
+
+        // The artifact is rebuilt after the other one whenever it is
+        void AddDependency(const std::string& artifact, const std::string& dependency);
+
+        void Unregister(const std::string& artifact);
+
+        // Rebuilds only the artifacts affected by files changed since the
+        // previous call, dependencies first; returns how many were rebuilt
+        std::size_t Update();
+
+    private:
+        FileWatcher m_watcher;
+        DependencyGraph m_dependencies;
+        std::unordered_map<std::string, RebuildFunction> m_rebuilds;
+    };
+}
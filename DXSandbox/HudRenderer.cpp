@@ -0,0 +1,465 @@
+#include "HudRenderer.hpp"
+
+#include "Debug.hpp"
+#include "ErrorHandling.hpp"
+#include "UploadRing.hpp"
+
+#include <d3dcompiler.h>
+
+#include <algorithm>
+#include <cassert>
+#include <climits>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    // Each instance is one quad, expanded from a triangle strip of four
+    // vertices. Coverage is sampled from the atlas and scales the alpha of
+    // the quad color.
+    constexpr std::string_view HudShader = R"(
+        Texture2D<float> g_atlas : register(t0);
+        SamplerState g_sampler : register(s0);
+
+        cbuffer Constants : register(b0)
+        {
+            float2 g_pixelToClip;
+        };
+
+        struct Quad
+        {
+            float4 rect : RECT;
+            float4 uvRect : UVRECT;
+            float4 color : COLOR;
+        };
+
+        struct Interpolants
+        {
+            float4 position : SV_Position;
+            float2 uv : TEXCOORD0;
+            float4 color : COLOR;
+        };
+
+        Interpolants VSMain(Quad quad, uint vertexId : SV_VertexID)
+        {
+            const float2 corner = float2(vertexId & 1, vertexId >> 1);
+            const float2 position = lerp(quad.rect.xy, quad.rect.zw, corner);
+
+            Interpolants output;
+            output.position = float4(position * g_pixelToClip + float2(-1.0, 1.0), 0.0, 1.0);
+            output.uv = lerp(quad.uvRect.xy, quad.uvRect.zw, corner);
+            output.color = quad.color;
+
+            return output;
+        }
+
+        float4 PSMain(Interpolants input) : SV_Target
+        {
+            const float coverage = g_atlas.SampleLevel(g_sampler, input.uv, 0.0);
+
+            return float4(input.color.rgb, input.color.a * coverage);
+        }
+    )";
+
+    struct HudConstants final
+    {
+        float pixelToClip[2];
+    };
+
+    constexpr const wchar_t* FontFace = L"Consolas";
+    constexpr int FontPixelHeight = 14;
+
+    constexpr std::uint32_t AtlasWidth = 256;
+    constexpr std::uint32_t AtlasHeight = 128;
+
+    DXSandbox::ComPtr<ID3DBlob> CompileShader(const char* entryPoint, const char* target)
+    {
+        DXSandbox::ComPtr<ID3DBlob> code;
+        DXSandbox::ComPtr<ID3DBlob> errors;
+
+        const HRESULT hr = D3DCompile(HudShader.data(), HudShader.size(), "Hud", nullptr, nullptr,
+                                      entryPoint, target, D3DCOMPILE_OPTIMIZATION_LEVEL3, 0, &code, &errors);
+
+        if (FAILED(hr) && errors)
+            DXSandbox::Debug::WriteLine(std::string_view{static_cast<const char*>(errors->GetBufferPointer())});
+
+        DXSandbox::ThrowIfFailed(hr);
+
+        return code;
+    }
+
+    // A memory device context with the font selected
+    struct FontContext final
+    {
+        HDC dc = nullptr;
+        HFONT font = nullptr;
+
+        FontContext(const wchar_t* faceName, int pixelHeight)
+        {
+            dc = CreateCompatibleDC(nullptr);
+
+            if (!dc)
+                DXSandbox::ThrowLastError();
+
+            font = CreateFontW(-pixelHeight, 0, 0, 0, FW_NORMAL, FALSE, FALSE, FALSE, ANSI_CHARSET,
+                               OUT_TT_PRECIS, CLIP_DEFAULT_PRECIS, ANTIALIASED_QUALITY,
+                               FIXED_PITCH | FF_MODERN, faceName);
+
+            if (!font)
+            {
+                DeleteDC(dc);
+                DXSandbox::ThrowLastError();
+            }
+
+            SelectObject(dc, font);
+        }
+
+        ~FontContext()
+        {
+            DeleteDC(dc);
+            DeleteObject(font);
+        }
+
+        FontContext(const FontContext&) = delete;
+        FontContext& operator = (const FontContext&) = delete;
+    };
+
+    DXSandbox::GlyphAtlas RasterizeFont(const wchar_t* faceName, int pixelHeight)
+    {
+        using DXSandbox::GlyphAtlas;
+
+        const FontContext context{faceName, pixelHeight};
+
+        TEXTMETRICW textMetrics = {};
+
+        if (!GetTextMetricsW(context.dc, &textMetrics))
+            DXSandbox::ThrowLastError();
+
+        GlyphAtlas atlas{AtlasWidth, AtlasHeight,
+                         static_cast<float>(textMetrics.tmHeight + textMetrics.tmExternalLeading),
+                         static_cast<float>(textMetrics.tmAscent)};
+
+        static constexpr MAT2 identity =
+        {
+            .eM11 = {.value = 1},
+            .eM22 = {.value = 1}
+        };
+
+        std::vector<BYTE> outline;
+        std::vector<std::uint8_t> coverage;
+
+        for (char character = GlyphAtlas::FirstCharacter; character <= GlyphAtlas::LastCharacter; ++character)
+        {
+            GLYPHMETRICS glyphMetrics = {};
+
+            const auto codePoint = static_cast<UINT>(character);
+
+            const DWORD size = GetGlyphOutlineW(context.dc, codePoint, GGO_GRAY8_BITMAP, &glyphMetrics,
+                                                0, nullptr, &identity);
+
+            if (size == GDI_ERROR)
+                continue;
+
+            outline.resize(size);
+
+            if (size != 0 && GetGlyphOutlineW(context.dc, codePoint, GGO_GRAY8_BITMAP, &glyphMetrics,
+                                              size, outline.data(), &identity) == GDI_ERROR)
+            {
+                continue;
+            }
+
+            // Blank glyphs report a one texel box without a bitmap
+            const UINT width = size != 0 ? glyphMetrics.gmBlackBoxX : 0;
+            const UINT height = size != 0 ? glyphMetrics.gmBlackBoxY : 0;
+
+            // Rows are DWORD aligned, with 65 levels of coverage
+            const UINT pitch = (width + 3) & ~3u;
+
+            coverage.resize(std::size_t{width} * height);
+
+            for (UINT y = 0; y < height; ++y)
+            {
+                for (UINT x = 0; x < width; ++x)
+                {
+                    const unsigned level = std::min<unsigned>(outline[y * pitch + x], 64);
+
+                    coverage[std::size_t{y} * width + x] = static_cast<std::uint8_t>(level * 255 / 64);
+                }
+            }
+
+            const GlyphAtlas::GlyphBitmap bitmap =
+            {
+                .width = width,
+                .height = height,
+                .bearingX = glyphMetrics.gmptGlyphOrigin.x,
+                .bearingY = glyphMetrics.gmptGlyphOrigin.y,
+                .advance = static_cast<float>(glyphMetrics.gmCellIncX),
+                .coverage = coverage
+            };
+
+            if (!atlas.AddGlyph(character, bitmap))
+                DXSandbox::Debug::WriteLine("The HUD glyph atlas has no room for '{}'", character);
+        }
+
+        return atlas;
+    }
+}
+
+namespace DXSandbox
+{
+    HudRenderer::HudRenderer(ComPtr<ID3D12Device> device, DXGI_FORMAT format, BindlessDescriptorTable& descriptors)
+        : m_device{std::move(device)}
+        , m_descriptors{descriptors}
+        , m_atlas{RasterizeFont(FontFace, FontPixelHeight)}
+    {
+        assert(m_device);
+
+        CreatePipeline(format);
+        CreateAtlasTexture();
+    }
+
+    HudRenderer::~HudRenderer() = default;
+
+    const GlyphAtlas& HudRenderer::Atlas() const noexcept
+    {
+        return m_atlas;
+    }
+
+    void HudRenderer::Record(ID3D12GraphicsCommandList* commandList, UploadRing& uploadRing,
+                             std::span<const TextQuad> quads, UINT width, UINT height)
+    {
+        assert(commandList);
+
+        if (quads.empty() || width == 0 || height == 0)
+            return;
+
+        if (!m_isAtlasUploaded && !UploadAtlas(commandList, uploadRing))
+            return;
+
+        const std::optional<UploadRing::Allocation> vertices = uploadRing.Allocate(quads.size_bytes(),
+                                                                                   alignof(TextQuad));
+
+        if (!vertices) [[unlikely]]
+            return;
+
+        std::memcpy(vertices->cpuAddress, quads.data(), quads.size_bytes());
+
+        const D3D12_VERTEX_BUFFER_VIEW vertexBufferView =
+        {
+            .BufferLocation = vertices->gpuAddress,
+            .SizeInBytes = static_cast<UINT>(quads.size_bytes()),
+            .StrideInBytes = sizeof(TextQuad)
+        };
+
+        const HudConstants constants =
+        {
+            .pixelToClip = {2.0f / static_cast<float>(width), -2.0f / static_cast<float>(height)}
+        };
+
+        ID3D12DescriptorHeap* const heaps[] = {m_descriptors.Heap()};
+
+        commandList->SetDescriptorHeaps(1, heaps);
+        commandList->SetGraphicsRootSignature(m_rootSignature.Get());
+        commandList->SetPipelineState(m_pipelineState.Get());
+        commandList->SetGraphicsRoot32BitConstants(0, sizeof(constants) / sizeof(float), &constants, 0);
+        commandList->SetGraphicsRootDescriptorTable(1, m_descriptors.GpuDescriptor(m_atlasView));
+        commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+        commandList->IASetVertexBuffers(0, 1, &vertexBufferView);
+        commandList->DrawInstanced(4, static_cast<UINT>(quads.size()), 0, 0);
+    }
+
+    void HudRenderer::CreatePipeline(DXGI_FORMAT format)
+    {
+        const D3D12_DESCRIPTOR_RANGE atlasRange =
+        {
+            .RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV,
+            .NumDescriptors = 1,
+            .OffsetInDescriptorsFromTableStart = D3D12_DESCRIPTOR_RANGE_OFFSET_APPEND
+        };
+
+        const D3D12_ROOT_PARAMETER parameters[] =
+        {
+            {
+                .ParameterType = D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS,
+                .Constants = {.Num32BitValues = sizeof(HudConstants) / sizeof(float)},
+                .ShaderVisibility = D3D12_SHADER_VISIBILITY_VERTEX
+            },
+            {
+                .ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE,
+                .DescriptorTable = {.NumDescriptorRanges = 1, .pDescriptorRanges = &atlasRange},
+                .ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL
+            }
+        };
+
+        // Quads are aligned to whole pixels, as are the glyphs in the atlas
+        const D3D12_STATIC_SAMPLER_DESC sampler =
+        {
+            .Filter = D3D12_FILTER_MIN_MAG_MIP_POINT,
+            .AddressU = D3D12_TEXTURE_ADDRESS_MODE_CLAMP,
+            .AddressV = D3D12_TEXTURE_ADDRESS_MODE_CLAMP,
+            .AddressW = D3D12_TEXTURE_ADDRESS_MODE_CLAMP,
+            .MaxLOD = D3D12_FLOAT32_MAX,
+            .ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL
+        };
+
+        const D3D12_ROOT_SIGNATURE_DESC rootSignatureDesc =
+        {
+            .NumParameters = static_cast<UINT>(std::size(parameters)),
+            .pParameters = parameters,
+            .NumStaticSamplers = 1,
+            .pStaticSamplers = &sampler,
+            .Flags = D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT
+        };
+
+        ComPtr<ID3DBlob> rootSignatureBlob;
+
+        ThrowIfFailed(D3D12SerializeRootSignature(&rootSignatureDesc, D3D_ROOT_SIGNATURE_VERSION_1,
+                                                  &rootSignatureBlob, nullptr));
+        ThrowIfFailed(m_device->CreateRootSignature(0, rootSignatureBlob->GetBufferPointer(),
+                                                    rootSignatureBlob->GetBufferSize(),
+                                                    IID_PPV_ARGS(&m_rootSignature)));
+
+        const ComPtr<ID3DBlob> vertexShader = CompileShader("VSMain", "vs_5_0");
+        const ComPtr<ID3DBlob> pixelShader = CompileShader("PSMain", "ps_5_0");
+
+        static constexpr D3D12_INPUT_ELEMENT_DESC inputElements[] =
+        {
+            {"RECT", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, offsetof(DXSandbox::TextQuad, left),
+             D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1},
+            {"UVRECT", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, offsetof(DXSandbox::TextQuad, u0),
+             D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1},
+            {"COLOR", 0, DXGI_FORMAT_R8G8B8A8_UNORM, 0, offsetof(DXSandbox::TextQuad, color),
+             D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1}
+        };
+
+        D3D12_GRAPHICS_PIPELINE_STATE_DESC pipelineDesc =
+        {
+            .pRootSignature = m_rootSignature.Get(),
+            .VS = {vertexShader->GetBufferPointer(), vertexShader->GetBufferSize()},
+            .PS = {pixelShader->GetBufferPointer(), pixelShader->GetBufferSize()},
+            .SampleMask = UINT_MAX,
+            .RasterizerState =
+            {
+                .FillMode = D3D12_FILL_MODE_SOLID,
+                .CullMode = D3D12_CULL_MODE_NONE,
+                .DepthClipEnable = TRUE
+            },
+            .InputLayout = {inputElements, static_cast<UINT>(std::size(inputElements))},
+            .PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE,
+            .NumRenderTargets = 1,
+            .SampleDesc = {.Count = 1}
+        };
+
+        pipelineDesc.BlendState.RenderTarget[0] =
+        {
+            .BlendEnable = TRUE,
+            .SrcBlend = D3D12_BLEND_SRC_ALPHA,
+            .DestBlend = D3D12_BLEND_INV_SRC_ALPHA,
+            .BlendOp = D3D12_BLEND_OP_ADD,
+            .SrcBlendAlpha = D3D12_BLEND_ONE,
+            .DestBlendAlpha = D3D12_BLEND_INV_SRC_ALPHA,
+            .BlendOpAlpha = D3D12_BLEND_OP_ADD,
+            .LogicOp = D3D12_LOGIC_OP_NOOP,
+            .RenderTargetWriteMask = D3D12_COLOR_WRITE_ENABLE_ALL
+        };
+
+        pipelineDesc.RTVFormats[0] = format;
+
+        ThrowIfFailed(m_device->CreateGraphicsPipelineState(&pipelineDesc, IID_PPV_ARGS(&m_pipelineState)));
+    }
+
+    void HudRenderer::CreateAtlasTexture()
+    {
+        static constexpr D3D12_HEAP_PROPERTIES heapProperties =
+        {
+            .Type = D3D12_HEAP_TYPE_DEFAULT
+        };
+
+        const D3D12_RESOURCE_DESC textureDesc =
+        {
+            .Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D,
+            .Width = m_atlas.Width(),
+            .Height = m_atlas.Height(),
+            .DepthOrArraySize = 1,
+            .MipLevels = 1,
+            .Format = DXGI_FORMAT_R8_UNORM,
+            .SampleDesc = {.Count = 1}
+        };
+
+        // Filled by the first frame drawing the overlay
+        ThrowIfFailed(m_device->CreateCommittedResource(&heapProperties, D3D12_HEAP_FLAG_NONE, &textureDesc,
+                                                        D3D12_RESOURCE_STATE_COPY_DEST, nullptr,
+                                                        IID_PPV_ARGS(&m_atlasTexture)));
+
+        m_atlasView = m_descriptors.RegisterTexture(m_atlasTexture.Get());
+    }
+
+    bool HudRenderer::UploadAtlas(ID3D12GraphicsCommandList* commandList, UploadRing& uploadRing)
+    {
+        const UINT width = m_atlas.Width();
+        const UINT height = m_atlas.Height();
+        const UINT rowPitch = (width + D3D12_TEXTURE_DATA_PITCH_ALIGNMENT - 1) &
+                              ~(D3D12_TEXTURE_DATA_PITCH_ALIGNMENT - 1);
+
+        const std::optional<UploadRing::Allocation> staging = uploadRing.Allocate(
+            UINT64{rowPitch} * height, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+
+        if (!staging)
+            return false;
+
+        const std::span<const std::uint8_t> pixels = m_atlas.Pixels();
+
+        for (UINT y = 0; y < height; ++y)
+        {
+            std::memcpy(staging->cpuAddress + std::size_t{y} * rowPitch,
+                        pixels.data() + std::size_t{y} * width, width);
+        }
+
+        D3D12_TEXTURE_COPY_LOCATION destination = {};
+
+        destination.pResource = m_atlasTexture.Get();
+        destination.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+        destination.SubresourceIndex = 0;
+
+        D3D12_TEXTURE_COPY_LOCATION source = {};
+
+        source.pResource = staging->buffer;
+        source.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+        source.PlacedFootprint =
+        {
+            .Offset = staging->offset,
+            .Footprint =
+            {
+                .Format = DXGI_FORMAT_R8_UNORM,
+                .Width = width,
+                .Height = height,
+                .Depth = 1,
+                .RowPitch = rowPitch
+            }
+        };
+
+        commandList->CopyTextureRegion(&destination, 0, 0, 0, &source, nullptr);
+
+        const D3D12_RESOURCE_BARRIER barrier =
+        {
+            .Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION,
+            .Transition =
+            {
+                .pResource = m_atlasTexture.Get(),
+                .Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES,
+                .StateBefore = D3D12_RESOURCE_STATE_COPY_DEST,
+                .StateAfter = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE
+            }
+        };
+
+        commandList->ResourceBarrier(1, &barrier);
+
+        m_isAtlasUploaded = true;
+
+        return true;
+    }
+}
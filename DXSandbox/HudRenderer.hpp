@@ -0,0 +1,60 @@
+#pragma once
+
+#include "WindowsPlatform.hpp"
+
+#include "BindlessDescriptorTable.hpp"
+#include "ComPtr.hpp"
+#include "GlyphAtlas.hpp"
+#include "TextLayout.hpp"
+
+#include <d3d12.h>
+
+#include <span>
+
+namespace DXSandbox
+{
+    class UploadRing;
+
+    // Draws overlay quads, text and solid rectangles alike, from a glyph
+    // atlas rasterized once with GDI. The quads of a frame are uploaded
+    // through the ring in one allocation and drawn with one instanced draw;
+    // the atlas is read through the bindless table, which must outlive the
+    // renderer.
+    class HudRenderer final
+    {
+    public:
+        HudRenderer(ComPtr<ID3D12Device> device, DXGI_FORMAT format, BindlessDescriptorTable& descriptors);
+        ~HudRenderer();
+
+        HudRenderer(const HudRenderer&) = delete;
+        HudRenderer& operator = (const HudRenderer&) = delete;
+
+        const GlyphAtlas& Atlas() const noexcept;
+
+        // Draws over the render target bound with a viewport of the size.
+        // The first call also uploads the atlas. Nothing is drawn while the
+        // ring is full.
+        void Record(ID3D12GraphicsCommandList* commandList, UploadRing& uploadRing,
+                    std::span<const TextQuad> quads, UINT width, UINT height);
+
+    private:
+        void CreatePipeline(DXGI_FORMAT format);
+        void CreateAtlasTexture();
+
+        bool UploadAtlas(ID3D12GraphicsCommandList* commandList, UploadRing& uploadRing);
+
+    private:
+        ComPtr<ID3D12Device> m_device;
+        BindlessDescriptorTable& m_descriptors;
+
+        GlyphAtlas m_atlas;
+
+        ComPtr<ID3D12RootSignature> m_rootSignature;
+        ComPtr<ID3D12PipelineState> m_pipelineState;
+
+        ComPtr<ID3D12Resource> m_atlasTexture;
+        BindlessDescriptorTable::Handle m_atlasView = BindlessHandleTable::InvalidHandle;
+
+        bool m_isAtlasUploaded = false;
+    };
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace DXSandbox
+{
+    // The states render targets go through in a frame
+    enum class ResourceState : std::uint8_t
+    {
+        Present,
+        RenderTarget,
+        ShaderResource,
+        CopySource
+    };
+
+    struct DrawArgs final
+    {
+        std::uint32_t vertexCount = 0;
+        std::uint32_t instanceCount = 1;
+        std::uint32_t startVertex = 0;
+        std::uint32_t startInstance = 0;
+    };
+
+    // The commands the renderer records for a window, above the graphics
+    // API. Targets, root signatures and pipeline states are indices into
+    // the tables of the recording; sizes are in pixels from the top left
+    // corner of the target.
+    class ICommandBackend
+    {
+    public:
+        // Starts a command list, with nothing bound
+        virtual void BeginList() = 0;
+
+        virtual void Barrier(std::uint32_t target, ResourceState before, ResourceState after) = 0;
+
+        // Binds the target, with the viewport and scissor rectangle covering
+        // the size
+        virtual void SetRenderTarget(std::uint32_t target, std::uint32_t width, std::uint32_t height) = 0;
+        virtual void Clear(std::uint32_t target, std::uint32_t width, std::uint32_t height,
+                           const std::array<float, 4>& color) = 0;
+
+        virtual void SetRootSignature(std::uint32_t rootSignature) = 0;
+        virtual void SetPipelineState(std::uint32_t pipelineState) = 0;
+        virtual void SetMaterial(std::uint32_t material) = 0;
+        virtual void Draw(const DrawArgs& args) = 0;
+
+        // Stretches the corner of the source over the bound target
+        virtual void Upscale(std::uint32_t source, std::uint32_t width, std::uint32_t height) = 0;
+
+        virtual void CopyToReadback(std::uint32_t source) = 0;
+
+    protected:
+        ~ICommandBackend() = default;
+    };
+}
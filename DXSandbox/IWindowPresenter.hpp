@@ -5,12 +5,16 @@
 namespace DXSandbox
 {
     class Window;
+    struct WindowEvent;
 
     class IWindowPresenter
     {
     public:
         virtual void OnWindowClose(Window& sender) = 0;
 
+        // Resize, activation and input; called on the window thread
+        virtual void OnWindowEvent(Window& sender, const WindowEvent& event) = 0;
+
         virtual POINT WindowMinSize() const = 0;
 
     protected:
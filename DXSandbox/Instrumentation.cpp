@@ -0,0 +1,33 @@
+#include "Instrumentation.hpp"
+
+#include "Debug.hpp"
+
+#include <cassert>
+
+namespace
+{
+    constinit const DXSandbox::Instrumentation::Counter* g_firstCounter = nullptr;
+}
+
+namespace DXSandbox::Instrumentation
+{
+    Counter::Counter(const char* name) noexcept
+        : m_name{name}
+        , m_next{g_firstCounter}
+    {
+        assert(m_name);
+
+        g_firstCounter = this;
+    }
+
+    const Counter* FirstCounter() noexcept
+    {
+        return g_firstCounter;
+    }
+
+    void ReportCounters()
+    {
+        for (const Counter* counter = FirstCounter(); counter; counter = counter->Next())
+            Debug::WriteLine("{}: {}", counter->Name(), counter->Value());
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace DXSandbox::Instrumentation
+{
+    // Named counter that must have static storage duration. Counters link
+    // themselves into a global list when constructed, so they can be
+    // enumerated without registration calls or allocations.
+    class Counter final
+    {
+    public:
+        explicit Counter(const char* name) noexcept;
+
+        Counter(const Counter&) = delete;
+        Counter& operator = (const Counter&) = delete;
+
+        void Set(std::int64_t value) noexcept
+        {
+            m_value.store(value, std::memory_order_relaxed);
+        }
+
+        void Add(std::int64_t value) noexcept
+        {
+            m_value.fetch_add(value, std::memory_order_relaxed);
+        }
+
+        std::int64_t Value() const noexcept
+        {
+            return m_value.load(std::memory_order_relaxed);
+        }
+
+        const char* Name() const noexcept { return m_name; }
+
+        const Counter* Next() const noexcept { return m_next; }
+
+    private:
+        const char* m_name = nullptr;
+        std::atomic<std::int64_t> m_value = 0;
+        const Counter* m_next = nullptr;
+    };
+
+    const Counter* FirstCounter() noexcept;
+
+    // Writes every counter to the debug output
+    void ReportCounters();
+}
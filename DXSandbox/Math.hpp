@@ -0,0 +1,547 @@
+#pragma once
+
+#include <cassert>
+#include <cmath>
+#include <type_traits>
+
+// Scalar math layer. Every function is constexpr so transforms and camera
+// setups can be evaluated at compile time; the runtime paths fall back to
+// the <cmath> implementations. Matrices are row-major and use the row-vector
+// convention (v' = v * M) to match Direct3D and HLSL defaults.
+namespace DXSandbox::Math
+{
+    inline constexpr float Pi = 3.14159265358979323846f;
+    inline constexpr float TwoPi = 2.0f * Pi;
+    inline constexpr float HalfPi = 0.5f * Pi;
+
+    constexpr float ToRadians(float degrees) noexcept
+    {
+        return degrees * (Pi / 180.0f);
+    }
+
+    constexpr float Abs(float value) noexcept
+    {
+        return value < 0.0f ? -value : value;
+    }
+
+    constexpr float Sqrt(float value) noexcept
+    {
+        if (std::is_constant_evaluated())
+        {
+            if (value <= 0.0f)
+                return 0.0f;
+
+            double result = value > 1.0f ? value : 1.0;
+
+            for (int i = 0; i < 64; ++i)
+            {
+                const double next = 0.5 * (result + value / result);
+
+                if (next == result)
+                    break;
+
+                result = next;
+            }
+
+            return static_cast<float>(result);
+        }
+
+        return std::sqrt(value);
+    }
+
+    namespace Detail
+    {
+        // Reduces the angle to [-Pi, Pi] for the series expansions below
+        constexpr double ReduceAngle(double angle) noexcept
+        {
+            constexpr double pi = 3.14159265358979323846;
+            constexpr double twoPi = 2.0 * pi;
+
+            angle -= twoPi * static_cast<double>(static_cast<long long>(angle / twoPi));
+
+            if (angle > pi)
+                angle -= twoPi;
+            else if (angle < -pi)
+                angle += twoPi;
+
+            return angle;
+        }
+
+        constexpr double SinSeries(double angle) noexcept
+        {
+            const double x = ReduceAngle(angle);
+            const double x2 = x * x;
+
+            double term = x;
+            double sum = x;
+
+            for (int n = 1; n < 12; ++n)
+            {
+                term *= -x2 / ((2.0 * n) * (2.0 * n + 1.0));
+                sum += term;
+            }
+
+            return sum;
+        }
+    }
+
+    constexpr float Sin(float angle) noexcept
+    {
+        if (std::is_constant_evaluated())
+            return static_cast<float>(Detail::SinSeries(angle));
+
+        return std::sin(angle);
+    }
+
+    constexpr float Cos(float angle) noexcept
+    {
+        if (std::is_constant_evaluated())
+            return static_cast<float>(Detail::SinSeries(static_cast<double>(angle) + 0.5 * 3.14159265358979323846));
+
+        return std::cos(angle);
+    }
+
+    constexpr float Tan(float angle) noexcept
+    {
+        return Sin(angle) / Cos(angle);
+    }
+
+    struct Float3 final
+    {
+        float x = 0.0f;
+        float y = 0.0f;
+        float z = 0.0f;
+
+        friend constexpr bool operator == (const Float3&, const Float3&) = default;
+    };
+
+    struct Float4 final
+    {
+        float x = 0.0f;
+        float y = 0.0f;
+        float z = 0.0f;
+        float w = 0.0f;
+
+        friend constexpr bool operator == (const Float4&, const Float4&) = default;
+    };
+
+    struct Quaternion final
+    {
+        float x = 0.0f;
+        float y = 0.0f;
+        float z = 0.0f;
+        float w = 1.0f;
+
+        friend constexpr bool operator == (const Quaternion&, const Quaternion&) = default;
+    };
+
+    struct Float4x4 final
+    {
+        float m[4][4] =
+        {
+            {1.0f, 0.0f, 0.0f, 0.0f},
+            {0.0f, 1.0f, 0.0f, 0.0f},
+            {0.0f, 0.0f, 1.0f, 0.0f},
+            {0.0f, 0.0f, 0.0f, 1.0f}
+        };
+
+        friend constexpr bool operator == (const Float4x4&, const Float4x4&) = default;
+    };
+
+    // Float3
+
+    constexpr Float3 operator + (const Float3& lhs, const Float3& rhs) noexcept
+    {
+        return {lhs.x + rhs.x, lhs.y + rhs.y, lhs.z + rhs.z};
+    }
+
+    constexpr Float3 operator - (const Float3& lhs, const Float3& rhs) noexcept
+    {
+        return {lhs.x - rhs.x, lhs.y - rhs.y, lhs.z - rhs.z};
+    }
+
+    constexpr Float3 operator - (const Float3& value) noexcept
+    {
+        return {-value.x, -value.y, -value.z};
+    }
+
+    constexpr Float3 operator * (const Float3& lhs, float rhs) noexcept
+    {
+        return {lhs.x * rhs, lhs.y * rhs, lhs.z * rhs};
+    }
+
+    constexpr Float3 operator * (float lhs, const Float3& rhs) noexcept
+    {
+        return rhs * lhs;
+    }
+
+    constexpr Float3 operator / (const Float3& lhs, float rhs) noexcept
+    {
+        return lhs * (1.0f / rhs);
+    }
+
+    constexpr float Dot(const Float3& lhs, const Float3& rhs) noexcept
+    {
+        return lhs.x * rhs.x + lhs.y * rhs.y + lhs.z * rhs.z;
+    }
+
+    constexpr Float3 Cross(const Float3& lhs, const Float3& rhs) noexcept
+    {
+        return
+        {
+            lhs.y * rhs.z - lhs.z * rhs.y,
+            lhs.z * rhs.x - lhs.x * rhs.z,
+            lhs.x * rhs.y - lhs.y * rhs.x
+        };
+    }
+
+    constexpr float Length(const Float3& value) noexcept
+    {
+        return Sqrt(Dot(value, value));
+    }
+
+    constexpr Float3 Normalize(const Float3& value) noexcept
+    {
+        const float length = Length(value);
+
+        return length > 0.0f ? value / length : value;
+    }
+
+    constexpr Float3 Lerp(const Float3& from, const Float3& to, float t) noexcept
+    {
+        return from + (to - from) * t;
+    }
+
+    // Float4
+
+    constexpr Float4 operator + (const Float4& lhs, const Float4& rhs) noexcept
+    {
+        return {lhs.x + rhs.x, lhs.y + rhs.y, lhs.z + rhs.z, lhs.w + rhs.w};
+    }
+
+    constexpr Float4 operator - (const Float4& lhs, const Float4& rhs) noexcept
+    {
+        return {lhs.x - rhs.x, lhs.y - rhs.y, lhs.z - rhs.z, lhs.w - rhs.w};
+    }
+
+    constexpr Float4 operator * (const Float4& lhs, float rhs) noexcept
+    {
+        return {lhs.x * rhs, lhs.y * rhs, lhs.z * rhs, lhs.w * rhs};
+    }
+
+    constexpr float Dot(const Float4& lhs, const Float4& rhs) noexcept
+    {
+        return lhs.x * rhs.x + lhs.y * rhs.y + lhs.z * rhs.z + lhs.w * rhs.w;
+    }
+
+    // Quaternion
+
+    // Hamilton product: rotating by (lhs * rhs) applies rhs first, then lhs
+    constexpr Quaternion operator * (const Quaternion& lhs, const Quaternion& rhs) noexcept
+    {
+        return
+        {
+            lhs.w * rhs.x + lhs.x * rhs.w + lhs.y * rhs.z - lhs.z * rhs.y,
+            lhs.w * rhs.y - lhs.x * rhs.z + lhs.y * rhs.w + lhs.z * rhs.x,
+            lhs.w * rhs.z + lhs.x * rhs.y - lhs.y * rhs.x + lhs.z * rhs.w,
+            lhs.w * rhs.w - lhs.x * rhs.x - lhs.y * rhs.y - lhs.z * rhs.z
+        };
+    }
+
+    constexpr Quaternion Conjugate(const Quaternion& value) noexcept
+    {
+        return {-value.x, -value.y, -value.z, value.w};
+    }
+
+    constexpr float Dot(const Quaternion& lhs, const Quaternion& rhs) noexcept
+    {
+        return lhs.x * rhs.x + lhs.y * rhs.y + lhs.z * rhs.z + lhs.w * rhs.w;
+    }
+
+    constexpr Quaternion Normalize(const Quaternion& value) noexcept
+    {
+        const float length = Sqrt(Dot(value, value));
+
+        if (length <= 0.0f)
+            return {};
+
+        const float scale = 1.0f / length;
+
+        return {value.x * scale, value.y * scale, value.z * scale, value.w * scale};
+    }
+
+    constexpr Quaternion RotationAxisAngle(const Float3& axis, float angle) noexcept
+    {
+        const Float3 unitAxis = Normalize(axis);
+        const float halfSin = Sin(0.5f * angle);
+
+        return {unitAxis.x * halfSin, unitAxis.y * halfSin, unitAxis.z * halfSin, Cos(0.5f * angle)};
+    }
+
+    constexpr Float3 Rotate(const Quaternion& rotation, const Float3& value) noexcept
+    {
+        const Float3 axis{rotation.x, rotation.y, rotation.z};
+        const Float3 t = 2.0f * Cross(axis, value);
+
+        return value + rotation.w * t + Cross(axis, t);
+    }
+
+    // Normalized linear interpolation along the shortest arc
+    constexpr Quaternion Nlerp(const Quaternion& from, const Quaternion& to, float t) noexcept
+    {
+        const float sign = Dot(from, to) < 0.0f ? -1.0f : 1.0f;
+
+        return Normalize(
+        {
+            from.x + (sign * to.x - from.x) * t,
+            from.y + (sign * to.y - from.y) * t,
+            from.z + (sign * to.z - from.z) * t,
+            from.w + (sign * to.w - from.w) * t
+        });
+    }
+
+    // Float4x4
+
+    constexpr Float4x4 Identity() noexcept
+    {
+        return {};
+    }
+
+    constexpr Float4x4 operator * (const Float4x4& lhs, const Float4x4& rhs) noexcept
+    {
+        Float4x4 result;
+
+        for (int row = 0; row < 4; ++row)
+        {
+            for (int column = 0; column < 4; ++column)
+            {
+                result.m[row][column] = lhs.m[row][0] * rhs.m[0][column] +
+                                        lhs.m[row][1] * rhs.m[1][column] +
+                                        lhs.m[row][2] * rhs.m[2][column] +
+                                        lhs.m[row][3] * rhs.m[3][column];
+            }
+        }
+
+        return result;
+    }
+
+    constexpr Float4x4 Transpose(const Float4x4& value) noexcept
+    {
+        Float4x4 result;
+
+        for (int row = 0; row < 4; ++row)
+        {
+            for (int column = 0; column < 4; ++column)
+                result.m[row][column] = value.m[column][row];
+        }
+
+        return result;
+    }
+
+    constexpr Float4x4 Translation(const Float3& offset) noexcept
+    {
+        Float4x4 result;
+
+        result.m[3][0] = offset.x;
+        result.m[3][1] = offset.y;
+        result.m[3][2] = offset.z;
+
+        return result;
+    }
+
+    constexpr Float4x4 Scaling(const Float3& scale) noexcept
+    {
+        Float4x4 result;
+
+        result.m[0][0] = scale.x;
+        result.m[1][1] = scale.y;
+        result.m[2][2] = scale.z;
+
+        return result;
+    }
+
+    constexpr Float4x4 Rotation(const Quaternion& rotation) noexcept
+    {
+        const float xx = rotation.x * rotation.x;
+        const float yy = rotation.y * rotation.y;
+        const float zz = rotation.z * rotation.z;
+        const float xy = rotation.x * rotation.y;
+        const float xz = rotation.x * rotation.z;
+        const float yz = rotation.y * rotation.z;
+        const float wx = rotation.w * rotation.x;
+        const float wy = rotation.w * rotation.y;
+        const float wz = rotation.w * rotation.z;
+
+        return
+        {{
+            {1.0f - 2.0f * (yy + zz), 2.0f * (xy + wz), 2.0f * (xz - wy), 0.0f},
+            {2.0f * (xy - wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz + wx), 0.0f},
+            {2.0f * (xz + wy), 2.0f * (yz - wx), 1.0f - 2.0f * (xx + yy), 0.0f},
+            {0.0f, 0.0f, 0.0f, 1.0f}
+        }};
+    }
+
+    // Scale, then rotate, then translate
+    constexpr Float4x4 AffineTransformation(const Float3& scale, const Quaternion& rotation,
+                                            const Float3& translation) noexcept
+    {
+        Float4x4 result = Rotation(rotation);
+
+        for (int column = 0; column < 3; ++column)
+        {
+            result.m[0][column] *= scale.x;
+            result.m[1][column] *= scale.y;
+            result.m[2][column] *= scale.z;
+        }
+
+        result.m[3][0] = translation.x;
+        result.m[3][1] = translation.y;
+        result.m[3][2] = translation.z;
+
+        return result;
+    }
+
+    constexpr float Determinant(const Float4x4& value) noexcept
+    {
+        const auto& a = value.m;
+
+        const float s0 = a[0][0] * a[1][1] - a[1][0] * a[0][1];
+        const float s1 = a[0][0] * a[1][2] - a[1][0] * a[0][2];
+        const float s2 = a[0][0] * a[1][3] - a[1][0] * a[0][3];
+        const float s3 = a[0][1] * a[1][2] - a[1][1] * a[0][2];
+        const float s4 = a[0][1] * a[1][3] - a[1][1] * a[0][3];
+        const float s5 = a[0][2] * a[1][3] - a[1][2] * a[0][3];
+
+        const float c5 = a[2][2] * a[3][3] - a[3][2] * a[2][3];
+        const float c4 = a[2][1] * a[3][3] - a[3][1] * a[2][3];
+        const float c3 = a[2][1] * a[3][2] - a[3][1] * a[2][2];
+        const float c2 = a[2][0] * a[3][3] - a[3][0] * a[2][3];
+        const float c1 = a[2][0] * a[3][2] - a[3][0] * a[2][2];
+        const float c0 = a[2][0] * a[3][1] - a[3][0] * a[2][1];
+
+        return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+    }
+
+    constexpr Float4x4 Inverse(const Float4x4& value) noexcept
+    {
+        const auto& a = value.m;
+
+        const float s0 = a[0][0] * a[1][1] - a[1][0] * a[0][1];
+        const float s1 = a[0][0] * a[1][2] - a[1][0] * a[0][2];
+        const float s2 = a[0][0] * a[1][3] - a[1][0] * a[0][3];
+        const float s3 = a[0][1] * a[1][2] - a[1][1] * a[0][2];
+        const float s4 = a[0][1] * a[1][3] - a[1][1] * a[0][3];
+        const float s5 = a[0][2] * a[1][3] - a[1][2] * a[0][3];
+
+        const float c5 = a[2][2] * a[3][3] - a[3][2] * a[2][3];
+        const float c4 = a[2][1] * a[3][3] - a[3][1] * a[2][3];
+        const float c3 = a[2][1] * a[3][2] - a[3][1] * a[2][2];
+        const float c2 = a[2][0] * a[3][3] - a[3][0] * a[2][3];
+        const float c1 = a[2][0] * a[3][2] - a[3][0] * a[2][2];
+        const float c0 = a[2][0] * a[3][1] - a[3][0] * a[2][1];
+
+        const float determinant = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+
+        assert(determinant != 0.0f);
+
+        const float d = 1.0f / determinant;
+
+        return
+        {{
+            {
+                ( a[1][1] * c5 - a[1][2] * c4 + a[1][3] * c3) * d,
+                (-a[0][1] * c5 + a[0][2] * c4 - a[0][3] * c3) * d,
+                ( a[3][1] * s5 - a[3][2] * s4 + a[3][3] * s3) * d,
+                (-a[2][1] * s5 + a[2][2] * s4 - a[2][3] * s3) * d
+            },
+            {
+                (-a[1][0] * c5 + a[1][2] * c2 - a[1][3] * c1) * d,
+                ( a[0][0] * c5 - a[0][2] * c2 + a[0][3] * c1) * d,
+                (-a[3][0] * s5 + a[3][2] * s2 - a[3][3] * s1) * d,
+                ( a[2][0] * s5 - a[2][2] * s2 + a[2][3] * s1) * d
+            },
+            {
+                ( a[1][0] * c4 - a[1][1] * c2 + a[1][3] * c0) * d,
+                (-a[0][0] * c4 + a[0][1] * c2 - a[0][3] * c0) * d,
+                ( a[3][0] * s4 - a[3][1] * s2 + a[3][3] * s0) * d,
+                (-a[2][0] * s4 + a[2][1] * s2 - a[2][3] * s0) * d
+            },
+            {
+                (-a[1][0] * c3 + a[1][1] * c1 - a[1][2] * c0) * d,
+                ( a[0][0] * c3 - a[0][1] * c1 + a[0][2] * c0) * d,
+                (-a[3][0] * s3 + a[3][1] * s1 - a[3][2] * s0) * d,
+                ( a[2][0] * s3 - a[2][1] * s1 + a[2][2] * s0) * d
+            }
+        }};
+    }
+
+    constexpr Float3 TransformPoint(const Float3& point, const Float4x4& transform) noexcept
+    {
+        const auto& m = transform.m;
+
+        return
+        {
+            point.x * m[0][0] + point.y * m[1][0] + point.z * m[2][0] + m[3][0],
+            point.x * m[0][1] + point.y * m[1][1] + point.z * m[2][1] + m[3][1],
+            point.x * m[0][2] + point.y * m[1][2] + point.z * m[2][2] + m[3][2]
+        };
+    }
+
+    constexpr Float3 TransformVector(const Float3& vector, const Float4x4& transform) noexcept
+    {
+        const auto& m = transform.m;
+
+        return
+        {
+            vector.x * m[0][0] + vector.y * m[1][0] + vector.z * m[2][0],
+            vector.x * m[0][1] + vector.y * m[1][1] + vector.z * m[2][1],
+            vector.x * m[0][2] + vector.y * m[1][2] + vector.z * m[2][2]
+        };
+    }
+
+    constexpr Float4 Transform(const Float4& value, const Float4x4& transform) noexcept
+    {
+        const auto& m = transform.m;
+
+        return
+        {
+            value.x * m[0][0] + value.y * m[1][0] + value.z * m[2][0] + value.w * m[3][0],
+            value.x * m[0][1] + value.y * m[1][1] + value.z * m[2][1] + value.w * m[3][1],
+            value.x * m[0][2] + value.y * m[1][2] + value.z * m[2][2] + value.w * m[3][2],
+            value.x * m[0][3] + value.y * m[1][3] + value.z * m[2][3] + value.w * m[3][3]
+        };
+    }
+
+    constexpr Float4x4 LookAtLH(const Float3& eye, const Float3& focus, const Float3& up) noexcept
+    {
+        const Float3 zAxis = Normalize(focus - eye);
+        const Float3 xAxis = Normalize(Cross(up, zAxis));
+        const Float3 yAxis = Cross(zAxis, xAxis);
+
+        return
+        {{
+            {xAxis.x, yAxis.x, zAxis.x, 0.0f},
+            {xAxis.y, yAxis.y, zAxis.y, 0.0f},
+            {xAxis.z, yAxis.z, zAxis.z, 0.0f},
+            {-Dot(xAxis, eye), -Dot(yAxis, eye), -Dot(zAxis, eye), 1.0f}
+        }};
+    }
+
+    constexpr Float4x4 PerspectiveFovLH(float fovY, float aspectRatio,
+                                        float nearZ, float farZ) noexcept
+    {
+        assert(aspectRatio > 0.0f && nearZ > 0.0f && farZ > nearZ);
+
+        const float height = 1.0f / Tan(0.5f * fovY);
+        const float width = height / aspectRatio;
+        const float range = farZ / (farZ - nearZ);
+
+        return
+        {{
+            {width, 0.0f, 0.0f, 0.0f},
+            {0.0f, height, 0.0f, 0.0f},
+            {0.0f, 0.0f, range, 1.0f},
+            {0.0f, 0.0f, -range * nearZ, 0.0f}
+        }};
+    }
+}
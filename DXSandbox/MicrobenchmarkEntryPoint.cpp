@@ -0,0 +1,9 @@
+#include "CommandLineArgs.hpp"
+#include "Microbenchmarks.hpp"
+
+// The microbenchmarks alone, without a window or a device, so they run on
+// any platform
+int main(int argc, char* argv[])
+{
+    return DXSandbox::RunMicrobenchmarks(DXSandbox::CommandLineArgs{argc, argv});
+}
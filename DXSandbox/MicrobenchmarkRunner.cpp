@@ -0,0 +1,155 @@
+#include "MicrobenchmarkRunner.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+    constexpr const char* Header = "name\titerations\trepetitions\tmean_ns\tmedian_ns\tstddev_ns\tmin_ns";
+
+    using Result = DXSandbox::MicrobenchmarkRunner::Result;
+
+    const Result* Find(const std::vector<Result>& results, std::string_view name) noexcept
+    {
+        const auto it = std::find_if(results.begin(), results.end(), [name](const Result& result)
+        {
+            return result.name == name;
+        });
+
+        return it != results.end() ? &*it : nullptr;
+    }
+}
+
+namespace DXSandbox
+{
+    MicrobenchmarkRunner::MicrobenchmarkRunner(const Params& params)
+        : m_params{params}
+    {
+        assert(m_params.repetitions > 0);
+    }
+
+    const std::vector<MicrobenchmarkRunner::Result>& MicrobenchmarkRunner::Results() const noexcept
+    {
+        return m_results;
+    }
+
+    bool MicrobenchmarkRunner::WriteResults(const std::filesystem::path& path) const
+    {
+        std::ofstream file{path, std::ios::trunc};
+
+        if (!file)
+            return false;
+
+        file << Header << '\n';
+
+        for (const Result& result : m_results)
+        {
+            file << result.name << '\t' << result.iterations << '\t' << result.repetitions << '\t'
+                 << result.mean << '\t' << result.median << '\t' << result.standardDeviation << '\t'
+                 << result.min << '\n';
+        }
+
+        return static_cast<bool>(file);
+    }
+
+    std::optional<std::vector<MicrobenchmarkRunner::Result>> MicrobenchmarkRunner::ReadResults(const std::filesystem::path& path)
+    {
+        std::ifstream file{path};
+        std::string line;
+
+        if (!std::getline(file, line) || line != Header)
+            return std::nullopt;
+
+        std::vector<Result> results;
+
+        while (std::getline(file, line))
+        {
+            std::istringstream fields{line};
+            Result result;
+
+            std::getline(fields, result.name, '\t');
+            fields >> result.iterations >> result.repetitions >> result.mean >> result.median
+                   >> result.standardDeviation >> result.min;
+
+            if (!fields)
+                return std::nullopt;
+
+            results.push_back(std::move(result));
+        }
+
+        return results;
+    }
+
+    std::vector<std::string> MicrobenchmarkRunner::FindRegressions(const std::vector<Result>& baseline,
+                                                                   double tolerance) const
+    {
+        std::vector<std::string> regressions;
+
+        for (const Result& result : m_results)
+        {
+            const Result* previous = Find(baseline, result.name);
+
+            if (!previous)
+                continue;
+
+            const double difference = result.median - previous->median;
+            const double noise = 3.0 * std::max(result.standardDeviation, previous->standardDeviation);
+
+            if (difference > previous->median * tolerance && difference > noise)
+                regressions.push_back(result.name);
+        }
+
+        return regressions;
+    }
+
+    bool MicrobenchmarkRunner::IsSelected(std::string_view name) const noexcept
+    {
+        return name.find(m_params.filter) != std::string_view::npos;
+    }
+
+    void MicrobenchmarkRunner::AddResult(std::string_view name, std::uint64_t iterations,
+                                         std::vector<Clock::duration>& samples)
+    {
+        assert(!samples.empty());
+
+        std::sort(samples.begin(), samples.end());
+
+        const double count = static_cast<double>(samples.size());
+
+        auto perOperation = [iterations](Clock::duration sample)
+        {
+            return std::chrono::duration<double, std::nano>(sample).count() / static_cast<double>(iterations);
+        };
+
+        double sum = 0.0;
+
+        for (const Clock::duration sample : samples)
+            sum += perOperation(sample);
+
+        const double mean = sum / count;
+
+        double squares = 0.0;
+
+        for (const Clock::duration sample : samples)
+            squares += (perOperation(sample) - mean) * (perOperation(sample) - mean);
+
+        const std::size_t middle = samples.size() / 2;
+
+        const double median = samples.size() % 2 ? perOperation(samples[middle])
+                                                 : 0.5 * (perOperation(samples[middle - 1]) + perOperation(samples[middle]));
+
+        m_results.push_back(
+        {
+            .name = std::string{name},
+            .iterations = iterations,
+            .repetitions = static_cast<std::uint32_t>(samples.size()),
+            .mean = mean,
+            .median = median,
+            .standardDeviation = samples.size() > 1 ? std::sqrt(squares / (count - 1.0)) : 0.0,
+            .min = perOperation(samples.front())
+        });
+    }
+}
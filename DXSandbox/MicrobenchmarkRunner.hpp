@@ -0,0 +1,111 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace DXSandbox
+{
+    // Keeps the optimizer from discarding a value that is never used
+    template <typename T>
+    inline void DoNotOptimize(const T& value) noexcept
+    {
+        static_cast<void>(*reinterpret_cast<const volatile char*>(&value));
+    }
+
+    // Times small operations. The iteration count of a repetition is doubled
+    // until one repetition takes long enough for the clock, then several
+    // repetitions are timed and summarized per operation, so the spread of
+    // the repetitions tells whether a difference between runs is noise.
+    // Results are written as tab-separated values, which also serve as the
+    // baseline of later runs.
+    class MicrobenchmarkRunner final
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        struct Params final
+        {
+            std::uint32_t repetitions = 15;
+            Clock::duration minRepetitionTime = std::chrono::milliseconds{10};
+
+            // Only benchmarks whose name contains it run
+            std::string filter;
+        };
+
+        // Times per operation, in nanoseconds
+        struct Result final
+        {
+            std::string name;
+            std::uint64_t iterations = 0;
+            std::uint32_t repetitions = 0;
+            double mean = 0.0;
+            double median = 0.0;
+            double standardDeviation = 0.0;
+            double min = 0.0;
+        };
+
+        explicit MicrobenchmarkRunner(const Params& params);
+
+        MicrobenchmarkRunner(const MicrobenchmarkRunner&) = delete;
+        MicrobenchmarkRunner& operator = (const MicrobenchmarkRunner&) = delete;
+
+        // Each call of the body is one operation
+        template <typename Body>
+        void Run(std::string_view name, Body&& body)
+        {
+            if (!IsSelected(name))
+                return;
+
+            std::uint64_t iterations = 1;
+
+            while (Time(body, iterations) < m_params.minRepetitionTime && iterations < MaxIterations)
+                iterations *= 2;
+
+            std::vector<Clock::duration> samples(m_params.repetitions);
+
+            for (Clock::duration& sample : samples)
+                sample = Time(body, iterations);
+
+            AddResult(name, iterations, samples);
+        }
+
+        const std::vector<Result>& Results() const noexcept;
+
+        bool WriteResults(const std::filesystem::path& path) const;
+
+        static std::optional<std::vector<Result>> ReadResults(const std::filesystem::path& path);
+
+        // Names of the benchmarks whose median is slower than the baseline
+        // by more than the relative tolerance and by more than the noise of
+        // both runs
+        std::vector<std::string> FindRegressions(const std::vector<Result>& baseline, double tolerance) const;
+
+    private:
+        static constexpr std::uint64_t MaxIterations = std::uint64_t{1} << 32;
+
+        template <typename Body>
+        static Clock::duration Time(Body& body, std::uint64_t iterations)
+        {
+            const auto start = Clock::now();
+
+            for (std::uint64_t i = 0; i < iterations; ++i)
+                body();
+
+            return Clock::now() - start;
+        }
+
+        bool IsSelected(std::string_view name) const noexcept;
+
+        void AddResult(std::string_view name, std::uint64_t iterations, std::vector<Clock::duration>& samples);
+
+    private:
+        Params m_params;
+
+        std::vector<Result> m_results;
+    };
+}
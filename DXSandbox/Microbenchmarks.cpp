@@ -0,0 +1,656 @@
+#include "Microbenchmarks.hpp"
+
+#ifdef _WIN32
+#   include "WindowsPlatform.hpp"
+#   include "HResultException.hpp"
+#   include "StringUtils.hpp"
+#endif
+
+#include "AllocationTracking.hpp"
+#include "AtlasPacker.hpp"
+#include "BindlessHandleTable.hpp"
+#include "BoundedQueue.hpp"
+#include "CommandLineArgs.hpp"
+#include "Debug.hpp"
+#include "DrawQueue.hpp"
+#include "FrameArena.hpp"
+#include "GlyphAtlas.hpp"
+#include "MathBatch.hpp"
+#include "MicrobenchmarkRunner.hpp"
+#include "PerfHud.hpp"
+#include "PoolAllocator.hpp"
+#include "QoiEncoder.hpp"
+#include "SceneStore.hpp"
+#include "TextLayout.hpp"
+#include "TlsfAllocator.hpp"
+#include "TripleBuffer.hpp"
+#include "YuvConversion.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <format>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using DXSandbox::DoNotOptimize;
+    using DXSandbox::MicrobenchmarkRunner;
+
+    constexpr const char* DefaultOutputPath = "Microbenchmarks.tsv";
+
+#ifdef _WIN32
+    void RunStringUtils(MicrobenchmarkRunner& runner)
+    {
+        using namespace DXSandbox::StringUtils;
+
+        const std::string shortUtf8 = "--d3dEnableDebugLayer";
+        const std::string longUtf8(4096, 'x');
+        const std::wstring shortUtf16 = UTF8ToUTF16(shortUtf8);
+        const std::wstring longUtf16 = UTF8ToUTF16(longUtf8);
+
+        runner.Run("StringUtils.UTF8ToUTF16.Short", [&] { DoNotOptimize(UTF8ToUTF16(shortUtf8)); });
+        runner.Run("StringUtils.UTF8ToUTF16.Long", [&] { DoNotOptimize(UTF8ToUTF16(longUtf8)); });
+        runner.Run("StringUtils.UTF16ToUTF8.Short", [&] { DoNotOptimize(UTF16ToUTF8(shortUtf16)); });
+        runner.Run("StringUtils.UTF16ToUTF8.Long", [&] { DoNotOptimize(UTF16ToUTF8(longUtf16)); });
+    }
+
+    void RunHResultException(MicrobenchmarkRunner& runner)
+    {
+        using DXSandbox::HResultException;
+
+        runner.Run("HResultException.Construct", []
+        {
+            DoNotOptimize(HResultException::FromHResult(E_FAIL));
+        });
+
+        runner.Run("HResultException.ThrowCatch", []
+        {
+            try
+            {
+                throw HResultException::FromHResult(DXGI_ERROR_DEVICE_REMOVED);
+            }
+            catch (const HResultException& e)
+            {
+                DoNotOptimize(e.Result());
+            }
+        });
+    }
+#endif
+
+#if defined _WIN32 && !defined NDEBUG
+    // Debug builds only, release builds compile WriteLine to nothing; the
+    // standard error it writes to elsewhere would bury the results
+    void RunDebugOutput(MicrobenchmarkRunner& runner)
+    {
+        runner.Run("Debug.WriteLine", [value = 0]() mutable
+        {
+            DXSandbox::Debug::WriteLine("Frame {} took {:.3f} ms", ++value, 16.6);
+        });
+    }
+#endif
+
+    void RunCommandLineArgs(MicrobenchmarkRunner& runner)
+    {
+        // Parsed as each platform receives its command line
+#ifdef _WIN32
+        std::wstring commandLine = L"DXSandbox.exe --d3dEnableDebugLayer --singleThreadedLoop "
+                                   L"--captureDirectory=Captures --hotReload=Content "
+                                   L"--benchmark --benchmarkFrames=1000 --benchmarkMaxP95Ms=16.6";
+
+        auto parse = [&] { return DXSandbox::CommandLineArgs{commandLine.data()}; };
+#else
+        static constexpr const char* argv[] =
+        {
+            "DXSandbox", "--d3dEnableDebugLayer", "--singleThreadedLoop",
+            "--captureDirectory=Captures", "--hotReload=Content",
+            "--benchmark", "--benchmarkFrames=1000", "--benchmarkMaxP95Ms=16.6"
+        };
+
+        auto parse = [] { return DXSandbox::CommandLineArgs{static_cast<int>(std::size(argv)), argv}; };
+#endif
+
+        runner.Run("CommandLineArgs.Parse", [&]
+        {
+            const DXSandbox::CommandLineArgs args = parse();
+
+            DoNotOptimize(args);
+        });
+
+        const DXSandbox::CommandLineArgs args = parse();
+
+        runner.Run("CommandLineArgs.Contains", [&] { DoNotOptimize(args.Contains("--benchmark")); });
+        runner.Run("CommandLineArgs.Value", [&] { DoNotOptimize(args.Value("--hotReload")); });
+        runner.Run("CommandLineArgs.NumericValue", [&]
+        {
+            DoNotOptimize(args.NumericValue("--benchmarkMaxP95Ms", 0.0));
+        });
+    }
+
+    void RunMathBatch(MicrobenchmarkRunner& runner)
+    {
+        namespace Math = DXSandbox::Math;
+
+        // Each operation is a whole batch, the size of a large scene
+        constexpr std::size_t BatchSize = 4096;
+
+        std::vector<Math::Float3> points(BatchSize);
+        std::vector<Math::Float3> transformedPoints(BatchSize);
+
+        for (std::size_t i = 0; i < BatchSize; ++i)
+            points[i] = {static_cast<float>(i), static_cast<float>(i % 7), static_cast<float>(i % 13)};
+
+        const Math::Float4x4 transform = Math::AffineTransformation({2.0f, 2.0f, 2.0f},
+                                                                    Math::RotationAxisAngle({0.0f, 1.0f, 0.0f}, 0.5f),
+                                                                    {1.0f, 2.0f, 3.0f});
+
+        runner.Run("MathBatch.TransformPoints.Scalar", [&]
+        {
+            Math::Scalar::TransformPoints(points, transform, transformedPoints);
+
+            DoNotOptimize(transformedPoints.back());
+        });
+
+        runner.Run("MathBatch.TransformPoints.Simd", [&]
+        {
+            Math::Simd::TransformPoints(points, transform, transformedPoints);
+
+            DoNotOptimize(transformedPoints.back());
+        });
+
+        // World matrices of a hierarchy level, parent times local
+        const std::vector<Math::Float4x4> parents(BatchSize, transform);
+        std::vector<Math::Float4x4> locals(BatchSize);
+        std::vector<Math::Float4x4> worlds(BatchSize);
+
+        for (std::size_t i = 0; i < BatchSize; ++i)
+            locals[i] = Math::Translation({static_cast<float>(i), 1.0f, 0.0f});
+
+        runner.Run("MathBatch.MultiplyMatrices.Scalar", [&]
+        {
+            Math::Scalar::MultiplyMatrices(locals, parents, worlds);
+
+            DoNotOptimize(worlds.back());
+        });
+
+        runner.Run("MathBatch.MultiplyMatrices.Simd", [&]
+        {
+            Math::Simd::MultiplyMatrices(locals, parents, worlds);
+
+            DoNotOptimize(worlds.back());
+        });
+    }
+
+    void RunAllocators(MicrobenchmarkRunner& runner)
+    {
+        DXSandbox::PoolAllocator pool{64};
+
+        pool.Reserve(256);
+
+        runner.Run("PoolAllocator.AllocateDeallocate", [&]
+        {
+            void* block = pool.AllocateBlock();
+
+            DoNotOptimize(block);
+            pool.DeallocateBlock(block);
+        });
+
+        DXSandbox::FrameArena arena{1024 * 1024};
+
+        runner.Run("FrameArena.Allocate64", [&, count = 0]() mutable
+        {
+            // Reset before running out, as a frame would
+            if (++count == 1024 * 1024 / 64)
+            {
+                arena.Reset();
+                count = 0;
+            }
+
+            DoNotOptimize(arena.allocate(64, 16));
+        });
+
+        runner.Run("NewDelete.64", []
+        {
+            auto* block = new std::byte[64];
+
+            DoNotOptimize(block);
+            delete[] block;
+        });
+
+        runner.Run("NewDelete.64.Tagged", []
+        {
+            const DXSandbox::AllocationTracking::TagScope tag{DXSandbox::AllocationTracking::Tag::Scene};
+
+            auto* block = new std::byte[64];
+
+            DoNotOptimize(block);
+            delete[] block;
+        });
+
+        // The worst case, a callstack for every allocation
+        DXSandbox::AllocationTracking::SetSampleInterval(1);
+
+        runner.Run("NewDelete.64.Sampled", []
+        {
+            auto* block = new std::byte[64];
+
+            DoNotOptimize(block);
+            delete[] block;
+        });
+
+        DXSandbox::AllocationTracking::SetSampleInterval(DXSandbox::AllocationTracking::DefaultSampleInterval);
+
+        DXSandbox::TlsfAllocator tlsf{256 * 1024 * 1024};
+
+        // A few live allocations, so free lists are not trivially empty
+        std::vector<DXSandbox::TlsfAllocator::Handle> live;
+
+        for (std::uint64_t size = 256; size <= 1024 * 1024; size *= 2)
+            live.push_back(tlsf.Allocate(size).handle);
+
+        runner.Run("TlsfAllocator.AllocateFree", [&]
+        {
+            const auto allocation = tlsf.Allocate(64 * 1024);
+
+            DoNotOptimize(allocation);
+            tlsf.Free(allocation.handle);
+        });
+
+        for (const auto handle : live)
+            tlsf.Free(handle);
+    }
+
+    void RunDrawSort(MicrobenchmarkRunner& runner)
+    {
+        using namespace DXSandbox;
+
+        // A million draws spread over every state, in submission order
+        constexpr std::size_t DrawCount = 1024 * 1024;
+
+        std::vector<DrawPacket> packets(DrawCount);
+        std::vector<RadixSortEntry> entries(DrawCount);
+
+        for (std::uint32_t i = 0, random = 1; i < DrawCount; ++i)
+        {
+            random = random * 1664525u + 1013904223u;
+
+            packets[i] =
+            {
+                .pass = random >> 30,
+                .rootSignature = (random >> 20) % DrawSortKey::MaxRootSignatures,
+                .pipelineState = (random >> 12) % 256,
+                .material = random % 4096,
+                .depth = (random * 2654435761u) % DrawSortKey::MaxDepth,
+                .vertexCount = 36,
+                .instanceCount = 1,
+                .startVertex = 0,
+                .startInstance = 0
+            };
+
+            entries[i] = {DrawSortKey::Encode(packets[i]), i};
+        }
+
+        // Every operation sorts the unsorted entries again
+        std::vector<RadixSortEntry> sorted(DrawCount);
+        RadixSorter sorter;
+
+        runner.Run("RadixSorter.Sort.1M", [&]
+        {
+            std::copy(entries.begin(), entries.end(), sorted.begin());
+            sorter.Sort(sorted);
+
+            DoNotOptimize(sorted.front());
+        });
+
+        runner.Run("StableSort.1M", [&]
+        {
+            std::copy(entries.begin(), entries.end(), sorted.begin());
+            std::stable_sort(sorted.begin(), sorted.end(), [](const RadixSortEntry& lhs, const RadixSortEntry& rhs)
+            {
+                return lhs.key < rhs.key;
+            });
+
+            DoNotOptimize(sorted.front());
+        });
+
+        // The whole frame path, from submission to sorted packets
+        DrawQueue queue;
+
+        runner.Run("DrawQueue.SubmitSort.1M", [&]
+        {
+            queue.Clear();
+
+            for (const DrawPacket& packet : packets)
+                queue.Submit(packet);
+
+            queue.Sort();
+
+            DoNotOptimize(queue.SortedPackets().front());
+        });
+    }
+
+    // Scenes of 1K to 1M entities, as roots with 3 children of 4 children
+    // each, from below the size at which levels update in parallel to well
+    // above it. Every root moves, or 1 % of them do, which only dirties
+    // their subtrees.
+    void RunSceneStore(MicrobenchmarkRunner& runner)
+    {
+        using namespace DXSandbox;
+
+        for (const std::uint32_t thousands : {1u, 10u, 100u, 1000u})
+        {
+            const std::uint32_t rootCount = thousands * 1000 / 16;
+
+            SceneStore scene;
+            std::vector<Entity> roots;
+
+            roots.reserve(rootCount);
+
+            for (std::uint32_t i = 0; i < rootCount; ++i)
+            {
+                const Entity root = scene.CreateEntity();
+
+                for (std::uint32_t j = 0; j < 3; ++j)
+                {
+                    const auto offset = Math::Translation({static_cast<float>(j), 1.0f, 0.0f});
+                    const Entity child = scene.CreateEntity(root, offset);
+
+                    for (std::uint32_t k = 0; k < 4; ++k)
+                        scene.CreateEntity(child, Math::Translation({0.0f, 1.0f, static_cast<float>(k)}));
+                }
+
+                roots.push_back(root);
+            }
+
+            scene.UpdateTransforms();
+
+            const std::string size = thousands < 1000 ? std::format("{}K", thousands) : "1M";
+
+            runner.Run("SceneStore.UpdateTransforms.All." + size, [&, frame = 0.0f]() mutable
+            {
+                frame += 1.0f;
+
+                for (const Entity root : roots)
+                    scene.SetLocalTransform(root, Math::Translation({frame, 0.0f, 0.0f}));
+
+                scene.UpdateTransforms();
+
+                DoNotOptimize(scene.WorldTransforms().back());
+            });
+
+            runner.Run("SceneStore.UpdateTransforms.Dirty1Percent." + size, [&, frame = 0.0f]() mutable
+            {
+                frame += 1.0f;
+
+                for (std::size_t i = 0; i < roots.size(); i += 100)
+                    scene.SetLocalTransform(roots[i], Math::Translation({frame, 0.0f, 0.0f}));
+
+                scene.UpdateTransforms();
+
+                DoNotOptimize(scene.WorldTransforms().back());
+            });
+        }
+    }
+
+    void RunBindless(MicrobenchmarkRunner& runner)
+    {
+        using DXSandbox::BindlessHandleTable;
+
+        BindlessHandleTable table{64 * 1024};
+
+        // A table mostly filled by registered resources
+        std::vector<BindlessHandleTable::Handle> live(48 * 1024);
+
+        for (auto& handle : live)
+            handle = table.Allocate();
+
+        runner.Run("BindlessHandleTable.AllocateFree", [&, fenceValue = std::uint64_t{0}]() mutable
+        {
+            const BindlessHandleTable::Handle handle = table.Allocate();
+
+            DoNotOptimize(handle);
+
+            // Released by one frame and reclaimed once it completes
+            table.Free(handle, ++fenceValue);
+            table.Reclaim(fenceValue);
+        });
+
+        runner.Run("BindlessHandleTable.Index", [&, i = std::size_t{0}]() mutable
+        {
+            DoNotOptimize(table.Index(live[i]));
+
+            i = (i + 1) % live.size();
+        });
+
+        runner.Run("BindlessHandleTable.IsValid", [&, i = std::size_t{0}]() mutable
+        {
+            DoNotOptimize(table.IsValid(live[i]));
+
+            i = (i + 1) % live.size();
+        });
+    }
+
+    void RunHud(MicrobenchmarkRunner& runner)
+    {
+        using namespace DXSandbox;
+
+        // Glyph sized rectangles until the atlas is full, then again
+        AtlasPacker packer{256, 256};
+
+        runner.Run("AtlasPacker.Pack", [&, i = std::uint32_t{0}]() mutable
+        {
+            if (!packer.Pack(6 + i % 5, 12 + i % 7))
+                packer.Reset();
+
+            ++i;
+        });
+
+        // Monospaced glyphs of the size the overlay rasterizes
+        GlyphAtlas atlas{256, 128, 16.0f, 13.0f};
+
+        const std::vector<std::uint8_t> coverage(7 * 11, 0xff);
+
+        for (char character = GlyphAtlas::FirstCharacter; character <= GlyphAtlas::LastCharacter; ++character)
+        {
+            const bool isBlank = character == ' ';
+
+            atlas.AddGlyph(character,
+            {
+                .width = isBlank ? 0u : 7u,
+                .height = isBlank ? 0u : 11u,
+                .bearingX = 0,
+                .bearingY = 11,
+                .advance = 7.0f,
+                .coverage = isBlank ? std::span<const std::uint8_t>{} : std::span{coverage}
+            });
+        }
+
+        TextLayout layout{atlas};
+
+        runner.Run("TextLayout.AddText", [&]
+        {
+            layout.Clear();
+            layout.AddText(8.0f, 8.0f, "Frame arena peak           12.5 MB", 0xffffffff);
+
+            DoNotOptimize(layout.Quads().data());
+        });
+
+        // A full overlay, with the frame history filled
+        static constexpr PerfHud::Row rows[] =
+        {
+            {"Frame arena peak", "FrameMemory.ArenaPeakBytes", PerfHud::Unit::Bytes},
+            {"Draws", "DrawQueue.Draws", PerfHud::Unit::Count}
+        };
+
+        PerfHud hud{rows};
+
+        for (std::size_t i = 0; i < PerfHud::HistorySize; ++i)
+            hud.AddFrame(std::chrono::microseconds{16'000 + static_cast<int>(i % 9) * 500});
+
+        runner.Run("PerfHud.Build", [&]
+        {
+            layout.Clear();
+            hud.Build(layout, 8.0f, 8.0f);
+
+            DoNotOptimize(layout.Quads().data());
+        });
+    }
+
+    // One operation is a whole 1080p frame, so its megapixels per second
+    // are 2073.6 divided by the time in milliseconds. The frame mixes flat
+    // areas, gradients and noise, as rendered frames do.
+    void RunCapture(MicrobenchmarkRunner& runner)
+    {
+        constexpr std::uint32_t Width = 1920;
+        constexpr std::uint32_t Height = 1080;
+
+        std::vector<std::byte> frame(std::size_t{Width} * Height * 4);
+
+        for (std::uint32_t y = 0, random = 1; y < Height; ++y)
+        {
+            for (std::uint32_t x = 0; x < Width; ++x)
+            {
+                random = random * 1664525u + 1013904223u;
+
+                const bool isNoise = (x / 64 + y / 64) % 4 == 0;
+                const bool isFlat = (x / 64 + y / 64) % 4 == 1;
+
+                std::byte* pixel = &frame[(std::size_t{y} * Width + x) * 4];
+
+                pixel[0] = static_cast<std::byte>(isNoise ? random >> 24 : isFlat ? 40 : x);
+                pixel[1] = static_cast<std::byte>(isNoise ? random >> 16 : isFlat ? 80 : x + y);
+                pixel[2] = static_cast<std::byte>(isNoise ? random >> 8 : isFlat ? 120 : y);
+                pixel[3] = std::byte{255};
+            }
+        }
+
+        const DXSandbox::Qoi::ImageView image =
+        {
+            .pixels = frame.data(),
+            .width = Width,
+            .height = Height,
+            .rowPitch = Width * 4
+        };
+
+        runner.Run("Capture.QoiEncode.1080p", [&]
+        {
+            DoNotOptimize(DXSandbox::Qoi::Encode(image).size());
+        });
+
+        namespace Yuv = DXSandbox::Yuv;
+
+        const Yuv::RgbaView rgba =
+        {
+            .pixels = frame.data(),
+            .width = Width,
+            .height = Height,
+            .rowPitch = Width * 4
+        };
+
+        std::vector<std::uint8_t> planes(Yuv::I420Size(Width, Height));
+
+        runner.Run("Capture.RgbaToI420.Scalar.1080p", [&]
+        {
+            Yuv::Scalar::ConvertRgbaToI420(rgba, planes.data());
+
+            DoNotOptimize(planes.back());
+        });
+
+        runner.Run("Capture.RgbaToI420.Simd.1080p", [&]
+        {
+            Yuv::Simd::ConvertRgbaToI420(rgba, planes.data());
+
+            DoNotOptimize(planes.back());
+        });
+    }
+
+    void RunQueues(MicrobenchmarkRunner& runner)
+    {
+        DXSandbox::BoundedQueue<std::uint64_t, 1024> queue;
+
+        runner.Run("BoundedQueue.PushPop", [&, value = std::uint64_t{0}]() mutable
+        {
+            queue.TryPush(value);
+            queue.TryPop(value);
+
+            DoNotOptimize(value);
+        });
+
+        DXSandbox::TripleBuffer<std::uint64_t> tripleBuffer;
+
+        runner.Run("TripleBuffer.PublishAcquire", [&]
+        {
+            ++tripleBuffer.WriteBuffer();
+            tripleBuffer.Publish();
+            tripleBuffer.Acquire();
+
+            DoNotOptimize(tripleBuffer.ReadBuffer());
+        });
+    }
+}
+
+namespace DXSandbox
+{
+    int RunMicrobenchmarks(const CommandLineArgs& args)
+    {
+        const MicrobenchmarkRunner::Params params =
+        {
+            .filter = std::string{args.Value("--microbenchmarkFilter").value_or("")}
+        };
+
+        MicrobenchmarkRunner runner{params};
+
+#ifdef _WIN32
+        RunStringUtils(runner);
+        RunHResultException(runner);
+#endif
+#if defined _WIN32 && !defined NDEBUG
+        RunDebugOutput(runner);
+#endif
+        RunCommandLineArgs(runner);
+        RunMathBatch(runner);
+        RunAllocators(runner);
+        RunDrawSort(runner);
+        RunSceneStore(runner);
+        RunBindless(runner);
+        RunHud(runner);
+        RunCapture(runner);
+        RunQueues(runner);
+
+        const auto outputPath = args.PathValue("--microbenchmarkOutput").value_or(DefaultOutputPath);
+
+        if (!runner.WriteResults(outputPath))
+        {
+            std::cerr << "Failed to write the microbenchmark results to " << outputPath << '\n';
+            return 1;
+        }
+
+        const auto baselinePath = args.PathValue("--microbenchmarkBaseline");
+
+        if (!baselinePath)
+            return 0;
+
+        const auto baseline = MicrobenchmarkRunner::ReadResults(*baselinePath);
+
+        if (!baseline)
+        {
+            std::cerr << "Failed to read the microbenchmark baseline " << *baselinePath << '\n';
+            return 1;
+        }
+
+        const double tolerance = args.NumericValue("--microbenchmarkTolerance", 0.1);
+        const auto regressions = runner.FindRegressions(*baseline, tolerance);
+
+        // On the standard error rather than the debug output, so release
+        // runs in CI show which benchmarks failed them
+        for (const std::string& name : regressions)
+            std::cerr << "Microbenchmark " << name << " regressed\n";
+
+        return regressions.empty() ? 0 : 1;
+    }
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+namespace DXSandbox
+{
+    class CommandLineArgs;
+
+    // Times the CPU-side building blocks and writes the results to
+    // --microbenchmarkOutput (Microbenchmarks.tsv). Given a previous output
+    // as --microbenchmarkBaseline, regressions beyond
+    // --microbenchmarkTolerance (0.1) make the returned exit code nonzero.
+    // --microbenchmarkFilter selects benchmarks by a part of their name.
+    int RunMicrobenchmarks(const CommandLineArgs& args);
+}
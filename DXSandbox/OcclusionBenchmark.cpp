@@ -0,0 +1,249 @@
+#include "OcclusionBenchmark.hpp"
+
+#include "CommandLineArgs.hpp"
+#include "Debug.hpp"
+#include "DrawQueue.hpp"
+#include "OcclusionCuller.hpp"
+#include "StringUtils.hpp"
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <span>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    using namespace DXSandbox::Math;
+
+    using DXSandbox::BoundingBox;
+    using DXSandbox::OcclusionCuller;
+
+    constexpr const char* DefaultOutputPath = "OcclusionCulling.tsv";
+    constexpr const char* Header = "scene\tthreads\tframes\tobjects\toccluder_triangles\tfrustum_culled_percent\t"
+                                   "occlusion_culled_percent\tdraws_after_culling\trasterize_ms\tpyramid_ms\ttest_ms";
+
+    // Unit cube from the origin, faces clockwise seen from outside
+    constexpr Float3 CubeVertices[] =
+    {
+        {0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {1.0f, 1.0f, 0.0f},
+        {0.0f, 0.0f, 1.0f}, {1.0f, 0.0f, 1.0f}, {0.0f, 1.0f, 1.0f}, {1.0f, 1.0f, 1.0f}
+    };
+
+    constexpr std::uint32_t CubeIndices[] =
+    {
+        0, 2, 3, 0, 3, 1, // -z
+        5, 7, 6, 5, 6, 4, // +z
+        4, 6, 2, 4, 2, 0, // -x
+        1, 3, 7, 1, 7, 5, // +x
+        2, 6, 7, 2, 7, 3, // +y
+        4, 0, 1, 4, 1, 5  // -y
+    };
+
+    struct SceneDesc final
+    {
+        const char* name = nullptr;
+
+        std::uint32_t blocks = 0;
+        float blockSize = 0.0f;
+        float streetWidth = 0.0f;
+        float minHeight = 0.0f;
+        float maxHeight = 0.0f;
+
+        // Cars, lamps and the like along the streets of each block
+        std::uint32_t propsPerBlock = 0;
+    };
+
+    constexpr SceneDesc Scenes[] =
+    {
+        {.name = "Downtown", .blocks = 32, .blockSize = 40.0f, .streetWidth = 14.0f,
+         .minHeight = 20.0f, .maxHeight = 160.0f, .propsPerBlock = 8},
+        {.name = "Suburb", .blocks = 48, .blockSize = 20.0f, .streetWidth = 12.0f,
+         .minHeight = 4.0f, .maxHeight = 10.0f, .propsPerBlock = 4}
+    };
+
+    struct Scene final
+    {
+        // The buildings first, which also occlude
+        std::vector<Float4x4> buildingTransforms;
+        std::vector<BoundingBox> bounds;
+    };
+
+    Scene GenerateScene(const SceneDesc& desc)
+    {
+        std::mt19937 random{1234};
+
+        std::uniform_real_distribution<float> height{desc.minHeight, desc.maxHeight};
+        std::uniform_real_distribution<float> inset{0.0f, 0.2f * desc.blockSize};
+        std::uniform_real_distribution<float> along{0.0f, desc.blockSize};
+        std::uniform_real_distribution<float> propSize{0.5f, 4.5f};
+
+        const float pitch = desc.blockSize + desc.streetWidth;
+
+        Scene scene;
+
+        for (std::uint32_t z = 0; z < desc.blocks; ++z)
+        {
+            for (std::uint32_t x = 0; x < desc.blocks; ++x)
+            {
+                const float left = static_cast<float>(x) * pitch + inset(random);
+                const float front = static_cast<float>(z) * pitch + inset(random);
+                const float right = static_cast<float>(x) * pitch + desc.blockSize - inset(random);
+                const float back = static_cast<float>(z) * pitch + desc.blockSize - inset(random);
+
+                const Float3 size = {right - left, height(random), back - front};
+
+                scene.buildingTransforms.push_back(Scaling(size) * Translation({left, 0.0f, front}));
+                scene.bounds.push_back({.min = {left, 0.0f, front}, .max = {right, size.y, back}});
+            }
+        }
+
+        for (std::uint32_t z = 0; z < desc.blocks; ++z)
+        {
+            for (std::uint32_t x = 0; x < desc.blocks; ++x)
+            {
+                for (std::uint32_t i = 0; i < desc.propsPerBlock; ++i)
+                {
+                    // On the street in front of or beside the block
+                    const bool isBeside = i % 2 != 0;
+                    const float street = (isBeside ? static_cast<float>(x) : static_cast<float>(z)) * pitch +
+                                         desc.blockSize + 0.5f * desc.streetWidth;
+                    const float offset = (isBeside ? static_cast<float>(z) : static_cast<float>(x)) * pitch +
+                                         along(random);
+
+                    const float px = isBeside ? street : offset;
+                    const float pz = isBeside ? offset : street;
+                    const float size = propSize(random);
+
+                    scene.bounds.push_back({.min = {px, 0.0f, pz}, .max = {px + size, 0.5f * size, pz + size}});
+                }
+            }
+        }
+
+        return scene;
+    }
+
+    // Walks down the middle street of the scene, looking around
+    Float4x4 CameraView(const SceneDesc& desc, std::uint32_t frame, std::uint32_t frameCount)
+    {
+        const float pitch = desc.blockSize + desc.streetWidth;
+        const float length = static_cast<float>(desc.blocks) * pitch;
+        const float t = static_cast<float>(frame) / static_cast<float>(frameCount);
+
+        const float streetX = static_cast<float>(desc.blocks / 2) * pitch - 0.5f * desc.streetWidth;
+        const Float3 eye = {streetX, 1.7f, 0.05f * length + 0.9f * length * t};
+
+        const float yaw = 0.6f * std::sin(2.0f * Pi * 3.0f * t);
+
+        return LookAtLH(eye, eye + Float3{std::sin(yaw), 0.0f, std::cos(yaw)}, {0.0f, 1.0f, 0.0f});
+    }
+
+    double ToMilliseconds(OcclusionCuller::Clock::duration duration, std::uint32_t frames) noexcept
+    {
+        return std::chrono::duration<double, std::milli>(duration).count() / static_cast<double>(frames);
+    }
+
+    double Percent(std::uint64_t part, std::uint64_t whole) noexcept
+    {
+        return whole ? 100.0 * static_cast<double>(part) / static_cast<double>(whole) : 0.0;
+    }
+}
+
+namespace DXSandbox
+{
+    int RunOcclusionBenchmark(const CommandLineArgs& args)
+    {
+        const auto threadCount = args.NumericValue<std::uint32_t>("--occlusionThreads",
+                                                                  std::thread::hardware_concurrency());
+        const auto frameCount = std::max(args.NumericValue<std::uint32_t>("--occlusionBenchmarkFrames", 300), 1u);
+
+        const std::unique_ptr<ThreadPool> workers = threadCount ? std::make_unique<ThreadPool>(threadCount) : nullptr;
+
+        const OcclusionCuller::Params params;
+
+        OcclusionCuller culler{params, workers.get()};
+
+        const Float4x4 projection = PerspectiveFovLH(Pi / 3.0f, static_cast<float>(params.width) /
+                                                                static_cast<float>(params.height), 0.5f, 2000.0f);
+
+        const auto outputPath = args.Value("--occlusionBenchmarkOutput").value_or(DefaultOutputPath);
+
+        std::ofstream file{std::filesystem::path{StringUtils::UTF8ToUTF16(outputPath)}, std::ios::trunc};
+
+        file << Header << '\n';
+
+        for (const SceneDesc& desc : Scenes)
+        {
+            const Scene scene = GenerateScene(desc);
+
+            std::vector<std::uint8_t> isVisible(scene.bounds.size());
+
+            DrawQueue drawQueue;
+
+            OcclusionCuller::Statistics total;
+            std::uint64_t drawsAfterCulling = 0;
+
+            for (std::uint32_t frame = 0; frame < frameCount; ++frame)
+            {
+                culler.BeginFrame(CameraView(desc, frame, frameCount) * projection);
+
+                for (const Float4x4& transform : scene.buildingTransforms)
+                    culler.AddOccluder(CubeVertices, CubeIndices, transform);
+
+                culler.RenderOccluders();
+                culler.TestVisibility(scene.bounds, isVisible);
+
+                // One draw per object, dropped before recording when hidden
+                drawQueue.Clear();
+
+                for (std::uint32_t i = 0; i < scene.bounds.size(); ++i)
+                    drawQueue.Submit({.vertexCount = 36, .startInstance = i});
+
+                drawQueue.RemoveHidden(isVisible);
+
+                drawsAfterCulling += drawQueue.Size();
+
+                const OcclusionCuller::Statistics stats = culler.Stats();
+
+                total.occluderTriangles = stats.occluderTriangles;
+                total.testedObjects += stats.testedObjects;
+                total.frustumCulledObjects += stats.frustumCulledObjects;
+                total.occlusionCulledObjects += stats.occlusionCulledObjects;
+                total.rasterizeTime += stats.rasterizeTime;
+                total.pyramidTime += stats.pyramidTime;
+                total.testTime += stats.testTime;
+            }
+
+            const double frustumCulled = Percent(total.frustumCulledObjects, total.testedObjects);
+            const double occlusionCulled = Percent(total.occlusionCulledObjects, total.testedObjects);
+            const double rasterizeMs = ToMilliseconds(total.rasterizeTime, frameCount);
+            const double pyramidMs = ToMilliseconds(total.pyramidTime, frameCount);
+            const double testMs = ToMilliseconds(total.testTime, frameCount);
+
+            Debug::WriteLine("Occlusion culling {}: {} objects, {:.1f}% outside of the view, {:.1f}% occluded, "
+                             "rasterize {:.3f} ms, pyramid {:.3f} ms, test {:.3f} ms",
+                             std::string_view{desc.name}, scene.bounds.size(), frustumCulled, occlusionCulled,
+                             rasterizeMs, pyramidMs, testMs);
+
+            file << desc.name << '\t' << threadCount << '\t' << frameCount << '\t' << scene.bounds.size() << '\t'
+                 << total.occluderTriangles << '\t' << frustumCulled << '\t' << occlusionCulled << '\t'
+                 << drawsAfterCulling / frameCount << '\t' << rasterizeMs << '\t' << pyramidMs << '\t'
+                 << testMs << '\n';
+        }
+
+        if (!file)
+        {
+            Debug::WriteLine("Failed to write the occlusion culling results to {}", outputPath);
+            return 1;
+        }
+
+        return 0;
+    }
+}
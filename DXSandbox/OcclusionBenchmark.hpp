@@ -0,0 +1,13 @@
+#pragma once
+
+namespace DXSandbox
+{
+    class CommandLineArgs;
+
+    // Flies a street level camera through synthetic city scenes, culls the
+    // buildings and props against the buildings as occluders, and writes
+    // the cull rates and the mean time of each stage to
+    // --occlusionBenchmarkOutput (OcclusionCulling.tsv). The culler uses
+    // --occlusionThreads workers (hardware concurrency), none when zero.
+    int RunOcclusionBenchmark(const CommandLineArgs& args);
+}
@@ -0,0 +1,560 @@
+#include "OcclusionCuller.hpp"
+
+#include "MathBatch.hpp"
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <latch>
+
+namespace
+{
+    using DXSandbox::Math::Float3;
+    using DXSandbox::Math::Float4;
+
+    constexpr std::uint32_t FullCoverage = ~std::uint32_t{0};
+
+    // Clip space w below which a vertex is treated as crossing the near plane
+    constexpr float MinClipW = 1e-5f;
+
+    constexpr std::uint8_t OutsideView = 0;
+    constexpr std::uint8_t Visible = 1;
+    constexpr std::uint8_t Hidden = 2;
+
+    constexpr std::uint32_t RoundUp(std::uint32_t value, std::uint32_t multiple) noexcept
+    {
+        return (value + multiple - 1) / multiple * multiple;
+    }
+
+    std::array<Float3, 8> Corners(const DXSandbox::BoundingBox& box) noexcept
+    {
+        return
+        {{
+            {box.min.x, box.min.y, box.min.z},
+            {box.max.x, box.min.y, box.min.z},
+            {box.min.x, box.max.y, box.min.z},
+            {box.max.x, box.max.y, box.min.z},
+            {box.min.x, box.min.y, box.max.z},
+            {box.max.x, box.min.y, box.max.z},
+            {box.min.x, box.max.y, box.max.z},
+            {box.max.x, box.max.y, box.max.z}
+        }};
+    }
+
+    // Coverage of one row of eight pixel centers, one bit per pixel
+    std::uint32_t RowCoverage(const float (&edgeA)[3], const float (&edgeRow)[3], float x) noexcept
+    {
+#if defined DXSANDBOX_MATH_SSE
+        const __m128 offsetsLow = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+        const __m128 offsetsHigh = _mm_setr_ps(4.5f, 5.5f, 6.5f, 7.5f);
+
+        const __m128 xLow = _mm_add_ps(_mm_set1_ps(x), offsetsLow);
+        const __m128 xHigh = _mm_add_ps(_mm_set1_ps(x), offsetsHigh);
+
+        __m128 insideLow = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        __m128 insideHigh = insideLow;
+
+        for (int i = 0; i < 3; ++i)
+        {
+            const __m128 a = _mm_set1_ps(edgeA[i]);
+            const __m128 row = _mm_set1_ps(edgeRow[i]);
+            const __m128 zero = _mm_setzero_ps();
+
+            insideLow = _mm_and_ps(insideLow, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a, xLow), row), zero));
+            insideHigh = _mm_and_ps(insideHigh, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a, xHigh), row), zero));
+        }
+
+        return static_cast<std::uint32_t>(_mm_movemask_ps(insideLow)) |
+               static_cast<std::uint32_t>(_mm_movemask_ps(insideHigh)) << 4;
+#else
+        std::uint32_t coverage = 0;
+
+        for (std::uint32_t column = 0; column < DXSandbox::OcclusionCuller::TileWidth; ++column)
+        {
+            const float pixelX = x + static_cast<float>(column) + 0.5f;
+
+            bool isInside = true;
+
+            for (int i = 0; i < 3; ++i)
+                isInside = isInside && edgeA[i] * pixelX + edgeRow[i] >= 0.0f;
+
+            coverage |= static_cast<std::uint32_t>(isInside) << column;
+        }
+
+        return coverage;
+#endif
+    }
+}
+
+namespace DXSandbox
+{
+    OcclusionCuller::OcclusionCuller(const Params& params, ThreadPool* workers)
+        : m_width{RoundUp(std::max(params.width, 1u), TileWidth)}
+        , m_height{RoundUp(std::max(params.height, 1u), TileHeight)}
+        , m_tileColumns{m_width / TileWidth}
+        , m_tileRows{m_height / TileHeight}
+        , m_workers{workers}
+    {
+        const std::size_t tileCount = std::size_t{m_tileColumns} * m_tileRows;
+
+        m_tileDepths.resize(tileCount);
+        m_layerDepths.resize(tileCount);
+        m_layerMasks.resize(tileCount);
+
+        std::uint32_t columns = m_tileColumns;
+        std::uint32_t rows = m_tileRows;
+
+        for (;;)
+        {
+            m_pyramid.push_back({.columns = columns, .rows = rows,
+                                 .depths = std::vector<float>(std::size_t{columns} * rows)});
+
+            if (columns == 1 && rows == 1)
+                break;
+
+            columns = (columns + 1) / 2;
+            rows = (rows + 1) / 2;
+        }
+    }
+
+    OcclusionCuller::~OcclusionCuller() = default;
+
+    void OcclusionCuller::BeginFrame(const Math::Float4x4& viewProjection)
+    {
+        m_viewProjection = viewProjection;
+
+        m_triangles.clear();
+
+        std::fill(m_tileDepths.begin(), m_tileDepths.end(), 1.0f);
+        std::fill(m_layerDepths.begin(), m_layerDepths.end(), 0.0f);
+        std::fill(m_layerMasks.begin(), m_layerMasks.end(), 0u);
+
+        m_stats = {};
+    }
+
+    void OcclusionCuller::AddOccluder(std::span<const Math::Float3> vertices, std::span<const std::uint32_t> indices,
+                                      const Math::Float4x4& world)
+    {
+        assert(indices.size() % 3 == 0);
+
+        const Math::Float4x4 worldViewProjection = world * m_viewProjection;
+
+        auto toClip = [&](std::uint32_t index)
+        {
+            assert(index < vertices.size());
+
+            const Float3& vertex = vertices[index];
+
+            return Math::Transform(Float4{vertex.x, vertex.y, vertex.z, 1.0f}, worldViewProjection);
+        };
+
+        for (std::size_t i = 0; i < indices.size(); i += 3)
+            SetupTriangle(toClip(indices[i]), toClip(indices[i + 1]), toClip(indices[i + 2]));
+
+        m_stats.occluderTriangles += static_cast<std::uint32_t>(indices.size() / 3);
+    }
+
+    void OcclusionCuller::RenderOccluders()
+    {
+        const auto start = Clock::now();
+
+        // One band of tile rows per job, so no two jobs write the same tile
+        const std::size_t bandCount = std::min<std::size_t>(m_workers ? m_workers->ThreadCount() : 1,
+                                                            m_tileRows);
+
+        Dispatch(bandCount, [this, bandCount](std::size_t band)
+        {
+            const auto firstRow = static_cast<std::uint32_t>(band * m_tileRows / bandCount);
+            const auto endRow = static_cast<std::uint32_t>((band + 1) * m_tileRows / bandCount);
+
+            RasterizeBand(firstRow, endRow);
+        });
+
+        const auto rasterized = Clock::now();
+
+        BuildPyramid();
+
+        m_stats.rasterizedTriangles = static_cast<std::uint32_t>(m_triangles.size());
+        m_stats.rasterizeTime = rasterized - start;
+        m_stats.pyramidTime = Clock::now() - rasterized;
+    }
+
+    void OcclusionCuller::TestVisibility(std::span<const BoundingBox> bounds, std::span<std::uint8_t> isVisible)
+    {
+        assert(isVisible.size() >= bounds.size());
+
+        const auto start = Clock::now();
+
+        static constexpr std::size_t ObjectsPerJob = 256;
+
+        const std::size_t jobCount = (bounds.size() + ObjectsPerJob - 1) / ObjectsPerJob;
+
+        std::atomic<std::uint32_t> frustumCulled = 0;
+        std::atomic<std::uint32_t> occlusionCulled = 0;
+
+        Dispatch(jobCount, [&](std::size_t job)
+        {
+            const std::size_t first = job * ObjectsPerJob;
+            const std::size_t last = std::min(first + ObjectsPerJob, bounds.size());
+
+            std::uint32_t outside = 0;
+            std::uint32_t hidden = 0;
+
+            for (std::size_t i = first; i < last; ++i)
+            {
+                const std::uint8_t result = TestBox(bounds[i]);
+
+                outside += result == OutsideView;
+                hidden += result == Hidden;
+
+                isVisible[i] = result == Visible;
+            }
+
+            frustumCulled.fetch_add(outside, std::memory_order_relaxed);
+            occlusionCulled.fetch_add(hidden, std::memory_order_relaxed);
+        });
+
+        m_stats.testedObjects += static_cast<std::uint32_t>(bounds.size());
+        m_stats.frustumCulledObjects += frustumCulled.load(std::memory_order_relaxed);
+        m_stats.occlusionCulledObjects += occlusionCulled.load(std::memory_order_relaxed);
+        m_stats.testTime += Clock::now() - start;
+    }
+
+    std::span<const float> OcclusionCuller::TileDepths() const noexcept
+    {
+        return m_tileDepths;
+    }
+
+    std::uint32_t OcclusionCuller::TileColumns() const noexcept
+    {
+        return m_tileColumns;
+    }
+
+    std::uint32_t OcclusionCuller::TileRows() const noexcept
+    {
+        return m_tileRows;
+    }
+
+    OcclusionCuller::Statistics OcclusionCuller::Stats() const noexcept
+    {
+        return m_stats;
+    }
+
+    BoundingBox OcclusionCuller::TransformBox(const BoundingBox& box, const Math::Float4x4& world) noexcept
+    {
+        const auto corners = Corners(box);
+
+        const Float3 first = Math::TransformPoint(corners[0], world);
+
+        BoundingBox result = {.min = first, .max = first};
+
+        for (const Float3& corner : corners)
+        {
+            const Float3 point = Math::TransformPoint(corner, world);
+
+            result.min = {std::min(result.min.x, point.x), std::min(result.min.y, point.y),
+                          std::min(result.min.z, point.z)};
+            result.max = {std::max(result.max.x, point.x), std::max(result.max.y, point.y),
+                          std::max(result.max.z, point.z)};
+        }
+
+        return result;
+    }
+
+    void OcclusionCuller::SetupTriangle(const Math::Float4& clip0, const Math::Float4& clip1,
+                                        const Math::Float4& clip2)
+    {
+        // Clipping would only add occluder area; dropping the triangle keeps
+        // the buffer conservative
+        const bool isClipped = clip0.w < MinClipW || clip1.w < MinClipW || clip2.w < MinClipW ||
+                               clip0.z < 0.0f || clip1.z < 0.0f || clip2.z < 0.0f;
+
+        if (isClipped)
+            return;
+
+        const float width = static_cast<float>(m_width);
+        const float height = static_cast<float>(m_height);
+
+        auto toScreen = [width, height](const Math::Float4& clip)
+        {
+            const float inverseW = 1.0f / clip.w;
+
+            return Float3
+            {
+                (clip.x * inverseW * 0.5f + 0.5f) * width,
+                (0.5f - clip.y * inverseW * 0.5f) * height,
+                clip.z * inverseW
+            };
+        };
+
+        const Float3 v[3] = {toScreen(clip0), toScreen(clip1), toScreen(clip2)};
+
+        // Positive for clockwise triangles, the y axis pointing down
+        const float area = (v[1].x - v[0].x) * (v[2].y - v[0].y) - (v[2].x - v[0].x) * (v[1].y - v[0].y);
+
+        if (area <= 0.0f)
+            return;
+
+        const float minX = std::min({v[0].x, v[1].x, v[2].x});
+        const float maxX = std::max({v[0].x, v[1].x, v[2].x});
+        const float minY = std::min({v[0].y, v[1].y, v[2].y});
+        const float maxY = std::max({v[0].y, v[1].y, v[2].y});
+
+        if (maxX <= 0.0f || maxY <= 0.0f || minX >= width || minY >= height)
+            return;
+
+        Triangle triangle;
+
+        for (int i = 0; i < 3; ++i)
+        {
+            const Float3& from = v[i];
+            const Float3& to = v[(i + 1) % 3];
+
+            triangle.edgeA[i] = from.y - to.y;
+            triangle.edgeB[i] = to.x - from.x;
+            triangle.edgeC[i] = -(triangle.edgeA[i] * from.x + triangle.edgeB[i] * from.y);
+        }
+
+        const float depth1 = v[1].z - v[0].z;
+        const float depth2 = v[2].z - v[0].z;
+
+        triangle.depthOriginX = v[0].x;
+        triangle.depthOriginY = v[0].y;
+        triangle.depthOrigin = v[0].z;
+        triangle.depthDx = (depth1 * (v[2].y - v[0].y) - depth2 * (v[1].y - v[0].y)) / area;
+        triangle.depthDy = (depth2 * (v[1].x - v[0].x) - depth1 * (v[2].x - v[0].x)) / area;
+        triangle.maxDepth = std::max({v[0].z, v[1].z, v[2].z});
+
+        auto tileIndex = [](float coordinate, std::uint32_t tileSize, std::uint32_t tileCount)
+        {
+            const float tile = std::clamp(coordinate / static_cast<float>(tileSize), 0.0f,
+                                          static_cast<float>(tileCount - 1));
+
+            return static_cast<std::uint32_t>(tile);
+        };
+
+        triangle.firstTileX = tileIndex(minX, TileWidth, m_tileColumns);
+        triangle.lastTileX = tileIndex(maxX, TileWidth, m_tileColumns);
+        triangle.firstTileY = tileIndex(minY, TileHeight, m_tileRows);
+        triangle.lastTileY = tileIndex(maxY, TileHeight, m_tileRows);
+
+        m_triangles.push_back(triangle);
+    }
+
+    void OcclusionCuller::RasterizeBand(std::uint32_t firstTileRow, std::uint32_t lastTileRow)
+    {
+        for (const Triangle& triangle : m_triangles)
+        {
+            const std::uint32_t firstY = std::max(triangle.firstTileY, firstTileRow);
+            const std::uint32_t endY = std::min(triangle.lastTileY + 1, lastTileRow);
+
+            for (std::uint32_t tileY = firstY; tileY < endY; ++tileY)
+            {
+                for (std::uint32_t tileX = triangle.firstTileX; tileX <= triangle.lastTileX; ++tileX)
+                    RasterizeTile(triangle, tileX, tileY);
+            }
+        }
+    }
+
+    void OcclusionCuller::RasterizeTile(const Triangle& triangle, std::uint32_t tileX, std::uint32_t tileY)
+    {
+        const std::size_t tile = std::size_t{tileY} * m_tileColumns + tileX;
+
+        const float x = static_cast<float>(tileX * TileWidth);
+        const float y = static_cast<float>(tileY * TileHeight);
+
+        // Farthest depth of the plane over the tile, found at a corner, and
+        // never beyond the triangle itself
+        const float planeX0 = triangle.depthDx * (x - triangle.depthOriginX);
+        const float planeX1 = triangle.depthDx * (x + TileWidth - triangle.depthOriginX);
+        const float planeY0 = triangle.depthDy * (y - triangle.depthOriginY);
+        const float planeY1 = triangle.depthDy * (y + TileHeight - triangle.depthOriginY);
+
+        const float depth = std::min(triangle.depthOrigin + std::max(planeX0, planeX1) + std::max(planeY0, planeY1),
+                                     triangle.maxDepth);
+
+        if (depth >= m_tileDepths[tile])
+            return;
+
+        std::uint32_t coverage = 0;
+
+        for (std::uint32_t row = 0; row < TileHeight; ++row)
+        {
+            const float pixelY = y + static_cast<float>(row) + 0.5f;
+
+            const float edgeRow[3] =
+            {
+                triangle.edgeB[0] * pixelY + triangle.edgeC[0],
+                triangle.edgeB[1] * pixelY + triangle.edgeC[1],
+                triangle.edgeB[2] * pixelY + triangle.edgeC[2]
+            };
+
+            coverage |= RowCoverage(triangle.edgeA, edgeRow, x) << (row * TileWidth);
+        }
+
+        if (coverage == 0)
+            return;
+
+        std::uint32_t& mask = m_layerMasks[tile];
+        float& layerDepth = m_layerDepths[tile];
+
+        layerDepth = mask ? std::max(layerDepth, depth) : depth;
+        mask |= coverage;
+
+        // A full working layer is nearer than the reference everywhere
+        if (mask == FullCoverage)
+        {
+            m_tileDepths[tile] = layerDepth;
+            mask = 0;
+        }
+    }
+
+    void OcclusionCuller::BuildPyramid()
+    {
+        std::copy(m_tileDepths.begin(), m_tileDepths.end(), m_pyramid.front().depths.begin());
+
+        for (std::size_t level = 1; level < m_pyramid.size(); ++level)
+        {
+            const PyramidLevel& source = m_pyramid[level - 1];
+            PyramidLevel& target = m_pyramid[level];
+
+            for (std::uint32_t row = 0; row < target.rows; ++row)
+            {
+                for (std::uint32_t column = 0; column < target.columns; ++column)
+                {
+                    const std::uint32_t sourceColumn = 2 * column;
+                    const std::uint32_t sourceRow = 2 * row;
+                    const std::uint32_t nextColumn = std::min(sourceColumn + 1, source.columns - 1);
+                    const std::uint32_t nextRow = std::min(sourceRow + 1, source.rows - 1);
+
+                    auto at = [&source](std::uint32_t c, std::uint32_t r)
+                    {
+                        return source.depths[std::size_t{r} * source.columns + c];
+                    };
+
+                    target.depths[std::size_t{row} * target.columns + column] =
+                        std::max({at(sourceColumn, sourceRow), at(nextColumn, sourceRow),
+                                  at(sourceColumn, nextRow), at(nextColumn, nextRow)});
+                }
+            }
+        }
+    }
+
+    std::uint8_t OcclusionCuller::TestBox(const BoundingBox& box) const noexcept
+    {
+        const float width = static_cast<float>(m_width);
+        const float height = static_cast<float>(m_height);
+
+        float minX = width;
+        float maxX = 0.0f;
+        float minY = height;
+        float maxY = 0.0f;
+        float minDepth = 1.0f;
+
+        // Clip space outcodes; a box with every corner beyond one plane is
+        // outside of the view
+        std::uint32_t outsideAll = 0x3F;
+
+        for (const Float3& corner : Corners(box))
+        {
+            const Float4 clip = Math::Transform(Float4{corner.x, corner.y, corner.z, 1.0f}, m_viewProjection);
+
+            const std::uint32_t outside = (clip.x < -clip.w ? 0x01u : 0u) |
+                                          (clip.x > clip.w ? 0x02u : 0u) |
+                                          (clip.y < -clip.w ? 0x04u : 0u) |
+                                          (clip.y > clip.w ? 0x08u : 0u) |
+                                          (clip.z < 0.0f ? 0x10u : 0u) |
+                                          (clip.z > clip.w ? 0x20u : 0u);
+
+            outsideAll &= outside;
+
+            // Crossing the near plane, the projection is unbounded
+            if (clip.w < MinClipW || clip.z < 0.0f)
+            {
+                minDepth = 0.0f;
+                continue;
+            }
+
+            const float inverseW = 1.0f / clip.w;
+
+            const float x = (clip.x * inverseW * 0.5f + 0.5f) * width;
+            const float y = (0.5f - clip.y * inverseW * 0.5f) * height;
+
+            minX = std::min(minX, x);
+            maxX = std::max(maxX, x);
+            minY = std::min(minY, y);
+            maxY = std::max(maxY, y);
+            minDepth = std::min(minDepth, clip.z * inverseW);
+        }
+
+        if (outsideAll != 0)
+            return OutsideView;
+
+        if (minDepth <= 0.0f)
+            return Visible;
+
+        const auto toTile = [](float coordinate, std::uint32_t tileSize, std::uint32_t tileCount)
+        {
+            const float tile = std::clamp(coordinate / static_cast<float>(tileSize), 0.0f,
+                                          static_cast<float>(tileCount - 1));
+
+            return static_cast<std::uint32_t>(tile);
+        };
+
+        std::uint32_t firstX = toTile(minX, TileWidth, m_tileColumns);
+        std::uint32_t lastX = toTile(maxX, TileWidth, m_tileColumns);
+        std::uint32_t firstY = toTile(minY, TileHeight, m_tileRows);
+        std::uint32_t lastY = toTile(maxY, TileHeight, m_tileRows);
+
+        // The finest level where the rectangle spans at most four texels
+        // each way; coarser levels mix in more of the background
+        std::size_t level = 0;
+
+        while (level + 1 < m_pyramid.size() && (lastX - firstX > 3 || lastY - firstY > 3))
+        {
+            firstX /= 2;
+            lastX /= 2;
+            firstY /= 2;
+            lastY /= 2;
+            ++level;
+        }
+
+        const PyramidLevel& pyramid = m_pyramid[level];
+
+        for (std::uint32_t row = firstY; row <= lastY; ++row)
+        {
+            for (std::uint32_t column = firstX; column <= lastX; ++column)
+            {
+                if (minDepth <= pyramid.depths[std::size_t{row} * pyramid.columns + column])
+                    return Visible;
+            }
+        }
+
+        return Hidden;
+    }
+
+    void OcclusionCuller::Dispatch(std::size_t jobCount, const std::function<void(std::size_t job)>& job)
+    {
+        if (!m_workers || jobCount <= 1)
+        {
+            for (std::size_t i = 0; i < jobCount; ++i)
+                job(i);
+
+            return;
+        }
+
+        std::latch done{static_cast<std::ptrdiff_t>(jobCount)};
+
+        for (std::size_t i = 0; i < jobCount; ++i)
+        {
+            m_workers->Submit([&job, &done, i]
+            {
+                job(i);
+                done.count_down();
+            });
+        }
+
+        done.wait();
+    }
+}
@@ -0,0 +1,157 @@
+#pragma once
+
+#include "Math.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
+
+namespace DXSandbox
+{
+    class ThreadPool;
+
+    struct BoundingBox final
+    {
+        Math::Float3 min;
+        Math::Float3 max;
+    };
+
+    // CPU occlusion culling against a low resolution depth buffer. Occluder
+    // triangles are rasterized into tiles of 8x4 pixels, each holding a
+    // coverage mask and two depths in the style of masked occlusion culling:
+    // a reference depth that every pixel of the tile is at least as near as,
+    // and the farthest depth of a working layer that replaces the reference
+    // once it covers the whole tile. The reference depths form the base of
+    // a hierarchical Z pyramid of farthest depths, against which the screen
+    // rectangle and nearest depth of each bounding box are tested. Both the
+    // rasterization, split in horizontal bands, and the tests are spread
+    // over the worker threads. Depths are normalized device depths, with 0
+    // at the near plane.
+    class OcclusionCuller final
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        static constexpr std::uint32_t TileWidth = 8;
+        static constexpr std::uint32_t TileHeight = 4;
+
+        struct Params final
+        {
+            // Rounded up to whole tiles
+            std::uint32_t width = 256;
+            std::uint32_t height = 128;
+        };
+
+        struct Statistics final
+        {
+            std::uint32_t occluderTriangles = 0;
+            std::uint32_t rasterizedTriangles = 0;
+            std::uint32_t testedObjects = 0;
+            std::uint32_t frustumCulledObjects = 0;
+            std::uint32_t occlusionCulledObjects = 0;
+
+            Clock::duration rasterizeTime = {};
+            Clock::duration pyramidTime = {};
+            Clock::duration testTime = {};
+        };
+
+        // Without workers everything runs on the calling thread
+        explicit OcclusionCuller(const Params& params, ThreadPool* workers = nullptr);
+        ~OcclusionCuller();
+
+        OcclusionCuller(const OcclusionCuller&) = delete;
+        OcclusionCuller& operator = (const OcclusionCuller&) = delete;
+
+        // Clears the depth buffer and the occluders of the previous frame
+        void BeginFrame(const Math::Float4x4& viewProjection);
+
+        // Triangles are clockwise seen from the front, like Direct3D; back
+        // faces and triangles crossing the near plane do not occlude
+        void AddOccluder(std::span<const Math::Float3> vertices, std::span<const std::uint32_t> indices,
+                         const Math::Float4x4& world);
+
+        void RenderOccluders();
+
+        // Writes 1 for each box in world space that may be visible and 0
+        // for each one outside of the view or hidden by the occluders
+        void TestVisibility(std::span<const BoundingBox> bounds, std::span<std::uint8_t> isVisible);
+
+        // Farthest depth of each tile, row by row
+        std::span<const float> TileDepths() const noexcept;
+
+        std::uint32_t TileColumns() const noexcept;
+        std::uint32_t TileRows() const noexcept;
+
+        Statistics Stats() const noexcept;
+
+        // Axis aligned box enclosing the transformed box
+        static BoundingBox TransformBox(const BoundingBox& box, const Math::Float4x4& world) noexcept;
+
+    private:
+        // A triangle in screen space: the edge functions are positive
+        // inside, and depth is a plane over the screen
+        struct Triangle final
+        {
+            float edgeA[3];
+            float edgeB[3];
+            float edgeC[3];
+
+            float depthOriginX = 0.0f;
+            float depthOriginY = 0.0f;
+            float depthOrigin = 0.0f;
+            float depthDx = 0.0f;
+            float depthDy = 0.0f;
+            float maxDepth = 0.0f;
+
+            std::uint32_t firstTileX = 0;
+            std::uint32_t firstTileY = 0;
+            std::uint32_t lastTileX = 0;
+            std::uint32_t lastTileY = 0;
+        };
+
+        void SetupTriangle(const Math::Float4& clip0, const Math::Float4& clip1, const Math::Float4& clip2);
+        void RasterizeBand(std::uint32_t firstTileRow, std::uint32_t lastTileRow);
+        void RasterizeTile(const Triangle& triangle, std::uint32_t tileX, std::uint32_t tileY);
+        void BuildPyramid();
+
+        // 0 outside of the view, 1 visible, 2 hidden
+        std::uint8_t TestBox(const BoundingBox& box) const noexcept;
+
+        // Runs the jobs on the workers and waits for them
+        void Dispatch(std::size_t jobCount, const std::function<void(std::size_t job)>& job);
+
+    private:
+        std::uint32_t m_width = 0;
+        std::uint32_t m_height = 0;
+        std::uint32_t m_tileColumns = 0;
+        std::uint32_t m_tileRows = 0;
+
+        ThreadPool* m_workers = nullptr;
+
+        Math::Float4x4 m_viewProjection;
+
+        std::vector<Triangle> m_triangles;
+
+        // Per tile: the reference depth, the working layer and its coverage
+        std::vector<float> m_tileDepths;
+        std::vector<float> m_layerDepths;
+        std::vector<std::uint32_t> m_layerMasks;
+
+        // Farthest depths, level 0 being the tiles; each level halves both
+        // dimensions, rounded up
+        struct PyramidLevel final
+        {
+            std::uint32_t columns = 0;
+            std::uint32_t rows = 0;
+            std::vector<float> depths;
+        };
+
+        std::vector<PyramidLevel> m_pyramid;
+
+        Statistics m_stats;
+    };
+}
@@ -0,0 +1,183 @@
+#include "PerfHud.hpp"
+
+#include "Instrumentation.hpp"
+#include "TextLayout.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <string_view>
+#include <utility>
+
+namespace
+{
+    using DXSandbox::PerfHud;
+
+    constexpr float Padding = 8.0f;
+    constexpr float Spacing = 4.0f;
+
+    constexpr float BarWidth = 2.0f;
+    constexpr float GraphWidth = PerfHud::HistorySize * BarWidth;
+    constexpr float GraphHeight = 64.0f;
+
+    // Frames slower than this are drawn in the warning color, twice as
+    // slow in the error color
+    constexpr float TargetMilliseconds = 1000.0f / 60.0f;
+
+    // The graph shows at least two target frames, more when spikes need it
+    constexpr float MinGraphMilliseconds = 2.0f * TargetMilliseconds;
+
+    constexpr std::uint32_t BackgroundColor = 0xc0101010;
+    constexpr std::uint32_t GraphColor = 0xff303030;
+    constexpr std::uint32_t TargetLineColor = 0xff808080;
+    constexpr std::uint32_t TextColor = 0xffffffff;
+    constexpr std::uint32_t LabelColor = 0xffb0b0b0;
+    constexpr std::uint32_t GoodColor = 0xff40d040;
+    constexpr std::uint32_t WarningColor = 0xff20c0f0;
+    constexpr std::uint32_t ErrorColor = 0xff3030f0;
+
+    using FormatBuffer = std::array<char, 64>;
+
+    // Formats into the buffer, truncating, so frames do not allocate
+    template <typename... Args>
+    std::string_view Format(FormatBuffer& buffer, std::format_string<Args...> format, Args&&... args)
+    {
+        const auto result = std::format_to_n(buffer.data(), buffer.size(), format, std::forward<Args>(args)...);
+
+        return {buffer.data(), static_cast<std::size_t>(result.out - buffer.data())};
+    }
+
+    std::string_view FormatValue(FormatBuffer& buffer, std::int64_t value, PerfHud::Unit unit)
+    {
+        switch (unit)
+        {
+            case PerfHud::Unit::Bytes:
+                return Format(buffer, "{:.1f} MB", static_cast<double>(value) / (1024.0 * 1024.0));
+
+            case PerfHud::Unit::Microseconds:
+                return Format(buffer, "{:.2f} ms", static_cast<double>(value) / 1000.0);
+
+            default:
+                return Format(buffer, "{}", value);
+        }
+    }
+
+    std::uint32_t FrameColor(float milliseconds) noexcept
+    {
+        if (milliseconds > 2.0f * TargetMilliseconds)
+            return ErrorColor;
+
+        return milliseconds > TargetMilliseconds ? WarningColor : GoodColor;
+    }
+}
+
+namespace DXSandbox
+{
+    PerfHud::PerfHud(std::span<const Row> rows)
+    {
+        m_rows.reserve(rows.size());
+
+        for (const Row& row : rows)
+        {
+            for (const auto* counter = Instrumentation::FirstCounter(); counter; counter = counter->Next())
+            {
+                if (std::strcmp(counter->Name(), row.counter) == 0)
+                {
+                    m_rows.push_back({.label = row.label, .counter = counter, .unit = row.unit});
+                    break;
+                }
+            }
+        }
+    }
+
+    void PerfHud::AddFrame(std::chrono::steady_clock::duration frameTime) noexcept
+    {
+        using Milliseconds = std::chrono::duration<float, std::milli>;
+
+        m_frameMilliseconds[m_nextFrame] = std::chrono::duration_cast<Milliseconds>(frameTime).count();
+
+        m_nextFrame = (m_nextFrame + 1) % HistorySize;
+        m_frameCount = std::min(m_frameCount + 1, HistorySize);
+    }
+
+    void PerfHud::Build(TextLayout& layout, float x, float y) const
+    {
+        const float lineHeight = layout.LineHeight();
+        const float width = GraphWidth + 2.0f * Padding;
+        const float height = 2.0f * Padding + lineHeight + GraphHeight + 2.0f * Spacing +
+                             static_cast<float>(m_rows.size()) * lineHeight;
+
+        // Drawn first, so everything else blends over it
+        layout.AddRect(x, y, width, height, BackgroundColor);
+
+        const float left = x + Padding;
+        const float right = x + width - Padding;
+
+        float penY = y + Padding;
+
+        // Oldest frame first
+        const std::size_t firstFrame = (m_nextFrame + HistorySize - m_frameCount) % HistorySize;
+
+        float total = 0.0f;
+        float slowest = 0.0f;
+
+        for (std::size_t i = 0; i < m_frameCount; ++i)
+        {
+            const float milliseconds = m_frameMilliseconds[(firstFrame + i) % HistorySize];
+
+            total += milliseconds;
+            slowest = std::max(slowest, milliseconds);
+        }
+
+        FormatBuffer buffer;
+
+        if (m_frameCount != 0)
+        {
+            const float average = total / static_cast<float>(m_frameCount);
+            const float fps = average > 0.0f ? 1000.0f / average : 0.0f;
+
+            layout.AddText(left, penY, Format(buffer, "{:.1f} FPS  {:.2f} ms", fps, average), TextColor);
+
+            const std::string_view maxText = Format(buffer, "max {:.2f} ms", slowest);
+
+            layout.AddText(right - layout.Measure(maxText), penY, maxText, FrameColor(slowest));
+        }
+
+        penY += lineHeight + Spacing;
+
+        layout.AddRect(left, penY, GraphWidth, GraphHeight, GraphColor);
+
+        const float graphMilliseconds = std::max(MinGraphMilliseconds, slowest);
+        const float pixelsPerMillisecond = GraphHeight / graphMilliseconds;
+        const float graphBottom = penY + GraphHeight;
+
+        // Newest frame at the right edge
+        float barLeft = left + static_cast<float>(HistorySize - m_frameCount) * BarWidth;
+
+        for (std::size_t i = 0; i < m_frameCount; ++i)
+        {
+            const float milliseconds = m_frameMilliseconds[(firstFrame + i) % HistorySize];
+            const float barHeight = std::max(1.0f, milliseconds * pixelsPerMillisecond);
+
+            layout.AddRect(barLeft, graphBottom - barHeight, BarWidth, barHeight, FrameColor(milliseconds));
+
+            barLeft += BarWidth;
+        }
+
+        layout.AddRect(left, graphBottom - TargetMilliseconds * pixelsPerMillisecond, GraphWidth, 1.0f,
+                       TargetLineColor);
+
+        penY += GraphHeight + Spacing;
+
+        for (const BoundRow& row : m_rows)
+        {
+            layout.AddText(left, penY, row.label, LabelColor);
+
+            const std::string_view value = FormatValue(buffer, row.counter->Value(), row.unit);
+
+            layout.AddText(right - layout.Measure(value), penY, value, TextColor);
+
+            penY += lineHeight;
+        }
+    }
+}
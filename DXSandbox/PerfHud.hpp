@@ -0,0 +1,70 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace DXSandbox
+{
+    namespace Instrumentation
+    {
+        class Counter;
+    }
+
+    class TextLayout;
+
+    // Content of the on-screen performance overlay: the frame rate, a graph
+    // of the recent frame times, and rows showing instrumentation counters,
+    // such as memory use and queue depths. Laid out again every frame,
+    // without allocating once the layout has grown to its size.
+    class PerfHud final
+    {
+    public:
+        enum class Unit : std::uint8_t
+        {
+            Count,
+            Bytes,          // Shown in megabytes
+            Microseconds    // Shown in milliseconds
+        };
+
+        struct Row final
+        {
+            const char* label = nullptr;
+            const char* counter = nullptr;
+            Unit unit = Unit::Count;
+        };
+
+        static constexpr std::size_t HistorySize = 120;
+
+        // Counters are looked up by name once; rows of counters that do not
+        // exist are left out
+        explicit PerfHud(std::span<const Row> rows);
+
+        PerfHud(const PerfHud&) = delete;
+        PerfHud& operator = (const PerfHud&) = delete;
+
+        void AddFrame(std::chrono::steady_clock::duration frameTime) noexcept;
+
+        // Appends the panel with its top left corner at the position
+        void Build(TextLayout& layout, float x, float y) const;
+
+    private:
+        struct BoundRow final
+        {
+            const char* label = nullptr;
+            const Instrumentation::Counter* counter = nullptr;
+            Unit unit = Unit::Count;
+        };
+
+    private:
+        std::vector<BoundRow> m_rows;
+
+        // Oldest first once full
+        std::array<float, HistorySize> m_frameMilliseconds = {};
+        std::size_t m_nextFrame = 0;
+        std::size_t m_frameCount = 0;
+    };
+}
@@ -0,0 +1,130 @@
+#include "PoolAllocator.hpp"
+
+#include "Instrumentation.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace
+{
+    using DXSandbox::Instrumentation::Counter;
+
+    Counter g_poolPages{"FrameMemory.PoolPages"};
+    Counter g_poolOversizedAllocations{"FrameMemory.PoolOversizedAllocations"};
+
+    inline std::size_t AlignUp(std::size_t value, std::size_t alignment) noexcept
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+}
+
+namespace DXSandbox
+{
+    PoolAllocator::PoolAllocator(std::size_t blockSize, std::size_t blockAlignment,
+                                 std::size_t blocksPerPage, std::pmr::memory_resource* upstream)
+        : m_upstream{upstream}
+        , m_blockAlignment{std::max({blockAlignment, alignof(FreeBlock), alignof(Page)})}
+        , m_blocksPerPage{std::max<std::size_t>(blocksPerPage, 1)}
+    {
+        assert(m_upstream);
+
+        m_blockSize = AlignUp(std::max(blockSize, sizeof(FreeBlock)), m_blockAlignment);
+        m_pageHeaderSize = AlignUp(sizeof(Page), m_blockAlignment);
+        m_pageSize = m_pageHeaderSize + m_blockSize * m_blocksPerPage;
+
+        m_stats.blockSize = m_blockSize;
+    }
+
+    PoolAllocator::~PoolAllocator()
+    {
+        assert(m_stats.liveBlocks == 0);
+
+        while (m_pages)
+        {
+            Page* page = m_pages;
+            m_pages = page->next;
+
+            m_upstream->deallocate(page, m_pageSize, m_blockAlignment);
+        }
+
+        g_poolPages.Add(-static_cast<std::int64_t>(m_stats.pageCount));
+    }
+
+    void* PoolAllocator::AllocateBlock()
+    {
+        if (!m_freeBlocks)
+            AddPage();
+
+        FreeBlock* block = m_freeBlocks;
+        m_freeBlocks = block->next;
+
+        ++m_stats.liveBlocks;
+        m_stats.peakBlocks = std::max(m_stats.peakBlocks, m_stats.liveBlocks);
+
+        return block;
+    }
+
+    void PoolAllocator::DeallocateBlock(void* block) noexcept
+    {
+        assert(block && m_stats.liveBlocks > 0);
+
+        m_freeBlocks = new (block) FreeBlock{m_freeBlocks};
+
+        --m_stats.liveBlocks;
+    }
+
+    void PoolAllocator::Reserve(std::size_t blockCount)
+    {
+        while (m_stats.pageCount * m_blocksPerPage < blockCount)
+            AddPage();
+    }
+
+    PoolAllocator::Statistics PoolAllocator::Stats() const noexcept
+    {
+        return m_stats;
+    }
+
+    void* PoolAllocator::do_allocate(std::size_t bytes, std::size_t alignment)
+    {
+        if (bytes > m_blockSize || alignment > m_blockAlignment)
+        {
+            ++m_stats.oversizedAllocations;
+            g_poolOversizedAllocations.Add(1);
+
+            return m_upstream->allocate(bytes, alignment);
+        }
+
+        return AllocateBlock();
+    }
+
+    void PoolAllocator::do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment) noexcept
+    {
+        if (bytes > m_blockSize || alignment > m_blockAlignment)
+            m_upstream->deallocate(pointer, bytes, alignment);
+        else
+            DeallocateBlock(pointer);
+    }
+
+    bool PoolAllocator::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+    {
+        return this == &other;
+    }
+
+    void PoolAllocator::AddPage()
+    {
+        auto memory = static_cast<std::byte*>(m_upstream->allocate(m_pageSize, m_blockAlignment));
+
+        m_pages = new (memory) Page{m_pages};
+
+        // Push in reverse so blocks are handed out in address order
+        for (std::size_t i = m_blocksPerPage; i > 0; --i)
+        {
+            std::byte* block = memory + m_pageHeaderSize + (i - 1) * m_blockSize;
+
+            m_freeBlocks = new (block) FreeBlock{m_freeBlocks};
+        }
+
+        ++m_stats.pageCount;
+        g_poolPages.Add(1);
+    }
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <memory_resource>
+#include <new>
+#include <utility>
+
+namespace DXSandbox
+{
+    // Fixed-size block allocator. Pages of blocks are taken from the upstream
+    // resource on demand and kept until destruction, so once the pool has
+    // grown to its working set, allocation and deallocation are a free list
+    // pop and push. Requests larger than the block size go upstream.
+    class PoolAllocator final : public std::pmr::memory_resource
+    {
+    public:
+        struct Statistics final
+        {
+            std::size_t blockSize = 0;
+            std::size_t pageCount = 0;
+            std::size_t liveBlocks = 0;
+            std::size_t peakBlocks = 0;
+            std::size_t oversizedAllocations = 0;
+        };
+
+        explicit PoolAllocator(std::size_t blockSize,
+                               std::size_t blockAlignment = alignof(std::max_align_t),
+                               std::size_t blocksPerPage = 256,
+                               std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+        ~PoolAllocator() override;
+
+        PoolAllocator(const PoolAllocator&) = delete;
+        PoolAllocator& operator = (const PoolAllocator&) = delete;
+
+        void* AllocateBlock();
+        void DeallocateBlock(void* block) noexcept;
+
+        // Grows the pool up front so the first frames do not allocate
+        void Reserve(std::size_t blockCount);
+
+        Statistics Stats() const noexcept;
+
+    private:
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+        void do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment) noexcept override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+        void AddPage();
+
+    private:
+        struct FreeBlock final
+        {
+            FreeBlock* next = nullptr;
+        };
+
+        struct Page final
+        {
+            Page* next = nullptr;
+        };
+
+        std::pmr::memory_resource* m_upstream = nullptr;
+
+        std::size_t m_blockSize = 0;
+        std::size_t m_blockAlignment = 0;
+        std::size_t m_blocksPerPage = 0;
+        std::size_t m_pageHeaderSize = 0;
+        std::size_t m_pageSize = 0;
+
+        Page* m_pages = nullptr;
+        FreeBlock* m_freeBlocks = nullptr;
+
+        Statistics m_stats;
+    };
+
+    // Typed front end for pooling objects of one type
+    template <typename T>
+    class ObjectPool final
+    {
+    public:
+        explicit ObjectPool(std::size_t objectsPerPage = 256,
+                            std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+            : m_pool{sizeof(T), alignof(T), objectsPerPage, upstream}
+        {
+        }
+
+        template <typename... Args>
+        T* Create(Args&&... args)
+        {
+            void* memory = m_pool.AllocateBlock();
+
+            try
+            {
+                return new (memory) T(std::forward<Args>(args)...);
+            }
+            catch (...)
+            {
+                m_pool.DeallocateBlock(memory);
+                throw;
+            }
+        }
+
+        void Destroy(T* object) noexcept
+        {
+            assert(object);
+
+            object->~T();
+            m_pool.DeallocateBlock(object);
+        }
+
+        void Reserve(std::size_t objectCount)
+        {
+            m_pool.Reserve(objectCount);
+        }
+
+        PoolAllocator::Statistics Stats() const noexcept
+        {
+            return m_pool.Stats();
+        }
+
+    private:
+        PoolAllocator m_pool;
+    };
+}
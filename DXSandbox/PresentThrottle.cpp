@@ -0,0 +1,78 @@
+#include "PresentThrottle.hpp"
+
+namespace DXSandbox
+{
+    PresentThrottle::PresentThrottle(Clock::duration testPresentInterval) noexcept
+        : m_testPresentInterval{testPresentInterval}
+    {
+    }
+
+    void PresentThrottle::OnMinimized() noexcept
+    {
+        m_state = State::Minimized;
+    }
+
+    void PresentThrottle::OnRestored() noexcept
+    {
+        // The next frame tells whether the window is still covered
+        m_state = State::Visible;
+    }
+
+    void PresentThrottle::OnActivated(Clock::time_point now) noexcept
+    {
+        if (m_state == State::Occluded)
+            m_nextTestPresent = now;
+    }
+
+    void PresentThrottle::OnPresented(bool isOccluded, Clock::time_point now) noexcept
+    {
+        // Only a restore ends minimization
+        if (m_state == State::Minimized)
+            return;
+
+        if (isOccluded)
+        {
+            m_state = State::Occluded;
+            m_nextTestPresent = now + m_testPresentInterval;
+        }
+        else
+        {
+            m_state = State::Visible;
+        }
+    }
+
+    PresentThrottle::Action PresentThrottle::NextAction(Clock::time_point now) const noexcept
+    {
+        switch (m_state)
+        {
+            case State::Minimized:
+                return Action::Wait;
+
+            case State::Occluded:
+                return now >= m_nextTestPresent ? Action::TestPresent : Action::Wait;
+
+            default:
+                return Action::Render;
+        }
+    }
+
+    std::optional<PresentThrottle::Clock::duration> PresentThrottle::WaitTimeout(Clock::time_point now) const noexcept
+    {
+        switch (m_state)
+        {
+            case State::Minimized:
+                return std::nullopt;
+
+            case State::Occluded:
+                return now < m_nextTestPresent ? m_nextTestPresent - now : Clock::duration::zero();
+
+            default:
+                return Clock::duration::zero();
+        }
+    }
+
+    PresentThrottle::State PresentThrottle::CurrentState() const noexcept
+    {
+        return m_state;
+    }
+}
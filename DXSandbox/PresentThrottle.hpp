@@ -0,0 +1,62 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+
+namespace DXSandbox
+{
+    // Decides whether the main loop renders, from what the window and the
+    // swap chain report about visibility. A minimized window renders nothing
+    // until it is restored. A window that Present reports as occluded only
+    // makes periodic test presents, to find out when it is visible again.
+    // Time is passed in rather than read, so the transitions can be driven
+    // without a window or a device.
+    class PresentThrottle final
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        static constexpr Clock::duration DefaultTestPresentInterval = std::chrono::milliseconds{250};
+
+        enum class State : std::uint8_t
+        {
+            Visible,
+            Minimized,
+            Occluded
+        };
+
+        enum class Action : std::uint8_t
+        {
+            Render,       // Render and present a frame
+            TestPresent,  // Check visibility without rendering
+            Wait          // Block for a window event, at most WaitTimeout
+        };
+
+        explicit PresentThrottle(Clock::duration testPresentInterval = DefaultTestPresentInterval) noexcept;
+
+        void OnMinimized() noexcept;
+        void OnRestored() noexcept;
+
+        // Activation does not prove visibility, so an occluded window is
+        // only tested right away
+        void OnActivated(Clock::time_point now) noexcept;
+
+        // Result of a frame or test present
+        void OnPresented(bool isOccluded, Clock::time_point now) noexcept;
+
+        Action NextAction(Clock::time_point now) const noexcept;
+
+        // How long a Wait may block; empty to block until a window event
+        std::optional<Clock::duration> WaitTimeout(Clock::time_point now) const noexcept;
+
+        State CurrentState() const noexcept;
+
+    private:
+        Clock::duration m_testPresentInterval;
+
+        State m_state = State::Visible;
+
+        Clock::time_point m_nextTestPresent;
+    };
+}
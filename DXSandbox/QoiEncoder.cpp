@@ -0,0 +1,174 @@
+#include "QoiEncoder.hpp"
+
+#include <cassert>
+#include <cstring>
+#include <memory>
+
+namespace
+{
+    constexpr std::uint8_t OpIndex = 0x00;
+    constexpr std::uint8_t OpDiff = 0x40;
+    constexpr std::uint8_t OpLuma = 0x80;
+    constexpr std::uint8_t OpRun = 0xc0;
+    constexpr std::uint8_t OpRgb = 0xfe;
+    constexpr std::uint8_t OpRgba = 0xff;
+
+    constexpr int MaxRun = 62;
+
+    constexpr std::size_t HeaderSize = 14;
+    constexpr std::uint8_t EndMarker[] = {0, 0, 0, 0, 0, 0, 0, 1};
+
+    struct Pixel final
+    {
+        std::uint8_t r = 0;
+        std::uint8_t g = 0;
+        std::uint8_t b = 0;
+        std::uint8_t a = 0;
+
+        friend bool operator == (Pixel, Pixel) = default;
+    };
+
+    inline std::size_t HashIndex(Pixel pixel) noexcept
+    {
+        return (pixel.r * 3 + pixel.g * 5 + pixel.b * 7 + pixel.a * 11) % 64;
+    }
+
+    inline void WriteBigEndian(std::uint8_t* out, std::uint32_t value) noexcept
+    {
+        out[0] = static_cast<std::uint8_t>(value >> 24);
+        out[1] = static_cast<std::uint8_t>(value >> 16);
+        out[2] = static_cast<std::uint8_t>(value >> 8);
+        out[3] = static_cast<std::uint8_t>(value);
+    }
+
+    // Channel difference with 8-bit wraparound, as the format defines it
+    inline int WrappedDifference(std::uint8_t current, std::uint8_t previous) noexcept
+    {
+        return static_cast<std::int8_t>(static_cast<std::uint8_t>(current - previous));
+    }
+}
+
+namespace DXSandbox::Qoi
+{
+    std::vector<std::uint8_t> Encode(const ImageView& image, std::uint8_t channels)
+    {
+        assert(image.pixels && image.width > 0 && image.height > 0);
+        assert(image.rowPitch >= image.width * 4);
+        assert(channels == 3 || channels == 4);
+
+        const std::size_t pixelCount = static_cast<std::size_t>(image.width) * image.height;
+
+        // Worst case is one RGBA op per pixel, so the output is assembled in
+        // an uninitialized buffer of that size and copied out at the end
+        const std::size_t maxSize = HeaderSize + pixelCount * (channels + 1) + sizeof(EndMarker);
+
+        const auto buffer = std::make_unique_for_overwrite<std::uint8_t[]>(maxSize);
+
+        std::uint8_t* out = buffer.get();
+
+        std::memcpy(out, "qoif", 4);
+        WriteBigEndian(out + 4, image.width);
+        WriteBigEndian(out + 8, image.height);
+        out[12] = channels;
+        out[13] = 0; // sRGB with linear alpha
+
+        out += HeaderSize;
+
+        // The format starts from zeroed index entries and opaque black
+        Pixel index[64] = {};
+        Pixel previous = {.a = 255};
+
+        int run = 0;
+
+        for (std::uint32_t y = 0; y < image.height; ++y)
+        {
+            const auto row = reinterpret_cast<const std::uint8_t*>(image.pixels) +
+                             static_cast<std::size_t>(y) * image.rowPitch;
+
+            const bool isLastRow = y + 1 == image.height;
+
+            for (std::uint32_t x = 0; x < image.width; ++x)
+            {
+                const std::uint8_t* source = row + static_cast<std::size_t>(x) * 4;
+
+                const Pixel pixel =
+                {
+                    .r = source[0],
+                    .g = source[1],
+                    .b = source[2],
+                    .a = channels == 4 ? source[3] : std::uint8_t{255}
+                };
+
+                if (pixel == previous)
+                {
+                    if (++run == MaxRun || (isLastRow && x + 1 == image.width))
+                    {
+                        *out++ = static_cast<std::uint8_t>(OpRun | (run - 1));
+                        run = 0;
+                    }
+
+                    continue;
+                }
+
+                if (run > 0)
+                {
+                    *out++ = static_cast<std::uint8_t>(OpRun | (run - 1));
+                    run = 0;
+                }
+
+                const std::size_t hash = HashIndex(pixel);
+
+                if (index[hash] == pixel)
+                {
+                    *out++ = static_cast<std::uint8_t>(OpIndex | hash);
+                }
+                else
+                {
+                    index[hash] = pixel;
+
+                    if (pixel.a == previous.a)
+                    {
+                        const int dr = WrappedDifference(pixel.r, previous.r);
+                        const int dg = WrappedDifference(pixel.g, previous.g);
+                        const int db = WrappedDifference(pixel.b, previous.b);
+
+                        const int drg = dr - dg;
+                        const int dbg = db - dg;
+
+                        if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1)
+                        {
+                            *out++ = static_cast<std::uint8_t>(OpDiff | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2));
+                        }
+                        else if (drg >= -8 && drg <= 7 && dg >= -32 && dg <= 31 && dbg >= -8 && dbg <= 7)
+                        {
+                            *out++ = static_cast<std::uint8_t>(OpLuma | (dg + 32));
+                            *out++ = static_cast<std::uint8_t>((drg + 8) << 4 | (dbg + 8));
+                        }
+                        else
+                        {
+                            *out++ = OpRgb;
+                            *out++ = pixel.r;
+                            *out++ = pixel.g;
+                            *out++ = pixel.b;
+                        }
+                    }
+                    else
+                    {
+                        *out++ = OpRgba;
+                        *out++ = pixel.r;
+                        *out++ = pixel.g;
+                        *out++ = pixel.b;
+                        *out++ = pixel.a;
+                    }
+                }
+
+                previous = pixel;
+            }
+        }
+
+        std::memcpy(out, EndMarker, sizeof(EndMarker));
+        out += sizeof(EndMarker);
+
+        return {buffer.get(), out};
+    }
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace DXSandbox::Qoi
+{
+    // Tightly or loosely packed RGBA8 pixels
+    struct ImageView final
+    {
+        const std::byte* pixels = nullptr;
+        std::uint32_t width = 0;
+        std::uint32_t height = 0;
+        std::uint32_t rowPitch = 0;
+    };
+
+    // Encodes to the "Quite OK Image" format, a lossless format that is an
+    // order of magnitude faster to write than PNG at a similar size. With
+    // three channels the alpha channel is ignored.
+    std::vector<std::uint8_t> Encode(const ImageView& image, std::uint8_t channels = 4);
+}
@@ -0,0 +1,150 @@
+#include "RadixSort.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <execution>
+#include <limits>
+#include <numeric>
+#include <thread>
+
+namespace
+{
+    constexpr unsigned DigitBits = 8;
+    constexpr unsigned PassCount = 64 / DigitBits;
+    constexpr std::uint64_t DigitMask = (1U << DigitBits) - 1;
+
+    // Below this size a single chunk sorted on the calling thread is faster
+    constexpr std::size_t ParallelThreshold = 1 << 15;
+    constexpr std::size_t MinChunkSize = 1 << 14;
+
+    inline std::size_t Digit(const DXSandbox::RadixSortEntry& entry, unsigned shift) noexcept
+    {
+        return static_cast<std::size_t>((entry.key >> shift) & DigitMask);
+    }
+
+    std::size_t ChunkCount(std::size_t count) noexcept
+    {
+        if (count < ParallelThreshold)
+            return 1;
+
+        const std::size_t threadCount = std::max(std::thread::hardware_concurrency(), 1U);
+
+        return std::clamp<std::size_t>(count / MinChunkSize, 1, threadCount);
+    }
+}
+
+namespace DXSandbox
+{
+    void RadixSorter::Sort(std::span<RadixSortEntry> entries)
+    {
+        const std::size_t chunkCount = ChunkCount(entries.size());
+
+        if (m_scratch.size() < entries.size())
+            m_scratch.resize(entries.size());
+
+        m_histograms.resize(chunkCount);
+
+        if (m_chunkIndices.size() != chunkCount)
+        {
+            m_chunkIndices.resize(chunkCount);
+            std::iota(m_chunkIndices.begin(), m_chunkIndices.end(), 0U);
+        }
+
+        Sort(entries, m_scratch.data(), m_histograms, m_chunkIndices);
+    }
+
+    void RadixSorter::Sort(std::span<RadixSortEntry> entries, std::pmr::memory_resource& scratch)
+    {
+        const std::size_t chunkCount = ChunkCount(entries.size());
+
+        std::pmr::vector<RadixSortEntry> sortScratch(entries.size(), &scratch);
+        std::pmr::vector<Histogram> histograms(chunkCount, &scratch);
+        std::pmr::vector<std::uint32_t> chunkIndices(chunkCount, &scratch);
+
+        std::iota(chunkIndices.begin(), chunkIndices.end(), 0U);
+
+        Sort(entries, sortScratch.data(), histograms, chunkIndices);
+    }
+
+    void RadixSorter::Sort(std::span<RadixSortEntry> entries, RadixSortEntry* scratch,
+                           std::span<Histogram> histograms, std::span<const std::uint32_t> chunkIndices)
+    {
+        const std::size_t count = entries.size();
+
+        if (count < 2)
+            return;
+
+        assert(count <= std::numeric_limits<std::uint32_t>::max());
+
+        const std::size_t chunkCount = histograms.size();
+        const std::size_t chunkSize = (count + chunkCount - 1) / chunkCount;
+
+        RadixSortEntry* source = entries.data();
+        RadixSortEntry* target = scratch;
+
+        auto forEachChunk = [&](auto&& function)
+        {
+            if (chunkCount == 1)
+                function(0U);
+            else
+                std::for_each(std::execution::par, chunkIndices.begin(), chunkIndices.end(), function);
+        };
+
+        for (unsigned pass = 0; pass < PassCount; ++pass)
+        {
+            const unsigned shift = pass * DigitBits;
+
+            forEachChunk([&](std::uint32_t chunk)
+            {
+                Histogram& histogram = histograms[chunk];
+                histogram.fill(0);
+
+                const std::size_t first = chunk * chunkSize;
+                const std::size_t last = std::min(first + chunkSize, count);
+
+                for (std::size_t i = first; i < last; ++i)
+                    ++histogram[Digit(source[i], shift)];
+            });
+
+            // Keys often share their high bytes; such passes would only copy
+            const std::size_t firstDigit = Digit(source[0], shift);
+            std::size_t firstDigitCount = 0;
+
+            for (const Histogram& histogram : histograms)
+                firstDigitCount += histogram[firstDigit];
+
+            if (firstDigitCount == count)
+                continue;
+
+            // Exclusive prefix sum ordered by digit, then by chunk, which keeps
+            // the scatter stable
+            std::uint32_t offset = 0;
+
+            for (std::size_t digit = 0; digit < BucketCount; ++digit)
+            {
+                for (Histogram& histogram : histograms)
+                {
+                    const std::uint32_t digitCount = histogram[digit];
+                    histogram[digit] = offset;
+                    offset += digitCount;
+                }
+            }
+
+            forEachChunk([&](std::uint32_t chunk)
+            {
+                Histogram& offsets = histograms[chunk];
+
+                const std::size_t first = chunk * chunkSize;
+                const std::size_t last = std::min(first + chunkSize, count);
+
+                for (std::size_t i = first; i < last; ++i)
+                    target[offsets[Digit(source[i], shift)]++] = source[i];
+            });
+
+            std::swap(source, target);
+        }
+
+        if (source != entries.data())
+            std::copy(source, source + count, entries.data());
+    }
+}
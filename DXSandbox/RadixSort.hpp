@@ -0,0 +1,40 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <vector>
+
+namespace DXSandbox
+{
+    struct RadixSortEntry final
+    {
+        std::uint64_t key = 0;
+        std::uint32_t value = 0;
+    };
+
+    // Stable LSD radix sort over 64-bit keys, eight bits per pass. Large inputs
+    // are split into chunks whose histograms and scatters run in parallel.
+    // Scratch storage is kept between calls, so sorting a similar number of
+    // entries every frame does not allocate, unless it is taken from a
+    // memory resource such as the frame arena.
+    class RadixSorter final
+    {
+    public:
+        void Sort(std::span<RadixSortEntry> entries);
+        void Sort(std::span<RadixSortEntry> entries, std::pmr::memory_resource& scratch);
+
+    private:
+        static constexpr std::size_t BucketCount = 256;
+
+        using Histogram = std::array<std::uint32_t, BucketCount>;
+
+        static void Sort(std::span<RadixSortEntry> entries, RadixSortEntry* scratch,
+                         std::span<Histogram> histograms, std::span<const std::uint32_t> chunkIndices);
+
+        std::vector<RadixSortEntry> m_scratch;
+        std::vector<Histogram> m_histograms;
+        std::vector<std::uint32_t> m_chunkIndices;
+    };
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace DXSandbox
+{
+    // Pixels of a read back RGBA8 render target, valid during the handler
+    struct ReadbackImage final
+    {
+        std::uint64_t frameIndex = 0;
+
+        std::uint32_t width = 0;
+        std::uint32_t height = 0;
+        std::uint32_t rowPitch = 0;
+
+        const std::byte* pixels = nullptr;
+    };
+
+    // Runs on a worker thread and must not throw
+    using ReadbackHandler = std::function<void(const ReadbackImage& image)>;
+}
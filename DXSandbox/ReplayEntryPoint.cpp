@@ -0,0 +1,9 @@
+#include "CommandLineArgs.hpp"
+#include "CommandReplay.hpp"
+
+// The command replay alone, without a window or a device, so captures can
+// be replayed on any platform
+int main(int argc, char* argv[])
+{
+    return DXSandbox::RunCommandReplay(DXSandbox::CommandLineArgs{argc, argv});
+}
@@ -0,0 +1,204 @@
+#include "ResidencyManager.hpp"
+
+#include "ErrorHandling.hpp"
+#include "Instrumentation.hpp"
+
+#include <dxgi1_6.h>
+
+#include <algorithm>
+#include <cassert>
+
+namespace
+{
+    using DXSandbox::Instrumentation::Counter;
+
+    Counter g_budgetBytes{"Residency.BudgetBytes"};
+    Counter g_residentBytes{"Residency.ResidentBytes"};
+    Counter g_evictedBytes{"Residency.EvictedBytes"};
+    Counter g_evictions{"Residency.Evictions"};
+    Counter g_madeResident{"Residency.MadeResident"};
+    Counter g_deferredResident{"Residency.DeferredResident"};
+    Counter g_budgetChanges{"Residency.BudgetChanges"};
+}
+
+namespace DXSandbox
+{
+    ResidencyManager::ResidencyManager(ComPtr<ID3D12Device> device, ComPtr<IDXGIAdapter3> adapter)
+        : m_device{std::move(device)}
+        , m_adapter{std::move(adapter)}
+    {
+        assert(m_device && m_adapter);
+
+        m_budgetChangeEvent = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+
+        if (!m_budgetChangeEvent)
+            ThrowLastError();
+
+        try
+        {
+            ThrowIfFailed(UpdateBudget());
+            ThrowIfFailed(m_adapter->RegisterVideoMemoryBudgetChangeNotificationEvent(m_budgetChangeEvent,
+                                                                                      &m_budgetChangeCookie));
+        }
+        catch (...)
+        {
+            CloseHandle(m_budgetChangeEvent);
+            throw;
+        }
+    }
+
+    ResidencyManager::~ResidencyManager()
+    {
+        m_adapter->UnregisterVideoMemoryBudgetChangeNotification(m_budgetChangeCookie);
+
+        CloseHandle(m_budgetChangeEvent);
+    }
+
+    ResidencyManager::ObjectId ResidencyManager::Track(ComPtr<ID3D12Pageable> object, std::uint64_t size)
+    {
+        assert(object);
+
+        const ObjectId id = m_policy.Add(size);
+
+        if (id >= m_objects.size())
+            m_objects.resize(id + 1);
+
+        m_objects[id] = std::move(object);
+
+        return id;
+    }
+
+    void ResidencyManager::Untrack(ObjectId id)
+    {
+        assert(id < m_objects.size() && m_objects[id]);
+
+        m_policy.Remove(id);
+
+        m_objects[id] = nullptr;
+    }
+
+    void ResidencyManager::MarkUsed(ObjectId id, UINT64 fenceValue)
+    {
+        m_policy.MarkUsed(id, fenceValue);
+    }
+
+    HRESULT ResidencyManager::Update(UINT64 completedFenceValue)
+    {
+        if (WaitForSingleObject(m_budgetChangeEvent, 0) == WAIT_OBJECT_0)
+        {
+            g_budgetChanges.Add(1);
+
+            const HRESULT hr = UpdateBudget();
+
+            if (FAILED(hr)) [[unlikely]]
+                return hr;
+        }
+
+        m_policy.Update(completedFenceValue, m_batch);
+
+        // Evicted first, so the memory is there for the objects coming back
+        HRESULT hr = Evict();
+
+        if (SUCCEEDED(hr))
+            hr = MakeResident(completedFenceValue);
+
+        const ResidencyPolicy::Statistics stats = m_policy.Stats();
+
+        g_residentBytes.Set(static_cast<std::int64_t>(stats.residentBytes));
+        g_evictedBytes.Set(static_cast<std::int64_t>(stats.evictedBytes));
+
+        return hr;
+    }
+
+    HRESULT ResidencyManager::Evict()
+    {
+        const UINT count = PageablesOf(m_batch.evict);
+
+        if (count == 0)
+            return S_OK;
+
+        const HRESULT hr = m_device->Evict(count, m_pageables.data());
+
+        if (FAILED(hr)) [[unlikely]]
+            return hr;
+
+        g_evictions.Add(count);
+
+        return S_OK;
+    }
+
+    HRESULT ResidencyManager::MakeResident(UINT64 completedFenceValue)
+    {
+        const UINT count = PageablesOf(m_batch.makeResident);
+
+        if (count == 0)
+            return S_OK;
+
+        HRESULT hr = m_device->MakeResident(count, m_pageables.data());
+
+        // The budget left out more than it should have; older objects make
+        // room until the frame's objects fit
+        while (hr == E_OUTOFMEMORY && m_policy.Trim(completedFenceValue, m_batch))
+        {
+            hr = Evict();
+
+            if (FAILED(hr)) [[unlikely]]
+                return hr;
+
+            PageablesOf(m_batch.makeResident);
+
+            hr = m_device->MakeResident(count, m_pageables.data());
+        }
+
+        // Nothing else can go. The frame runs without them rather than
+        // failing, and the next one tries again.
+        if (hr == E_OUTOFMEMORY)
+        {
+            m_policy.Defer(m_batch);
+
+            g_deferredResident.Add(count);
+
+            return S_OK;
+        }
+
+        if (FAILED(hr)) [[unlikely]]
+            return hr;
+
+        g_madeResident.Add(count);
+
+        return S_OK;
+    }
+
+    UINT ResidencyManager::PageablesOf(const std::vector<ObjectId>& ids)
+    {
+        m_pageables.clear();
+
+        for (const ObjectId id : ids)
+            m_pageables.push_back(m_objects[id].Get());
+
+        return static_cast<UINT>(m_pageables.size());
+    }
+
+    HRESULT ResidencyManager::UpdateBudget()
+    {
+        DXGI_QUERY_VIDEO_MEMORY_INFO info;
+
+        const HRESULT hr = m_adapter->QueryVideoMemoryInfo(0, DXGI_MEMORY_SEGMENT_GROUP_LOCAL, &info);
+
+        if (FAILED(hr)) [[unlikely]]
+            return hr;
+
+        // The budget covers the whole process; what is not tracked here, like
+        // swap chains and committed resources, is taken out of it
+        const std::uint64_t trackedBytes = std::min(m_policy.Stats().residentBytes, info.CurrentUsage);
+        const std::uint64_t untrackedBytes = info.CurrentUsage - trackedBytes;
+
+        const std::uint64_t budget = info.Budget > untrackedBytes ? info.Budget - untrackedBytes : 0;
+
+        m_policy.SetBudget(budget);
+
+        g_budgetBytes.Set(static_cast<std::int64_t>(info.Budget));
+
+        return S_OK;
+    }
+}
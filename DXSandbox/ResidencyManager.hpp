@@ -0,0 +1,71 @@
+#pragma once
+
+#include "WindowsPlatform.hpp"
+
+#include "ComPtr.hpp"
+#include "ResidencyPolicy.hpp"
+
+#include <d3d12.h>
+
+#include <cstdint>
+#include <vector>
+
+interface IDXGIAdapter3;
+
+namespace DXSandbox
+{
+    // Keeps the tracked heaps within the video memory budget of the adapter.
+    // A ResidencyPolicy decides what is resident, and each frame makes its
+    // decisions in one MakeResident and one Evict call. The budget is read
+    // again whenever the OS reports that it changed, and the next update
+    // trims to it.
+    class ResidencyManager final
+    {
+    public:
+        using ObjectId = ResidencyPolicy::ObjectId;
+
+        ResidencyManager(ComPtr<ID3D12Device> device, ComPtr<IDXGIAdapter3> adapter);
+        ~ResidencyManager();
+
+        ResidencyManager(const ResidencyManager&) = delete;
+        ResidencyManager& operator = (const ResidencyManager&) = delete;
+
+        // Objects are created resident
+        ObjectId Track(ComPtr<ID3D12Pageable> object, std::uint64_t size);
+        void Untrack(ObjectId id);
+
+        // The frame signaling fenceValue uses the object
+        void MarkUsed(ObjectId id, UINT64 fenceValue);
+
+        // Must be called before the lists of the frame execute; making the
+        // objects resident blocks until they are. Running out of video
+        // memory is not a failure: objects that cannot be made resident
+        // stay evicted until a later frame.
+        [[nodiscard]] HRESULT Update(UINT64 completedFenceValue);
+
+    private:
+        [[nodiscard]] HRESULT UpdateBudget();
+
+        // The calls of the batch
+        [[nodiscard]] HRESULT Evict();
+        [[nodiscard]] HRESULT MakeResident(UINT64 completedFenceValue);
+
+        UINT PageablesOf(const std::vector<ObjectId>& ids);
+
+    private:
+        ComPtr<ID3D12Device> m_device;
+        ComPtr<IDXGIAdapter3> m_adapter;
+
+        HANDLE m_budgetChangeEvent = nullptr;
+        DWORD m_budgetChangeCookie = 0;
+
+        ResidencyPolicy m_policy;
+        ResidencyPolicy::Batch m_batch;
+
+        // Indexed by object id; untracked objects leave an empty slot
+        std::vector<ComPtr<ID3D12Pageable>> m_objects;
+
+        // Reused for the arguments of the batched calls
+        std::vector<ID3D12Pageable*> m_pageables;
+    };
+}
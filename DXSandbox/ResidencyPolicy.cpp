@@ -0,0 +1,252 @@
+#include "ResidencyPolicy.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace DXSandbox
+{
+    void ResidencyPolicy::Batch::Clear() noexcept
+    {
+        makeResident.clear();
+        evict.clear();
+    }
+
+    ResidencyPolicy::ResidencyPolicy(std::uint64_t budget)
+        : m_budget{budget}
+    {
+    }
+
+    ResidencyPolicy::ObjectId ResidencyPolicy::Add(std::uint64_t size)
+    {
+        ObjectId id = InvalidObject;
+
+        if (m_freeIds.empty())
+        {
+            id = static_cast<ObjectId>(m_objects.size());
+            m_objects.emplace_back();
+        }
+        else
+        {
+            id = m_freeIds.back();
+            m_freeIds.pop_back();
+        }
+
+        m_objects[id] =
+        {
+            .size = size,
+            .isTracked = true,
+            .isResident = true
+        };
+
+        m_residentBytes += size;
+
+        LinkMostRecent(id);
+
+        return id;
+    }
+
+    void ResidencyPolicy::Remove(ObjectId id)
+    {
+        assert(id < m_objects.size() && m_objects[id].isTracked);
+
+        Object& object = m_objects[id];
+
+        if (object.isResident)
+        {
+            Unlink(id);
+            m_residentBytes -= object.size;
+        }
+
+        if (object.isPendingResident)
+            std::erase(m_pendingResident, id);
+
+        object = {};
+
+        m_freeIds.push_back(id);
+    }
+
+    void ResidencyPolicy::MarkUsed(ObjectId id, std::uint64_t fenceValue)
+    {
+        assert(id < m_objects.size() && m_objects[id].isTracked);
+
+        Object& object = m_objects[id];
+
+        object.lastUsed = std::max(object.lastUsed, fenceValue);
+
+        if (object.isResident)
+        {
+            Unlink(id);
+            LinkMostRecent(id);
+        }
+        else if (!object.isPendingResident)
+        {
+            object.isPendingResident = true;
+            m_pendingResident.push_back(id);
+        }
+    }
+
+    void ResidencyPolicy::SetBudget(std::uint64_t budget) noexcept
+    {
+        m_budget = budget;
+    }
+
+    std::uint64_t ResidencyPolicy::Budget() const noexcept
+    {
+        return m_budget;
+    }
+
+    void ResidencyPolicy::Update(std::uint64_t completedFenceValue, Batch& batch)
+    {
+        batch.Clear();
+
+        for (const ObjectId id : m_pendingResident)
+        {
+            Object& object = m_objects[id];
+
+            object.isPendingResident = false;
+            object.isResident = true;
+
+            m_residentBytes += object.size;
+
+            LinkMostRecent(id);
+
+            batch.makeResident.push_back(id);
+        }
+
+        m_pendingResident.clear();
+
+        EvictDownTo(m_budget, completedFenceValue, batch.evict);
+    }
+
+    bool ResidencyPolicy::Trim(std::uint64_t completedFenceValue, Batch& batch)
+    {
+        std::uint64_t bytes = 0;
+
+        for (const ObjectId id : batch.makeResident)
+            bytes += m_objects[id].size;
+
+        batch.evict.clear();
+
+        EvictDownTo(m_residentBytes - std::min(bytes, m_residentBytes), completedFenceValue, batch.evict);
+
+        return !batch.evict.empty();
+    }
+
+    void ResidencyPolicy::Defer(const Batch& batch)
+    {
+        for (const ObjectId id : batch.makeResident)
+        {
+            Object& object = m_objects[id];
+
+            assert(object.isResident && !object.isPendingResident);
+
+            Unlink(id);
+
+            object.isResident = false;
+            object.isPendingResident = true;
+            m_residentBytes -= object.size;
+
+            m_pendingResident.push_back(id);
+        }
+    }
+
+    bool ResidencyPolicy::IsResident(ObjectId id) const noexcept
+    {
+        assert(id < m_objects.size() && m_objects[id].isTracked);
+
+        return m_objects[id].isResident;
+    }
+
+    std::uint64_t ResidencyPolicy::LastUsed(ObjectId id) const noexcept
+    {
+        assert(id < m_objects.size() && m_objects[id].isTracked);
+
+        return m_objects[id].lastUsed;
+    }
+
+    ResidencyPolicy::Statistics ResidencyPolicy::Stats() const noexcept
+    {
+        Statistics stats;
+
+        for (const Object& object : m_objects)
+        {
+            if (!object.isTracked)
+                continue;
+
+            ++stats.objectCount;
+
+            if (object.isResident)
+            {
+                ++stats.residentCount;
+                stats.residentBytes += object.size;
+            }
+            else
+            {
+                stats.evictedBytes += object.size;
+            }
+        }
+
+        return stats;
+    }
+
+    void ResidencyPolicy::LinkMostRecent(ObjectId id) noexcept
+    {
+        Object& object = m_objects[id];
+
+        object.lessRecent = m_mostRecent;
+        object.moreRecent = InvalidObject;
+
+        if (m_mostRecent != InvalidObject)
+            m_objects[m_mostRecent].moreRecent = id;
+        else
+            m_leastRecent = id;
+
+        m_mostRecent = id;
+    }
+
+    void ResidencyPolicy::EvictDownTo(std::uint64_t residentBytes, std::uint64_t completedFenceValue,
+                                      std::vector<ObjectId>& evicted)
+    {
+        // Objects created but not used yet have no order among the others,
+        // so the whole list is walked rather than stopping at the first
+        // object in use
+        ObjectId id = m_leastRecent;
+
+        while (m_residentBytes > residentBytes && id != InvalidObject)
+        {
+            Object& object = m_objects[id];
+
+            const ObjectId next = object.moreRecent;
+
+            if (object.lastUsed <= completedFenceValue)
+            {
+                Unlink(id);
+
+                object.isResident = false;
+                m_residentBytes -= object.size;
+
+                evicted.push_back(id);
+            }
+
+            id = next;
+        }
+    }
+
+    void ResidencyPolicy::Unlink(ObjectId id) noexcept
+    {
+        Object& object = m_objects[id];
+
+        if (object.lessRecent != InvalidObject)
+            m_objects[object.lessRecent].moreRecent = object.moreRecent;
+        else
+            m_leastRecent = object.moreRecent;
+
+        if (object.moreRecent != InvalidObject)
+            m_objects[object.moreRecent].lessRecent = object.lessRecent;
+        else
+            m_mostRecent = object.lessRecent;
+
+        object.lessRecent = InvalidObject;
+        object.moreRecent = InvalidObject;
+    }
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace DXSandbox
+{
+    // Decides which objects stay in video memory under a budget. Resident
+    // objects are kept in least recently used order. Each frame, the evicted
+    // objects it uses are made resident again, then the least recently used
+    // objects the GPU has finished with are evicted until the resident bytes
+    // fit the budget. Uses are stamped with the fence value of the frame, so
+    // nothing a frame in flight reads is evicted. The policy knows nothing
+    // of the GPU; the caller makes the residency calls of each batch.
+    class ResidencyPolicy final
+    {
+    public:
+        using ObjectId = std::uint32_t;
+
+        static constexpr ObjectId InvalidObject = ~ObjectId{0};
+
+        static constexpr std::uint64_t Unlimited = std::numeric_limits<std::uint64_t>::max();
+
+        // Objects to make resident and to evict, each made in one call
+        struct Batch final
+        {
+            std::vector<ObjectId> makeResident;
+            std::vector<ObjectId> evict;
+
+            void Clear() noexcept;
+        };
+
+        struct Statistics final
+        {
+            std::uint32_t objectCount = 0;
+            std::uint32_t residentCount = 0;
+            std::uint64_t residentBytes = 0;
+            std::uint64_t evictedBytes = 0;
+        };
+
+        explicit ResidencyPolicy(std::uint64_t budget = Unlimited);
+
+        // Objects are created resident, which counts against the budget
+        ObjectId Add(std::uint64_t size);
+
+        // The caller keeps the object alive until the frames using it complete
+        void Remove(ObjectId id);
+
+        void MarkUsed(ObjectId id, std::uint64_t fenceValue);
+
+        void SetBudget(std::uint64_t budget) noexcept;
+        std::uint64_t Budget() const noexcept;
+
+        // Fills the batch for the frame about to be submitted. Objects used by
+        // a frame in flight are never evicted, so the frames alone may exceed
+        // the budget.
+        void Update(std::uint64_t completedFenceValue, Batch& batch);
+
+        // For when the objects the batch makes resident do not fit in video
+        // memory: replaces its evictions with least recently used objects the
+        // GPU has finished with, as many bytes as it makes resident, whatever
+        // the budget. False when nothing more can be evicted.
+        bool Trim(std::uint64_t completedFenceValue, Batch& batch);
+
+        // Gives up on the objects the batch makes resident; they are evicted
+        // again, and the next update retries them
+        void Defer(const Batch& batch);
+
+        bool IsResident(ObjectId id) const noexcept;
+
+        // Fence value of the last frame using the object, 0 for none yet
+        std::uint64_t LastUsed(ObjectId id) const noexcept;
+
+        Statistics Stats() const noexcept;
+
+    private:
+        struct Object final
+        {
+            std::uint64_t size = 0;
+            std::uint64_t lastUsed = 0;
+
+            // Neighbors in the list of resident objects
+            ObjectId lessRecent = InvalidObject;
+            ObjectId moreRecent = InvalidObject;
+
+            bool isTracked = false;
+            bool isResident = false;
+            bool isPendingResident = false;
+        };
+
+        void LinkMostRecent(ObjectId id) noexcept;
+        void Unlink(ObjectId id) noexcept;
+
+        // Least recently used first, skipping objects in use
+        void EvictDownTo(std::uint64_t residentBytes, std::uint64_t completedFenceValue,
+                         std::vector<ObjectId>& evicted);
+
+    private:
+        std::uint64_t m_budget = Unlimited;
+        std::uint64_t m_residentBytes = 0;
+
+        std::vector<Object> m_objects;
+        std::vector<ObjectId> m_freeIds;
+
+        ObjectId m_leastRecent = InvalidObject;
+        ObjectId m_mostRecent = InvalidObject;
+
+        // Evicted objects used since the last update
+        std::vector<ObjectId> m_pendingResident;
+    };
+}
@@ -0,0 +1,257 @@
+#include "SceneStore.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <execution>
+#include <numeric>
+
+namespace
+{
+    // Levels smaller than this are not worth the cost of a parallel dispatch
+    constexpr std::uint32_t ParallelLevelThreshold = 4096;
+}
+
+namespace DXSandbox
+{
+    SceneStore::SceneStore() = default;
+
+    SceneStore::~SceneStore() = default;
+
+    Entity SceneStore::CreateEntity(Entity parent, const Math::Float4x4& localTransform)
+    {
+        std::uint32_t parentIndex = NoParent;
+        std::uint32_t depth = 0;
+
+        if (parent.IsValid())
+        {
+            parentIndex = DenseIndex(parent);
+            depth = m_depths[parentIndex] + 1;
+        }
+
+        std::uint32_t slot = 0;
+
+        if (!m_freeSlots.empty())
+        {
+            slot = m_freeSlots.back();
+            m_freeSlots.pop_back();
+        }
+        else
+        {
+            slot = static_cast<std::uint32_t>(m_slotGenerations.size());
+            m_slotGenerations.push_back(0);
+            m_slotDenseIndices.push_back(DeadSlot);
+        }
+
+        const auto denseIndex = static_cast<std::uint32_t>(m_slots.size());
+
+        m_slots.push_back(slot);
+        m_parents.push_back(parentIndex);
+        m_depths.push_back(depth);
+        m_localTransforms.push_back(localTransform);
+        m_worldTransforms.push_back(localTransform);
+        m_dirtyFlags.push_back(1);
+
+        m_slotDenseIndices[slot] = denseIndex;
+
+        ++m_liveCount;
+
+        m_isSorted = false;
+        m_hasDirty = true;
+
+        return {slot, m_slotGenerations[slot]};
+    }
+
+    void SceneStore::DestroyEntity(Entity entity)
+    {
+        const std::uint32_t first = DenseIndex(entity);
+
+        auto release = [this](std::uint32_t denseIndex)
+        {
+            const std::uint32_t slot = m_slots[denseIndex];
+
+            ++m_slotGenerations[slot];
+            m_slotDenseIndices[slot] = DeadSlot;
+            m_freeSlots.push_back(slot);
+
+            m_slots[denseIndex] = DeadSlot;
+
+            --m_liveCount;
+        };
+
+        release(first);
+
+        // Descendants always follow their parents in dense order
+        for (auto i = first + 1; i < m_slots.size(); ++i)
+        {
+            const std::uint32_t parent = m_parents[i];
+
+            if (m_slots[i] != DeadSlot && parent != NoParent && m_slots[parent] == DeadSlot)
+                release(i);
+        }
+
+        m_isSorted = false;
+    }
+
+    bool SceneStore::IsAlive(Entity entity) const noexcept
+    {
+        return entity.index < m_slotGenerations.size() &&
+               m_slotGenerations[entity.index] == entity.generation &&
+               m_slotDenseIndices[entity.index] != DeadSlot;
+    }
+
+    std::size_t SceneStore::EntityCount() const noexcept
+    {
+        return m_liveCount;
+    }
+
+    void SceneStore::SetLocalTransform(Entity entity, const Math::Float4x4& localTransform)
+    {
+        const std::uint32_t denseIndex = DenseIndex(entity);
+
+        m_localTransforms[denseIndex] = localTransform;
+        m_dirtyFlags[denseIndex] = 1;
+
+        m_hasDirty = true;
+    }
+
+    const Math::Float4x4& SceneStore::LocalTransform(Entity entity) const
+    {
+        return m_localTransforms[DenseIndex(entity)];
+    }
+
+    const Math::Float4x4& SceneStore::WorldTransform(Entity entity) const
+    {
+        return m_worldTransforms[DenseIndex(entity)];
+    }
+
+    void SceneStore::UpdateTransforms()
+    {
+        if (!m_isSorted)
+            SortHierarchy();
+
+        if (!m_hasDirty)
+            return;
+
+        for (std::size_t level = 0; level + 1 < m_levelOffsets.size(); ++level)
+            UpdateLevel(m_levelOffsets[level], m_levelOffsets[level + 1]);
+
+        std::fill(m_dirtyFlags.begin(), m_dirtyFlags.end(), std::uint8_t{0});
+
+        m_hasDirty = false;
+    }
+
+    std::span<const Math::Float4x4> SceneStore::WorldTransforms() const noexcept
+    {
+        assert(m_isSorted);
+
+        return m_worldTransforms;
+    }
+
+    std::uint32_t SceneStore::DenseIndex(Entity entity) const noexcept
+    {
+        assert(IsAlive(entity));
+
+        return m_slotDenseIndices[entity.index];
+    }
+
+    void SceneStore::SortHierarchy()
+    {
+        const std::size_t count = m_slots.size();
+
+        std::uint32_t maxDepth = 0;
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            if (m_slots[i] != DeadSlot)
+                maxDepth = std::max(maxDepth, m_depths[i]);
+        }
+
+        // Counting sort by depth, stable within a level
+        std::vector<std::uint32_t> levelOffsets(static_cast<std::size_t>(maxDepth) + 2, 0);
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            if (m_slots[i] != DeadSlot)
+                ++levelOffsets[m_depths[i] + 1];
+        }
+
+        std::partial_sum(levelOffsets.begin(), levelOffsets.end(), levelOffsets.begin());
+
+        std::vector<std::uint32_t> cursors(levelOffsets.begin(), levelOffsets.end() - 1);
+        std::vector<std::uint32_t> remap(count, NoParent);
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            if (m_slots[i] != DeadSlot)
+                remap[i] = cursors[m_depths[i]]++;
+        }
+
+        std::vector<std::uint32_t> slots(m_liveCount);
+        std::vector<std::uint32_t> parents(m_liveCount);
+        std::vector<std::uint32_t> depths(m_liveCount);
+        std::vector<Math::Float4x4> localTransforms(m_liveCount);
+        std::vector<Math::Float4x4> worldTransforms(m_liveCount);
+        std::vector<std::uint8_t> dirtyFlags(m_liveCount);
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            if (m_slots[i] == DeadSlot)
+                continue;
+
+            const std::uint32_t target = remap[i];
+            const std::uint32_t parent = m_parents[i];
+
+            slots[target] = m_slots[i];
+            parents[target] = parent != NoParent ? remap[parent] : NoParent;
+            depths[target] = m_depths[i];
+            localTransforms[target] = m_localTransforms[i];
+            worldTransforms[target] = m_worldTransforms[i];
+            dirtyFlags[target] = m_dirtyFlags[i];
+
+            m_slotDenseIndices[m_slots[i]] = target;
+        }
+
+        m_slots = std::move(slots);
+        m_parents = std::move(parents);
+        m_depths = std::move(depths);
+        m_localTransforms = std::move(localTransforms);
+        m_worldTransforms = std::move(worldTransforms);
+        m_dirtyFlags = std::move(dirtyFlags);
+
+        m_levelOffsets = std::move(levelOffsets);
+
+        m_iterationIndices.resize(m_liveCount);
+        std::iota(m_iterationIndices.begin(), m_iterationIndices.end(), 0U);
+
+        m_isSorted = true;
+    }
+
+    void SceneStore::UpdateLevel(std::uint32_t first, std::uint32_t last)
+    {
+        // Entries of one level only read their parents, which belong to the
+        // previous, already updated level, and only write their own slots.
+        auto update = [this](std::uint32_t i) noexcept
+        {
+            const std::uint32_t parent = m_parents[i];
+
+            if (parent == NoParent)
+            {
+                if (m_dirtyFlags[i])
+                    m_worldTransforms[i] = m_localTransforms[i];
+            }
+            else if (m_dirtyFlags[i] || m_dirtyFlags[parent])
+            {
+                m_dirtyFlags[i] = 1;
+                m_worldTransforms[i] = m_localTransforms[i] * m_worldTransforms[parent];
+            }
+        };
+
+        const auto begin = m_iterationIndices.begin() + first;
+        const auto end = m_iterationIndices.begin() + last;
+
+        if (last - first < ParallelLevelThreshold)
+            std::for_each(begin, end, update);
+        else
+            std::for_each(std::execution::par, begin, end, update);
+    }
+}
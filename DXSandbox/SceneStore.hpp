@@ -0,0 +1,91 @@
+#pragma once
+
+#include "Math.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace DXSandbox
+{
+    struct Entity final
+    {
+        static constexpr std::uint32_t InvalidIndex = std::numeric_limits<std::uint32_t>::max();
+
+        std::uint32_t index = InvalidIndex;
+        std::uint32_t generation = 0;
+
+        bool IsValid() const noexcept { return index != InvalidIndex; }
+
+        friend bool operator == (Entity, Entity) = default;
+    };
+
+    // Entities with a transform are stored as a single structure-of-arrays
+    // archetype. The dense arrays are kept sorted by hierarchy depth, so each
+    // level is a contiguous range whose entries only depend on the previous
+    // level and can be updated in parallel.
+    class SceneStore final
+    {
+    public:
+        SceneStore();
+        ~SceneStore();
+
+        SceneStore(const SceneStore&) = delete;
+        SceneStore& operator = (const SceneStore&) = delete;
+
+        Entity CreateEntity(Entity parent = {}, const Math::Float4x4& localTransform = {});
+
+        // Destroys the entity together with all of its descendants
+        void DestroyEntity(Entity entity);
+
+        bool IsAlive(Entity entity) const noexcept;
+
+        std::size_t EntityCount() const noexcept;
+
+        void SetLocalTransform(Entity entity, const Math::Float4x4& localTransform);
+
+        const Math::Float4x4& LocalTransform(Entity entity) const;
+        const Math::Float4x4& WorldTransform(Entity entity) const;
+
+        // Recomputes world transforms of dirty entities and their subtrees
+        void UpdateTransforms();
+
+        // World transforms of all live entities in storage order, as of the
+        // last UpdateTransforms
+        std::span<const Math::Float4x4> WorldTransforms() const noexcept;
+
+    private:
+        std::uint32_t DenseIndex(Entity entity) const noexcept;
+
+        void SortHierarchy();
+        void UpdateLevel(std::uint32_t first, std::uint32_t last);
+
+    private:
+        static constexpr std::uint32_t NoParent = std::numeric_limits<std::uint32_t>::max();
+        static constexpr std::uint32_t DeadSlot = std::numeric_limits<std::uint32_t>::max();
+
+        // Entity table, indexed by Entity::index
+        std::vector<std::uint32_t> m_slotDenseIndices;
+        std::vector<std::uint32_t> m_slotGenerations;
+        std::vector<std::uint32_t> m_freeSlots;
+
+        // Transform archetype, indexed by dense index. A parent always has a
+        // smaller dense index than its children, sorted or not.
+        std::vector<std::uint32_t> m_slots;
+        std::vector<std::uint32_t> m_parents;
+        std::vector<std::uint32_t> m_depths;
+        std::vector<Math::Float4x4> m_localTransforms;
+        std::vector<Math::Float4x4> m_worldTransforms;
+        std::vector<std::uint8_t> m_dirtyFlags;
+
+        // Level L occupies dense range [m_levelOffsets[L], m_levelOffsets[L + 1])
+        std::vector<std::uint32_t> m_levelOffsets;
+        std::vector<std::uint32_t> m_iterationIndices;
+
+        std::size_t m_liveCount = 0;
+
+        bool m_isSorted = true;
+        bool m_hasDirty = false;
+    };
+}
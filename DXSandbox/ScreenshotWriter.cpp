@@ -0,0 +1,70 @@
+#include "ScreenshotWriter.hpp"
+
+#include "Debug.hpp"
+#include "Instrumentation.hpp"
+#include "QoiEncoder.hpp"
+
+#include <chrono>
+#include <exception>
+#include <format>
+#include <fstream>
+
+namespace
+{
+    using DXSandbox::Instrumentation::Counter;
+
+    Counter g_screenshots{"Screenshot.Written"};
+    Counter g_failedScreenshots{"Screenshot.Failed"};
+    Counter g_encodeTime{"Screenshot.LastEncodeMicroseconds"};
+
+    void WriteScreenshot(const std::filesystem::path& directory, const DXSandbox::ReadbackImage& image)
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        // The swap chain alpha is meaningless, so only RGB is kept
+        const std::vector<std::uint8_t> encoded = DXSandbox::Qoi::Encode(
+        {
+            .pixels = image.pixels,
+            .width = image.width,
+            .height = image.height,
+            .rowPitch = image.rowPitch
+        }, 3);
+
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+
+        g_encodeTime.Set(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+
+        std::filesystem::create_directories(directory);
+
+        const std::filesystem::path path = directory / std::format("Frame{:06}.qoi", image.frameIndex);
+
+        std::ofstream file{path, std::ios::binary};
+
+        file.write(reinterpret_cast<const char*>(encoded.data()), static_cast<std::streamsize>(encoded.size()));
+
+        if (!file)
+            throw std::ios_base::failure{"Failed to write " + path.string()};
+    }
+}
+
+namespace DXSandbox
+{
+    ReadbackHandler MakeScreenshotWriter(std::filesystem::path directory)
+    {
+        return [directory = std::move(directory)](const ReadbackImage& image)
+        {
+            try
+            {
+                WriteScreenshot(directory, image);
+
+                g_screenshots.Add(1);
+            }
+            catch (const std::exception& e)
+            {
+                g_failedScreenshots.Add(1);
+
+                Debug::WriteLine("Screenshot of frame {} failed: {}", image.frameIndex, e.what());
+            }
+        };
+    }
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "ReadbackImage.hpp"
+
+#include <filesystem>
+
+namespace DXSandbox
+{
+    // Returns a readback handler that encodes the frame as QOI and writes it
+    // to Frame<index>.qoi in the directory, which is created when missing.
+    // Failures are logged and counted rather than thrown.
+    ReadbackHandler MakeScreenshotWriter(std::filesystem::path directory);
+}
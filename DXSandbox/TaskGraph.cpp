@@ -0,0 +1,147 @@
+#include "TaskGraph.hpp"
+
+#include "AllocationTracking.hpp"
+#include "TraceRecorder.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace DXSandbox
+{
+    TaskGraph::TaskId TaskGraph::Add(std::string name,
+                                     std::function<void()> function,
+                                     std::initializer_list<TaskId> dependencies)
+    {
+        assert(function);
+
+        const TaskId id = m_tasks.size();
+
+        for (const TaskId dependency : dependencies)
+        {
+            assert(dependency < id);
+            m_tasks[dependency].dependents.push_back(id);
+        }
+
+        m_tasks.push_back(
+        {
+            .name = std::move(name),
+            .function = std::move(function),
+            .dependents = {},
+            .dependencyCount = dependencies.size()
+        });
+
+        return id;
+    }
+
+    void TaskGraph::Run(TraceRecorder* trace)
+    {
+        std::mutex mutex;
+        std::condition_variable stateChanged;
+
+        std::deque<TaskId> queue;
+        std::vector<std::size_t> pendingDependencies(m_tasks.size());
+        std::size_t finishedCount = 0;
+        std::exception_ptr error;
+
+        for (TaskId id = 0; id < m_tasks.size(); ++id)
+        {
+            pendingDependencies[id] = m_tasks[id].dependencyCount;
+
+            if (pendingDependencies[id] == 0)
+                queue.push_back(id);
+        }
+
+        // Tasks allocate for the caller, on whichever thread they run
+        const AllocationTracking::Tag callerTag = AllocationTracking::CurrentTag();
+
+        const auto execute = [&](TaskId id)
+        {
+            const AllocationTracking::TagScope tag{callerTag};
+
+            Task& task = m_tasks[id];
+
+            std::exception_ptr taskError;
+
+            {
+                const TraceScope scope{trace, task.name};
+
+                try
+                {
+                    task.function();
+                }
+                catch (...)
+                {
+                    taskError = std::current_exception();
+                }
+            }
+
+            {
+                const std::scoped_lock lock{mutex};
+
+                ++finishedCount;
+
+                if (taskError && !error)
+                    error = taskError;
+
+                if (!error)
+                {
+                    for (const TaskId dependent : task.dependents)
+                    {
+                        if (--pendingDependencies[dependent] == 0)
+                            queue.push_back(dependent);
+                    }
+                }
+            }
+
+            stateChanged.notify_all();
+        };
+
+        // Pops the next task from the queue; returns false once the graph has
+        // finished or failed
+        const auto next = [&](TaskId& id)
+        {
+            std::unique_lock lock{mutex};
+
+            stateChanged.wait(lock, [&]
+            {
+                return error || finishedCount == m_tasks.size() || !queue.empty();
+            });
+
+            if (error || queue.empty())
+                return false;
+
+            id = queue.front();
+            queue.pop_front();
+
+            return true;
+        };
+
+        const auto work = [&]
+        {
+            for (TaskId id = 0; next(id);)
+                execute(id);
+        };
+
+        // The calling thread is one of the workers
+        const std::size_t hardwareThreads = std::max(std::thread::hardware_concurrency(), 1u);
+        const std::size_t workerCount = std::min<std::size_t>(m_tasks.size(), hardwareThreads);
+
+        std::vector<std::jthread> workers;
+        workers.reserve(workerCount);
+
+        for (std::size_t i = 1; i < workerCount; ++i)
+            workers.emplace_back(work);
+
+        work();
+
+        workers.clear();
+
+        if (error)
+            std::rethrow_exception(error);
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+namespace DXSandbox
+{
+    class TraceRecorder;
+
+    // One-shot dependency graph of tasks. Run executes every task once, each
+    // as soon as its dependencies have finished, on the thread calling Run
+    // and a set of worker threads that lives for the duration of the run.
+    class TaskGraph final
+    {
+    public:
+        using TaskId = std::size_t;
+
+        TaskGraph() = default;
+
+        TaskGraph(const TaskGraph&) = delete;
+        TaskGraph& operator = (const TaskGraph&) = delete;
+
+        // Dependencies must be tasks added before, so the graph has no cycles
+        TaskId Add(std::string name,
+                   std::function<void()> function,
+                   std::initializer_list<TaskId> dependencies = {});
+
+        // Every task is recorded in the trace. After a task throws no new
+        // tasks are started and the exception is rethrown once the running
+        // ones have finished.
+        void Run(TraceRecorder* trace = nullptr);
+
+    private:
+        struct Task final
+        {
+            std::string name;
+            std::function<void()> function;
+            std::vector<TaskId> dependents;
+            std::size_t dependencyCount = 0;
+        };
+
+        std::vector<Task> m_tasks;
+    };
+}
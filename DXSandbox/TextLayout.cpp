@@ -0,0 +1,132 @@
+#include "TextLayout.hpp"
+
+#include "GlyphAtlas.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    const DXSandbox::GlyphAtlas::Glyph* FindOrFallback(const DXSandbox::GlyphAtlas& atlas, char character) noexcept
+    {
+        const DXSandbox::GlyphAtlas::Glyph* glyph = atlas.Find(character);
+
+        return glyph ? glyph : atlas.Find('?');
+    }
+}
+
+namespace DXSandbox
+{
+    TextLayout::TextLayout(const GlyphAtlas& atlas)
+        : m_atlas{atlas}
+    {
+    }
+
+    float TextLayout::AddText(float x, float y, std::string_view text, std::uint32_t color)
+    {
+        const float left = std::round(x);
+
+        float penX = left;
+        float penY = std::round(y);
+        float maxWidth = 0.0f;
+
+        for (const char character : text)
+        {
+            if (character == '\n')
+            {
+                maxWidth = std::max(maxWidth, penX - left);
+
+                penX = left;
+                penY += m_atlas.LineHeight();
+                continue;
+            }
+
+            const GlyphAtlas::Glyph* glyph = FindOrFallback(m_atlas, character);
+
+            if (!glyph)
+                continue;
+
+            if (glyph->width > 0.0f)
+            {
+                const float glyphLeft = penX + glyph->left;
+                const float glyphTop = penY + glyph->top;
+
+                m_quads.push_back(
+                {
+                    .left = glyphLeft,
+                    .top = glyphTop,
+                    .right = glyphLeft + glyph->width,
+                    .bottom = glyphTop + glyph->height,
+                    .u0 = glyph->u0,
+                    .v0 = glyph->v0,
+                    .u1 = glyph->u1,
+                    .v1 = glyph->v1,
+                    .color = color
+                });
+            }
+
+            penX += std::round(glyph->advance);
+        }
+
+        return std::max(maxWidth, penX - left);
+    }
+
+    void TextLayout::AddRect(float x, float y, float width, float height, std::uint32_t color)
+    {
+        if (width <= 0.0f || height <= 0.0f)
+            return;
+
+        // Every corner samples the middle of the solid block
+        const float u = m_atlas.SolidU();
+        const float v = m_atlas.SolidV();
+
+        m_quads.push_back(
+        {
+            .left = x,
+            .top = y,
+            .right = x + width,
+            .bottom = y + height,
+            .u0 = u,
+            .v0 = v,
+            .u1 = u,
+            .v1 = v,
+            .color = color
+        });
+    }
+
+    float TextLayout::Measure(std::string_view text) const noexcept
+    {
+        float width = 0.0f;
+        float maxWidth = 0.0f;
+
+        for (const char character : text)
+        {
+            if (character == '\n')
+            {
+                maxWidth = std::max(maxWidth, width);
+                width = 0.0f;
+                continue;
+            }
+
+            if (const GlyphAtlas::Glyph* glyph = FindOrFallback(m_atlas, character))
+                width += std::round(glyph->advance);
+        }
+
+        return std::max(maxWidth, width);
+    }
+
+    float TextLayout::LineHeight() const noexcept
+    {
+        return m_atlas.LineHeight();
+    }
+
+    std::span<const TextQuad> TextLayout::Quads() const noexcept
+    {
+        return m_quads;
+    }
+
+    void TextLayout::Clear() noexcept
+    {
+        m_quads.clear();
+    }
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace DXSandbox
+{
+    class GlyphAtlas;
+
+    // One textured rectangle in pixels of the target, as read by the
+    // overlay shader per instance
+    struct TextQuad final
+    {
+        float left = 0.0f;
+        float top = 0.0f;
+        float right = 0.0f;
+        float bottom = 0.0f;
+
+        float u0 = 0.0f;
+        float v0 = 0.0f;
+        float u1 = 0.0f;
+        float v1 = 0.0f;
+
+        // RGBA, red in the low byte
+        std::uint32_t color = 0;
+    };
+
+    // Turns text and rectangles into quads sampling a glyph atlas, so a
+    // whole overlay is drawn with one instanced draw. Pens are snapped to
+    // whole pixels, which keeps unscaled glyphs sharp.
+    class TextLayout final
+    {
+    public:
+        explicit TextLayout(const GlyphAtlas& atlas);
+
+        TextLayout(const TextLayout&) = delete;
+        TextLayout& operator = (const TextLayout&) = delete;
+
+        // The text starts at the top left corner given, and each line feed
+        // starts a line below it. Characters without a glyph are drawn as
+        // '?'. Returns the width of the widest line.
+        float AddText(float x, float y, std::string_view text, std::uint32_t color);
+
+        void AddRect(float x, float y, float width, float height, std::uint32_t color);
+
+        // Width of the widest line, without laying it out
+        float Measure(std::string_view text) const noexcept;
+
+        float LineHeight() const noexcept;
+
+        std::span<const TextQuad> Quads() const noexcept;
+
+        // Keeps the capacity for the next frame
+        void Clear() noexcept;
+
+    private:
+        const GlyphAtlas& m_atlas;
+
+        std::vector<TextQuad> m_quads;
+    };
+}
@@ -0,0 +1,79 @@
+#include "ThreadPool.hpp"
+
+#include <cassert>
+
+namespace DXSandbox
+{
+    ThreadPool::ThreadPool(std::size_t threadCount)
+    {
+        assert(threadCount > 0);
+
+        m_threads.reserve(threadCount);
+
+        for (std::size_t i = 0; i < threadCount; ++i)
+            m_threads.emplace_back([this](std::stop_token stopToken) { WorkerLoop(stopToken); });
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        for (std::jthread& thread : m_threads)
+            thread.request_stop();
+
+        m_threads.clear();
+    }
+
+    void ThreadPool::Submit(Job job)
+    {
+        assert(job);
+
+        {
+            const std::scoped_lock lock{m_mutex};
+
+            QueuedJob* queued = m_jobPool.Create(std::move(job));
+
+            if (m_lastJob)
+                m_lastJob->next = queued;
+            else
+                m_firstJob = queued;
+
+            m_lastJob = queued;
+        }
+
+        m_jobAvailable.notify_one();
+    }
+
+    std::size_t ThreadPool::ThreadCount() const noexcept
+    {
+        return m_threads.size();
+    }
+
+    void ThreadPool::WorkerLoop(std::stop_token stopToken)
+    {
+        for (;;)
+        {
+            Job job;
+
+            {
+                std::unique_lock lock{m_mutex};
+
+                m_jobAvailable.wait(lock, stopToken, [this] { return m_firstJob != nullptr; });
+
+                // Stopping only once everything queued has run
+                if (!m_firstJob)
+                    return;
+
+                QueuedJob* queued = m_firstJob;
+
+                m_firstJob = queued->next;
+
+                if (!m_firstJob)
+                    m_lastJob = nullptr;
+
+                job = std::move(queued->job);
+                m_jobPool.Destroy(queued);
+            }
+
+            job();
+        }
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "PoolAllocator.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+namespace DXSandbox
+{
+    // Fixed set of worker threads running jobs in submission order. Jobs
+    // must not throw. Destruction runs the jobs still queued, then joins.
+    class ThreadPool final
+    {
+    public:
+        using Job = std::function<void()>;
+
+        explicit ThreadPool(std::size_t threadCount);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator = (const ThreadPool&) = delete;
+
+        void Submit(Job job);
+
+        std::size_t ThreadCount() const noexcept;
+
+    private:
+        void WorkerLoop(std::stop_token stopToken);
+
+    private:
+        struct QueuedJob final
+        {
+            Job job;
+            QueuedJob* next = nullptr;
+        };
+
+        std::mutex m_mutex;
+        std::condition_variable_any m_jobAvailable;
+
+        // Jobs are queued every frame, so the queue takes its nodes from a
+        // pool, which stops allocating once it holds the most jobs ever
+        // queued at once
+        ObjectPool<QueuedJob> m_jobPool;
+        QueuedJob* m_firstJob = nullptr;
+        QueuedJob* m_lastJob = nullptr;
+
+        // Joined first on destruction, while the queue still exists
+        std::vector<std::jthread> m_threads;
+    };
+}
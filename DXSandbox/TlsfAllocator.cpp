@@ -0,0 +1,333 @@
+#include "TlsfAllocator.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <stdexcept>
+
+namespace
+{
+    inline std::uint64_t AlignUp(std::uint64_t value, std::uint64_t alignment) noexcept
+    {
+        assert(std::has_single_bit(alignment));
+
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+}
+
+namespace DXSandbox
+{
+    TlsfAllocator::TlsfAllocator(std::uint64_t capacity)
+        : m_capacity{capacity & ~(MinBlockSize - 1)}
+    {
+        static_assert(MinBlockSize >= SecondLevelCount);
+
+        if (m_capacity < MinBlockSize)
+            throw std::invalid_argument{"TLSF capacity is too small"};
+
+        for (auto& lists : m_freeLists)
+            lists.fill(InvalidHandle);
+
+        const Handle first = NewBlock();
+
+        assert(first == FirstBlock);
+
+        m_blocks[first].size = m_capacity;
+
+        InsertFree(first);
+    }
+
+    TlsfAllocator::Allocation TlsfAllocator::Allocate(std::uint64_t size, std::uint64_t alignment)
+    {
+        assert(std::has_single_bit(alignment));
+
+        if (size == 0 || size > m_capacity)
+            return {};
+
+        alignment = std::max(alignment, MinBlockSize);
+        size = AlignUp(size, MinBlockSize);
+
+        // Offsets are multiples of MinBlockSize, so this covers any padding
+        const std::uint64_t searchSize = size + alignment - MinBlockSize;
+
+        if (searchSize > m_capacity)
+            return {};
+
+        const Handle handle = FindFree(searchSize);
+
+        if (handle == InvalidHandle)
+            return {};
+
+        RemoveFree(handle);
+
+        const std::uint64_t padding = AlignUp(m_blocks[handle].offset, alignment) - m_blocks[handle].offset;
+
+        if (padding > 0)
+            SplitFront(handle, padding);
+
+        if (m_blocks[handle].size - size >= MinBlockSize)
+            SplitBack(handle, size);
+
+        Block& block = m_blocks[handle];
+
+        block.isFree = false;
+
+        m_usedBytes += block.size;
+        ++m_allocationCount;
+
+        return {block.offset, block.size, handle};
+    }
+
+    void TlsfAllocator::Free(Handle handle) noexcept
+    {
+        assert(handle < m_blocks.size());
+        assert(!m_blocks[handle].isFree && m_blocks[handle].size > 0);
+
+        m_usedBytes -= m_blocks[handle].size;
+        --m_allocationCount;
+
+        m_blocks[handle].isFree = true;
+
+        const Handle next = m_blocks[handle].nextPhysical;
+
+        if (next != InvalidHandle && m_blocks[next].isFree)
+        {
+            RemoveFree(next);
+
+            m_blocks[handle].size += m_blocks[next].size;
+            m_blocks[handle].nextPhysical = m_blocks[next].nextPhysical;
+
+            if (m_blocks[handle].nextPhysical != InvalidHandle)
+                m_blocks[m_blocks[handle].nextPhysical].prevPhysical = handle;
+
+            ReleaseBlock(next);
+        }
+
+        Handle merged = handle;
+
+        const Handle prev = m_blocks[handle].prevPhysical;
+
+        if (prev != InvalidHandle && m_blocks[prev].isFree)
+        {
+            RemoveFree(prev);
+
+            m_blocks[prev].size += m_blocks[handle].size;
+            m_blocks[prev].nextPhysical = m_blocks[handle].nextPhysical;
+
+            if (m_blocks[prev].nextPhysical != InvalidHandle)
+                m_blocks[m_blocks[prev].nextPhysical].prevPhysical = prev;
+
+            ReleaseBlock(handle);
+
+            merged = prev;
+        }
+
+        InsertFree(merged);
+    }
+
+    TlsfAllocator::Statistics TlsfAllocator::Stats() const noexcept
+    {
+        Statistics stats =
+        {
+            .capacity = m_capacity,
+            .usedBytes = m_usedBytes,
+            .allocationCount = m_allocationCount
+        };
+
+        for (unsigned firstLevel = 0; firstLevel < FirstLevelCount; ++firstLevel)
+        {
+            for (unsigned secondLevel = 0; secondLevel < SecondLevelCount; ++secondLevel)
+            {
+                for (Handle handle = m_freeLists[firstLevel][secondLevel];
+                     handle != InvalidHandle; handle = m_blocks[handle].nextFree)
+                {
+                    stats.largestFreeBlock = std::max(stats.largestFreeBlock, m_blocks[handle].size);
+                    ++stats.freeBlockCount;
+                }
+            }
+        }
+
+        return stats;
+    }
+
+    TlsfAllocator::ListIndex TlsfAllocator::MapSize(std::uint64_t size) noexcept
+    {
+        // Sizes are at least MinBlockSize, so the first level is always large
+        // enough for the second-level shift to be valid
+        const auto firstLevel = static_cast<unsigned>(std::bit_width(size) - 1);
+        const auto secondLevel = static_cast<unsigned>((size >> (firstLevel - SecondLevelBits)) - SecondLevelCount);
+
+        return {firstLevel, secondLevel};
+    }
+
+    std::uint64_t TlsfAllocator::RoundUpToList(std::uint64_t size) noexcept
+    {
+        // Every block in the list found for the rounded size is guaranteed to fit
+        const auto firstLevel = static_cast<unsigned>(std::bit_width(size) - 1);
+
+        return size + (1ULL << (firstLevel - SecondLevelBits)) - 1;
+    }
+
+    TlsfAllocator::Handle TlsfAllocator::NewBlock()
+    {
+        if (!m_unusedBlocks.empty())
+        {
+            const Handle handle = m_unusedBlocks.back();
+            m_unusedBlocks.pop_back();
+
+            m_blocks[handle] = {};
+
+            return handle;
+        }
+
+        m_blocks.emplace_back();
+
+        // Keeps ReleaseBlock from allocating
+        m_unusedBlocks.reserve(m_blocks.size());
+
+        return static_cast<Handle>(m_blocks.size() - 1);
+    }
+
+    void TlsfAllocator::ReleaseBlock(Handle handle) noexcept
+    {
+        assert(handle != FirstBlock);
+
+        // A zero size marks the node as unused for the asserts above
+        m_blocks[handle] = {};
+        m_unusedBlocks.push_back(handle);
+    }
+
+    void TlsfAllocator::InsertFree(Handle handle) noexcept
+    {
+        Block& block = m_blocks[handle];
+
+        const auto [firstLevel, secondLevel] = MapSize(block.size);
+
+        Handle& head = m_freeLists[firstLevel][secondLevel];
+
+        block.isFree = true;
+        block.prevFree = InvalidHandle;
+        block.nextFree = head;
+
+        if (head != InvalidHandle)
+            m_blocks[head].prevFree = handle;
+
+        head = handle;
+
+        m_firstLevelBitmap |= 1ULL << firstLevel;
+        m_secondLevelBitmaps[firstLevel] |= 1U << secondLevel;
+    }
+
+    void TlsfAllocator::RemoveFree(Handle handle) noexcept
+    {
+        Block& block = m_blocks[handle];
+
+        assert(block.isFree);
+
+        const auto [firstLevel, secondLevel] = MapSize(block.size);
+
+        if (block.prevFree != InvalidHandle)
+            m_blocks[block.prevFree].nextFree = block.nextFree;
+        else
+            m_freeLists[firstLevel][secondLevel] = block.nextFree;
+
+        if (block.nextFree != InvalidHandle)
+            m_blocks[block.nextFree].prevFree = block.prevFree;
+
+        if (m_freeLists[firstLevel][secondLevel] == InvalidHandle)
+        {
+            m_secondLevelBitmaps[firstLevel] &= ~(1U << secondLevel);
+
+            if (m_secondLevelBitmaps[firstLevel] == 0)
+                m_firstLevelBitmap &= ~(1ULL << firstLevel);
+        }
+
+        block.prevFree = InvalidHandle;
+        block.nextFree = InvalidHandle;
+        block.isFree = false;
+    }
+
+    TlsfAllocator::Handle TlsfAllocator::FindFree(std::uint64_t size) const noexcept
+    {
+        auto [firstLevel, secondLevel] = MapSize(RoundUpToList(size));
+
+        if (firstLevel < FirstLevelCount)
+        {
+            std::uint32_t secondLevelMap = m_secondLevelBitmaps[firstLevel] & (~0U << secondLevel);
+
+            if (secondLevelMap == 0 && firstLevel + 1 < FirstLevelCount)
+            {
+                const std::uint64_t firstLevelMap = m_firstLevelBitmap & (~0ULL << (firstLevel + 1));
+
+                if (firstLevelMap != 0)
+                {
+                    firstLevel = static_cast<unsigned>(std::countr_zero(firstLevelMap));
+                    secondLevelMap = m_secondLevelBitmaps[firstLevel];
+                }
+            }
+
+            if (secondLevelMap != 0)
+                return m_freeLists[firstLevel][std::countr_zero(secondLevelMap)];
+        }
+
+        // Good fit failed; the list of the exact size class may still hold a
+        // block that is large enough
+        const auto [exactFirstLevel, exactSecondLevel] = MapSize(size);
+
+        for (Handle handle = m_freeLists[exactFirstLevel][exactSecondLevel];
+             handle != InvalidHandle; handle = m_blocks[handle].nextFree)
+        {
+            if (m_blocks[handle].size >= size)
+                return handle;
+        }
+
+        return InvalidHandle;
+    }
+
+    void TlsfAllocator::SplitFront(Handle handle, std::uint64_t size)
+    {
+        assert(size % MinBlockSize == 0 && size < m_blocks[handle].size);
+
+        const Handle front = NewBlock();
+
+        Block& block = m_blocks[handle];
+        Block& frontBlock = m_blocks[front];
+
+        frontBlock.offset = block.offset;
+        frontBlock.size = size;
+        frontBlock.prevPhysical = block.prevPhysical;
+        frontBlock.nextPhysical = handle;
+
+        if (block.prevPhysical != InvalidHandle)
+            m_blocks[block.prevPhysical].nextPhysical = front;
+
+        block.prevPhysical = front;
+        block.offset += size;
+        block.size -= size;
+
+        InsertFree(front);
+    }
+
+    void TlsfAllocator::SplitBack(Handle handle, std::uint64_t size)
+    {
+        assert(size % MinBlockSize == 0 && size < m_blocks[handle].size);
+
+        const Handle back = NewBlock();
+
+        Block& block = m_blocks[handle];
+        Block& backBlock = m_blocks[back];
+
+        backBlock.offset = block.offset + size;
+        backBlock.size = block.size - size;
+        backBlock.prevPhysical = handle;
+        backBlock.nextPhysical = block.nextPhysical;
+
+        if (block.nextPhysical != InvalidHandle)
+            m_blocks[block.nextPhysical].prevPhysical = back;
+
+        block.nextPhysical = back;
+        block.size = size;
+
+        InsertFree(back);
+    }
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace DXSandbox
+{
+    // Two-level segregated fit allocator over an abstract range of offsets.
+    // It never touches the memory it manages, so it can carve up GPU heaps as
+    // well as anything else addressed by offset. Allocation and free are O(1).
+    class TlsfAllocator final
+    {
+    public:
+        using Handle = std::uint32_t;
+
+        static constexpr Handle InvalidHandle = std::numeric_limits<Handle>::max();
+
+        // Granularity of every offset and size handed out
+        static constexpr std::uint64_t MinBlockSize = 256;
+
+        struct Allocation final
+        {
+            std::uint64_t offset = 0;
+            std::uint64_t size = 0;
+            Handle handle = InvalidHandle;
+
+            bool IsValid() const noexcept { return handle != InvalidHandle; }
+        };
+
+        struct Statistics final
+        {
+            std::uint64_t capacity = 0;
+            std::uint64_t usedBytes = 0;
+            std::uint64_t largestFreeBlock = 0;
+            std::uint32_t allocationCount = 0;
+            std::uint32_t freeBlockCount = 0;
+
+            std::uint64_t FreeBytes() const noexcept { return capacity - usedBytes; }
+
+            // 0 when all free space is one block, approaching 1 as it splinters
+            float Fragmentation() const noexcept
+            {
+                const std::uint64_t freeBytes = FreeBytes();
+
+                return freeBytes ? 1.0f - static_cast<float>(largestFreeBlock) / static_cast<float>(freeBytes) : 0.0f;
+            }
+        };
+
+        explicit TlsfAllocator(std::uint64_t capacity);
+
+        // Returns an invalid allocation when no free block fits
+        Allocation Allocate(std::uint64_t size, std::uint64_t alignment = MinBlockSize);
+
+        void Free(Handle handle) noexcept;
+
+        Statistics Stats() const noexcept;
+
+        std::uint64_t Capacity() const noexcept { return m_capacity; }
+
+        bool IsEmpty() const noexcept { return m_allocationCount == 0; }
+
+        // Visits live allocations in offset order
+        template <typename Function>
+        void ForEachAllocation(Function&& function) const
+        {
+            for (Handle handle = FirstBlock; handle != InvalidHandle; handle = m_blocks[handle].nextPhysical)
+            {
+                const Block& block = m_blocks[handle];
+
+                if (!block.isFree)
+                    function(Allocation{block.offset, block.size, handle});
+            }
+        }
+
+    private:
+        struct Block final
+        {
+            std::uint64_t offset = 0;
+            std::uint64_t size = 0;
+
+            Handle prevPhysical = InvalidHandle;
+            Handle nextPhysical = InvalidHandle;
+            Handle prevFree = InvalidHandle;
+            Handle nextFree = InvalidHandle;
+
+            bool isFree = false;
+        };
+
+        struct ListIndex final
+        {
+            unsigned firstLevel = 0;
+            unsigned secondLevel = 0;
+        };
+
+        static ListIndex MapSize(std::uint64_t size) noexcept;
+        static std::uint64_t RoundUpToList(std::uint64_t size) noexcept;
+
+        Handle NewBlock();
+        void ReleaseBlock(Handle handle) noexcept;
+
+        void InsertFree(Handle handle) noexcept;
+        void RemoveFree(Handle handle) noexcept;
+        Handle FindFree(std::uint64_t size) const noexcept;
+
+        void SplitFront(Handle handle, std::uint64_t size);
+        void SplitBack(Handle handle, std::uint64_t size);
+
+    private:
+        // The block at offset 0 absorbs its neighbours when merging and is
+        // never released
+        static constexpr Handle FirstBlock = 0;
+
+        static constexpr unsigned SecondLevelBits = 4;
+        static constexpr unsigned SecondLevelCount = 1U << SecondLevelBits;
+        static constexpr unsigned FirstLevelCount = 64;
+
+        std::vector<Block> m_blocks;
+        std::vector<Handle> m_unusedBlocks;
+
+        std::array<std::array<Handle, SecondLevelCount>, FirstLevelCount> m_freeLists;
+        std::array<std::uint32_t, FirstLevelCount> m_secondLevelBitmaps = {};
+        std::uint64_t m_firstLevelBitmap = 0;
+
+        std::uint64_t m_capacity = 0;
+        std::uint64_t m_usedBytes = 0;
+        std::uint32_t m_allocationCount = 0;
+    };
+}
@@ -0,0 +1,167 @@
+#include "TraceRecorder.hpp"
+
+#ifdef _WIN32
+#include "WindowsPlatform.hpp"
+#else
+#include <unistd.h>
+#endif
+
+#include "AllocationTracking.hpp"
+
+#include <cassert>
+#include <fstream>
+
+namespace
+{
+    std::string EscapeJson(std::string_view text)
+    {
+        std::string escaped;
+        escaped.reserve(text.size());
+
+        for (const char c : text)
+        {
+            if (c == '"' || c == '\\')
+                escaped += '\\';
+
+            escaped += c;
+        }
+
+        return escaped;
+    }
+
+    inline std::uint32_t CurrentThreadId() noexcept
+    {
+#ifdef _WIN32
+        return GetCurrentThreadId();
+#else
+        return static_cast<std::uint32_t>(gettid());
+#endif
+    }
+
+    inline long long ToMicroseconds(DXSandbox::TraceRecorder::Clock::duration duration) noexcept
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+    }
+}
+
+namespace DXSandbox
+{
+    TraceRecorder::TraceRecorder()
+        : m_origin{Clock::now()}
+    {
+    }
+
+    void TraceRecorder::Record(std::string_view name, Clock::time_point start, Clock::time_point end)
+    {
+        Record(name, CurrentThreadId(), start, end);
+    }
+
+    void TraceRecorder::Record(std::string_view name, std::uint32_t trackId,
+                               Clock::time_point start, Clock::time_point end)
+    {
+        assert(end >= start);
+
+        // Traces outlive the subsystems they time, whose tags would report
+        // the events as leaks
+        const AllocationTracking::TagScope tag{AllocationTracking::Tag::Untagged};
+
+        Event event =
+        {
+            .name = std::string{name},
+            .threadId = trackId,
+            .start = start,
+            .duration = end - start
+        };
+
+        const std::scoped_lock lock{m_mutex};
+
+        m_events.push_back(std::move(event));
+    }
+
+    void TraceRecorder::NameTrack(std::uint32_t trackId, std::string_view name)
+    {
+        const AllocationTracking::TagScope tag{AllocationTracking::Tag::Untagged};
+        const std::scoped_lock lock{m_mutex};
+
+        for (Track& track : m_tracks)
+        {
+            if (track.id == trackId)
+            {
+                track.name = name;
+                return;
+            }
+        }
+
+        m_tracks.push_back({.id = trackId, .name = std::string{name}});
+    }
+
+    TraceRecorder::Clock::time_point TraceRecorder::Origin() const noexcept
+    {
+        return m_origin;
+    }
+
+    std::vector<TraceRecorder::Event> TraceRecorder::Events() const
+    {
+        const std::scoped_lock lock{m_mutex};
+
+        return m_events;
+    }
+
+    bool TraceRecorder::WriteChromeTrace(const std::filesystem::path& path) const
+    {
+        std::ofstream file{path, std::ios::trunc};
+
+        if (!file)
+            return false;
+
+        file << "{\"traceEvents\":[";
+
+        const char* separator = "\n";
+
+        std::vector<Track> tracks;
+
+        {
+            const std::scoped_lock lock{m_mutex};
+
+            tracks = m_tracks;
+        }
+
+        for (const Track& track : tracks)
+        {
+            file << separator
+                 << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << track.id
+                 << ",\"args\":{\"name\":\"" << EscapeJson(track.name) << "\"}}";
+
+            separator = ",\n";
+        }
+
+        for (const Event& event : Events())
+        {
+            file << separator
+                 << "{\"name\":\"" << EscapeJson(event.name) << "\",\"ph\":\"X\""
+                 << ",\"ts\":" << ToMicroseconds(event.start - m_origin)
+                 << ",\"dur\":" << ToMicroseconds(event.duration)
+                 << ",\"pid\":1,\"tid\":" << event.threadId << '}';
+
+            separator = ",\n";
+        }
+
+        file << "\n]}\n";
+
+        return static_cast<bool>(file);
+    }
+
+    TraceScope::TraceScope(TraceRecorder* recorder, std::string_view name)
+        : m_recorder{recorder}
+        , m_name{name}
+    {
+        if (m_recorder)
+            m_start = TraceRecorder::Clock::now();
+    }
+
+    TraceScope::~TraceScope()
+    {
+        if (m_recorder)
+            m_recorder->Record(m_name, m_start, TraceRecorder::Clock::now());
+    }
+}
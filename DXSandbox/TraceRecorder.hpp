@@ -0,0 +1,79 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace DXSandbox
+{
+    // Thread-safe collector of timed events, exported in the Chrome trace
+    // event format (chrome://tracing, Perfetto).
+    class TraceRecorder final
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        struct Event final
+        {
+            std::string name;
+            std::uint32_t threadId = 0;
+            Clock::time_point start;
+            Clock::duration duration = {};
+        };
+
+        TraceRecorder();
+
+        TraceRecorder(const TraceRecorder&) = delete;
+        TraceRecorder& operator = (const TraceRecorder&) = delete;
+
+        void Record(std::string_view name, Clock::time_point start, Clock::time_point end);
+
+        // Records on a track other than the calling thread, such as a GPU
+        // queue; track ids must not collide with thread ids
+        void Record(std::string_view name, std::uint32_t trackId,
+                    Clock::time_point start, Clock::time_point end);
+
+        // Shown instead of the id of a thread or track in the export
+        void NameTrack(std::uint32_t trackId, std::string_view name);
+
+        // Timestamps in the export are relative to the recorder creation
+        Clock::time_point Origin() const noexcept;
+
+        std::vector<Event> Events() const;
+
+        bool WriteChromeTrace(const std::filesystem::path& path) const;
+
+    private:
+        const Clock::time_point m_origin;
+
+        struct Track final
+        {
+            std::uint32_t id = 0;
+            std::string name;
+        };
+
+        mutable std::mutex m_mutex;
+        std::vector<Event> m_events;
+        std::vector<Track> m_tracks;
+    };
+
+    // Records the lifetime of the scope; does nothing without a recorder
+    class TraceScope final
+    {
+    public:
+        explicit TraceScope(TraceRecorder* recorder, std::string_view name);
+        ~TraceScope();
+
+        TraceScope(const TraceScope&) = delete;
+        TraceScope& operator = (const TraceScope&) = delete;
+
+    private:
+        TraceRecorder* m_recorder = nullptr;
+        std::string_view m_name;
+        TraceRecorder::Clock::time_point m_start;
+    };
+}
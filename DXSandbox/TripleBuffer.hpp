@@ -0,0 +1,70 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace DXSandbox
+{
+    // Lock-free hand-over of the newest value from one producer to one
+    // consumer. The producer writes into its own buffer and publishes it by
+    // swapping it with the shared middle buffer; the consumer swaps its
+    // buffer with the middle one whenever something new was published.
+    // Neither side ever waits, and values published faster than they are
+    // consumed are overwritten.
+    template <typename T>
+    class TripleBuffer final
+    {
+    public:
+        TripleBuffer() = default;
+
+        TripleBuffer(const TripleBuffer&) = delete;
+        TripleBuffer& operator = (const TripleBuffer&) = delete;
+
+        // Producer side; the buffer keeps whatever it held three publishes ago
+        T& WriteBuffer() noexcept
+        {
+            return m_buffers[m_writeIndex];
+        }
+
+        // Producer side; returns false if the previous value was never consumed
+        bool Publish() noexcept
+        {
+            const std::uint8_t previous = m_middle.exchange(m_writeIndex | FreshBit,
+                                                            std::memory_order_acq_rel);
+
+            m_writeIndex = previous & IndexMask;
+
+            return !(previous & FreshBit);
+        }
+
+        // Consumer side; returns false if nothing was published since the last call
+        bool Acquire() noexcept
+        {
+            if (!(m_middle.load(std::memory_order_relaxed) & FreshBit))
+                return false;
+
+            const std::uint8_t previous = m_middle.exchange(m_readIndex, std::memory_order_acq_rel);
+
+            m_readIndex = previous & IndexMask;
+
+            return true;
+        }
+
+        // Consumer side
+        const T& ReadBuffer() const noexcept
+        {
+            return m_buffers[m_readIndex];
+        }
+
+    private:
+        static constexpr std::uint8_t IndexMask = 0x3;
+        static constexpr std::uint8_t FreshBit = 0x4;
+
+        std::array<T, 3> m_buffers = {};
+
+        std::uint8_t m_writeIndex = 0;
+        std::atomic<std::uint8_t> m_middle = 1;
+        std::uint8_t m_readIndex = 2;
+    };
+}
@@ -0,0 +1,107 @@
+#include "UploadRing.hpp"
+
+#include "ErrorHandling.hpp"
+#include "Instrumentation.hpp"
+
+#include <cassert>
+#include <utility>
+
+namespace
+{
+    using DXSandbox::Instrumentation::Counter;
+
+    Counter g_frameBytes{"UploadRing.FrameBytes"};
+    Counter g_failedAllocations{"UploadRing.FailedAllocations"};
+}
+
+namespace DXSandbox
+{
+    UploadRing::UploadRing(ComPtr<ID3D12Device> device, UINT64 capacity)
+        : m_capacity{capacity}
+    {
+        assert(device && capacity > 0);
+
+        static constexpr D3D12_HEAP_PROPERTIES heapProperties =
+        {
+            .Type = D3D12_HEAP_TYPE_UPLOAD
+        };
+
+        const D3D12_RESOURCE_DESC bufferDesc =
+        {
+            .Dimension = D3D12_RESOURCE_DIMENSION_BUFFER,
+            .Width = capacity,
+            .Height = 1,
+            .DepthOrArraySize = 1,
+            .MipLevels = 1,
+            .SampleDesc = {.Count = 1},
+            .Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR
+        };
+
+        ThrowIfFailed(device->CreateCommittedResource(&heapProperties, D3D12_HEAP_FLAG_NONE, &bufferDesc,
+                                                      D3D12_RESOURCE_STATE_GENERIC_READ, nullptr,
+                                                      IID_PPV_ARGS(&m_buffer)));
+
+        // Upload heaps are write combined and stay mapped; the CPU only
+        // ever writes them
+        static constexpr D3D12_RANGE noRead = {};
+
+        void* data = nullptr;
+
+        ThrowIfFailed(m_buffer->Map(0, &noRead, &data));
+
+        m_cpuAddress = static_cast<std::byte*>(data);
+        m_gpuAddress = m_buffer->GetGPUVirtualAddress();
+    }
+
+    UploadRing::~UploadRing() = default;
+
+    std::optional<UploadRing::Allocation> UploadRing::Allocate(UINT64 size, UINT64 alignment)
+    {
+        assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+        assert(size > 0);
+
+        UINT64 start = (m_head + alignment - 1) & ~(alignment - 1);
+
+        // An allocation never wraps; the end of the buffer is skipped instead
+        if (start % m_capacity + size > m_capacity)
+            start = (start / m_capacity + 1) * m_capacity;
+
+        if (start + size - m_tail > m_capacity) [[unlikely]]
+        {
+            g_failedAllocations.Add(1);
+            return std::nullopt;
+        }
+
+        m_head = start + size;
+
+        const UINT64 offset = start % m_capacity;
+
+        return Allocation
+        {
+            .cpuAddress = m_cpuAddress + offset,
+            .gpuAddress = m_gpuAddress + offset,
+            .buffer = m_buffer.Get(),
+            .offset = offset
+        };
+    }
+
+    void UploadRing::EndFrame(UINT64 fenceValue)
+    {
+        g_frameBytes.Set(static_cast<std::int64_t>(m_head - m_frameStart));
+
+        if (m_head == m_frameStart)
+            return;
+
+        m_frames.push_back({.fenceValue = fenceValue, .end = m_head});
+        m_frameStart = m_head;
+    }
+
+    void UploadRing::Reclaim(UINT64 completedFenceValue)
+    {
+        while (!m_frames.empty() && m_frames.front().fenceValue <= completedFenceValue)
+        {
+            m_tail = m_frames.front().end;
+            m_frames.pop_front();
+        }
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "WindowsPlatform.hpp"
+
+#include "ComPtr.hpp"
+
+#include <d3d12.h>
+
+#include <cstddef>
+#include <deque>
+#include <optional>
+
+namespace DXSandbox
+{
+    // A persistently mapped upload buffer handing out memory the GPU reads
+    // once, such as per-frame vertices and texture uploads. Memory is handed
+    // out in order and comes back in order, as the frames that used it
+    // complete, so allocating is a bump of the head.
+    class UploadRing final
+    {
+    public:
+        struct Allocation final
+        {
+            std::byte* cpuAddress = nullptr;
+            D3D12_GPU_VIRTUAL_ADDRESS gpuAddress = 0;
+
+            // For copies, which take the buffer and an offset
+            ID3D12Resource* buffer = nullptr;
+            UINT64 offset = 0;
+        };
+
+        UploadRing(ComPtr<ID3D12Device> device, UINT64 capacity);
+        ~UploadRing();
+
+        UploadRing(const UploadRing&) = delete;
+        UploadRing& operator = (const UploadRing&) = delete;
+
+        // Empty when the frames in flight still use too much of the ring.
+        // The alignment must be a power of two.
+        std::optional<Allocation> Allocate(UINT64 size, UINT64 alignment);
+
+        // What was allocated since the previous call is used by the frame
+        // signaling the fence value
+        void EndFrame(UINT64 fenceValue);
+
+        void Reclaim(UINT64 completedFenceValue);
+
+    private:
+        struct Frame final
+        {
+            UINT64 fenceValue = 0;
+            UINT64 end = 0;
+        };
+
+    private:
+        ComPtr<ID3D12Resource> m_buffer;
+
+        std::byte* m_cpuAddress = nullptr;
+        D3D12_GPU_VIRTUAL_ADDRESS m_gpuAddress = 0;
+        UINT64 m_capacity = 0;
+
+        // Positions only grow; the offset in the buffer is taken modulo the
+        // capacity
+        UINT64 m_head = 0;
+        UINT64 m_tail = 0;
+        UINT64 m_frameStart = 0;
+
+        std::deque<Frame> m_frames;
+    };
+}
@@ -0,0 +1,292 @@
+#include "Upscaler.hpp"
+
+#include "Debug.hpp"
+#include "ErrorHandling.hpp"
+
+#include <d3dcompiler.h>
+
+#include <cassert>
+#include <climits>
+#include <iterator>
+#include <string_view>
+#include <utility>
+
+namespace
+{
+    // A triangle covering the output, sampling the rendered corner. The
+    // coordinates are clamped half a texel inside the corner, so filtering
+    // does not read what earlier frames left outside of it.
+    constexpr std::string_view UpscaleShader = R"(
+        Texture2D<float4> g_source : register(t0);
+        SamplerState g_sampler : register(s0);
+
+        cbuffer Constants : register(b0)
+        {
+            float2 g_uvScale;
+            float2 g_uvMax;
+        };
+
+        struct Interpolants
+        {
+            float4 position : SV_Position;
+            float2 uv : TEXCOORD0;
+        };
+
+        Interpolants VSMain(uint vertexId : SV_VertexID)
+        {
+            const float2 uv = float2((vertexId << 1) & 2, vertexId & 2);
+
+            Interpolants output;
+            output.position = float4(uv * float2(2.0, -2.0) + float2(-1.0, 1.0), 0.0, 1.0);
+            output.uv = uv * g_uvScale;
+
+            return output;
+        }
+
+        float4 PSMain(Interpolants input) : SV_Target
+        {
+            return g_source.SampleLevel(g_sampler, min(input.uv, g_uvMax), 0.0);
+        }
+    )";
+
+    struct UpscaleConstants final
+    {
+        float uvScale[2];
+        float uvMax[2];
+    };
+
+    DXSandbox::ComPtr<ID3DBlob> CompileShader(const char* entryPoint, const char* target)
+    {
+        DXSandbox::ComPtr<ID3DBlob> code;
+        DXSandbox::ComPtr<ID3DBlob> errors;
+
+        const HRESULT hr = D3DCompile(UpscaleShader.data(), UpscaleShader.size(), "Upscale", nullptr, nullptr,
+                                      entryPoint, target, D3DCOMPILE_OPTIMIZATION_LEVEL3, 0, &code, &errors);
+
+        if (FAILED(hr) && errors)
+            DXSandbox::Debug::WriteLine(std::string_view{static_cast<const char*>(errors->GetBufferPointer())});
+
+        DXSandbox::ThrowIfFailed(hr);
+
+        return code;
+    }
+}
+
+namespace DXSandbox
+{
+    Upscaler::Upscaler(ComPtr<ID3D12Device> device, DXGI_FORMAT format)
+        : m_device{std::move(device)}
+        , m_format{format}
+    {
+        assert(m_device);
+
+        CreatePipeline();
+        CreateDescriptorHeaps();
+    }
+
+    Upscaler::~Upscaler() = default;
+
+    HRESULT Upscaler::Resize(UINT width, UINT height)
+    {
+        if (width == 0 || height == 0 || (width == m_width && height == m_height))
+            return S_OK;
+
+        m_width = width;
+        m_height = height;
+
+        return CreateTarget();
+    }
+
+    ID3D12Resource* Upscaler::Target() const noexcept
+    {
+        return m_target.Get();
+    }
+
+    D3D12_CPU_DESCRIPTOR_HANDLE Upscaler::TargetView() const noexcept
+    {
+        return m_rtvHeap->GetCPUDescriptorHandleForHeapStart();
+    }
+
+    UINT Upscaler::Width() const noexcept
+    {
+        return m_width;
+    }
+
+    UINT Upscaler::Height() const noexcept
+    {
+        return m_height;
+    }
+
+    void Upscaler::Record(ID3D12GraphicsCommandList* commandList, UINT renderWidth, UINT renderHeight)
+    {
+        assert(commandList && m_target);
+        assert(renderWidth <= m_width && renderHeight <= m_height);
+
+        D3D12_RESOURCE_BARRIER barrier =
+        {
+            .Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION,
+            .Transition =
+            {
+                .pResource = m_target.Get(),
+                .Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES,
+                .StateBefore = D3D12_RESOURCE_STATE_RENDER_TARGET,
+                .StateAfter = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE
+            }
+        };
+
+        commandList->ResourceBarrier(1, &barrier);
+
+        const float width = static_cast<float>(m_width);
+        const float height = static_cast<float>(m_height);
+
+        const UpscaleConstants constants =
+        {
+            .uvScale = {static_cast<float>(renderWidth) / width, static_cast<float>(renderHeight) / height},
+            .uvMax = {(static_cast<float>(renderWidth) - 0.5f) / width,
+                      (static_cast<float>(renderHeight) - 0.5f) / height}
+        };
+
+        ID3D12DescriptorHeap* const heaps[] = {m_srvHeap.Get()};
+
+        commandList->SetDescriptorHeaps(1, heaps);
+        commandList->SetGraphicsRootSignature(m_rootSignature.Get());
+        commandList->SetPipelineState(m_pipelineState.Get());
+        commandList->SetGraphicsRoot32BitConstants(0, sizeof(constants) / sizeof(float), &constants, 0);
+        commandList->SetGraphicsRootDescriptorTable(1, m_srvHeap->GetGPUDescriptorHandleForHeapStart());
+        commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+        commandList->DrawInstanced(3, 1, 0, 0);
+
+        std::swap(barrier.Transition.StateBefore, barrier.Transition.StateAfter);
+
+        commandList->ResourceBarrier(1, &barrier);
+    }
+
+    void Upscaler::CreatePipeline()
+    {
+        const D3D12_DESCRIPTOR_RANGE sourceRange =
+        {
+            .RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV,
+            .NumDescriptors = 1,
+            .OffsetInDescriptorsFromTableStart = D3D12_DESCRIPTOR_RANGE_OFFSET_APPEND
+        };
+
+        const D3D12_ROOT_PARAMETER parameters[] =
+        {
+            {
+                .ParameterType = D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS,
+                .Constants = {.Num32BitValues = sizeof(UpscaleConstants) / sizeof(float)},
+                .ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL
+            },
+            {
+                .ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE,
+                .DescriptorTable = {.NumDescriptorRanges = 1, .pDescriptorRanges = &sourceRange},
+                .ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL
+            }
+        };
+
+        const D3D12_STATIC_SAMPLER_DESC sampler =
+        {
+            .Filter = D3D12_FILTER_MIN_MAG_LINEAR_MIP_POINT,
+            .AddressU = D3D12_TEXTURE_ADDRESS_MODE_CLAMP,
+            .AddressV = D3D12_TEXTURE_ADDRESS_MODE_CLAMP,
+            .AddressW = D3D12_TEXTURE_ADDRESS_MODE_CLAMP,
+            .MaxLOD = D3D12_FLOAT32_MAX,
+            .ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL
+        };
+
+        const D3D12_ROOT_SIGNATURE_DESC rootSignatureDesc =
+        {
+            .NumParameters = static_cast<UINT>(std::size(parameters)),
+            .pParameters = parameters,
+            .NumStaticSamplers = 1,
+            .pStaticSamplers = &sampler
+        };
+
+        ComPtr<ID3DBlob> rootSignatureBlob;
+
+        ThrowIfFailed(D3D12SerializeRootSignature(&rootSignatureDesc, D3D_ROOT_SIGNATURE_VERSION_1,
+                                                  &rootSignatureBlob, nullptr));
+        ThrowIfFailed(m_device->CreateRootSignature(0, rootSignatureBlob->GetBufferPointer(),
+                                                    rootSignatureBlob->GetBufferSize(),
+                                                    IID_PPV_ARGS(&m_rootSignature)));
+
+        const ComPtr<ID3DBlob> vertexShader = CompileShader("VSMain", "vs_5_0");
+        const ComPtr<ID3DBlob> pixelShader = CompileShader("PSMain", "ps_5_0");
+
+        D3D12_GRAPHICS_PIPELINE_STATE_DESC pipelineDesc =
+        {
+            .pRootSignature = m_rootSignature.Get(),
+            .VS = {vertexShader->GetBufferPointer(), vertexShader->GetBufferSize()},
+            .PS = {pixelShader->GetBufferPointer(), pixelShader->GetBufferSize()},
+            .SampleMask = UINT_MAX,
+            .RasterizerState =
+            {
+                .FillMode = D3D12_FILL_MODE_SOLID,
+                .CullMode = D3D12_CULL_MODE_NONE,
+                .DepthClipEnable = TRUE
+            },
+            .PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE,
+            .NumRenderTargets = 1,
+            .SampleDesc = {.Count = 1}
+        };
+
+        pipelineDesc.BlendState.RenderTarget[0].RenderTargetWriteMask = D3D12_COLOR_WRITE_ENABLE_ALL;
+        pipelineDesc.RTVFormats[0] = m_format;
+
+        ThrowIfFailed(m_device->CreateGraphicsPipelineState(&pipelineDesc, IID_PPV_ARGS(&m_pipelineState)));
+    }
+
+    void Upscaler::CreateDescriptorHeaps()
+    {
+        static constexpr D3D12_DESCRIPTOR_HEAP_DESC rtvHeapDesc =
+        {
+            .Type = D3D12_DESCRIPTOR_HEAP_TYPE_RTV,
+            .NumDescriptors = 1
+        };
+
+        ThrowIfFailed(m_device->CreateDescriptorHeap(&rtvHeapDesc, IID_PPV_ARGS(&m_rtvHeap)));
+
+        static constexpr D3D12_DESCRIPTOR_HEAP_DESC srvHeapDesc =
+        {
+            .Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV,
+            .NumDescriptors = 1,
+            .Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE
+        };
+
+        ThrowIfFailed(m_device->CreateDescriptorHeap(&srvHeapDesc, IID_PPV_ARGS(&m_srvHeap)));
+    }
+
+    HRESULT Upscaler::CreateTarget()
+    {
+        static constexpr D3D12_HEAP_PROPERTIES heapProperties =
+        {
+            .Type = D3D12_HEAP_TYPE_DEFAULT
+        };
+
+        const D3D12_RESOURCE_DESC targetDesc =
+        {
+            .Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D,
+            .Width = m_width,
+            .Height = m_height,
+            .DepthOrArraySize = 1,
+            .MipLevels = 1,
+            .Format = m_format,
+            .SampleDesc = {.Count = 1},
+            .Flags = D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET
+        };
+
+        m_target = nullptr;
+
+        const HRESULT hr = m_device->CreateCommittedResource(&heapProperties, D3D12_HEAP_FLAG_NONE, &targetDesc,
+                                                             D3D12_RESOURCE_STATE_RENDER_TARGET, nullptr,
+                                                             IID_PPV_ARGS(&m_target));
+
+        if (FAILED(hr)) [[unlikely]]
+            return hr;
+
+        m_device->CreateRenderTargetView(m_target.Get(), nullptr, m_rtvHeap->GetCPUDescriptorHandleForHeapStart());
+        m_device->CreateShaderResourceView(m_target.Get(), nullptr, m_srvHeap->GetCPUDescriptorHandleForHeapStart());
+
+        return S_OK;
+    }
+}
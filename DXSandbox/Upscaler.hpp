@@ -0,0 +1,60 @@
+#pragma once
+
+#include "WindowsPlatform.hpp"
+
+#include "ComPtr.hpp"
+
+#include <d3d12.h>
+
+namespace DXSandbox
+{
+    // An internal render target sized for the output, of which frames
+    // rendered at a lower resolution use the top left corner, and the pass
+    // stretching that corner over the output with bilinear filtering. The
+    // target is not reallocated when the render resolution changes.
+    class Upscaler final
+    {
+    public:
+        Upscaler(ComPtr<ID3D12Device> device, DXGI_FORMAT format);
+        ~Upscaler();
+
+        Upscaler(const Upscaler&) = delete;
+        Upscaler& operator = (const Upscaler&) = delete;
+
+        // Must not be called while the GPU uses the target; zero sizes are
+        // ignored
+        [[nodiscard]] HRESULT Resize(UINT width, UINT height);
+
+        // Kept in D3D12_RESOURCE_STATE_RENDER_TARGET between passes
+        ID3D12Resource* Target() const noexcept;
+        D3D12_CPU_DESCRIPTOR_HANDLE TargetView() const noexcept;
+
+        UINT Width() const noexcept;
+        UINT Height() const noexcept;
+
+        // Draws the rendered corner over the output, which must be bound as
+        // the only render target with a viewport covering it
+        void Record(ID3D12GraphicsCommandList* commandList, UINT renderWidth, UINT renderHeight);
+
+    private:
+        void CreatePipeline();
+        void CreateDescriptorHeaps();
+        [[nodiscard]] HRESULT CreateTarget();
+
+    private:
+        ComPtr<ID3D12Device> m_device;
+
+        DXGI_FORMAT m_format = DXGI_FORMAT_UNKNOWN;
+
+        ComPtr<ID3D12RootSignature> m_rootSignature;
+        ComPtr<ID3D12PipelineState> m_pipelineState;
+
+        ComPtr<ID3D12DescriptorHeap> m_rtvHeap;
+        ComPtr<ID3D12DescriptorHeap> m_srvHeap;
+
+        ComPtr<ID3D12Resource> m_target;
+
+        UINT m_width = 0;
+        UINT m_height = 0;
+    };
+}
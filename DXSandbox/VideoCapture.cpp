@@ -0,0 +1,239 @@
+#include "VideoCapture.hpp"
+
+#include "Debug.hpp"
+#include "Instrumentation.hpp"
+#include "YuvConversion.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <exception>
+#include <format>
+#include <stdexcept>
+
+namespace
+{
+    using DXSandbox::Instrumentation::Counter;
+
+    Counter g_writtenFrames{"Capture.VideoFrames"};
+    Counter g_droppedFrames{"Capture.DroppedVideoFrames"};
+    Counter g_failedWrites{"Capture.FailedVideoWrites"};
+    Counter g_convertRate{"Capture.ConvertMegapixelsPerSecond"};
+    Counter g_writeRate{"Capture.WriteMegabytesPerSecond"};
+
+    std::int64_t PerSecond(std::uint64_t amount, std::chrono::steady_clock::duration time) noexcept
+    {
+        const auto microseconds = std::chrono::duration_cast<std::chrono::microseconds>(time).count();
+
+        // Millions per second is the same as units per microsecond
+        return microseconds > 0 ? static_cast<std::int64_t>(amount / static_cast<std::uint64_t>(microseconds)) : 0;
+    }
+}
+
+namespace DXSandbox
+{
+    VideoCapture::VideoCapture(const Params& params)
+        : m_frameRate{params.frameRate}
+        , m_maxQueuedFrames{params.maxQueuedFrames}
+        , m_chunkSize{params.chunkSize}
+    {
+        assert(m_frameRate > 0 && m_maxQueuedFrames > 0 && m_chunkSize > 0);
+
+        // Chunks go straight to the file instead of through another buffer
+        m_file.rdbuf()->pubsetbuf(nullptr, 0);
+        m_file.open(params.path, std::ios::binary | std::ios::trunc);
+
+        if (!m_file)
+            throw std::runtime_error{"Failed to create " + params.path.string()};
+
+        m_writer = std::jthread{[this](std::stop_token stopToken) { WriterLoop(stopToken); }};
+    }
+
+    VideoCapture::~VideoCapture()
+    {
+        m_writer.request_stop();
+        m_writer.join();
+
+        ReportThroughput();
+    }
+
+    ReadbackHandler VideoCapture::FrameHandler()
+    {
+        return [self = shared_from_this()](const ReadbackImage& image)
+        {
+            try
+            {
+                self->OnFrame(image);
+            }
+            catch (const std::exception& e)
+            {
+                g_droppedFrames.Add(1);
+
+                Debug::WriteLine("Video capture of frame {} failed: {}", image.frameIndex, e.what());
+            }
+        };
+    }
+
+    void VideoCapture::OnFrame(const ReadbackImage& image)
+    {
+        FrameData buffer;
+
+        if (!AcquireBuffer(image, buffer))
+        {
+            g_droppedFrames.Add(1);
+            return;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+
+        buffer.resize(Yuv::I420Size(image.width, image.height));
+
+        Yuv::ConvertRgbaToI420(
+        {
+            .pixels = image.pixels,
+            .width = image.width,
+            .height = image.height,
+            .rowPitch = image.rowPitch
+        }, buffer.data());
+
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+
+        {
+            const std::scoped_lock lock{m_mutex};
+
+            m_queuedFrames.emplace(image.frameIndex, std::move(buffer));
+
+            m_convertedPixels += static_cast<std::uint64_t>(image.width) * image.height;
+            m_convertTime += elapsed;
+        }
+
+        m_frameQueued.notify_one();
+    }
+
+    bool VideoCapture::AcquireBuffer(const ReadbackImage& image, FrameData& buffer)
+    {
+        const std::scoped_lock lock{m_mutex};
+
+        if (m_width == 0)
+        {
+            m_width = image.width;
+            m_height = image.height;
+        }
+
+        if (image.width != m_width || image.height != m_height)
+            return false;
+
+        if (!m_freeBuffers.empty())
+        {
+            buffer = std::move(m_freeBuffers.back());
+            m_freeBuffers.pop_back();
+
+            return true;
+        }
+
+        // Every buffer is queued or being filled, so the queue is full
+        if (m_allocatedBuffers == m_maxQueuedFrames)
+            return false;
+
+        ++m_allocatedBuffers;
+
+        return true;
+    }
+
+    bool VideoCapture::IsFrameWritable() const noexcept
+    {
+        if (m_queuedFrames.empty())
+            return false;
+
+        // A missing frame is waited for until a later one is queued too,
+        // which is when it was either dropped or is running late
+        const std::uint64_t frameIndex = m_queuedFrames.begin()->first;
+
+        return !m_lastWrittenFrame || frameIndex == *m_lastWrittenFrame + 1 || m_queuedFrames.size() > 1;
+    }
+
+    void VideoCapture::WriterLoop(std::stop_token stopToken)
+    {
+        for (;;)
+        {
+            std::uint64_t frameIndex = 0;
+            FrameData frame;
+
+            {
+                std::unique_lock lock{m_mutex};
+
+                m_frameQueued.wait(lock, stopToken, [this] { return IsFrameWritable(); });
+
+                // Stopping only once everything queued has been written
+                if (m_queuedFrames.empty())
+                    return;
+
+                auto node = m_queuedFrames.extract(m_queuedFrames.begin());
+
+                frameIndex = node.key();
+                frame = std::move(node.mapped());
+            }
+
+            if (m_lastWrittenFrame && frameIndex <= *m_lastWrittenFrame)
+            {
+                g_droppedFrames.Add(1);
+            }
+            else
+            {
+                if (!m_lastWrittenFrame)
+                    WriteHeader();
+
+                WriteFrame(frame);
+
+                m_lastWrittenFrame = frameIndex;
+            }
+
+            const std::scoped_lock lock{m_mutex};
+
+            m_freeBuffers.push_back(std::move(frame));
+        }
+    }
+
+    void VideoCapture::WriteHeader()
+    {
+        // The size was fixed before the first frame was queued
+        const std::string header = std::format("YUV4MPEG2 W{} H{} F{}:1 Ip A1:1 C420jpeg XCOLORRANGE=LIMITED\n",
+                                               m_width, m_height, m_frameRate);
+
+        m_file.write(header.data(), static_cast<std::streamsize>(header.size()));
+    }
+
+    void VideoCapture::WriteFrame(const FrameData& frame)
+    {
+        static constexpr char FrameHeader[] = "FRAME\n";
+
+        const auto start = std::chrono::steady_clock::now();
+
+        m_file.write(FrameHeader, sizeof(FrameHeader) - 1);
+
+        for (std::size_t offset = 0; offset < frame.size() && m_file; offset += m_chunkSize)
+        {
+            const std::size_t size = std::min(m_chunkSize, frame.size() - offset);
+
+            m_file.write(reinterpret_cast<const char*>(frame.data() + offset), static_cast<std::streamsize>(size));
+        }
+
+        if (!m_file)
+        {
+            g_failedWrites.Add(1);
+            m_file.clear();
+
+            return;
+        }
+
+        m_writeTime += std::chrono::steady_clock::now() - start;
+        m_writtenBytes += frame.size() + sizeof(FrameHeader) - 1;
+
+        g_writtenFrames.Add(1);
+    }
+
+    void VideoCapture::ReportThroughput() const
+    {
+        g_convertRate.Set(PerSecond(m_convertedPixels, m_convertTime));
+        g_writeRate.Set(PerSecond(m_writtenBytes, m_writeTime));
+    }
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "ReadbackImage.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+namespace DXSandbox
+{
+    // Streams read back frames to a Y4M file. Readback handlers convert the
+    // frames to I420 on the readback workers and queue them; a writer thread
+    // writes them to disk in chunks. The queue holds a bounded number of
+    // frames, and frames that do not fit are dropped and counted, so a slow
+    // disk never stalls rendering. The first frame fixes the video size,
+    // frames of another size (after a resize) are dropped too.
+    class VideoCapture final : public std::enable_shared_from_this<VideoCapture>
+    {
+    public:
+        struct Params final
+        {
+            std::filesystem::path path;
+
+            // Nominal rate written to the header, frames carry no timestamps
+            std::uint32_t frameRate = 60;
+
+            std::size_t maxQueuedFrames = 8;
+            std::size_t chunkSize = 1024 * 1024;
+        };
+
+        explicit VideoCapture(const Params& params);
+
+        // Writes the queued frames, then closes the file
+        ~VideoCapture();
+
+        VideoCapture(const VideoCapture&) = delete;
+        VideoCapture& operator = (const VideoCapture&) = delete;
+
+        // Handler capturing one frame, for GraphicsSystem::RequestReadback.
+        // It keeps the capture alive, which must be owned by a shared_ptr.
+        ReadbackHandler FrameHandler();
+
+    private:
+        using FrameData = std::vector<std::uint8_t>;
+
+        void OnFrame(const ReadbackImage& image);
+        bool AcquireBuffer(const ReadbackImage& image, FrameData& buffer);
+        bool IsFrameWritable() const noexcept;
+
+        void WriterLoop(std::stop_token stopToken);
+        void WriteHeader();
+        void WriteFrame(const FrameData& frame);
+        void ReportThroughput() const;
+
+    private:
+        std::ofstream m_file;
+
+        std::uint32_t m_frameRate = 0;
+        std::size_t m_maxQueuedFrames = 0;
+        std::size_t m_chunkSize = 0;
+
+        std::mutex m_mutex;
+        std::condition_variable_any m_frameQueued;
+
+        // Set by the first frame
+        std::uint32_t m_width = 0;
+        std::uint32_t m_height = 0;
+
+        std::size_t m_allocatedBuffers = 0;
+        std::vector<FrameData> m_freeBuffers;
+
+        // Ordered by frame index, as handlers may finish out of order
+        std::map<std::uint64_t, FrameData> m_queuedFrames;
+        std::optional<std::uint64_t> m_lastWrittenFrame;
+
+        using Duration = std::chrono::steady_clock::duration;
+
+        std::uint64_t m_convertedPixels = 0;
+        Duration m_convertTime = {};
+
+        // Owned by the writer thread
+        std::uint64_t m_writtenBytes = 0;
+        Duration m_writeTime = {};
+
+        // Joined first on destruction, while the queue still exists
+        std::jthread m_writer;
+    };
+}
@@ -2,9 +2,12 @@
 
 #include "ErrorHandling.hpp"
 #include "IWindowPresenter.hpp"
+#include "WindowEvent.hpp"
 
 #include <bit>
 #include <cassert>
+#include <cstdint>
+#include <optional>
 
 namespace
 {
@@ -64,6 +67,64 @@ namespace
 
         return RectSize(bounds);
     }
+
+    inline DXSandbox::WindowEvent CursorEvent(DXSandbox::WindowEvent::Type type, LPARAM lParam,
+                                              std::int32_t value = 0) noexcept
+    {
+        // Coordinates are signed 16-bit, negative on multiple monitor setups
+        return
+        {
+            .type = type,
+            .x = static_cast<std::int16_t>(LOWORD(lParam)),
+            .y = static_cast<std::int16_t>(HIWORD(lParam)),
+            .value = value
+        };
+    }
+
+    std::optional<DXSandbox::WindowEvent> ToWindowEvent(UINT message, WPARAM wParam,
+                                                         LPARAM lParam) noexcept
+    {
+        using Type = DXSandbox::WindowEvent::Type;
+
+        switch (message)
+        {
+            case WM_SIZE:
+                return CursorEvent(Type::Resize, lParam, static_cast<std::int32_t>(wParam));
+
+            case WM_ACTIVATE:
+                return DXSandbox::WindowEvent{.type = Type::Activate,
+                                              .value = LOWORD(wParam) != WA_INACTIVE};
+
+            case WM_KEYDOWN:
+            case WM_SYSKEYDOWN:
+                return DXSandbox::WindowEvent{.type = Type::KeyDown,
+                                              .value = static_cast<std::int32_t>(wParam)};
+
+            case WM_KEYUP:
+            case WM_SYSKEYUP:
+                return DXSandbox::WindowEvent{.type = Type::KeyUp,
+                                              .value = static_cast<std::int32_t>(wParam)};
+
+            case WM_CHAR:
+                return DXSandbox::WindowEvent{.type = Type::Character,
+                                              .value = static_cast<std::int32_t>(wParam)};
+
+            case WM_MOUSEMOVE:
+                return CursorEvent(Type::MouseMove, lParam);
+
+            case WM_LBUTTONDOWN: return CursorEvent(Type::MouseButtonDown, lParam, 0);
+            case WM_RBUTTONDOWN: return CursorEvent(Type::MouseButtonDown, lParam, 1);
+            case WM_MBUTTONDOWN: return CursorEvent(Type::MouseButtonDown, lParam, 2);
+            case WM_LBUTTONUP:   return CursorEvent(Type::MouseButtonUp, lParam, 0);
+            case WM_RBUTTONUP:   return CursorEvent(Type::MouseButtonUp, lParam, 1);
+            case WM_MBUTTONUP:   return CursorEvent(Type::MouseButtonUp, lParam, 2);
+
+            case WM_MOUSEWHEEL:
+                return CursorEvent(Type::MouseWheel, lParam, GET_WHEEL_DELTA_WPARAM(wParam));
+        }
+
+        return std::nullopt;
+    }
 }
 
 namespace DXSandbox
@@ -161,6 +222,11 @@ namespace DXSandbox
     {
         auto& window = GetWindowRef(hWnd);
 
+        // Translated messages still get their default processing below, so
+        // system keys and activation keep working
+        if (const auto event = ToWindowEvent(message, wParam, lParam))
+            window.OnEvent(*event);
+
         switch (message)
         {
             case WM_GETMINMAXINFO:
@@ -192,6 +258,11 @@ namespace DXSandbox
         m_presenter->OnWindowClose(*this);
     }
 
+    void Window::OnEvent(const WindowEvent& event)
+    {
+        m_presenter->OnWindowEvent(*this, event);
+    }
+
     void Window::OnDestroy() noexcept
     {
         [[maybe_unused]]
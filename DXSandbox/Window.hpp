@@ -7,6 +7,7 @@
 namespace DXSandbox
 {
     class IWindowPresenter;
+    struct WindowEvent;
 
     class Window final
     {
@@ -34,6 +35,7 @@ namespace DXSandbox
 
         void OnGetMinMaxInfo(MINMAXINFO& info);
         void OnClose();
+        void OnEvent(const WindowEvent& event);
         void OnDestroy() noexcept;
 
         void InvalidateHandle() noexcept;
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+
+namespace DXSandbox
+{
+    // Window message translated for consumption off the window thread
+    struct WindowEvent final
+    {
+        enum class Type : std::uint8_t
+        {
+            Close,
+            Resize,           // x, y: client size; value: SIZE_* kind
+            Activate,         // value: nonzero when the window became active
+            KeyDown,          // value: virtual key code
+            KeyUp,            // value: virtual key code
+            Character,        // value: UTF-16 code unit
+            MouseMove,        // x, y: cursor in client coordinates
+            MouseButtonDown,  // x, y: cursor; value: 0 left, 1 right, 2 middle
+            MouseButtonUp,    // x, y: cursor; value: 0 left, 1 right, 2 middle
+            MouseWheel        // x, y: cursor in screen coordinates; value: delta
+        };
+
+        Type type = Type::Close;
+
+        std::int32_t x = 0;
+        std::int32_t y = 0;
+        std::int32_t value = 0;
+
+        // Index of the sending window, 0 for the main window
+        std::uint32_t window = 0;
+    };
+}
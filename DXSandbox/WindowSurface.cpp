@@ -0,0 +1,192 @@
+#include "WindowSurface.hpp"
+
+#include "ErrorHandling.hpp"
+
+#include <dxgi1_6.h>
+
+#include <cassert>
+
+namespace DXSandbox
+{
+    WindowSurface::WindowSurface(IDXGIFactory6* factory, ComPtr<ID3D12Device> device,
+                                 ID3D12CommandQueue* commandQueue, const Params& params)
+        : m_device{std::move(device)}
+        , m_width{params.width}
+        , m_height{params.height}
+        , m_syncInterval{params.syncInterval}
+        , m_presentInterval{params.presentInterval}
+    {
+        assert(factory && m_device && commandQueue && params.presentInterval > 0);
+
+        CreateSwapChain(factory, commandQueue, params.hWnd);
+        CreateCommandLists();
+    }
+
+    WindowSurface::~WindowSurface() = default;
+
+    HRESULT WindowSurface::Resize(UINT width, UINT height)
+    {
+        if (width == 0 || height == 0 || (width == m_width && height == m_height))
+            return S_OK;
+
+        for (auto& backBuffer : m_backBuffers)
+            backBuffer = nullptr;
+
+        const HRESULT hr = m_swapChain->ResizeBuffers(BackBufferCount, width, height, DXGI_FORMAT_UNKNOWN, 0);
+
+        if (FAILED(hr)) [[unlikely]]
+            return hr;
+
+        m_width = width;
+        m_height = height;
+
+        m_currentBackBufferIndex = m_swapChain->GetCurrentBackBufferIndex();
+
+        return CreateRenderTargetViews();
+    }
+
+    bool WindowSurface::IsPresentDue(std::uint64_t frameIndex) const noexcept
+    {
+        return frameIndex % m_presentInterval == 0;
+    }
+
+    bool WindowSurface::IsOccluded() const noexcept
+    {
+        return m_isOccluded;
+    }
+
+    HRESULT WindowSurface::Present()
+    {
+        const HRESULT hr = m_swapChain->Present(m_syncInterval, 0);
+
+        m_isOccluded = hr == DXGI_STATUS_OCCLUDED;
+
+        return hr;
+    }
+
+    HRESULT WindowSurface::TestPresent()
+    {
+        const HRESULT hr = m_swapChain->Present(0, DXGI_PRESENT_TEST);
+
+        m_isOccluded = hr == DXGI_STATUS_OCCLUDED;
+
+        return hr;
+    }
+
+    void WindowSurface::UpdateBackBufferIndex() noexcept
+    {
+        m_currentBackBufferIndex = m_swapChain->GetCurrentBackBufferIndex();
+    }
+
+    ID3D12Resource* WindowSurface::BackBuffer() const noexcept
+    {
+        return m_backBuffers[m_currentBackBufferIndex].Get();
+    }
+
+    D3D12_CPU_DESCRIPTOR_HANDLE WindowSurface::RenderTargetView() const noexcept
+    {
+        D3D12_CPU_DESCRIPTOR_HANDLE rtvHandle = m_rtvHeap->GetCPUDescriptorHandleForHeapStart();
+
+        rtvHandle.ptr += static_cast<SIZE_T>(m_currentBackBufferIndex) * m_rtvDescriptorSize;
+
+        return rtvHandle;
+    }
+
+    WindowSurface::CachedCommandList& WindowSurface::CurrentCommandList() noexcept
+    {
+        return m_commandLists[m_currentBackBufferIndex];
+    }
+
+    UINT WindowSurface::Width() const noexcept
+    {
+        return m_width;
+    }
+
+    UINT WindowSurface::Height() const noexcept
+    {
+        return m_height;
+    }
+
+    std::uint64_t WindowSurface::BackBufferBytes() const noexcept
+    {
+        return m_backBufferBytes;
+    }
+
+    void WindowSurface::CreateSwapChain(IDXGIFactory6* factory, ID3D12CommandQueue* commandQueue, HWND hWnd)
+    {
+        const DXGI_SWAP_CHAIN_DESC1 swapChainDesc =
+        {
+            .Width = m_width,
+            .Height = m_height,
+            .Format = DXGI_FORMAT_R8G8B8A8_UNORM,
+            .SampleDesc = {.Count = 1},
+            .BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT,
+            .BufferCount = BackBufferCount,
+            .SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD
+        };
+
+        ComPtr<IDXGISwapChain1> baseSwapChain;
+
+        ThrowIfFailed(factory->CreateSwapChainForHwnd(commandQueue, hWnd, &swapChainDesc,
+                                                      nullptr, nullptr, &baseSwapChain));
+        ThrowIfFailed(baseSwapChain.As(&m_swapChain));
+        ThrowIfFailed(factory->MakeWindowAssociation(hWnd, DXGI_MWA_NO_ALT_ENTER));
+
+        m_currentBackBufferIndex = m_swapChain->GetCurrentBackBufferIndex();
+
+        static constexpr D3D12_DESCRIPTOR_HEAP_DESC rtvHeapDesc =
+        {
+            .Type = D3D12_DESCRIPTOR_HEAP_TYPE_RTV,
+            .NumDescriptors = BackBufferCount
+        };
+
+        ThrowIfFailed(m_device->CreateDescriptorHeap(&rtvHeapDesc, IID_PPV_ARGS(&m_rtvHeap)));
+
+        m_rtvDescriptorSize = m_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
+
+        ThrowIfFailed(CreateRenderTargetViews());
+    }
+
+    HRESULT WindowSurface::CreateRenderTargetViews()
+    {
+        assert(m_swapChain && m_rtvHeap);
+
+        // The cached lists reference the previous back buffers and size
+        for (CachedCommandList& cached : m_commandLists)
+            cached.isValid = false;
+
+        D3D12_CPU_DESCRIPTOR_HANDLE rtvHandle = m_rtvHeap->GetCPUDescriptorHandleForHeapStart();
+
+        m_backBufferBytes = 0;
+
+        for (UINT i = 0; i < BackBufferCount; ++i)
+        {
+            const HRESULT hr = m_swapChain->GetBuffer(i, IID_PPV_ARGS(&m_backBuffers[i]));
+
+            if (FAILED(hr)) [[unlikely]]
+                return hr;
+
+            m_device->CreateRenderTargetView(m_backBuffers[i].Get(), nullptr, rtvHandle);
+            rtvHandle.ptr += m_rtvDescriptorSize;
+
+            const D3D12_RESOURCE_DESC desc = m_backBuffers[i]->GetDesc();
+
+            m_backBufferBytes += m_device->GetResourceAllocationInfo(0, 1, &desc).SizeInBytes;
+        }
+
+        return S_OK;
+    }
+
+    void WindowSurface::CreateCommandLists()
+    {
+        for (CachedCommandList& cached : m_commandLists)
+        {
+            ThrowIfFailed(m_device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT,
+                                                           IID_PPV_ARGS(&cached.allocator)));
+            ThrowIfFailed(m_device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT,
+                                                      cached.allocator.Get(), nullptr,
+                                                      IID_PPV_ARGS(&cached.commandList)));
+            ThrowIfFailed(cached.commandList->Close());
+        }
+    }
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "WindowsPlatform.hpp"
+
+#include "ComPtr.hpp"
+
+#include <d3d12.h>
+
+#include <array>
+#include <cstdint>
+
+interface IDXGIFactory6;
+interface IDXGISwapChain3;
+
+namespace DXSandbox
+{
+    // Presentation state of one window on a device shared by every window:
+    // the swap chain, the render target views of its back buffers, and a
+    // command list cached for each back buffer
+    class WindowSurface final
+    {
+    public:
+        static constexpr UINT BackBufferCount = 2;
+
+        struct Params final
+        {
+            HWND hWnd = nullptr;
+            UINT width = 0;
+            UINT height = 0;
+
+            // Vertical blanks each present waits for; presents are made one
+            // after the other, so only one window of a frame should wait
+            UINT syncInterval = 1;
+
+            // Renders every nth frame, for windows that do not need the full
+            // frame rate
+            UINT presentInterval = 1;
+        };
+
+        // The list last recorded for a back buffer, executed again while
+        // the frame content does not change
+        struct CachedCommandList final
+        {
+            ComPtr<ID3D12CommandAllocator> allocator;
+            ComPtr<ID3D12GraphicsCommandList> commandList;
+            std::uint64_t contentKey = 0;
+            bool isValid = false;
+        };
+
+        WindowSurface(IDXGIFactory6* factory, ComPtr<ID3D12Device> device,
+                      ID3D12CommandQueue* commandQueue, const Params& params);
+        ~WindowSurface();
+
+        WindowSurface(const WindowSurface&) = delete;
+        WindowSurface& operator = (const WindowSurface&) = delete;
+
+        // Must not be called while the GPU uses the back buffers; zero sizes
+        // are ignored
+        [[nodiscard]] HRESULT Resize(UINT width, UINT height);
+
+        bool IsPresentDue(std::uint64_t frameIndex) const noexcept;
+
+        // Whether the last present found nothing of the window visible
+        bool IsOccluded() const noexcept;
+
+        [[nodiscard]] HRESULT Present();
+        [[nodiscard]] HRESULT TestPresent();
+
+        // Called once the GPU has finished the presented frame
+        void UpdateBackBufferIndex() noexcept;
+
+        ID3D12Resource* BackBuffer() const noexcept;
+        D3D12_CPU_DESCRIPTOR_HANDLE RenderTargetView() const noexcept;
+
+        CachedCommandList& CurrentCommandList() noexcept;
+
+        UINT Width() const noexcept;
+        UINT Height() const noexcept;
+
+        // Video memory taken by the back buffers
+        std::uint64_t BackBufferBytes() const noexcept;
+
+    private:
+        void CreateSwapChain(IDXGIFactory6* factory, ID3D12CommandQueue* commandQueue, HWND hWnd);
+        [[nodiscard]] HRESULT CreateRenderTargetViews();
+        void CreateCommandLists();
+
+    private:
+        ComPtr<ID3D12Device> m_device;
+        ComPtr<IDXGISwapChain3> m_swapChain;
+        ComPtr<ID3D12DescriptorHeap> m_rtvHeap;
+
+        UINT m_rtvDescriptorSize = 0;
+
+        UINT m_width = 0;
+        UINT m_height = 0;
+
+        UINT m_syncInterval = 1;
+        UINT m_presentInterval = 1;
+
+        bool m_isOccluded = false;
+
+        std::array<ComPtr<ID3D12Resource>, BackBufferCount> m_backBuffers;
+
+        UINT m_currentBackBufferIndex = 0;
+
+        std::uint64_t m_backBufferBytes = 0;
+
+        std::array<CachedCommandList, BackBufferCount> m_commandLists;
+    };
+}
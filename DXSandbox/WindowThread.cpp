@@ -0,0 +1,75 @@
+#include "WindowThread.hpp"
+
+#include "AllocationTracking.hpp"
+#include "Window.hpp"
+
+#include <cassert>
+#include <future>
+
+namespace
+{
+    void PumpMessages()
+    {
+        MSG msg;
+
+        while (GetMessageW(&msg, nullptr, WM_NULL, WM_NULL) > 0)
+        {
+            TranslateMessage(&msg);
+            DispatchMessageW(&msg);
+        }
+    }
+}
+
+namespace DXSandbox
+{
+    WindowThread::WindowThread(HINSTANCE hInstance, IWindowPresenter& presenter)
+    {
+        std::promise<void> created;
+        std::future<void> creation = created.get_future();
+
+        m_thread = std::jthread{[this, hInstance, &presenter, &created]
+        {
+            const AllocationTracking::TagScope tag{AllocationTracking::Tag::Window};
+
+            try
+            {
+                m_window = std::make_unique<Window>(hInstance, presenter);
+                m_threadId = GetCurrentThreadId();
+            }
+            catch (...)
+            {
+                created.set_exception(std::current_exception());
+                return;
+            }
+
+            created.set_value();
+
+            PumpMessages();
+
+            // Windows can only be destroyed by the thread that created them
+            m_window = nullptr;
+        }};
+
+        creation.get();
+    }
+
+    WindowThread::~WindowThread()
+    {
+        assert(m_threadId);
+
+        // The message queue exists since the window was created on it
+        [[maybe_unused]]
+        const BOOL isPosted = PostThreadMessageW(m_threadId, WM_QUIT, 0, 0);
+
+        assert(isPosted);
+
+        m_thread.join();
+    }
+
+    Window& WindowThread::Get() noexcept
+    {
+        assert(m_window);
+
+        return *m_window;
+    }
+}
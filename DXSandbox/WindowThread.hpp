@@ -0,0 +1,38 @@
+#pragma once
+
+#include "WindowsPlatform.hpp"
+
+#include <memory>
+#include <thread>
+
+namespace DXSandbox
+{
+    class IWindowPresenter;
+    class Window;
+
+    // Owns a window on a dedicated thread that does nothing but pump its
+    // messages, so modal move and size loops or slow messages never stall
+    // rendering. The presenter is called on that thread and must hand
+    // events over rather than act on them.
+    class WindowThread final
+    {
+    public:
+        // Returns once the window exists; creation errors are rethrown here
+        explicit WindowThread(HINSTANCE hInstance, IWindowPresenter& presenter);
+
+        // Destroys the window on its thread and joins it
+        ~WindowThread();
+
+        WindowThread(const WindowThread&) = delete;
+        WindowThread& operator = (const WindowThread&) = delete;
+
+        // Calls sending messages to the window are served by the window
+        // thread, which never waits for other threads
+        Window& Get() noexcept;
+
+    private:
+        std::unique_ptr<Window> m_window;
+        DWORD m_threadId = 0;
+        std::jthread m_thread;
+    };
+}
@@ -0,0 +1,241 @@
+#include "YuvConversion.hpp"
+
+#include <cassert>
+
+#if !defined DXSANDBOX_YUV_NO_SIMD && (defined _M_X64 || defined __SSE2__)
+#   define DXSANDBOX_YUV_SSE2 1
+#   include <emmintrin.h>
+#endif
+
+namespace
+{
+    struct Planes final
+    {
+        std::uint8_t* y = nullptr;
+        std::uint8_t* u = nullptr;
+        std::uint8_t* v = nullptr;
+
+        std::uint32_t chromaWidth = 0;
+    };
+
+    Planes SplitPlanes(const DXSandbox::Yuv::RgbaView& image, std::uint8_t* destination) noexcept
+    {
+        const std::size_t lumaSize = static_cast<std::size_t>(image.width) * image.height;
+        const std::uint32_t chromaWidth = (image.width + 1) / 2;
+        const std::size_t chromaSize = static_cast<std::size_t>(chromaWidth) * ((image.height + 1) / 2);
+
+        return
+        {
+            .y = destination,
+            .u = destination + lumaSize,
+            .v = destination + lumaSize + chromaSize,
+            .chromaWidth = chromaWidth
+        };
+    }
+
+    inline const std::uint8_t* Row(const DXSandbox::Yuv::RgbaView& image, std::uint32_t y) noexcept
+    {
+        return reinterpret_cast<const std::uint8_t*>(image.pixels) + static_cast<std::size_t>(y) * image.rowPitch;
+    }
+
+    inline std::uint8_t Luma(int r, int g, int b) noexcept
+    {
+        return static_cast<std::uint8_t>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+    }
+
+    inline std::uint8_t ChromaU(int r, int g, int b) noexcept
+    {
+        return static_cast<std::uint8_t>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+    }
+
+    inline std::uint8_t ChromaV(int r, int g, int b) noexcept
+    {
+        return static_cast<std::uint8_t>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+    }
+
+    // Converts the pixels [xBegin, xEnd) of a row pair, with xBegin even.
+    // The last row of an odd height is passed as both rows, and the last
+    // column of an odd width is repeated, so the averages stay unbiased.
+    void ConvertSpanScalar(const std::uint8_t* row0, const std::uint8_t* row1, std::uint32_t width,
+                           std::uint32_t xBegin, std::uint32_t xEnd,
+                           std::uint8_t* y0, std::uint8_t* y1, std::uint8_t* u, std::uint8_t* v) noexcept
+    {
+        for (std::uint32_t x = xBegin; x < xEnd; x += 2)
+        {
+            const std::uint32_t x1 = x + 1 < width ? x + 1 : x;
+
+            const std::uint8_t* block[4] = {row0 + x * 4, row0 + x1 * 4, row1 + x * 4, row1 + x1 * 4};
+
+            int r = 0;
+            int g = 0;
+            int b = 0;
+
+            for (const std::uint8_t* pixel : block)
+            {
+                r += pixel[0];
+                g += pixel[1];
+                b += pixel[2];
+            }
+
+            y0[x] = Luma(block[0][0], block[0][1], block[0][2]);
+            y1[x] = Luma(block[2][0], block[2][1], block[2][2]);
+
+            if (x1 != x)
+            {
+                y0[x1] = Luma(block[1][0], block[1][1], block[1][2]);
+                y1[x1] = Luma(block[3][0], block[3][1], block[3][2]);
+            }
+
+            u[x / 2] = ChromaU((r + 2) >> 2, (g + 2) >> 2, (b + 2) >> 2);
+            v[x / 2] = ChromaV((r + 2) >> 2, (g + 2) >> 2, (b + 2) >> 2);
+        }
+    }
+
+    using SpanConverter = void (*)(const std::uint8_t* row0, const std::uint8_t* row1, std::uint32_t width,
+                                   std::uint8_t* y0, std::uint8_t* y1, std::uint8_t* u, std::uint8_t* v);
+
+    void ConvertRowPairsScalar(const std::uint8_t* row0, const std::uint8_t* row1, std::uint32_t width,
+                               std::uint8_t* y0, std::uint8_t* y1, std::uint8_t* u, std::uint8_t* v) noexcept
+    {
+        ConvertSpanScalar(row0, row1, width, 0, width, y0, y1, u, v);
+    }
+
+#if defined DXSANDBOX_YUV_SSE2
+    // Sums adjacent 32-bit lanes of two madd results: four pixels' worth
+    inline __m128i SumPairs(__m128i lo, __m128i hi) noexcept
+    {
+        const __m128 loFloat = _mm_castsi128_ps(lo);
+        const __m128 hiFloat = _mm_castsi128_ps(hi);
+
+        const __m128i even = _mm_castps_si128(_mm_shuffle_ps(loFloat, hiFloat, _MM_SHUFFLE(2, 0, 2, 0)));
+        const __m128i odd = _mm_castps_si128(_mm_shuffle_ps(loFloat, hiFloat, _MM_SHUFFLE(3, 1, 3, 1)));
+
+        return _mm_add_epi32(even, odd);
+    }
+
+    // ((sum + 128) >> 8) + bias for four lanes, narrowed to bytes
+    inline std::uint32_t Finish(__m128i sum, __m128i bias) noexcept
+    {
+        const __m128i rounded = _mm_add_epi32(_mm_srai_epi32(_mm_add_epi32(sum, _mm_set1_epi32(128)), 8), bias);
+        const __m128i words = _mm_packs_epi32(rounded, rounded);
+
+        return static_cast<std::uint32_t>(_mm_cvtsi128_si32(_mm_packus_epi16(words, words)));
+    }
+
+    inline void Store4(std::uint8_t* destination, std::uint32_t value) noexcept
+    {
+        destination[0] = static_cast<std::uint8_t>(value);
+        destination[1] = static_cast<std::uint8_t>(value >> 8);
+        destination[2] = static_cast<std::uint8_t>(value >> 16);
+        destination[3] = static_cast<std::uint8_t>(value >> 24);
+    }
+
+    // Luma of four RGBA pixels
+    inline std::uint32_t Luma4(__m128i pixels, __m128i lumaWeights) noexcept
+    {
+        const __m128i zero = _mm_setzero_si128();
+
+        const __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi8(pixels, zero), lumaWeights);
+        const __m128i hi = _mm_madd_epi16(_mm_unpackhi_epi8(pixels, zero), lumaWeights);
+
+        return Finish(SumPairs(lo, hi), _mm_set1_epi32(16));
+    }
+
+    // Rounded 2x2 averages of four pixels from each row, as two RGBA words
+    inline __m128i Average2x2(__m128i top, __m128i bottom) noexcept
+    {
+        const __m128i zero = _mm_setzero_si128();
+
+        const __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(top, zero), _mm_unpacklo_epi8(bottom, zero));
+        const __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(top, zero), _mm_unpackhi_epi8(bottom, zero));
+
+        const __m128i loSum = _mm_add_epi16(lo, _mm_srli_si128(lo, 8));
+        const __m128i hiSum = _mm_add_epi16(hi, _mm_srli_si128(hi, 8));
+
+        const __m128i sum = _mm_unpacklo_epi64(loSum, hiSum);
+
+        return _mm_srli_epi16(_mm_add_epi16(sum, _mm_set1_epi16(2)), 2);
+    }
+
+    // Eight pixels of both rows per iteration, the remainder is scalar
+    void ConvertRowPairsSse2(const std::uint8_t* row0, const std::uint8_t* row1, std::uint32_t width,
+                             std::uint8_t* y0, std::uint8_t* y1, std::uint8_t* u, std::uint8_t* v) noexcept
+    {
+        const __m128i lumaWeights = _mm_setr_epi16(66, 129, 25, 0, 66, 129, 25, 0);
+        const __m128i uWeights = _mm_setr_epi16(-38, -74, 112, 0, -38, -74, 112, 0);
+        const __m128i vWeights = _mm_setr_epi16(112, -94, -18, 0, 112, -94, -18, 0);
+        const __m128i chromaBias = _mm_set1_epi32(128);
+
+        const std::uint32_t simdWidth = width & ~7u;
+
+        for (std::uint32_t x = 0; x < simdWidth; x += 8)
+        {
+            const __m128i top0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x * 4));
+            const __m128i top1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x * 4 + 16));
+            const __m128i bottom0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x * 4));
+            const __m128i bottom1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x * 4 + 16));
+
+            Store4(y0 + x, Luma4(top0, lumaWeights));
+            Store4(y0 + x + 4, Luma4(top1, lumaWeights));
+            Store4(y1 + x, Luma4(bottom0, lumaWeights));
+            Store4(y1 + x + 4, Luma4(bottom1, lumaWeights));
+
+            const __m128i average0 = Average2x2(top0, bottom0);
+            const __m128i average1 = Average2x2(top1, bottom1);
+
+            const __m128i uSum = SumPairs(_mm_madd_epi16(average0, uWeights), _mm_madd_epi16(average1, uWeights));
+            const __m128i vSum = SumPairs(_mm_madd_epi16(average0, vWeights), _mm_madd_epi16(average1, vWeights));
+
+            Store4(u + x / 2, Finish(uSum, chromaBias));
+            Store4(v + x / 2, Finish(vSum, chromaBias));
+        }
+
+        ConvertSpanScalar(row0, row1, width, simdWidth, width, y0, y1, u, v);
+    }
+#endif
+
+    void Convert(const DXSandbox::Yuv::RgbaView& image, std::uint8_t* destination, SpanConverter convert) noexcept
+    {
+        assert(image.pixels && destination);
+        assert(image.rowPitch >= image.width * 4);
+
+        const Planes planes = SplitPlanes(image, destination);
+
+        for (std::uint32_t y = 0; y < image.height; y += 2)
+        {
+            const std::uint32_t y1 = y + 1 < image.height ? y + 1 : y;
+
+            // An odd last row is converted twice into the same luma row
+            const std::size_t chromaOffset = static_cast<std::size_t>(y / 2) * planes.chromaWidth;
+
+            convert(Row(image, y), Row(image, y1), image.width,
+                    planes.y + static_cast<std::size_t>(y) * image.width,
+                    planes.y + static_cast<std::size_t>(y1) * image.width,
+                    planes.u + chromaOffset, planes.v + chromaOffset);
+        }
+    }
+}
+
+namespace DXSandbox::Yuv
+{
+    std::size_t I420Size(std::uint32_t width, std::uint32_t height) noexcept
+    {
+        const std::size_t chromaSize = static_cast<std::size_t>((width + 1) / 2) * ((height + 1) / 2);
+
+        return static_cast<std::size_t>(width) * height + 2 * chromaSize;
+    }
+
+    void Scalar::ConvertRgbaToI420(const RgbaView& image, std::uint8_t* destination) noexcept
+    {
+        Convert(image, destination, ConvertRowPairsScalar);
+    }
+
+    void Simd::ConvertRgbaToI420(const RgbaView& image, std::uint8_t* destination) noexcept
+    {
+#if defined DXSANDBOX_YUV_SSE2
+        Convert(image, destination, ConvertRowPairsSse2);
+#else
+        Convert(image, destination, ConvertRowPairsScalar);
+#endif
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace DXSandbox::Yuv
+{
+    // Tightly or loosely packed RGBA8 pixels
+    struct RgbaView final
+    {
+        const std::byte* pixels = nullptr;
+        std::uint32_t width = 0;
+        std::uint32_t height = 0;
+        std::uint32_t rowPitch = 0;
+    };
+
+    // Size of a planar I420 frame: full resolution Y followed by quarter
+    // resolution U and V, rounded up for odd sizes
+    std::size_t I420Size(std::uint32_t width, std::uint32_t height) noexcept;
+
+    // BT.601 limited range conversion, chroma averaged over 2x2 blocks. The
+    // SIMD path is chosen at compile time like the math batch kernels and
+    // produces the same bytes as the scalar one, which is kept for comparison.
+    namespace Scalar
+    {
+        void ConvertRgbaToI420(const RgbaView& image, std::uint8_t* destination) noexcept;
+    }
+
+    namespace Simd
+    {
+        void ConvertRgbaToI420(const RgbaView& image, std::uint8_t* destination) noexcept;
+    }
+
+    inline void ConvertRgbaToI420(const RgbaView& image, std::uint8_t* destination) noexcept
+    {
+        Simd::ConvertRgbaToI420(image, destination);
+    }
+}
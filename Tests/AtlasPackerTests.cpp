@@ -0,0 +1,116 @@
+#include "Check.hpp"
+
+#include "AtlasPacker.hpp"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace
+{
+    using DXSandbox::AtlasPacker;
+    using DXSandbox::Tests::Check;
+
+    constexpr std::uint32_t AtlasSize = 256;
+
+    bool Overlaps(const AtlasPacker::Rect& a, const AtlasPacker::Rect& b) noexcept
+    {
+        return a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height;
+    }
+
+    // Glyph sized rectangles until the atlas is full
+    void TestPacking()
+    {
+        std::mt19937 random{3};
+
+        AtlasPacker packer{AtlasSize, AtlasSize};
+
+        std::vector<AtlasPacker::Rect> rects;
+        std::uint64_t area = 0;
+
+        std::uint32_t failedWidth = 0;
+        std::uint32_t failedHeight = 0;
+
+        bool isInBounds = true;
+        bool isSized = true;
+
+        for (;;)
+        {
+            const std::uint32_t width = 4 + random() % 20;
+            const std::uint32_t height = 8 + random() % 16;
+
+            const auto rect = packer.Pack(width, height);
+
+            if (!rect)
+            {
+                failedWidth = width;
+                failedHeight = height;
+                break;
+            }
+
+            isInBounds &= rect->x + rect->width <= AtlasSize && rect->y + rect->height <= AtlasSize;
+            isSized &= rect->width == width && rect->height == height;
+
+            rects.push_back(*rect);
+            area += std::uint64_t{width} * height;
+        }
+
+        bool isDisjoint = true;
+
+        for (std::size_t i = 0; i < rects.size(); ++i)
+        {
+            for (std::size_t j = i + 1; j < rects.size(); ++j)
+                isDisjoint &= !Overlaps(rects[i], rects[j]);
+        }
+
+        const double occupancy = static_cast<double>(area) / (AtlasSize * AtlasSize);
+
+        Check(isInBounds, "Packed rectangles are inside the atlas");
+        Check(isSized, "Packed rectangles have the size asked for");
+        Check(isDisjoint, "Packed rectangles do not overlap");
+        Check(packer.Occupancy() == occupancy, "The occupancy is the packed area");
+        Check(occupancy > 0.7, "The skyline packs glyphs densely");
+
+        Check(!packer.Pack(failedWidth, failedHeight) && packer.Occupancy() == occupancy,
+              "A rectangle that did not fit fails again without using space");
+
+        packer.Reset();
+
+        const auto whole = packer.Pack(AtlasSize, AtlasSize);
+
+        Check(whole && whole->x == 0 && whole->y == 0, "A reset atlas packs its whole area");
+        Check(!packer.Pack(1, 1), "An atlas filled by one rectangle packs nothing more");
+    }
+
+    void TestOversized()
+    {
+        AtlasPacker packer{AtlasSize, AtlasSize};
+
+        Check(!packer.Pack(AtlasSize + 1, 1), "A rectangle wider than the atlas fails");
+        Check(!packer.Pack(1, AtlasSize + 1), "A rectangle taller than the atlas fails");
+        Check(packer.Occupancy() == 0.0, "Failed packs use nothing");
+    }
+
+    // Rows are filled from the top down, left to right
+    void TestSkyline()
+    {
+        AtlasPacker packer{100, 100};
+
+        const auto first = packer.Pack(60, 10);
+        const auto second = packer.Pack(40, 20);
+        const auto third = packer.Pack(60, 10);
+
+        Check(first && first->x == 0 && first->y == 0, "The first rectangle goes to the top left corner");
+        Check(second && second->x == 60 && second->y == 0, "The next one goes beside it");
+        Check(third && third->x == 0 && third->y == 10, "Then under the lowest edge");
+    }
+}
+
+int main()
+{
+    TestPacking();
+    TestOversized();
+    TestSkyline();
+
+    return DXSandbox::Tests::Result();
+}
@@ -0,0 +1,119 @@
+#include "Check.hpp"
+
+#include "BindlessHandleTable.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+    using DXSandbox::BindlessHandleTable;
+    using DXSandbox::Tests::Check;
+
+    using Handle = BindlessHandleTable::Handle;
+
+    void TestStaleHandles()
+    {
+        BindlessHandleTable table{4};
+
+        const Handle handle = table.Allocate();
+
+        Check(handle != BindlessHandleTable::InvalidHandle && table.IsValid(handle), "An allocated handle is valid");
+        const std::uint32_t index = table.Index(handle);
+
+        Check(index == 0, "The first handle has the first slot");
+
+        table.Free(handle, 1);
+
+        Check(!table.IsValid(handle), "A freed handle is stale");
+
+        table.Reclaim(1);
+
+        const Handle reused = table.Allocate();
+
+        Check(table.Index(reused) == index && reused != handle,
+              "A reused slot has a handle of a new generation");
+        Check(!table.IsValid(handle) && table.IsValid(reused), "The stale handle stays stale after the reuse");
+        Check(!table.IsValid(BindlessHandleTable::InvalidHandle), "The invalid handle is never valid");
+        Check(!table.IsValid(Handle{7}), "A handle beyond the capacity is not valid");
+    }
+
+    void TestReclaim()
+    {
+        BindlessHandleTable table{2};
+
+        const Handle first = table.Allocate();
+        const Handle second = table.Allocate();
+
+        Check(table.Allocate() == BindlessHandleTable::InvalidHandle, "A full table allocates nothing");
+
+        const std::uint32_t firstIndex = table.Index(first);
+        const std::uint32_t secondIndex = table.Index(second);
+
+        // Released by frames 5 and 6, which the GPU completes in turn
+        table.Free(first, 5);
+        table.Free(second, 6);
+
+        Check(table.Stats().pendingCount == 2 && table.Stats().liveCount == 0, "Freed slots wait for the GPU");
+
+        table.Reclaim(4);
+
+        Check(table.Allocate() == BindlessHandleTable::InvalidHandle,
+              "No slot is reused before the frame releasing it completes");
+
+        table.Reclaim(5);
+
+        const Handle reused = table.Allocate();
+
+        Check(reused != BindlessHandleTable::InvalidHandle && table.Index(reused) == firstIndex,
+              "The slot of a completed frame is reused");
+        Check(table.Allocate() == BindlessHandleTable::InvalidHandle, "The slot of a frame in flight is not");
+
+        table.Reclaim(6);
+
+        Check(table.Index(table.Allocate()) == secondIndex, "Completing the next frame frees its slot");
+        Check(table.Stats().pendingCount == 0 && table.Stats().liveCount == 2, "Every slot is live again");
+    }
+
+    // A single slot freed more times than there are generations
+    void TestGenerationWrap()
+    {
+        BindlessHandleTable table{1};
+
+        constexpr std::uint32_t GenerationCount = (1u << BindlessHandleTable::GenerationBits) - 1;
+
+        std::vector<Handle> handles;
+
+        for (std::uint32_t i = 0; i <= GenerationCount; ++i)
+        {
+            const Handle handle = table.Allocate();
+
+            handles.push_back(handle);
+
+            table.Free(handle, i);
+            table.Reclaim(i);
+        }
+
+        bool isNeverInvalid = true;
+        bool isNextGeneration = true;
+
+        for (std::uint32_t i = 0; i < GenerationCount; ++i)
+        {
+            isNeverInvalid &= handles[i] != BindlessHandleTable::InvalidHandle;
+            isNextGeneration &= handles[i] >> BindlessHandleTable::IndexBits == i + 1;
+        }
+
+        Check(isNeverInvalid, "No generation gives the invalid handle");
+        Check(isNextGeneration, "Every free moves the slot to the next generation");
+        Check(handles[GenerationCount] == handles[0], "The generation wraps around to the first one, skipping zero");
+    }
+}
+
+int main()
+{
+    TestStaleHandles();
+    TestReclaim();
+    TestGenerationWrap();
+
+    return DXSandbox::Tests::Result();
+}
@@ -0,0 +1,113 @@
+#include "Check.hpp"
+
+#include "BoundedQueue.hpp"
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    using DXSandbox::BoundedQueue;
+    using DXSandbox::Tests::Check;
+
+    constexpr std::uint32_t ProducerCount = 4;
+    constexpr std::uint32_t ItemsPerProducer = 200'000;
+
+    struct Item final
+    {
+        std::uint32_t producer = 0;
+        std::uint32_t sequence = 0;
+    };
+
+    void TestCapacity()
+    {
+        BoundedQueue<std::uint32_t, 4> queue;
+
+        std::uint32_t value = 0;
+
+        Check(!queue.TryPop(value), "An empty queue pops nothing");
+
+        for (std::uint32_t i = 0; i < 4; ++i)
+            Check(queue.TryPush(i), "Pushing below the capacity succeeds");
+
+        Check(!queue.TryPush(4), "Pushing to a full queue fails");
+
+        // Several laps, so the sequence numbers wrap around the cells
+        bool isFifo = true;
+
+        for (std::uint32_t i = 0; i < 40; ++i)
+        {
+            isFifo &= queue.TryPop(value) && value == i;
+            isFifo &= queue.TryPush(i + 4);
+        }
+
+        Check(isFifo, "Values pop in the order they were pushed");
+    }
+
+    // Producers push their items in sequence through a small queue, which
+    // is full most of the time, while one consumer pops them all
+    void TestProducersConsumer()
+    {
+        BoundedQueue<Item, 64> queue;
+
+        std::vector<std::jthread> producers;
+
+        for (std::uint32_t producer = 0; producer < ProducerCount; ++producer)
+        {
+            producers.emplace_back([&queue, producer]
+            {
+                for (std::uint32_t sequence = 0; sequence < ItemsPerProducer; ++sequence)
+                {
+                    while (!queue.TryPush({.producer = producer, .sequence = sequence}))
+                        std::this_thread::yield();
+                }
+            });
+        }
+
+        std::vector<std::uint32_t> nextSequences(ProducerCount, 0);
+
+        bool isKnownProducer = true;
+        bool isInOrder = true;
+
+        for (std::uint32_t popped = 0; popped < ProducerCount * ItemsPerProducer;)
+        {
+            Item item;
+
+            if (!queue.TryPop(item))
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            ++popped;
+
+            if (item.producer >= ProducerCount)
+            {
+                isKnownProducer = false;
+                continue;
+            }
+
+            isInOrder &= item.sequence == nextSequences[item.producer];
+            nextSequences[item.producer] = item.sequence + 1;
+        }
+
+        producers.clear();
+
+        Item item;
+
+        Check(isKnownProducer, "Every item comes from a producer");
+        Check(isInOrder, "The items of each producer pop in the order they were pushed");
+        Check(nextSequences == std::vector<std::uint32_t>(ProducerCount, ItemsPerProducer),
+              "Every item of every producer pops once");
+        Check(!queue.TryPop(item), "Nothing is left once every item has popped");
+    }
+}
+
+int main()
+{
+    TestCapacity();
+    TestProducersConsumer();
+
+    return DXSandbox::Tests::Result();
+}
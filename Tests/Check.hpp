@@ -0,0 +1,28 @@
+#pragma once
+
+#include <iostream>
+#include <source_location>
+
+namespace DXSandbox::Tests
+{
+    inline int g_failedChecks = 0;
+
+    // Unlike assert, also checked in release builds. Failures are reported
+    // with their location and the test goes on, so one run shows them all.
+    inline void Check(bool isPassed, const char* description,
+                      const std::source_location location = std::source_location::current())
+    {
+        if (isPassed)
+            return;
+
+        std::cerr << location.file_name() << '(' << location.line() << "): " << description << '\n';
+
+        ++g_failedChecks;
+    }
+
+    // The exit code of the test
+    inline int Result() noexcept
+    {
+        return g_failedChecks == 0 ? 0 : 1;
+    }
+}
@@ -0,0 +1,311 @@
+#include "Check.hpp"
+
+#include "CommandCapture.hpp"
+#include "CommandStream.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <optional>
+#include <random>
+#include <span>
+#include <vector>
+
+namespace
+{
+    namespace fs = std::filesystem;
+
+    using namespace DXSandbox;
+
+    using DXSandbox::Tests::Check;
+
+    // Every call as its name and arguments, floats by their bits, so two
+    // recordings compare exactly
+    class RecordingBackend final : public ICommandBackend
+    {
+    public:
+        using Call = std::vector<std::uint32_t>;
+
+        void BeginList() override
+        {
+            m_calls.push_back({0});
+        }
+
+        void Barrier(std::uint32_t target, ResourceState before, ResourceState after) override
+        {
+            m_calls.push_back({1, target, static_cast<std::uint32_t>(before), static_cast<std::uint32_t>(after)});
+        }
+
+        void SetRenderTarget(std::uint32_t target, std::uint32_t width, std::uint32_t height) override
+        {
+            m_calls.push_back({2, target, width, height});
+        }
+
+        void Clear(std::uint32_t target, std::uint32_t width, std::uint32_t height,
+                   const std::array<float, 4>& color) override
+        {
+            m_calls.push_back({3, target, width, height, std::bit_cast<std::uint32_t>(color[0]),
+                               std::bit_cast<std::uint32_t>(color[1]), std::bit_cast<std::uint32_t>(color[2]),
+                               std::bit_cast<std::uint32_t>(color[3])});
+        }
+
+        void SetRootSignature(std::uint32_t rootSignature) override
+        {
+            m_calls.push_back({4, rootSignature});
+        }
+
+        void SetPipelineState(std::uint32_t pipelineState) override
+        {
+            m_calls.push_back({5, pipelineState});
+        }
+
+        void SetMaterial(std::uint32_t material) override
+        {
+            m_calls.push_back({6, material});
+        }
+
+        void Draw(const DrawArgs& args) override
+        {
+            m_calls.push_back({7, args.vertexCount, args.instanceCount, args.startVertex, args.startInstance});
+        }
+
+        void Upscale(std::uint32_t source, std::uint32_t width, std::uint32_t height) override
+        {
+            m_calls.push_back({8, source, width, height});
+        }
+
+        void CopyToReadback(std::uint32_t source) override
+        {
+            m_calls.push_back({9, source});
+        }
+
+        const std::vector<Call>& Calls() const noexcept
+        {
+            return m_calls;
+        }
+
+    private:
+        std::vector<Call> m_calls;
+    };
+
+    constexpr std::uint32_t MaxUInt = std::numeric_limits<std::uint32_t>::max();
+
+    // Every opcode, with integers at the edges of the varint byte counts
+    // and floats that are easy to mangle
+    void RecordFrame(ICommandBackend& backend)
+    {
+        backend.BeginList();
+        backend.Barrier(0, ResourceState::Present, ResourceState::RenderTarget);
+        backend.Barrier(MaxUInt, ResourceState::ShaderResource, ResourceState::CopySource);
+        backend.SetRenderTarget(127, 128, 16'383);
+        backend.Clear(16'384, 1920, 1080, {-0.0f, 0.25f, std::numeric_limits<float>::infinity(), 1e-40f});
+        backend.SetRootSignature(1);
+        backend.SetPipelineState(2'097'151);
+        backend.SetMaterial(2'097'152);
+        backend.Draw({.vertexCount = 36, .instanceCount = 1, .startVertex = 0, .startInstance = MaxUInt});
+        backend.Draw({.vertexCount = 3, .instanceCount = 268'435'455, .startVertex = 268'435'456,
+                      .startInstance = 7});
+        backend.Upscale(3, 1280, 720);
+        backend.CopyToReadback(4);
+        backend.Barrier(1, ResourceState::CopySource, ResourceState::Present);
+    }
+
+    void TestRoundTrip()
+    {
+        RecordingBackend direct;
+        CommandStream stream;
+
+        RecordFrame(direct);
+        RecordFrame(stream);
+
+        RecordingBackend replayed;
+
+        const std::optional<std::size_t> count = CommandStream::Replay(stream.Bytes(), replayed);
+
+        Check(stream.CommandCount() == direct.Calls().size(), "The stream counts every command");
+        Check(count == direct.Calls().size(), "Replaying returns the number of commands");
+        Check(replayed.Calls() == direct.Calls(), "Every command replays with its exact arguments");
+
+        stream.Reset();
+
+        Check(stream.Bytes().empty() && stream.CommandCount() == 0, "Reset empties the stream");
+        Check(CommandStream::Replay({}, replayed) == std::size_t{0}, "An empty stream replays nothing");
+    }
+
+    // Every prefix of a frame: those ending on a command replay what they
+    // hold, the others fail without issuing the command they cut
+    void TestTruncation()
+    {
+        RecordingBackend direct;
+        CommandStream stream;
+
+        RecordFrame(direct);
+        RecordFrame(stream);
+
+        const std::span<const std::byte> bytes = stream.Bytes();
+
+        bool isBoundaryReplayed = true;
+        bool isTruncationRejected = true;
+        bool isCutCommandDropped = true;
+
+        std::size_t boundaryCount = 0;
+
+        for (std::size_t size = 0; size < bytes.size(); ++size)
+        {
+            RecordingBackend replayed;
+
+            const std::optional<std::size_t> count = CommandStream::Replay(bytes.first(size), replayed);
+
+            // The commands replayed are always a prefix of the frame
+            const std::vector<RecordingBackend::Call> expected(direct.Calls().begin(),
+                                                               direct.Calls().begin() +
+                                                               static_cast<std::ptrdiff_t>(replayed.Calls().size()));
+
+            isCutCommandDropped &= replayed.Calls() == expected;
+
+            if (count)
+            {
+                isBoundaryReplayed &= *count == replayed.Calls().size() && *count == boundaryCount;
+                ++boundaryCount;
+            }
+            else
+            {
+                isTruncationRejected &= replayed.Calls().size() + 1 == boundaryCount;
+            }
+        }
+
+        Check(boundaryCount == direct.Calls().size(), "Each command ends at one prefix of the frame");
+        Check(isBoundaryReplayed, "A prefix ending on a command replays the commands it holds");
+        Check(isTruncationRejected, "A prefix cutting a command fails after the commands before it");
+        Check(isCutCommandDropped, "A cut command is never issued");
+    }
+
+    void TestMalformed()
+    {
+        auto replay = [](const std::vector<std::uint8_t>& values, RecordingBackend& backend)
+        {
+            std::vector<std::byte> bytes;
+
+            for (const std::uint8_t value : values)
+                bytes.push_back(static_cast<std::byte>(value));
+
+            return CommandStream::Replay(bytes, backend);
+        };
+
+        RecordingBackend unknownOpcode;
+
+        Check(!replay({0, 0xff, 0}, unknownOpcode) && unknownOpcode.Calls().size() == 1,
+              "An unknown opcode fails after the commands before it");
+
+        RecordingBackend badState;
+
+        Check(!replay({1, 0, 0, 4}, badState) && badState.Calls().empty(),
+              "A barrier to an unknown state fails without being issued");
+
+        RecordingBackend overlongVarint;
+
+        Check(!replay({4, 0x80, 0x80, 0x80, 0x80, 0x80, 0x01}, overlongVarint) && overlongVarint.Calls().empty(),
+              "A varint longer than 32 bits fails without being issued");
+
+        // Random bytes either replay as valid commands or fail, without
+        // reading past the end or issuing more than was decoded
+        std::mt19937 random{17};
+
+        bool isCountConsistent = true;
+
+        for (int round = 0; round < 10'000; ++round)
+        {
+            std::vector<std::uint8_t> values(random() % 32);
+
+            for (std::uint8_t& value : values)
+                value = static_cast<std::uint8_t>(random() % 3 ? random() % 10 : random());
+
+            RecordingBackend backend;
+
+            const std::optional<std::size_t> count = replay(values, backend);
+
+            isCountConsistent &= !count || *count == backend.Calls().size();
+        }
+
+        Check(isCountConsistent, "Random bytes replay only what they decode to");
+    }
+
+    void TestCapture(const fs::path& root)
+    {
+        const fs::path path = root / "Capture.bin";
+
+        CommandCapture capture;
+
+        const int target = 0;
+
+        capture.TargetIndex(&target, 1920, 1080);
+        capture.TargetIndex(&target, 1280, 720);
+        capture.SetStateCounts(1, 8);
+
+        for (int frame = 0; frame < 3; ++frame)
+        {
+            RecordFrame(capture.Stream());
+            capture.EndFrame();
+        }
+
+        Check(capture.Write(path), "A capture is written");
+
+        const std::optional<CommandCapture> read = CommandCapture::Read(path);
+
+        Check(read.has_value(), "A written capture is read back");
+
+        if (read)
+        {
+            bool isSameFrames = read->FrameCount() == capture.FrameCount();
+
+            for (std::uint32_t frame = 0; isSameFrames && frame < capture.FrameCount(); ++frame)
+            {
+                const auto expected = capture.Frame(frame);
+                const auto actual = read->Frame(frame);
+
+                isSameFrames &= std::equal(expected.begin(), expected.end(), actual.begin(), actual.end());
+            }
+
+            Check(isSameFrames, "The frames read back are those written");
+            Check(read->CommandCount() == capture.CommandCount() && read->Targets().size() == 2 &&
+                  read->Targets()[1].width == 1280 && read->PipelineStateCount() == 8,
+                  "The counts and targets read back are those written");
+        }
+
+        // Cut anywhere, a capture is rejected rather than read short
+        const auto size = fs::file_size(path);
+
+        bool isTruncationRejected = true;
+
+        for (std::uintmax_t cut = 0; cut < size; cut += 7)
+        {
+            fs::resize_file(path, cut);
+            isTruncationRejected &= !CommandCapture::Read(path);
+
+            capture.Write(path);
+        }
+
+        Check(isTruncationRejected, "A truncated capture is not read");
+    }
+}
+
+int main()
+{
+    const fs::path root = fs::temp_directory_path() / "DXSandboxCommandStreamTests";
+
+    fs::remove_all(root);
+    fs::create_directories(root);
+
+    TestRoundTrip();
+    TestTruncation();
+    TestMalformed();
+    TestCapture(root);
+
+    fs::remove_all(root);
+
+    return DXSandbox::Tests::Result();
+}
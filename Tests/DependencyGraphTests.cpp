@@ -0,0 +1,101 @@
+#include "Check.hpp"
+
+#include "DependencyGraph.hpp"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using DXSandbox::DependencyGraph;
+    using DXSandbox::Tests::Check;
+
+    std::vector<std::string> Dependents(const DependencyGraph& graph, const std::string& changed)
+    {
+        return graph.Dependents({&changed, 1});
+    }
+
+    bool IsBefore(const std::vector<std::string>& nodes, const std::string& first, const std::string& second)
+    {
+        const auto firstIt = std::find(nodes.begin(), nodes.end(), first);
+        const auto secondIt = std::find(nodes.begin(), nodes.end(), second);
+
+        return firstIt != nodes.end() && secondIt != nodes.end() && firstIt < secondIt;
+    }
+
+    // Pipeline states built from shaders, which include a common header,
+    // and a material built from a pipeline state and a texture
+    DependencyGraph ContentGraph()
+    {
+        DependencyGraph graph;
+
+        graph.AddDependency("pso.opaque", "shaders/opaque_vs.hlsl");
+        graph.AddDependency("pso.opaque", "shaders/opaque_ps.hlsl");
+        graph.AddDependency("shaders/opaque_ps.hlsl", "shaders/common.hlsli");
+        graph.AddDependency("shaders/opaque_vs.hlsl", "shaders/common.hlsli");
+        graph.AddDependency("pso.shadow", "shaders/opaque_vs.hlsl");
+        graph.AddDependency("material.rock", "pso.opaque");
+        graph.AddDependency("material.rock", "tex/rock.dds");
+
+        return graph;
+    }
+
+    void TestDependentsOrder()
+    {
+        const DependencyGraph graph = ContentGraph();
+
+        const auto dependents = Dependents(graph, "shaders/common.hlsli");
+
+        Check(dependents.size() == 5, "Every transitive dependent is listed once");
+        Check(IsBefore(dependents, "shaders/opaque_vs.hlsl", "pso.opaque"), "Shaders are rebuilt before their PSO");
+        Check(IsBefore(dependents, "shaders/opaque_ps.hlsl", "pso.opaque"), "Shaders are rebuilt before their PSO");
+        Check(IsBefore(dependents, "shaders/opaque_vs.hlsl", "pso.shadow"), "Shaders are rebuilt before their PSO");
+        Check(IsBefore(dependents, "pso.opaque", "material.rock"), "PSOs are rebuilt before their materials");
+
+        const auto textureDependents = Dependents(graph, "tex/rock.dds");
+
+        Check(textureDependents == std::vector<std::string>{"material.rock"}, "A leaf has its direct dependent");
+        Check(Dependents(graph, "material.rock").empty(), "Nothing depends on the material");
+    }
+
+    void TestEdgeRemoval()
+    {
+        DependencyGraph graph = ContentGraph();
+
+        graph.ClearDependencies("material.rock");
+
+        Check(Dependents(graph, "tex/rock.dds").empty(), "Cleared dependencies are not followed");
+        Check(!graph.Contains("tex/rock.dds"), "A node without edges is forgotten");
+        Check(graph.Contains("pso.opaque"), "Nodes with other edges are kept");
+
+        graph.Remove("shaders/opaque_vs.hlsl");
+
+        const auto dependents = Dependents(graph, "shaders/common.hlsli");
+
+        Check(dependents.size() == 2, "A removed node no longer links its dependents");
+        Check(IsBefore(dependents, "shaders/opaque_ps.hlsl", "pso.opaque"), "Shaders are rebuilt before their PSO");
+    }
+
+    void TestCycle()
+    {
+        DependencyGraph graph;
+
+        graph.AddDependency("a", "b");
+        graph.AddDependency("b", "c");
+        graph.AddDependency("c", "a");
+
+        const auto dependents = Dependents(graph, "a");
+
+        Check(dependents.size() == 3, "A cycle is broken, every node listed once");
+    }
+}
+
+int main()
+{
+    TestDependentsOrder();
+    TestEdgeRemoval();
+    TestCycle();
+
+    return DXSandbox::Tests::Result();
+}
@@ -0,0 +1,123 @@
+#include "Check.hpp"
+
+#include "DynamicResolution.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <vector>
+
+namespace
+{
+    using DXSandbox::DynamicResolution;
+    using DXSandbox::Tests::Check;
+
+    using Milliseconds = DynamicResolution::Milliseconds;
+
+    constexpr std::uint32_t FrameCount = 600;
+
+    struct Trace final
+    {
+        std::vector<double> scales;
+        std::vector<Milliseconds> gpuFrameTimes;
+        DynamicResolution::Statistics stats;
+    };
+
+    // GPU time of a frame at full resolution, by frame index
+    using Load = std::function<double(std::uint32_t)>;
+
+    // Frames whose GPU time follows the rendered pixels, with noise from a
+    // fixed seed, so every run of a trace is the same
+    Trace Simulate(const Load& load, Milliseconds cpuFrameTime = Milliseconds{8.0})
+    {
+        DynamicResolution controller{{}};
+
+        std::mt19937 random{7};
+        std::normal_distribution<double> noise{0.0, 0.5};
+
+        Trace trace;
+
+        for (std::uint32_t frame = 0; frame < FrameCount; ++frame)
+        {
+            const double scale = controller.Scale();
+            const Milliseconds gpuFrameTime{load(frame) * scale * scale + noise(random)};
+
+            trace.gpuFrameTimes.push_back(gpuFrameTime);
+            trace.scales.push_back(controller.Update(cpuFrameTime, gpuFrameTime));
+        }
+
+        trace.stats = controller.Stats();
+
+        return trace;
+    }
+
+    const DynamicResolution::Params DefaultParams;
+
+    void TestLightLoad()
+    {
+        const Trace trace = Simulate([](std::uint32_t) { return 12.0; });
+
+        Check(trace.scales.back() == DefaultParams.maxScale, "A load under the target renders at full resolution");
+        Check(trace.stats.changes == 0, "A load under the target never changes the scale");
+    }
+
+    void TestHeavyLoad()
+    {
+        const Trace trace = Simulate([](std::uint32_t) { return 28.0; });
+
+        const Milliseconds target = DefaultParams.targetFrameTime;
+
+        Check(trace.scales.back() < DefaultParams.maxScale, "A load over the target lowers the scale");
+        Check(trace.scales.back() >= DefaultParams.minScale, "The scale stays in its range");
+
+        // The last hundred frames, once settled, meet the target on average
+        Milliseconds total{};
+
+        for (std::uint32_t frame = FrameCount - 100; frame < FrameCount; ++frame)
+            total += trace.gpuFrameTimes[frame];
+
+        const Milliseconds average = total / 100.0;
+
+        Check(average <= target && average >= target * (1.0 - 2.0 * DefaultParams.headroom),
+              "A settled scale holds the GPU time in the band below the target");
+
+        Check(trace.stats.changes < 10, "The scale settles instead of oscillating");
+    }
+
+    void TestSpike()
+    {
+        auto load = [](std::uint32_t frame)
+        {
+            return frame == 300 ? 80.0 : frame < 200 ? 12.0 : frame < 400 ? 28.0 : 18.0;
+        };
+
+        const Trace trace = Simulate(load);
+
+        Check(trace.stats.panicDrops >= 1, "A frame far over the target drops the scale at once");
+        Check(trace.scales[300] < trace.scales[299], "The drop applies to the next frame");
+
+        const Trace replayed = Simulate(load);
+
+        Check(replayed.scales == trace.scales, "The same frame times always give the same scales");
+    }
+
+    void TestCpuBound()
+    {
+        // Heavy at first, then light, while the CPU alone misses the target
+        const Trace trace = Simulate([](std::uint32_t frame) { return frame < 200 ? 28.0 : 6.0; },
+                                     Milliseconds{20.0});
+
+        Check(trace.scales[199] < DefaultParams.maxScale, "The GPU still lowers the scale");
+        Check(trace.scales.back() == trace.scales[199], "The scale does not rise while the CPU misses the target");
+    }
+}
+
+int main()
+{
+    TestLightLoad();
+    TestHeavyLoad();
+    TestSpike();
+    TestCpuBound();
+
+    return DXSandbox::Tests::Result();
+}
@@ -0,0 +1,109 @@
+#include "Check.hpp"
+
+#include "FileWatcher.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    namespace fs = std::filesystem;
+
+    using DXSandbox::FileWatcher;
+    using DXSandbox::Tests::Check;
+
+    void WriteFile(const fs::path& path, const char* text)
+    {
+        std::ofstream{path, std::ios::trunc} << text;
+    }
+
+    // Notifications arrive in the background, so changes are collected
+    // until the expected number came or a second has passed
+    std::vector<fs::path> PollChanges(FileWatcher& watcher, std::size_t expectedCount)
+    {
+        std::vector<fs::path> changes;
+
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{1};
+
+        while (changes.size() < expectedCount && std::chrono::steady_clock::now() < deadline)
+        {
+            for (fs::path& path : watcher.Poll())
+            {
+                if (std::find(changes.begin(), changes.end(), path) == changes.end())
+                    changes.push_back(std::move(path));
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds{10});
+        }
+
+        return changes;
+    }
+
+    bool Contains(const std::vector<fs::path>& paths, const fs::path& path)
+    {
+        return std::find(paths.begin(), paths.end(), path) != paths.end();
+    }
+
+    void TestTree(const fs::path& root)
+    {
+        fs::create_directories(root / "sub");
+
+        FileWatcher watcher{root};
+
+        Check(watcher.Poll().empty(), "Nothing changed yet");
+
+        WriteFile(root / "a.txt", "a");
+        WriteFile(root / "sub" / "b.txt", "b");
+
+        auto changes = PollChanges(watcher, 2);
+
+        Check(changes.size() == 2, "Files written in the tree are reported once");
+        Check(Contains(changes, watcher.Directory() / "a.txt"), "Paths are absolute");
+        Check(Contains(changes, watcher.Directory() / "sub" / "b.txt"), "Subdirectories are watched");
+
+        // Written before the watcher can see the new directories
+        fs::create_directories(root / "new" / "deep");
+        WriteFile(root / "new" / "deep" / "c.txt", "c");
+
+        changes = PollChanges(watcher, 1);
+
+        Check(changes.size() == 1 && changes.front().filename() == "c.txt",
+              "Files in new directories are found by scanning them");
+
+        WriteFile(root / "new" / "deep" / "c.txt", "cc");
+
+        Check(PollChanges(watcher, 1).size() == 1, "New directories are watched");
+
+        // Written outside of the tree and moved in, as editors save files
+        const fs::path temporary = fs::path{root}.replace_extension(".tmp");
+
+        WriteFile(temporary, "d");
+        fs::rename(temporary, root / "sub" / "renamed.txt");
+
+        changes = PollChanges(watcher, 1);
+
+        Check(changes.size() == 1 && Contains(changes, watcher.Directory() / "sub" / "renamed.txt"),
+              "Files renamed into the tree are reported");
+
+        fs::remove_all(root / "new");
+
+        Check(PollChanges(watcher, 1).empty(), "Removals are not reported");
+    }
+}
+
+int main()
+{
+    const fs::path root = fs::temp_directory_path() / "DXSandboxFileWatcherTests";
+
+    fs::remove_all(root);
+
+    TestTree(root);
+
+    fs::remove_all(root);
+
+    return DXSandbox::Tests::Result();
+}
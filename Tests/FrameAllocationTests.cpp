@@ -0,0 +1,184 @@
+#include "Check.hpp"
+
+#include "AllocationTracking.hpp"
+#include "DrawQueue.hpp"
+#include "FrameArena.hpp"
+#include "Instrumentation.hpp"
+#include "SceneStore.hpp"
+#include "ThreadPool.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <latch>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+    using namespace DXSandbox;
+    using Tests::Check;
+
+    constexpr std::uint32_t WarmupFrames = 4;
+    constexpr std::uint32_t MeasuredFrames = 120;
+
+    constexpr std::uint32_t JobCount = 64;
+
+    struct FrameSize final
+    {
+        std::uint32_t rootCount = 0;
+        std::uint32_t childCount = 0;
+        std::uint32_t drawCount = 0;
+    };
+
+    constexpr FrameSize SmallFrame = {.rootCount = 64, .childCount = 8, .drawCount = 4096};
+
+    // Over the sizes at which the transform update and the sort dispatch
+    // their work in parallel
+    constexpr FrameSize ParallelFrame = {.rootCount = 8192, .childCount = 1, .drawCount = 1 << 16};
+
+    // Kept past the end of the frame, so the allocation cannot be elided
+    std::unique_ptr<std::uint64_t[]> g_frameData;
+
+    std::int64_t CounterValue(std::string_view name) noexcept
+    {
+        using Instrumentation::Counter;
+
+        for (const Counter* counter = Instrumentation::FirstCounter(); counter; counter = counter->Next())
+        {
+            if (counter->Name() == name)
+                return counter->Value();
+        }
+
+        return -1;
+    }
+
+    std::vector<Entity> PopulateScene(SceneStore& scene, const FrameSize& size)
+    {
+        std::vector<Entity> roots;
+
+        for (std::uint32_t i = 0; i < size.rootCount; ++i)
+        {
+            const Entity root = scene.CreateEntity();
+
+            for (std::uint32_t j = 0; j < size.childCount; ++j)
+                scene.CreateEntity(root, Math::Translation({static_cast<float>(j), 1.0f, 0.0f}));
+
+            roots.push_back(root);
+        }
+
+        return roots;
+    }
+
+    // The CPU side of a frame without a device, as GraphicsSystem runs it:
+    // the scene is animated, jobs are queued to the workers as the culler
+    // and the readback queue them, and the draws are submitted and sorted
+    // with the scratch of the frame arena
+    void RunFrame(SceneStore& scene, std::span<const Entity> roots, DrawQueue& drawQueue, FrameArena& arena,
+                  ThreadPool& workers, std::uint32_t drawCount, std::uint32_t frameIndex)
+    {
+        arena.Reset();
+
+        const float time = static_cast<float>(frameIndex) / 60.0f;
+
+        for (std::size_t i = 0; i < roots.size(); ++i)
+            scene.SetLocalTransform(roots[i], Math::Translation({time, static_cast<float>(i), 0.0f}));
+
+        scene.UpdateTransforms();
+
+        std::latch done{JobCount};
+        std::atomic<std::uint32_t> jobsRun = 0;
+
+        for (std::uint32_t i = 0; i < JobCount; ++i)
+        {
+            workers.Submit([&done, &jobsRun]
+            {
+                jobsRun.fetch_add(1, std::memory_order_relaxed);
+                done.count_down();
+            });
+        }
+
+        done.wait();
+
+        Check(jobsRun.load(std::memory_order_relaxed) == JobCount, "Every queued job runs");
+
+        drawQueue.Clear();
+
+        for (std::uint32_t i = 0; i < drawCount; ++i)
+        {
+            // Depth order changes every frame
+            const std::uint32_t depth = (i * 2654435761u + frameIndex * 40503u) % DrawSortKey::MaxDepth;
+
+            drawQueue.Submit(
+            {
+                .pass = i % 2,
+                .rootSignature = i % 4,
+                .pipelineState = i % 64,
+                .material = (i * 7) % 1024,
+                .depth = depth,
+                .vertexCount = 36,
+                .instanceCount = 1,
+                .startVertex = 0,
+                .startInstance = i
+            });
+        }
+
+        drawQueue.Sort(&arena);
+
+        FrameVector<const DrawPacket*> visiblePackets{&arena};
+
+        for (const DrawPacket& packet : drawQueue.SortedPackets())
+        {
+            if (packet.pass == 0)
+                visiblePackets.push_back(&packet);
+        }
+
+        Check(visiblePackets.size() == drawCount / 2, "Every draw of the first pass is sorted");
+    }
+
+    void TestSteadyStateFrames(const FrameSize& size)
+    {
+        SceneStore scene;
+        DrawQueue drawQueue;
+        FrameArena arena{64 * 1024 * 1024};
+        ThreadPool workers{2};
+
+        const std::vector<Entity> roots = PopulateScene(scene, size);
+
+        for (std::uint32_t frame = 0; frame < WarmupFrames + MeasuredFrames; ++frame)
+        {
+            RunFrame(scene, roots, drawQueue, arena, workers, size.drawCount, frame);
+
+            AllocationTracking::EndFrame();
+
+            if (frame >= WarmupFrames)
+                Check(CounterValue("Allocations.FrameCount") == 0, "A steady-state frame allocates");
+        }
+
+        Check(arena.Stats().overflowCount == 0, "The frame scratch overflows the arena");
+    }
+
+    // Otherwise the test above would pass without allocation tracking
+    void TestAllocatingFrame()
+    {
+        AllocationTracking::EndFrame();
+
+        g_frameData = std::make_unique<std::uint64_t[]>(64);
+
+        AllocationTracking::EndFrame();
+
+        Check(CounterValue("Allocations.FrameCount") == 1, "An allocating frame is counted");
+
+        g_frameData.reset();
+    }
+}
+
+int main()
+{
+    TestSteadyStateFrames(SmallFrame);
+    TestSteadyStateFrames(ParallelFrame);
+    TestAllocatingFrame();
+
+    return DXSandbox::Tests::Result();
+}
@@ -0,0 +1,154 @@
+#include "Check.hpp"
+
+#include "GpuScopeTree.hpp"
+#include "TraceRecorder.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    using namespace DXSandbox;
+    using Tests::Check;
+
+    using Clock = TraceRecorder::Clock;
+    using std::chrono::microseconds;
+
+    constexpr std::uint32_t TrackId = 0x8000'0000;
+
+    // One tick per microsecond, calibrated at tick 1000
+    constexpr std::uint64_t Frequency = 1'000'000;
+    constexpr std::uint64_t CalibrationTimestamp = 1000;
+
+    // Frame
+    //   Clear
+    //   Draws
+    //     Opaque
+    void BuildFrame(GpuScopeTree& tree)
+    {
+        Check(tree.Begin("Frame") == 0u, "The first scope begins at query 0");
+        Check(tree.Begin("Clear") == 2u, "Each scope begins at twice its index");
+        Check(tree.End() == 3u, "And ends at the next query");
+        Check(tree.Begin("Draws") == 4u, "A sibling takes the next scope");
+        Check(tree.Begin("Opaque") == 6u, "A child takes the next scope");
+        Check(tree.End() == 7u, "The innermost scope ends first");
+        Check(tree.End() == 5u, "Then its parent");
+        Check(tree.End() == 1u, "Then the root");
+    }
+
+    void TestNesting()
+    {
+        GpuScopeTree tree{8};
+
+        BuildFrame(tree);
+
+        const auto scopes = tree.Scopes();
+
+        Check(tree.IsBalanced() && tree.QueryCount() == 8, "Every scope that began has ended");
+        Check(scopes.size() == 4, "Every scope is kept");
+
+        if (scopes.size() != 4)
+            return;
+
+        Check(scopes[0].parent == GpuScopeTree::NoParent && scopes[0].depth == 0, "The root has no parent");
+        Check(scopes[1].parent == 0 && scopes[2].parent == 0 && scopes[1].depth == 1,
+              "Siblings share the root as their parent");
+        Check(scopes[3].parent == 2 && scopes[3].depth == 2, "A child nests in the scope open when it began");
+    }
+
+    // Timestamps in ticks, indexed by query, with the clock calibrated in
+    // the middle of the frame
+    void TestResolve()
+    {
+        GpuScopeTree tree{8};
+
+        BuildFrame(tree);
+
+        const std::vector<std::uint64_t> timestamps =
+        {
+            990, 1100,      // Frame, starting before the calibration
+            995, 1010,      // Clear
+            1020, 1090,     // Draws
+            1040, 1030      // Opaque, whose end the queue reports too early
+        };
+
+        const Clock::time_point cpuTime = Clock::now();
+
+        const GpuClockCalibration calibration =
+        {
+            .gpuTimestamp = CalibrationTimestamp,
+            .gpuFrequency = Frequency,
+            .cpuTime = cpuTime
+        };
+
+        std::vector<GpuScopeTree::ResolvedScope> resolved;
+
+        tree.Resolve(timestamps, calibration, resolved);
+
+        TraceRecorder trace;
+
+        trace.NameTrack(TrackId, "GPU");
+
+        GpuScopeTree::Export(resolved, trace, TrackId);
+
+        const std::vector<TraceRecorder::Event> events = trace.Events();
+
+        Check(events.size() == 4, "Every closed scope becomes a trace event");
+
+        if (events.size() != 4)
+            return;
+
+        auto isAt = [&](const TraceRecorder::Event& event, const char* name, std::int64_t start, std::int64_t end)
+        {
+            return event.name == name && event.threadId == TrackId &&
+                   event.start == cpuTime + microseconds{start} && event.duration == microseconds{end - start};
+        };
+
+        Check(isAt(events[0], "Frame", -10, 100), "Timestamps before the calibration come before its CPU time");
+        Check(isAt(events[1], "Clear", -5, 10), "Ticks are converted at the timestamp frequency");
+        Check(isAt(events[2], "Draws", 20, 90), "Events keep the order the scopes began in");
+        Check(isAt(events[3], "Opaque", 40, 40), "An end before its begin is clamped to the begin");
+
+        bool isNested = true;
+
+        for (const auto& [child, parent] : {std::pair{1, 0}, std::pair{2, 0}, std::pair{3, 2}})
+        {
+            isNested &= events[child].start >= events[parent].start;
+            isNested &= events[child].start + events[child].duration <= events[parent].start + events[parent].duration;
+        }
+
+        Check(isNested, "Children lie within their parents on the track");
+    }
+
+    void TestCapacity()
+    {
+        GpuScopeTree tree{2};
+
+        tree.Begin("Frame");
+        tree.Begin("Clear");
+        tree.End();
+
+        Check(!tree.Begin("Draws"), "A scope beyond the capacity is dropped");
+        Check(!tree.Begin("Opaque"), "So are its children");
+        Check(!tree.End() && !tree.End(), "Dropped scopes end without a query");
+        Check(tree.End() == 1u, "The scopes around them still end");
+
+        Check(tree.IsBalanced() && tree.DroppedScopes() == 2, "Dropped scopes are counted");
+        Check(tree.QueryCount() == tree.MaxQueryCount(), "Only the kept scopes use queries");
+
+        tree.Clear();
+
+        Check(tree.Scopes().empty() && tree.DroppedScopes() == 0, "Clearing starts the next frame");
+    }
+}
+
+int main()
+{
+    TestNesting();
+    TestResolve();
+    TestCapacity();
+
+    return DXSandbox::Tests::Result();
+}
@@ -0,0 +1,147 @@
+#include "Check.hpp"
+
+#include "MathBatch.hpp"
+
+#include <cstddef>
+#include <random>
+#include <vector>
+
+namespace
+{
+    namespace Math = DXSandbox::Math;
+
+    using DXSandbox::Tests::Check;
+
+    constexpr bool IsNear(float lhs, float rhs, float tolerance = 1e-5f)
+    {
+        return Math::Abs(lhs - rhs) <= tolerance;
+    }
+
+    constexpr bool IsNear(const Math::Float3& lhs, const Math::Float3& rhs, float tolerance = 1e-5f)
+    {
+        return IsNear(lhs.x, rhs.x, tolerance) && IsNear(lhs.y, rhs.y, tolerance) && IsNear(lhs.z, rhs.z, tolerance);
+    }
+
+    constexpr bool IsNear(const Math::Float4x4& lhs, const Math::Float4x4& rhs, float tolerance = 1e-5f)
+    {
+        for (int row = 0; row < 4; ++row)
+        {
+            for (int column = 0; column < 4; ++column)
+            {
+                if (!IsNear(lhs.m[row][column], rhs.m[row][column], tolerance))
+                    return false;
+            }
+        }
+
+        return true;
+    }
+
+    // The constant evaluated paths, which differ from the <cmath> ones
+    static_assert(Math::Sqrt(16.0f) == 4.0f);
+    static_assert(Math::Sqrt(0.0f) == 0.0f && Math::Sqrt(-1.0f) == 0.0f);
+    static_assert(IsNear(Math::Sqrt(2.0f), 1.41421356f));
+    static_assert(IsNear(Math::Sin(0.0f), 0.0f) && IsNear(Math::Sin(Math::HalfPi), 1.0f));
+    static_assert(IsNear(Math::Cos(0.0f), 1.0f) && IsNear(Math::Cos(Math::Pi), -1.0f));
+    static_assert(IsNear(Math::Sin(Math::TwoPi * 3.0f + Math::HalfPi), 1.0f, 1e-4f));
+    static_assert(IsNear(Math::Tan(Math::Pi / 4.0f), 1.0f));
+
+    static_assert(Math::Cross({1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}) == Math::Float3{0.0f, 0.0f, 1.0f});
+    static_assert(Math::Length({3.0f, 4.0f, 0.0f}) == 5.0f);
+    static_assert(IsNear(Math::Normalize(Math::Float3{0.0f, 0.0f, 2.0f}), {0.0f, 0.0f, 1.0f}));
+
+    // A quarter turn about y takes x to -z with the rotation matrices of
+    // the row vector convention
+    constexpr Math::Quaternion QuarterTurn = Math::RotationAxisAngle({0.0f, 1.0f, 0.0f}, Math::HalfPi);
+
+    static_assert(IsNear(Math::Rotate(QuarterTurn, {1.0f, 0.0f, 0.0f}), {0.0f, 0.0f, -1.0f}));
+    static_assert(IsNear(Math::TransformVector({1.0f, 0.0f, 0.0f}, Math::Rotation(QuarterTurn)),
+                         Math::Rotate(QuarterTurn, {1.0f, 0.0f, 0.0f})));
+
+    constexpr Math::Float4x4 Affine = Math::AffineTransformation({2.0f, 2.0f, 2.0f}, QuarterTurn,
+                                                                 {1.0f, 2.0f, 3.0f});
+
+    static_assert(IsNear(Math::TransformPoint({1.0f, 0.0f, 0.0f}, Affine), {1.0f, 2.0f, 1.0f}));
+    static_assert(IsNear(Math::Determinant(Affine), 8.0f, 1e-4f));
+    static_assert(IsNear(Affine * Math::Inverse(Affine), Math::Identity()));
+    static_assert(Math::Transpose(Math::Transpose(Affine)) == Affine);
+    static_assert(Math::Translation({1.0f, 2.0f, 3.0f}) * Math::Translation({-1.0f, -2.0f, -3.0f}) ==
+                  Math::Identity());
+
+    // The near plane maps to depth 0 and the far plane to depth 1
+    constexpr Math::Float4x4 Projection = Math::PerspectiveFovLH(Math::HalfPi, 1.0f, 1.0f, 100.0f);
+
+    static_assert(IsNear(Math::Transform({0.0f, 0.0f, 1.0f, 1.0f}, Projection).z, 0.0f));
+    static_assert(IsNear(Math::Transform({0.0f, 0.0f, 100.0f, 1.0f}, Projection).z /
+                         Math::Transform({0.0f, 0.0f, 100.0f, 1.0f}, Projection).w, 1.0f));
+
+    // Sizes around the four points of an SSE iteration, so every remainder
+    // goes through the tail
+    void TestTransformPoints()
+    {
+        std::mt19937 random{3};
+        std::uniform_real_distribution<float> coordinate{-100.0f, 100.0f};
+
+        bool isEqual = true;
+
+        for (std::size_t size = 0; size <= 67; ++size)
+        {
+            std::vector<Math::Float3> points(size);
+
+            for (Math::Float3& point : points)
+                point = {coordinate(random), coordinate(random), coordinate(random)};
+
+            std::vector<Math::Float3> scalar(size);
+            std::vector<Math::Float3> simd(size);
+
+            Math::Scalar::TransformPoints(points, Affine, scalar);
+            Math::Simd::TransformPoints(points, Affine, simd);
+
+            for (std::size_t i = 0; i < size; ++i)
+                isEqual &= IsNear(scalar[i], simd[i], 1e-3f);
+        }
+
+        Check(isEqual, "The SIMD points match the scalar ones for every batch size");
+    }
+
+    void TestMultiplyMatrices()
+    {
+        std::vector<Math::Float4x4> lhs;
+        std::vector<Math::Float4x4> rhs;
+
+        for (int i = 0; i < 16; ++i)
+        {
+            const float angle = 0.3f * static_cast<float>(i);
+
+            lhs.push_back(Math::AffineTransformation({1.0f, 2.0f, 3.0f},
+                                                     Math::RotationAxisAngle({1.0f, 1.0f, 0.0f}, angle),
+                                                     {angle, 0.0f, -angle}));
+            rhs.push_back(Math::Inverse(lhs.back()));
+        }
+
+        std::vector<Math::Float4x4> scalar(lhs.size());
+        std::vector<Math::Float4x4> simd(lhs.size());
+
+        Math::Scalar::MultiplyMatrices(lhs, rhs, scalar);
+        Math::Simd::MultiplyMatrices(lhs, rhs, simd);
+
+        bool isEqual = true;
+        bool isIdentity = true;
+
+        for (std::size_t i = 0; i < lhs.size(); ++i)
+        {
+            isEqual &= IsNear(scalar[i], simd[i]);
+            isIdentity &= IsNear(simd[i], Math::Identity(), 1e-4f);
+        }
+
+        Check(isEqual, "The SIMD products match the scalar ones");
+        Check(isIdentity, "A matrix times its inverse is the identity");
+    }
+}
+
+int main()
+{
+    TestTransformPoints();
+    TestMultiplyMatrices();
+
+    return DXSandbox::Tests::Result();
+}
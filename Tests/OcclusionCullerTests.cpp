@@ -0,0 +1,126 @@
+#include "Check.hpp"
+
+#include "OcclusionCuller.hpp"
+#include "ThreadPool.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+    using namespace DXSandbox::Math;
+
+    using DXSandbox::BoundingBox;
+    using DXSandbox::OcclusionCuller;
+    using DXSandbox::ThreadPool;
+    using DXSandbox::Tests::Check;
+
+    // A 10x10 wall 10 units in front of the camera, facing it
+    constexpr Float3 QuadVertices[] =
+    {
+        {-5.0f, -5.0f, 10.0f}, {5.0f, -5.0f, 10.0f}, {-5.0f, 5.0f, 10.0f}, {5.0f, 5.0f, 10.0f}
+    };
+
+    // Clockwise seen from the camera, and the other way around
+    constexpr std::uint32_t FrontIndices[] = {0, 2, 3, 0, 3, 1};
+    constexpr std::uint32_t BackIndices[] = {0, 3, 2, 0, 1, 3};
+
+    enum Box : std::size_t
+    {
+        Behind,
+        InFront,
+        Beside,
+        AcrossEdge,
+        LargerBehind,
+        BehindCamera,
+        BoxCount
+    };
+
+    const BoundingBox Boxes[BoxCount] =
+    {
+        {.min = {-1.0f, -1.0f, 20.0f}, .max = {1.0f, 1.0f, 22.0f}},
+        {.min = {-1.0f, -1.0f, 5.0f}, .max = {1.0f, 1.0f, 6.0f}},
+        {.min = {12.0f, -1.0f, 20.0f}, .max = {14.0f, 1.0f, 22.0f}},
+        {.min = {4.0f, -1.0f, 20.0f}, .max = {14.0f, 1.0f, 22.0f}},
+        {.min = {-30.0f, -1.0f, 40.0f}, .max = {30.0f, 1.0f, 42.0f}},
+        {.min = {-1.0f, -1.0f, -10.0f}, .max = {1.0f, 1.0f, -8.0f}}
+    };
+
+    std::vector<std::uint8_t> TestBoxes(OcclusionCuller& culler, const std::uint32_t (&indices)[6])
+    {
+        const OcclusionCuller::Params params;
+
+        const Float4x4 view = LookAtLH({0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 1.0f}, {0.0f, 1.0f, 0.0f});
+        const Float4x4 projection = PerspectiveFovLH(Pi / 3.0f, static_cast<float>(params.width) /
+                                                                static_cast<float>(params.height), 0.5f, 100.0f);
+
+        culler.BeginFrame(view * projection);
+        culler.AddOccluder(QuadVertices, indices, Identity());
+        culler.RenderOccluders();
+
+        std::vector<std::uint8_t> isVisible(BoxCount);
+
+        culler.TestVisibility(Boxes, isVisible);
+
+        return isVisible;
+    }
+
+    void TestOccluder(ThreadPool* workers)
+    {
+        OcclusionCuller culler{{}, workers};
+
+        const std::vector<std::uint8_t> isVisible = TestBoxes(culler, FrontIndices);
+
+        Check(!isVisible[Behind], "A box behind the occluder is hidden");
+        Check(isVisible[InFront], "A box in front of the occluder is visible");
+        Check(isVisible[Beside], "A box beside the occluder is visible");
+        Check(isVisible[AcrossEdge], "A box partly behind the occluder is visible");
+        Check(isVisible[LargerBehind], "A box behind the occluder but larger on screen is visible");
+        Check(!isVisible[BehindCamera], "A box behind the camera is outside of the view");
+
+        const OcclusionCuller::Statistics stats = culler.Stats();
+
+        Check(stats.occluderTriangles == 2 && stats.testedObjects == BoxCount, "Every triangle and box is counted");
+        Check(stats.occlusionCulledObjects == 1 && stats.frustumCulledObjects == 1,
+              "Hidden and outside boxes are counted apart");
+    }
+
+    void TestBackFace()
+    {
+        OcclusionCuller culler{{}};
+
+        const std::vector<std::uint8_t> isVisible = TestBoxes(culler, BackIndices);
+
+        Check(isVisible[Behind], "A back facing occluder hides nothing");
+    }
+
+    // The next frame starts from an empty depth buffer
+    void TestBeginFrame()
+    {
+        OcclusionCuller culler{{}};
+
+        TestBoxes(culler, FrontIndices);
+        culler.BeginFrame(Identity());
+        culler.RenderOccluders();
+
+        bool isCleared = true;
+
+        for (const float depth : culler.TileDepths())
+            isCleared &= depth == 1.0f;
+
+        Check(isCleared, "Beginning a frame clears the depths of the last one");
+    }
+}
+
+int main()
+{
+    TestOccluder(nullptr);
+
+    ThreadPool workers{4};
+
+    TestOccluder(&workers);
+    TestBackFace();
+    TestBeginFrame();
+
+    return DXSandbox::Tests::Result();
+}
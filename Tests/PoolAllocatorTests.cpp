@@ -0,0 +1,158 @@
+#include "Check.hpp"
+
+#include "PoolAllocator.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <set>
+#include <vector>
+
+namespace
+{
+    using DXSandbox::ObjectPool;
+    using DXSandbox::PoolAllocator;
+    using DXSandbox::Tests::Check;
+
+    constexpr std::size_t BlocksPerPage = 16;
+
+    void TestBlocks()
+    {
+        PoolAllocator pool{24, 32, BlocksPerPage};
+
+        std::vector<void*> blocks;
+        std::set<void*> distinct;
+
+        bool isAligned = true;
+
+        for (std::size_t i = 0; i < 3 * BlocksPerPage; ++i)
+        {
+            void* block = pool.AllocateBlock();
+
+            isAligned &= reinterpret_cast<std::uintptr_t>(block) % 32 == 0;
+
+            blocks.push_back(block);
+            distinct.insert(block);
+        }
+
+        Check(isAligned, "Blocks have the alignment of the pool");
+        Check(distinct.size() == blocks.size(), "Live blocks are distinct");
+        Check(pool.Stats().pageCount == 3, "Pages are added as the blocks run out");
+
+        void* freed = blocks.back();
+
+        pool.DeallocateBlock(freed);
+        blocks.pop_back();
+
+        Check(pool.AllocateBlock() == freed, "A freed block is handed out next");
+
+        blocks.push_back(freed);
+
+        for (void* block : blocks)
+            pool.DeallocateBlock(block);
+
+        const PoolAllocator::Statistics stats = pool.Stats();
+
+        Check(stats.liveBlocks == 0 && stats.peakBlocks == 3 * BlocksPerPage, "Live and peak blocks are counted");
+        Check(stats.pageCount == 3, "Pages are kept once freed");
+    }
+
+    void TestReserve()
+    {
+        PoolAllocator pool{64, alignof(std::max_align_t), BlocksPerPage};
+
+        pool.Reserve(BlocksPerPage + 1);
+
+        Check(pool.Stats().pageCount == 2, "Reserving adds the pages for the blocks");
+
+        std::vector<void*> blocks;
+
+        for (std::size_t i = 0; i < 2 * BlocksPerPage; ++i)
+            blocks.push_back(pool.AllocateBlock());
+
+        Check(pool.Stats().pageCount == 2, "Reserved blocks are allocated without new pages");
+
+        for (void* block : blocks)
+            pool.DeallocateBlock(block);
+    }
+
+    void TestMemoryResource()
+    {
+        PoolAllocator pool{16, alignof(std::max_align_t), BlocksPerPage};
+
+        {
+            // Nodes fit the blocks, while the large vector goes upstream
+            std::pmr::set<std::uint64_t> nodes{&pool};
+            std::pmr::vector<std::uint64_t> large{&pool};
+
+            for (std::uint64_t i = 0; i < 100; ++i)
+                nodes.insert(i);
+
+            large.resize(1000);
+
+            const PoolAllocator::Statistics stats = pool.Stats();
+
+            Check(nodes.size() == 100 && stats.liveBlocks == 0, "Nodes larger than a block go upstream");
+            Check(stats.oversizedAllocations >= 1, "Oversized allocations are counted");
+        }
+
+        PoolAllocator nodePool{64, alignof(std::max_align_t), BlocksPerPage};
+
+        {
+            std::pmr::set<std::uint64_t> nodes{&nodePool};
+
+            for (std::uint64_t i = 0; i < 100; ++i)
+                nodes.insert(i);
+
+            Check(nodePool.Stats().liveBlocks == 100, "Nodes that fit take a block each");
+        }
+
+        Check(nodePool.Stats().liveBlocks == 0, "Destroyed nodes return their blocks");
+    }
+
+    struct Tracked final
+    {
+        explicit Tracked(int& liveCount)
+            : liveCount{liveCount}
+        {
+            ++liveCount;
+        }
+
+        ~Tracked()
+        {
+            --liveCount;
+        }
+
+        int& liveCount;
+    };
+
+    void TestObjectPool()
+    {
+        ObjectPool<Tracked> pool{BlocksPerPage};
+
+        int liveCount = 0;
+
+        std::vector<Tracked*> objects;
+
+        for (std::size_t i = 0; i < BlocksPerPage; ++i)
+            objects.push_back(pool.Create(liveCount));
+
+        Check(liveCount == static_cast<int>(BlocksPerPage), "Created objects are constructed");
+        Check(pool.Stats().pageCount == 1, "Objects fill a page before the next is added");
+
+        for (Tracked* object : objects)
+            pool.Destroy(object);
+
+        Check(liveCount == 0 && pool.Stats().liveBlocks == 0, "Destroyed objects are destructed and freed");
+    }
+}
+
+int main()
+{
+    TestBlocks();
+    TestReserve();
+    TestMemoryResource();
+    TestObjectPool();
+
+    return DXSandbox::Tests::Result();
+}
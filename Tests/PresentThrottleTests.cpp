@@ -0,0 +1,103 @@
+#include "Check.hpp"
+
+#include "PresentThrottle.hpp"
+
+#include <chrono>
+
+namespace
+{
+    using DXSandbox::PresentThrottle;
+    using DXSandbox::Tests::Check;
+
+    using Action = PresentThrottle::Action;
+    using State = PresentThrottle::State;
+    using std::chrono::milliseconds;
+
+    constexpr PresentThrottle::Clock::duration Interval = milliseconds{100};
+
+    // Any fixed point will do, time only ever comes from the test
+    const PresentThrottle::Clock::time_point Start{std::chrono::hours{1}};
+
+    void TestOccluded()
+    {
+        PresentThrottle throttle{Interval};
+
+        Check(throttle.NextAction(Start) == Action::Render, "A visible window renders");
+        Check(throttle.WaitTimeout(Start) == PresentThrottle::Clock::duration::zero(), "A visible window never waits");
+
+        throttle.OnPresented(true, Start);
+
+        Check(throttle.CurrentState() == State::Occluded, "A present reporting occlusion occludes the window");
+        Check(throttle.NextAction(Start) == Action::Wait, "An occluded window waits");
+        Check(throttle.WaitTimeout(Start + milliseconds{30}) == milliseconds{70},
+              "The wait lasts until the next test present");
+        Check(throttle.NextAction(Start + Interval - milliseconds{1}) == Action::Wait,
+              "No test present before the interval");
+        Check(throttle.NextAction(Start + Interval) == Action::TestPresent, "A test present once the interval passed");
+        Check(throttle.WaitTimeout(Start + Interval + milliseconds{5}) == PresentThrottle::Clock::duration::zero(),
+              "An overdue test present does not wait");
+
+        throttle.OnPresented(true, Start + Interval);
+
+        Check(throttle.NextAction(Start + Interval + milliseconds{50}) == Action::Wait,
+              "A test present still occluded waits for another interval");
+        Check(throttle.NextAction(Start + 2 * Interval) == Action::TestPresent, "Test presents repeat every interval");
+
+        throttle.OnPresented(false, Start + 2 * Interval);
+
+        Check(throttle.CurrentState() == State::Visible, "A visible test present ends the occlusion");
+        Check(throttle.NextAction(Start + 2 * Interval) == Action::Render, "The window renders again at once");
+    }
+
+    void TestActivated()
+    {
+        PresentThrottle throttle{Interval};
+
+        throttle.OnActivated(Start);
+
+        Check(throttle.NextAction(Start) == Action::Render, "Activating a visible window changes nothing");
+
+        throttle.OnPresented(true, Start);
+        throttle.OnActivated(Start + milliseconds{10});
+
+        Check(throttle.NextAction(Start + milliseconds{10}) == Action::TestPresent,
+              "Activating an occluded window tests it right away");
+        Check(throttle.CurrentState() == State::Occluded, "Activation alone does not make the window visible");
+    }
+
+    void TestMinimized()
+    {
+        PresentThrottle throttle{Interval};
+
+        throttle.OnMinimized();
+
+        Check(throttle.NextAction(Start) == Action::Wait, "A minimized window waits");
+        Check(!throttle.WaitTimeout(Start), "A minimized window waits for a window event, without a timeout");
+        Check(throttle.NextAction(Start + 100 * Interval) == Action::Wait, "No test present while minimized");
+
+        throttle.OnPresented(false, Start);
+
+        Check(throttle.CurrentState() == State::Minimized, "Only a restore ends the minimization");
+
+        throttle.OnRestored();
+
+        Check(throttle.CurrentState() == State::Visible, "A restored window is visible");
+        Check(throttle.NextAction(Start) == Action::Render, "A restored window renders");
+
+        // Occluded, then minimized and restored
+        throttle.OnPresented(true, Start);
+        throttle.OnMinimized();
+        throttle.OnRestored();
+
+        Check(throttle.NextAction(Start) == Action::Render, "A restore renders the next frame to test the occlusion");
+    }
+}
+
+int main()
+{
+    TestOccluded();
+    TestActivated();
+    TestMinimized();
+
+    return DXSandbox::Tests::Result();
+}
@@ -0,0 +1,267 @@
+#include "Check.hpp"
+
+#include "QoiEncoder.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <vector>
+
+namespace
+{
+    using DXSandbox::Tests::Check;
+
+    namespace Qoi = DXSandbox::Qoi;
+
+    struct Image final
+    {
+        std::vector<std::uint8_t> pixels;
+        std::uint32_t width = 0;
+        std::uint32_t height = 0;
+        std::uint32_t rowPitch = 0;
+
+        Qoi::ImageView View() const noexcept
+        {
+            return
+            {
+                .pixels = reinterpret_cast<const std::byte*>(pixels.data()),
+                .width = width,
+                .height = height,
+                .rowPitch = rowPitch
+            };
+        }
+    };
+
+    struct Decoded final
+    {
+        std::uint32_t width = 0;
+        std::uint32_t height = 0;
+        std::uint8_t channels = 0;
+
+        // Tightly packed RGBA8
+        std::vector<std::uint8_t> pixels;
+    };
+
+    std::uint32_t ReadBigEndian(const std::uint8_t* in) noexcept
+    {
+        return std::uint32_t{in[0]} << 24 | std::uint32_t{in[1]} << 16 | std::uint32_t{in[2]} << 8 | in[3];
+    }
+
+    // Straight from the specification, without any of the encoder's code,
+    // so the two cannot share a mistake. Malformed input gives nothing.
+    std::optional<Decoded> Decode(const std::vector<std::uint8_t>& data)
+    {
+        constexpr std::size_t HeaderSize = 14;
+        constexpr std::uint8_t EndMarker[] = {0, 0, 0, 0, 0, 0, 0, 1};
+
+        if (data.size() < HeaderSize + sizeof(EndMarker) || data[0] != 'q' || data[1] != 'o' ||
+            data[2] != 'i' || data[3] != 'f')
+        {
+            return std::nullopt;
+        }
+
+        Decoded decoded{.width = ReadBigEndian(&data[4]), .height = ReadBigEndian(&data[8]), .channels = data[12]};
+
+        const std::size_t pixelCount = std::size_t{decoded.width} * decoded.height;
+        const std::size_t end = data.size() - sizeof(EndMarker);
+
+        decoded.pixels.reserve(pixelCount * 4);
+
+        std::uint8_t index[64][4] = {};
+        std::uint8_t pixel[4] = {0, 0, 0, 255};
+
+        std::size_t in = HeaderSize;
+
+        while (decoded.pixels.size() < pixelCount * 4)
+        {
+            if (in >= end)
+                return std::nullopt;
+
+            const std::uint8_t op = data[in++];
+            int run = 1;
+
+            if (op == 0xfe || op == 0xff)
+            {
+                const std::size_t channelCount = op == 0xff ? 4 : 3;
+
+                if (in + channelCount > end)
+                    return std::nullopt;
+
+                for (std::size_t channel = 0; channel < channelCount; ++channel)
+                    pixel[channel] = data[in++];
+            }
+            else if ((op & 0xc0) == 0x00)
+            {
+                for (int channel = 0; channel < 4; ++channel)
+                    pixel[channel] = index[op][channel];
+            }
+            else if ((op & 0xc0) == 0x40)
+            {
+                pixel[0] = static_cast<std::uint8_t>(pixel[0] + ((op >> 4) & 3) - 2);
+                pixel[1] = static_cast<std::uint8_t>(pixel[1] + ((op >> 2) & 3) - 2);
+                pixel[2] = static_cast<std::uint8_t>(pixel[2] + (op & 3) - 2);
+            }
+            else if ((op & 0xc0) == 0x80)
+            {
+                if (in >= end)
+                    return std::nullopt;
+
+                const int dg = (op & 0x3f) - 32;
+                const std::uint8_t next = data[in++];
+
+                pixel[0] = static_cast<std::uint8_t>(pixel[0] + dg + (next >> 4) - 8);
+                pixel[1] = static_cast<std::uint8_t>(pixel[1] + dg);
+                pixel[2] = static_cast<std::uint8_t>(pixel[2] + dg + (next & 0x0f) - 8);
+            }
+            else
+            {
+                run = (op & 0x3f) + 1;
+            }
+
+            const std::size_t hash = (pixel[0] * 3 + pixel[1] * 5 + pixel[2] * 7 + pixel[3] * 11) % 64;
+
+            for (int channel = 0; channel < 4; ++channel)
+                index[hash][channel] = pixel[channel];
+
+            for (int i = 0; i < run; ++i)
+                decoded.pixels.insert(decoded.pixels.end(), pixel, pixel + 4);
+        }
+
+        if (in != end || decoded.pixels.size() != pixelCount * 4)
+            return std::nullopt;
+
+        for (std::size_t i = 0; i < sizeof(EndMarker); ++i)
+        {
+            if (data[end + i] != EndMarker[i])
+                return std::nullopt;
+        }
+
+        return decoded;
+    }
+
+    // Flat areas for runs, gradients for the small differences, repeated
+    // colors for the index and noise with changing alpha for the rest
+    Image MakeImage(std::uint32_t width, std::uint32_t height, std::uint32_t rowPadding, std::mt19937& random)
+    {
+        Image image{.width = width, .height = height, .rowPitch = width * 4 + rowPadding};
+
+        image.pixels.resize(std::size_t{image.rowPitch} * height);
+
+        constexpr std::uint8_t Palette[][4] = {{255, 0, 0, 255}, {0, 255, 0, 255}, {10, 20, 30, 128}};
+
+        for (std::uint32_t y = 0; y < height; ++y)
+        {
+            for (std::uint32_t x = 0; x < width; ++x)
+            {
+                std::uint8_t* pixel = &image.pixels[std::size_t{y} * image.rowPitch + std::size_t{x} * 4];
+
+                switch ((x / 16 + y / 16) % 4)
+                {
+                case 0:
+                    pixel[0] = 40;
+                    pixel[1] = 80;
+                    pixel[2] = 120;
+                    pixel[3] = 255;
+                    break;
+                case 1:
+                    pixel[0] = static_cast<std::uint8_t>(x);
+                    pixel[1] = static_cast<std::uint8_t>(x + y);
+                    pixel[2] = static_cast<std::uint8_t>(y * 3);
+                    pixel[3] = 255;
+                    break;
+                case 2:
+                    for (int channel = 0; channel < 4; ++channel)
+                        pixel[channel] = Palette[random() % 3][channel];
+                    break;
+                default:
+                    for (int channel = 0; channel < 4; ++channel)
+                        pixel[channel] = static_cast<std::uint8_t>(random());
+                    break;
+                }
+            }
+        }
+
+        return image;
+    }
+
+    bool IsRoundTrip(const Image& image, std::uint8_t channels)
+    {
+        const std::optional<Decoded> decoded = Decode(Qoi::Encode(image.View(), channels));
+
+        if (!decoded || decoded->width != image.width || decoded->height != image.height ||
+            decoded->channels != channels)
+        {
+            return false;
+        }
+
+        for (std::uint32_t y = 0; y < image.height; ++y)
+        {
+            for (std::uint32_t x = 0; x < image.width; ++x)
+            {
+                const std::uint8_t* source = &image.pixels[std::size_t{y} * image.rowPitch + std::size_t{x} * 4];
+                const std::uint8_t* pixel = &decoded->pixels[(std::size_t{y} * image.width + x) * 4];
+
+                for (int channel = 0; channel < 4; ++channel)
+                {
+                    // Three channel images are opaque
+                    const std::uint8_t expected = channel == 3 && channels == 3 ? 255 : source[channel];
+
+                    if (pixel[channel] != expected)
+                        return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    void TestRoundTrip()
+    {
+        std::mt19937 random{5};
+
+        bool isRgbaRoundTrip = true;
+        bool isRgbRoundTrip = true;
+
+        // Odd sizes, a single pixel, padded rows, and a frame
+        const std::uint32_t Sizes[][3] = {{1, 1, 0}, {7, 3, 0}, {63, 1, 0}, {130, 70, 12}, {1920, 1080, 0}};
+
+        for (const auto& [width, height, rowPadding] : Sizes)
+        {
+            const Image image = MakeImage(width, height, rowPadding, random);
+
+            isRgbaRoundTrip &= IsRoundTrip(image, 4);
+            isRgbRoundTrip &= IsRoundTrip(image, 3);
+        }
+
+        Check(isRgbaRoundTrip, "RGBA images decode to the encoded pixels");
+        Check(isRgbRoundTrip, "RGB images decode to the encoded pixels, opaque");
+    }
+
+    // Runs longer than one op, ending with the image
+    void TestRuns()
+    {
+        const Image image
+        {
+            .pixels = std::vector<std::uint8_t>(200 * 4, 7),
+            .width = 200,
+            .height = 1,
+            .rowPitch = 200 * 4
+        };
+
+        const std::vector<std::uint8_t> encoded = Qoi::Encode(image.View());
+
+        Check(IsRoundTrip(image, 4), "A flat image decodes to its pixels");
+
+        // One RGBA op, then runs of 62, 62, 62 and 13 pixels
+        Check(encoded.size() == 14 + 5 + 4 + 8, "Repeated pixels are encoded as runs");
+    }
+}
+
+int main()
+{
+    TestRoundTrip();
+    TestRuns();
+
+    return DXSandbox::Tests::Result();
+}
@@ -0,0 +1,104 @@
+#include "Check.hpp"
+
+#include "RadixSort.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory_resource>
+#include <random>
+#include <vector>
+
+namespace
+{
+    using DXSandbox::RadixSortEntry;
+    using DXSandbox::RadixSorter;
+    using DXSandbox::Tests::Check;
+
+    // Around the threshold of the parallel chunks and well past it
+    constexpr std::size_t Sizes[] = {0, 1, 2, 3, 255, 256, 1000, 32767, 32768, 100'000, 1'000'000};
+
+    using KeyGenerator = std::function<std::uint64_t(std::mt19937_64&)>;
+
+    // The values are the original positions, so equal keys show whether
+    // their order was kept
+    std::vector<RadixSortEntry> MakeEntries(std::size_t count, std::mt19937_64& random, const KeyGenerator& key)
+    {
+        std::vector<RadixSortEntry> entries(count);
+
+        for (std::size_t i = 0; i < count; ++i)
+            entries[i] = {.key = key(random), .value = static_cast<std::uint32_t>(i)};
+
+        return entries;
+    }
+
+    std::vector<RadixSortEntry> StableSorted(std::vector<RadixSortEntry> entries)
+    {
+        std::stable_sort(entries.begin(), entries.end(),
+                         [](const RadixSortEntry& lhs, const RadixSortEntry& rhs) { return lhs.key < rhs.key; });
+
+        return entries;
+    }
+
+    bool IsEqual(const std::vector<RadixSortEntry>& lhs, const std::vector<RadixSortEntry>& rhs)
+    {
+        return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+                          [](const RadixSortEntry& a, const RadixSortEntry& b)
+                          {
+                              return a.key == b.key && a.value == b.value;
+                          });
+    }
+
+    void TestAgainstStableSort(const char* description, const KeyGenerator& key)
+    {
+        std::mt19937_64 random{11};
+
+        RadixSorter sorter;
+
+        bool isSorted = true;
+        bool isSortedWithScratch = true;
+
+        for (const std::size_t size : Sizes)
+        {
+            std::vector<RadixSortEntry> entries = MakeEntries(size, random, key);
+            const std::vector<RadixSortEntry> expected = StableSorted(entries);
+
+            std::vector<RadixSortEntry> withScratch = entries;
+
+            sorter.Sort(entries);
+            isSorted &= IsEqual(entries, expected);
+
+            std::pmr::monotonic_buffer_resource scratch;
+
+            sorter.Sort(withScratch, scratch);
+            isSortedWithScratch &= IsEqual(withScratch, expected);
+        }
+
+        Check(isSorted, description);
+        Check(isSortedWithScratch, description);
+    }
+}
+
+int main()
+{
+    TestAgainstStableSort("Random keys sort as std::stable_sort does",
+                          [](std::mt19937_64& random) { return random(); });
+
+    // Only a few values, so most keys are equal
+    TestAgainstStableSort("Duplicate keys keep their order",
+                          [](std::mt19937_64& random) { return random() % 16; });
+
+    // As draw keys, whose high bytes are shared and skip their passes
+    TestAgainstStableSort("Keys sharing their high bytes sort as std::stable_sort does",
+                          [](std::mt19937_64& random) { return 0xAB00'0000'0000'0000 | random() % 100'000; });
+
+    TestAgainstStableSort("Extreme keys sort as std::stable_sort does", [](std::mt19937_64& random)
+    {
+        constexpr std::uint64_t Keys[] = {0, 1, 0x8000'0000'0000'0000, ~std::uint64_t{0}};
+
+        return Keys[random() % 4];
+    });
+
+    return DXSandbox::Tests::Result();
+}
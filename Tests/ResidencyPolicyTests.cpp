@@ -0,0 +1,196 @@
+#include "Check.hpp"
+
+#include "ResidencyPolicy.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace
+{
+    using DXSandbox::ResidencyPolicy;
+    using DXSandbox::Tests::Check;
+
+    using ObjectId = ResidencyPolicy::ObjectId;
+
+    bool IsOnly(const std::vector<ObjectId>& ids, ObjectId id)
+    {
+        return ids.size() == 1 && ids.front() == id;
+    }
+
+    void TestLeastRecentlyUsed()
+    {
+        ResidencyPolicy policy{300};
+        ResidencyPolicy::Batch batch;
+
+        const ObjectId a = policy.Add(100);
+        const ObjectId b = policy.Add(100);
+        const ObjectId c = policy.Add(100);
+
+        policy.Update(0, batch);
+
+        Check(batch.evict.empty() && batch.makeResident.empty(), "Objects within the budget stay resident");
+
+        const ObjectId d = policy.Add(100);
+
+        policy.MarkUsed(a, 1);
+        policy.MarkUsed(d, 1);
+        policy.Update(0, batch);
+
+        Check(IsOnly(batch.evict, b), "The least recently used object is evicted over the budget");
+
+        policy.MarkUsed(b, 2);
+        policy.Update(1, batch);
+
+        Check(IsOnly(batch.makeResident, b), "An evicted object used again is made resident");
+        Check(IsOnly(batch.evict, c), "Which evicts the next least recently used one");
+        Check(policy.IsResident(b) && !policy.IsResident(c), "Residency follows the batch");
+
+        // Objects used by frame 3 are in flight until it completes
+        policy.SetBudget(100);
+        policy.MarkUsed(b, 3);
+        policy.MarkUsed(d, 3);
+        policy.Update(1, batch);
+
+        Check(IsOnly(batch.evict, a), "Completed objects are evicted to fit the budget");
+        Check(policy.IsResident(b) && policy.IsResident(d), "Objects in flight are never evicted");
+
+        policy.Update(3, batch);
+
+        Check(IsOnly(batch.evict, b) && policy.Stats().residentBytes == 100,
+              "The least recently used object is evicted once the frames complete");
+    }
+
+    // As the caller handles a batch that does not fit in video memory
+    void TestOutOfMemory()
+    {
+        ResidencyPolicy policy{300};
+        ResidencyPolicy::Batch batch;
+
+        const ObjectId a = policy.Add(100);
+        const ObjectId b = policy.Add(100);
+        const ObjectId c = policy.Add(100);
+
+        policy.MarkUsed(a, 1);
+        policy.MarkUsed(b, 1);
+        policy.MarkUsed(c, 1);
+        policy.SetBudget(200);
+        policy.Update(1, batch);
+
+        Check(IsOnly(batch.evict, a), "The budget evicts the least recently used object");
+
+        policy.MarkUsed(a, 2);
+        policy.Update(1, batch);
+
+        Check(IsOnly(batch.makeResident, a) && IsOnly(batch.evict, b), "Making one resident evicts another");
+
+        Check(policy.Trim(1, batch) && IsOnly(batch.evict, c), "Trimming evicts the next object");
+        Check(!policy.Trim(1, batch), "Trimming stops when nothing is left to evict");
+
+        policy.Defer(batch);
+
+        const ResidencyPolicy::Statistics stats = policy.Stats();
+
+        Check(!policy.IsResident(a), "A deferred object stays evicted");
+        Check(stats.residentBytes == 0 && stats.evictedBytes == 300, "Deferring keeps the bytes consistent");
+
+        policy.Update(2, batch);
+
+        Check(IsOnly(batch.makeResident, a) && batch.evict.empty(), "The next update retries the deferred object");
+    }
+
+    // Random uses, budgets, additions and removals over many frames; the
+    // invariants hold after every update
+    void TestSimulation()
+    {
+        std::mt19937 random{1};
+
+        ResidencyPolicy policy{1000};
+        ResidencyPolicy::Batch batch;
+
+        std::vector<ObjectId> ids;
+        std::vector<std::uint64_t> sizes;
+
+        auto add = [&]
+        {
+            const std::uint64_t size = random() % 100 + 1;
+            const ObjectId id = policy.Add(size);
+
+            if (id >= sizes.size())
+                sizes.resize(id + 1);
+
+            sizes[id] = size;
+
+            return id;
+        };
+
+        for (int i = 0; i < 50; ++i)
+            ids.push_back(add());
+
+        bool isConsistent = true;
+
+        for (std::uint64_t frame = 1; frame < 2000; ++frame)
+        {
+            for (int i = 0; i < 5; ++i)
+                policy.MarkUsed(ids[random() % ids.size()], frame);
+
+            if (random() % 100 == 0)
+                policy.SetBudget(random() % 3000);
+
+            if (random() % 50 == 0)
+            {
+                const std::size_t i = random() % ids.size();
+
+                policy.Remove(ids[i]);
+                ids[i] = add();
+            }
+
+            const std::uint64_t completedFenceValue = frame - 1;
+
+            policy.Update(completedFenceValue, batch);
+
+            for (const ObjectId id : batch.makeResident)
+                isConsistent &= policy.IsResident(id);
+
+            for (const ObjectId id : batch.evict)
+                isConsistent &= !policy.IsResident(id) && policy.LastUsed(id) <= completedFenceValue;
+
+            std::uint64_t residentBytes = 0;
+            std::uint64_t inFlightBytes = 0;
+            std::uint32_t residentCount = 0;
+
+            for (const ObjectId id : ids)
+            {
+                // The frame about to be submitted only uses resident objects
+                if (policy.LastUsed(id) > completedFenceValue)
+                {
+                    isConsistent &= policy.IsResident(id);
+                    inFlightBytes += sizes[id];
+                }
+
+                if (policy.IsResident(id))
+                {
+                    residentBytes += sizes[id];
+                    ++residentCount;
+                }
+            }
+
+            const ResidencyPolicy::Statistics stats = policy.Stats();
+
+            isConsistent &= stats.residentBytes == residentBytes && stats.residentCount == residentCount;
+            isConsistent &= residentBytes <= std::max(policy.Budget(), inFlightBytes);
+        }
+
+        Check(isConsistent, "Residency stays consistent with the uses and the budget");
+    }
+}
+
+int main()
+{
+    TestLeastRecentlyUsed();
+    TestOutOfMemory();
+    TestSimulation();
+
+    return DXSandbox::Tests::Result();
+}
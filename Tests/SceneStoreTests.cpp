@@ -0,0 +1,202 @@
+#include "Check.hpp"
+
+#include "SceneStore.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <vector>
+
+namespace
+{
+    using namespace DXSandbox;
+    using Tests::Check;
+
+    // Levels of several thousand entities, over the size at which they are
+    // updated in parallel
+    constexpr std::uint32_t RootCount = 5000;
+    constexpr std::uint32_t EntityCount = 40'000;
+
+    // The hierarchy as built, with the world transforms computed one entity
+    // at a time
+    struct Reference final
+    {
+        std::vector<Entity> entities;
+        std::vector<std::optional<std::size_t>> parents;
+        std::vector<Math::Float4x4> localTransforms;
+        std::vector<bool> isAlive;
+
+        Math::Float4x4 WorldTransform(std::size_t i) const
+        {
+            return parents[i] ? localTransforms[i] * WorldTransform(*parents[i]) : localTransforms[i];
+        }
+    };
+
+    Math::Float4x4 RandomTransform(std::mt19937& random)
+    {
+        std::uniform_real_distribution<float> distribution{-1.0f, 1.0f};
+
+        const Math::Quaternion rotation = Math::RotationAxisAngle({0.0f, 1.0f, 0.0f}, distribution(random));
+        const Math::Float3 position = {distribution(random), distribution(random), distribution(random)};
+
+        return Math::AffineTransformation({1.0f, 1.0f, 1.0f}, rotation, position);
+    }
+
+    bool IsNear(const Math::Float4x4& lhs, const Math::Float4x4& rhs) noexcept
+    {
+        for (int row = 0; row < 4; ++row)
+        {
+            for (int column = 0; column < 4; ++column)
+            {
+                if (std::abs(lhs.m[row][column] - rhs.m[row][column]) > 1e-4f)
+                    return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool MatchesReference(const SceneStore& scene, const Reference& reference)
+    {
+        bool isMatching = true;
+
+        for (std::size_t i = 0; i < reference.entities.size(); ++i)
+        {
+            if (reference.isAlive[i])
+                isMatching &= IsNear(scene.WorldTransform(reference.entities[i]), reference.WorldTransform(i));
+        }
+
+        return isMatching;
+    }
+
+    // Roots first, then entities under random earlier ones, so the depths
+    // vary from one branch to the next
+    Reference Populate(SceneStore& scene, std::mt19937& random)
+    {
+        Reference reference;
+
+        for (std::uint32_t i = 0; i < EntityCount; ++i)
+        {
+            std::optional<std::size_t> parent;
+
+            if (i >= RootCount)
+                parent = random() % i;
+
+            const Math::Float4x4 localTransform = RandomTransform(random);
+
+            reference.entities.push_back(scene.CreateEntity(parent ? reference.entities[*parent] : Entity{},
+                                                            localTransform));
+            reference.parents.push_back(parent);
+            reference.localTransforms.push_back(localTransform);
+            reference.isAlive.push_back(true);
+        }
+
+        return reference;
+    }
+
+    void TestUpdate()
+    {
+        std::mt19937 random{11};
+
+        SceneStore scene;
+        Reference reference = Populate(scene, random);
+
+        scene.UpdateTransforms();
+
+        Check(MatchesReference(scene, reference), "World transforms compose the local ones up the hierarchy");
+
+        // Dirty subtrees, deep and shallow, among clean ones
+        const std::vector<Math::Float4x4> before(scene.WorldTransforms().begin(), scene.WorldTransforms().end());
+
+        for (int i = 0; i < 50; ++i)
+        {
+            const std::size_t entity = random() % EntityCount;
+
+            reference.localTransforms[entity] = RandomTransform(random);
+            scene.SetLocalTransform(reference.entities[entity], reference.localTransforms[entity]);
+        }
+
+        scene.UpdateTransforms();
+
+        Check(MatchesReference(scene, reference), "Updating dirty subtrees matches a full recomputation");
+
+        std::size_t changed = 0;
+
+        for (std::size_t i = 0; i < before.size(); ++i)
+            changed += !(before[i] == scene.WorldTransforms()[i]);
+
+        Check(changed > 0 && changed < before.size(), "Only the dirty subtrees change");
+
+        scene.UpdateTransforms();
+
+        Check(MatchesReference(scene, reference), "An update without changes keeps the transforms");
+    }
+
+    void TestDestroy()
+    {
+        std::mt19937 random{13};
+
+        SceneStore scene;
+        Reference reference = Populate(scene, random);
+
+        scene.UpdateTransforms();
+
+        // Destroys subtrees, then moves a root so the update follows the
+        // storage sorted again
+        for (int i = 0; i < 20; ++i)
+        {
+            const std::size_t entity = RootCount + random() % (EntityCount - RootCount);
+
+            if (!reference.isAlive[entity])
+                continue;
+
+            scene.DestroyEntity(reference.entities[entity]);
+
+            for (std::size_t j = entity; j < EntityCount; ++j)
+            {
+                const auto parent = reference.parents[j];
+
+                if (j == entity || (parent && !reference.isAlive[*parent]))
+                    reference.isAlive[j] = false;
+            }
+        }
+
+        reference.localTransforms[0] = RandomTransform(random);
+        scene.SetLocalTransform(reference.entities[0], reference.localTransforms[0]);
+
+        scene.UpdateTransforms();
+
+        std::size_t aliveCount = 0;
+        bool isAliveMatching = true;
+
+        for (std::size_t i = 0; i < EntityCount; ++i)
+        {
+            aliveCount += reference.isAlive[i];
+            isAliveMatching &= scene.IsAlive(reference.entities[i]) == reference.isAlive[i];
+        }
+
+        Check(isAliveMatching, "Destroying an entity destroys its descendants");
+        Check(scene.EntityCount() == aliveCount && scene.WorldTransforms().size() == aliveCount,
+              "Only the live entities are counted and stored");
+        Check(MatchesReference(scene, reference), "The remaining entities keep their world transforms");
+
+        // Takes the slot of a destroyed entity
+        const Entity created = scene.CreateEntity();
+
+        bool isRevived = false;
+
+        for (std::size_t i = 0; i < EntityCount; ++i)
+            isRevived |= !reference.isAlive[i] && scene.IsAlive(reference.entities[i]);
+
+        Check(scene.IsAlive(created) && !isRevived, "A reused slot does not revive the destroyed entity");
+    }
+}
+
+int main()
+{
+    TestUpdate();
+    TestDestroy();
+
+    return DXSandbox::Tests::Result();
+}
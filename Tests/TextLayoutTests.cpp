@@ -0,0 +1,117 @@
+#include "Check.hpp"
+
+#include "GlyphAtlas.hpp"
+#include "TextLayout.hpp"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace
+{
+    using namespace DXSandbox;
+    using Tests::Check;
+
+    constexpr float LineHeight = 16.0f;
+    constexpr float Ascent = 12.0f;
+
+    constexpr std::uint32_t White = 0xffffffff;
+
+    // 'A' and '?' glyphs of 6x8 coverage on the baseline, which advance by
+    // 7 pixels once rounded, and a space advancing by 4
+    GlyphAtlas MakeAtlas()
+    {
+        GlyphAtlas atlas{128, 64, LineHeight, Ascent};
+
+        static const std::vector<std::uint8_t> coverage(6 * 8, 0x80);
+
+        const GlyphAtlas::GlyphBitmap glyph =
+        {
+            .width = 6,
+            .height = 8,
+            .bearingX = 1,
+            .bearingY = 8,
+            .advance = 7.4f,
+            .coverage = coverage
+        };
+
+        atlas.AddGlyph('A', glyph);
+        atlas.AddGlyph('?', glyph);
+        atlas.AddGlyph(' ', {.advance = 4.0f});
+
+        return atlas;
+    }
+
+    bool IsAt(const TextQuad& quad, float left, float top) noexcept
+    {
+        return quad.left == left && quad.top == top && quad.right == left + 6.0f && quad.bottom == top + 8.0f;
+    }
+
+    void TestText()
+    {
+        const GlyphAtlas atlas = MakeAtlas();
+
+        TextLayout layout{atlas};
+
+        // 'B' has no glyph and is drawn as '?'
+        const float width = layout.AddText(10.4f, 20.6f, "A A\nAB", White);
+
+        const std::span<const TextQuad> quads = layout.Quads();
+
+        Check(quads.size() == 4, "Every glyph with coverage gives a quad, spaces none");
+
+        if (quads.size() != 4)
+            return;
+
+        // The pen starts at (10, 21), snapped to whole pixels, and glyph
+        // tops are the ascent above the baseline
+        Check(IsAt(quads[0], 11.0f, 25.0f), "The first glyph is at the bearing from the pen");
+        Check(IsAt(quads[1], 22.0f, 25.0f), "Glyphs and spaces advance the pen by whole pixels");
+        Check(IsAt(quads[2], 11.0f, 41.0f), "A line feed starts a line below at the left");
+        Check(IsAt(quads[3], 18.0f, 41.0f), "The next glyph follows on the new line");
+
+        const GlyphAtlas::Glyph* question = atlas.Find('?');
+
+        Check(question && quads[3].u0 == question->u0 && quads[3].v1 == question->v1,
+              "A character without a glyph samples the '?' glyph");
+        Check(quads[0].u0 == quads[1].u0 && quads[0].v0 == quads[1].v0, "The same glyph samples the same texels");
+        Check(quads[0].u0 >= 0.0f && quads[0].u1 <= 1.0f && quads[0].u0 < quads[0].u1,
+              "Glyph texture coordinates are inside the atlas");
+        Check(quads[0].color == White, "Quads have the color of the text");
+
+        Check(width == 18.0f, "The width of the widest line is returned");
+        Check(layout.Measure("A A\nAB") == width, "Measuring matches the layout");
+
+        layout.Clear();
+
+        Check(layout.Quads().empty(), "Clearing removes the quads");
+    }
+
+    void TestRect()
+    {
+        const GlyphAtlas atlas = MakeAtlas();
+
+        TextLayout layout{atlas};
+
+        layout.AddRect(5.0f, 6.0f, 0.0f, 10.0f, White);
+
+        Check(layout.Quads().empty(), "An empty rectangle gives no quad");
+
+        layout.AddRect(5.0f, 6.0f, 20.0f, 10.0f, White);
+
+        const std::span<const TextQuad> quads = layout.Quads();
+
+        Check(quads.size() == 1 && quads[0].left == 5.0f && quads[0].top == 6.0f &&
+              quads[0].right == 25.0f && quads[0].bottom == 16.0f, "A rectangle covers its area");
+        Check(quads.size() == 1 && quads[0].u0 == atlas.SolidU() && quads[0].v1 == atlas.SolidV(),
+              "A rectangle samples the solid block");
+    }
+}
+
+int main()
+{
+    TestText();
+    TestRect();
+
+    return DXSandbox::Tests::Result();
+}
@@ -0,0 +1,121 @@
+#include "Check.hpp"
+
+#include "TlsfAllocator.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <random>
+
+namespace
+{
+    using DXSandbox::TlsfAllocator;
+    using DXSandbox::Tests::Check;
+
+    constexpr int RoundCount = 20;
+    constexpr int OperationCount = 200'000;
+
+    // Live allocations by offset
+    using LiveMap = std::map<std::uint64_t, TlsfAllocator::Allocation>;
+
+    bool IsDisjoint(const LiveMap& live, const TlsfAllocator::Allocation& allocation)
+    {
+        const auto next = live.lower_bound(allocation.offset);
+
+        if (next != live.end() && allocation.offset + allocation.size > next->first)
+            return false;
+        if (next != live.begin() && std::prev(next)->first + std::prev(next)->second.size > allocation.offset)
+            return false;
+
+        return true;
+    }
+
+    // Random allocations and frees of mixed sizes and alignments against a
+    // map of the live allocations, over heaps of varying capacity
+    void TestFuzz()
+    {
+        std::mt19937_64 random{7};
+
+        bool isValid = true;
+        bool isConsistent = true;
+        bool isCoalesced = true;
+
+        for (int round = 0; round < RoundCount; ++round)
+        {
+            const std::uint64_t capacity = (std::uint64_t{1} << 24) + random() % 1000 * TlsfAllocator::MinBlockSize;
+
+            TlsfAllocator allocator{capacity};
+
+            LiveMap live;
+            std::uint64_t usedBytes = 0;
+
+            for (int operation = 0; operation < OperationCount; ++operation)
+            {
+                if (live.empty() || random() % 2)
+                {
+                    // Mostly small, sometimes large
+                    const std::uint64_t size = 1 + random() % (random() % 4 ? 5000 : 300'000);
+                    const std::uint64_t alignment = std::uint64_t{1} << random() % 17;
+
+                    const TlsfAllocator::Allocation allocation = allocator.Allocate(size, alignment);
+
+                    if (!allocation.IsValid())
+                        continue;
+
+                    isValid &= allocation.offset % std::max(alignment, TlsfAllocator::MinBlockSize) == 0;
+                    isValid &= allocation.size >= size && allocation.offset + allocation.size <= capacity;
+                    isValid &= IsDisjoint(live, allocation);
+
+                    live[allocation.offset] = allocation;
+                    usedBytes += allocation.size;
+                }
+                else
+                {
+                    const auto freed = std::next(live.begin(), static_cast<std::ptrdiff_t>(random() % live.size()));
+
+                    allocator.Free(freed->second.handle);
+
+                    usedBytes -= freed->second.size;
+                    live.erase(freed);
+                }
+
+                if (operation % 10'000 == 0)
+                {
+                    const TlsfAllocator::Statistics stats = allocator.Stats();
+
+                    isConsistent &= stats.usedBytes == usedBytes && stats.allocationCount == live.size();
+
+                    std::size_t visited = 0;
+
+                    allocator.ForEachAllocation([&](const TlsfAllocator::Allocation& allocation)
+                    {
+                        isConsistent &= live.contains(allocation.offset);
+                        ++visited;
+                    });
+
+                    isConsistent &= visited == live.size();
+                }
+            }
+
+            for (const auto& [offset, allocation] : live)
+                allocator.Free(allocation.handle);
+
+            const TlsfAllocator::Statistics stats = allocator.Stats();
+
+            isCoalesced &= stats.freeBlockCount == 1 && stats.largestFreeBlock == stats.capacity;
+            isCoalesced &= allocator.Allocate(stats.capacity).IsValid();
+        }
+
+        Check(isValid, "Allocations are aligned, in range and disjoint");
+        Check(isConsistent, "Statistics and the visited allocations match the live allocations");
+        Check(isCoalesced, "Freeing everything merges the heap back into one block");
+    }
+}
+
+int main()
+{
+    TestFuzz();
+
+    return DXSandbox::Tests::Result();
+}
@@ -0,0 +1,133 @@
+#include "Check.hpp"
+
+#include "YuvConversion.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace
+{
+    using DXSandbox::Tests::Check;
+
+    namespace Yuv = DXSandbox::Yuv;
+
+    constexpr std::uint8_t Guard = 0xcd;
+
+    struct Image final
+    {
+        std::vector<std::uint8_t> pixels;
+        std::uint32_t width = 0;
+        std::uint32_t height = 0;
+        std::uint32_t rowPitch = 0;
+
+        Yuv::RgbaView View() const noexcept
+        {
+            return
+            {
+                .pixels = reinterpret_cast<const std::byte*>(pixels.data()),
+                .width = width,
+                .height = height,
+                .rowPitch = rowPitch
+            };
+        }
+    };
+
+    // Random channels, many at the ends of the range, where the packing of
+    // the SIMD path saturates
+    Image MakeImage(std::uint32_t width, std::uint32_t height, std::uint32_t rowPadding, std::mt19937& random)
+    {
+        Image image{.width = width, .height = height, .rowPitch = width * 4 + rowPadding};
+
+        image.pixels.resize(std::size_t{image.rowPitch} * height);
+
+        for (std::uint8_t& channel : image.pixels)
+        {
+            const std::uint32_t value = random();
+
+            channel = static_cast<std::uint8_t>(value % 4 == 0 ? 0 : value % 4 == 1 ? 255 : value >> 8);
+        }
+
+        return image;
+    }
+
+    // The planes, followed by guard bytes that neither path may write
+    std::vector<std::uint8_t> Convert(const Image& image, void (*convert)(const Yuv::RgbaView&, std::uint8_t*))
+    {
+        std::vector<std::uint8_t> planes(Yuv::I420Size(image.width, image.height) + 64, Guard);
+
+        convert(image.View(), planes.data());
+
+        return planes;
+    }
+
+    bool IsGuarded(const Image& image, const std::vector<std::uint8_t>& planes)
+    {
+        return std::all_of(planes.begin() + static_cast<std::ptrdiff_t>(Yuv::I420Size(image.width, image.height)),
+                           planes.end(), [](std::uint8_t value) { return value == Guard; });
+    }
+
+    void TestSimdMatchesScalar()
+    {
+        std::mt19937 random{9};
+
+        bool isEqual = true;
+        bool isGuarded = true;
+
+        // Every remainder of the eight pixel SIMD iteration, odd heights,
+        // padded rows, and a frame
+        std::vector<std::array<std::uint32_t, 3>> sizes = {{1, 1, 0}, {2, 2, 0}, {1920, 1080, 0}, {1280, 721, 32}};
+
+        for (std::uint32_t width = 1; width <= 33; ++width)
+            sizes.push_back({width, width % 5 + 1, width % 3 * 4});
+
+        for (const auto& [width, height, rowPadding] : sizes)
+        {
+            const Image image = MakeImage(width, height, rowPadding, random);
+
+            const std::vector<std::uint8_t> scalar = Convert(image, Yuv::Scalar::ConvertRgbaToI420);
+            const std::vector<std::uint8_t> simd = Convert(image, Yuv::Simd::ConvertRgbaToI420);
+
+            isEqual &= scalar == simd;
+            isGuarded &= IsGuarded(image, scalar) && IsGuarded(image, simd);
+        }
+
+        Check(isEqual, "The SIMD conversion gives the same bytes as the scalar one");
+        Check(isGuarded, "Conversions write only the I420 planes");
+    }
+
+    // Black and white at the ends of the limited range, without chroma
+    void TestLimitedRange()
+    {
+        Image image{.pixels = std::vector<std::uint8_t>(16 * 2 * 4), .width = 16, .height = 2, .rowPitch = 16 * 4};
+
+        // White on the left half, opaque black on the right
+        for (std::size_t i = 0; i < image.pixels.size(); ++i)
+        {
+            const std::size_t x = i / 4 % 16;
+
+            image.pixels[i] = i % 4 == 3 || x < 8 ? 255 : 0;
+        }
+
+        const std::vector<std::uint8_t> planes = Convert(image, Yuv::ConvertRgbaToI420);
+
+        const std::uint8_t* luma = planes.data();
+        const std::uint8_t* chroma = luma + 16 * 2;
+
+        Check(luma[0] == 235 && luma[16 + 7] == 235, "White is at the top of the luma range");
+        Check(luma[8] == 16 && luma[16 + 15] == 16, "Black is at the bottom of the luma range");
+        Check(std::all_of(chroma, chroma + 16, [](std::uint8_t value) { return value == 128; }),
+              "Grays have neutral chroma");
+    }
+}
+
+int main()
+{
+    TestSimdMatchesScalar();
+    TestLimitedRange();
+
+    return DXSandbox::Tests::Result();
+}